@@ -36,28 +36,37 @@ HEADERS = \
     qtwebenginecoreglobal_p.h \
     qwebenginecookiestore.h \
     qwebenginecookiestore_p.h \
+    qwebengineframetiming.h \
+    qwebengineframetiming_p.h \
     qwebenginehttprequest.h \
     qwebenginemessagepumpscheduler_p.h \
+    qwebenginenavigationpolicy.h \
     qwebenginequotarequest.h \
     qwebengineregisterprotocolhandlerrequest.h \
     qwebengineurlrequestinterceptor.h \
     qwebengineurlrequestinfo.h \
     qwebengineurlrequestinfo_p.h \
     qwebengineurlrequestjob.h \
+    qwebengineurlrequestruleset.h \
     qwebengineurlscheme.h \
-    qwebengineurlschemehandler.h
+    qwebengineurlschemehandler.h \
+    qwebenginewebchannelstatistics.h
 
 SOURCES = \
     qtwebenginecoreglobal.cpp \
     qwebenginecookiestore.cpp \
+    qwebengineframetiming.cpp \
     qwebenginehttprequest.cpp \
     qwebenginemessagepumpscheduler.cpp \
+    qwebenginenavigationpolicy.cpp \
     qwebenginequotarequest.cpp \
     qwebengineregisterprotocolhandlerrequest.cpp \
     qwebengineurlrequestinfo.cpp \
     qwebengineurlrequestjob.cpp \
+    qwebengineurlrequestruleset.cpp \
     qwebengineurlscheme.cpp \
-    qwebengineurlschemehandler.cpp
+    qwebengineurlschemehandler.cpp \
+    qwebenginewebchannelstatistics.cpp
 
 ### Qt6 Remove this workaround
 unix:!isEmpty(QMAKE_LFLAGS_VERSION_SCRIPT):!static {
@@ -42,6 +42,7 @@
 
 #include <QtWebEngineCore/qtwebenginecoreglobal.h>
 
+#include <QtCore/qjsonarray.h>
 #include <QtCore/qshareddata.h>
 #include <QtCore/qstring.h>
 #include <QtCore/qvariant.h>
@@ -92,6 +93,7 @@ private:
 
 Q_DECLARE_SHARED(QWebEngineCallback<int>)
 Q_DECLARE_SHARED(QWebEngineCallback<const QByteArray &>)
+Q_DECLARE_SHARED(QWebEngineCallback<const QJsonArray &>)
 Q_DECLARE_SHARED_NOT_MOVABLE_UNTIL_QT6(QWebEngineCallback<bool>)
 Q_DECLARE_SHARED_NOT_MOVABLE_UNTIL_QT6(QWebEngineCallback<const QString &>)
 Q_DECLARE_SHARED_NOT_MOVABLE_UNTIL_QT6(QWebEngineCallback<const QVariant &>)
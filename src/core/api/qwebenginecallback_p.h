@@ -56,6 +56,7 @@
 
 #include <QByteArray>
 #include <QHash>
+#include <QJsonArray>
 #include <QSharedData>
 #include <QString>
 #include <QVariant>
@@ -67,6 +68,7 @@
     F(int) \
     F(const QString &) \
     F(const QByteArray &) \
+    F(const QJsonArray &) \
     F(const QVariant &)
 
 namespace QtWebEngineCore {
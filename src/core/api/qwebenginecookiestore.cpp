@@ -41,28 +41,22 @@
 #include "qwebenginecookiestore_p.h"
 
 #include "net/base/registry_controlled_domains/registry_controlled_domain.h"
-
 #include "net/cookie_monster_delegate_qt.h"
+#include "net/cookie_policy_qt.h"
+#include "type_conversion.h"
 
 #include <QByteArray>
+#include <QMetaMethod>
 #include <QUrl>
 
-
-namespace {
-
-inline GURL toGurl(const QUrl& url)
-{
-    return GURL(url.toString().toStdString());
-}
-
-}
-
 QT_BEGIN_NAMESPACE
 
 using namespace QtWebEngineCore;
 
 QWebEngineCookieStorePrivate::QWebEngineCookieStorePrivate(QWebEngineCookieStore *q)
     : q_ptr(q)
+    , m_defaultCookieAccess(QWebEngineCookieStore::AllowCookies)
+    , m_thirdPartyCookieAccess(QWebEngineCookieStore::AllowCookies)
     , m_nextCallbackId(CallbackDirectory::ReservedCallbackIdsEnd)
     , m_deleteSessionCookiesPending(false)
     , m_deleteAllCookiesPending(false)
@@ -78,7 +72,7 @@ void QWebEngineCookieStorePrivate::processPendingUserCookies()
 
     if (m_getAllCookiesPending) {
         m_getAllCookiesPending = false;
-        delegate->getAllCookies(CallbackDirectory::GetAllCookiesCallbackId);
+        delegate->getAllCookies();
     }
 
     if (m_deleteAllCookiesPending) {
@@ -91,17 +85,18 @@ void QWebEngineCookieStorePrivate::processPendingUserCookies()
         delegate->deleteSessionCookies(CallbackDirectory::DeleteSessionCookiesCallbackId);
     }
 
-    if (m_pendingUserCookies.isEmpty())
-        return;
-
     for (const CookieData &cookieData : qAsConst(m_pendingUserCookies)) {
         if (cookieData.callbackId == CallbackDirectory::DeleteCookieCallbackId)
             delegate->deleteCookie(cookieData.cookie, cookieData.origin);
         else
             delegate->setCookie(cookieData.callbackId, cookieData.cookie, cookieData.origin);
     }
-
     m_pendingUserCookies.clear();
+
+    const QVector<std::function<void()>> bulkOperations = std::move(m_pendingBulkOperations);
+    m_pendingBulkOperations.clear();
+    for (const std::function<void()> &operation : bulkOperations)
+        operation();
 }
 
 void QWebEngineCookieStorePrivate::rejectPendingUserCookies()
@@ -110,6 +105,7 @@ void QWebEngineCookieStorePrivate::rejectPendingUserCookies()
     m_deleteAllCookiesPending = false;
     m_deleteSessionCookiesPending = false;
     m_pendingUserCookies.clear();
+    m_pendingBulkOperations.clear();
 }
 
 void QWebEngineCookieStorePrivate::setCookie(const QWebEngineCallback<bool> &callback, const QNetworkCookie &cookie, const QUrl &origin)
@@ -127,6 +123,16 @@ void QWebEngineCookieStorePrivate::setCookie(const QWebEngineCallback<bool> &cal
     delegate->setCookie(currentCallbackId, cookie, origin);
 }
 
+void QWebEngineCookieStorePrivate::setCookies(const QList<QNetworkCookie> &cookies, const QUrl &origin)
+{
+    if (!delegate || !delegate->hasCookieMonster()) {
+        m_pendingBulkOperations.append([this, cookies, origin] { delegate->setCookies(cookies, origin); });
+        return;
+    }
+
+    delegate->setCookies(cookies, origin);
+}
+
 void QWebEngineCookieStorePrivate::deleteCookie(const QNetworkCookie &cookie, const QUrl &url)
 {
     if (!delegate || !delegate->hasCookieMonster()) {
@@ -137,6 +143,16 @@ void QWebEngineCookieStorePrivate::deleteCookie(const QNetworkCookie &cookie, co
     delegate->deleteCookie(cookie, url);
 }
 
+void QWebEngineCookieStorePrivate::deleteCookies(const std::function<bool(const QNetworkCookie &)> &filter)
+{
+    if (!delegate || !delegate->hasCookieMonster()) {
+        m_pendingBulkOperations.append([this, filter] { delegate->deleteCookies(filter); });
+        return;
+    }
+
+    delegate->deleteCookies(filter);
+}
+
 void QWebEngineCookieStorePrivate::deleteSessionCookies()
 {
     if (!delegate || !delegate->hasCookieMonster()) {
@@ -165,13 +181,19 @@ void QWebEngineCookieStorePrivate::getAllCookies()
         return;
     }
 
-    delegate->getAllCookies(CallbackDirectory::GetAllCookiesCallbackId);
+    delegate->getAllCookies();
 }
 
-void QWebEngineCookieStorePrivate::onGetAllCallbackResult(qint64 callbackId, const QByteArray &cookieList)
+void QWebEngineCookieStorePrivate::loadCookies(const QString &domain)
 {
-    callbackDirectory.invoke(callbackId, cookieList);
+    if (!delegate || !delegate->hasCookieMonster()) {
+        m_pendingBulkOperations.append([this, domain] { delegate->loadCookies(domain); });
+        return;
+    }
+
+    delegate->loadCookies(domain);
 }
+
 void QWebEngineCookieStorePrivate::onSetCallbackResult(qint64 callbackId, bool success)
 {
     callbackDirectory.invoke(callbackId, success);
@@ -190,19 +212,99 @@ void QWebEngineCookieStorePrivate::onCookieChanged(const QNetworkCookie &cookie,
         Q_EMIT q_ptr->cookieAdded(cookie);
 }
 
-bool QWebEngineCookieStorePrivate::canAccessCookies(const QUrl &firstPartyUrl, const QUrl &url) const
+void QWebEngineCookieStorePrivate::onCookiesChanged(const QList<QNetworkCookie> &added, const QList<QNetworkCookie> &removed)
+{
+    Q_EMIT q_ptr->cookiesChanged(added, removed);
+}
+
+void QWebEngineCookieStorePrivate::onCookiesLoaded(const QString &domain, const QList<QNetworkCookie> &cookies, bool finished)
+{
+    Q_EMIT q_ptr->cookiesLoaded(domain, cookies, finished);
+}
+
+bool QWebEngineCookieStorePrivate::hasCookieChangedReceivers() const
 {
-    if (!filterCallback)
+    static const QMetaMethod cookieAddedSignal = QMetaMethod::fromSignal(&QWebEngineCookieStore::cookieAdded);
+    static const QMetaMethod cookieRemovedSignal = QMetaMethod::fromSignal(&QWebEngineCookieStore::cookieRemoved);
+    return q_ptr->isSignalConnected(cookieAddedSignal) || q_ptr->isSignalConnected(cookieRemovedSignal);
+}
+
+bool QWebEngineCookieStorePrivate::hasCookiesChangedReceivers() const
+{
+    static const QMetaMethod cookiesChangedSignal = QMetaMethod::fromSignal(&QWebEngineCookieStore::cookiesChanged);
+    return q_ptr->isSignalConnected(cookiesChangedSignal);
+}
+
+void QWebEngineCookieStorePrivate::setFilterCallback(FilterCallback &&filterCallback)
+{
+    QSharedPointer<const FilterCallback> callback;
+    if (filterCallback)
+        callback.reset(new FilterCallback(std::move(filterCallback)));
+
+    QMutexLocker lock(&m_cookiePolicyMutex);
+    m_filterCallback = callback;
+    m_hasCookiePolicyOrFilter.storeRelease(m_cookiePolicy || m_filterCallback);
+}
+
+void QWebEngineCookieStorePrivate::updateCookiePolicy()
+{
+    QHash<QString, CookiePolicyQt::Access> domainAccess;
+    for (auto it = m_domainCookieAccess.cbegin(); it != m_domainCookieAccess.cend(); ++it)
+        domainAccess.insert(it.key(), static_cast<CookiePolicyQt::Access>(it.value()));
+
+    QSharedPointer<const CookiePolicyQt> policy(
+                new CookiePolicyQt(static_cast<CookiePolicyQt::Access>(m_defaultCookieAccess),
+                                   static_cast<CookiePolicyQt::Access>(m_thirdPartyCookieAccess),
+                                   domainAccess));
+    if (policy->isTrivial())
+        policy.reset();
+
+    QMutexLocker lock(&m_cookiePolicyMutex);
+    m_cookiePolicy = policy;
+    m_hasCookiePolicyOrFilter.storeRelease(m_cookiePolicy || m_filterCallback);
+    lock.unlock();
+
+    if (delegate)
+        delegate->setCookiePolicy(policy);
+}
+
+QSharedPointer<const CookiePolicyQt> QWebEngineCookieStorePrivate::cookiePolicy()
+{
+    QMutexLocker lock(&m_cookiePolicyMutex);
+    return m_cookiePolicy;
+}
+
+bool QWebEngineCookieStorePrivate::canAccessCookies(const GURL &firstPartyUrl, const GURL &url)
+{
+    // Most profiles have neither, so the common case does not need to take the lock.
+    if (!m_hasCookiePolicyOrFilter.loadAcquire())
+        return true;
+
+    QMutexLocker lock(&m_cookiePolicyMutex);
+    if (!m_cookiePolicy && !m_filterCallback)
         return true;
 
     // Empty first-party URL indicates a first-party request (see net/base/static_cookie_policy.cc)
-    bool thirdParty = !firstPartyUrl.isEmpty() &&
-            !net::registry_controlled_domains::SameDomainOrHost(toGurl(url),
-                                                                toGurl(firstPartyUrl),
-                                                                net::registry_controlled_domains::INCLUDE_PRIVATE_REGISTRIES);
+    const std::string site = CookiePolicyQt::siteForUrl(url);
+    const std::string firstPartySite = firstPartyUrl.is_empty() ? site : CookiePolicyQt::siteForUrl(firstPartyUrl);
+    const bool thirdParty = firstPartySite != site;
+
+    if (m_cookiePolicy && m_cookiePolicy->evaluate(url, thirdParty) == CookiePolicyQt::Block)
+        return false;
+    if (!m_filterCallback)
+        return true;
 
-    QWebEngineCookieStore::FilterRequest request = { firstPartyUrl, url, thirdParty, false, 0};
-    return filterCallback(request);
+    // The filter is application code and must not run with the lock held.
+    const QSharedPointer<const FilterCallback> filterCallback = m_filterCallback;
+    lock.unlock();
+
+    // Filters keep getting the value they always got, which differs from the one above for URLs
+    // without a host, such as file: and qrc: URLs, that are never in the same domain.
+    const bool filterThirdParty = !firstPartyUrl.is_empty() &&
+            !net::registry_controlled_domains::SameDomainOrHost(url, firstPartyUrl,
+                                                                net::registry_controlled_domains::INCLUDE_PRIVATE_REGISTRIES);
+    QWebEngineCookieStore::FilterRequest request = { toQt(firstPartyUrl), toQt(url), filterThirdParty, false, 0};
+    return (*filterCallback)(request);
 }
 
 /*!
@@ -235,6 +337,29 @@ bool QWebEngineCookieStorePrivate::canAccessCookies(const QUrl &firstPartyUrl, c
     This signal is emitted whenever a \a cookie is deleted from the cookie store.
 */
 
+/*!
+    \fn void QWebEngineCookieStore::cookiesChanged(const QList<QNetworkCookie> &added, const QList<QNetworkCookie> &removed)
+    \since 5.13
+
+    This signal is emitted with the cookies \a added to and \a removed from the cookie store
+    since the last emission. Changes are collected on the IO thread and delivered from the
+    thread the cookie store lives in at most once per event loop iteration, which makes this
+    signal preferable to cookieAdded() and cookieRemoved() for bulk operations.
+
+    A cookie that is replaced is listed in both \a removed and \a added, and \a removed should be
+    applied first. Changes are only collected while the signal is connected.
+*/
+
+/*!
+    \fn void QWebEngineCookieStore::cookiesLoaded(const QString &domain, const QList<QNetworkCookie> &cookies, bool finished)
+    \since 5.13
+
+    This signal is emitted with a chunk of \a cookies in reply to loadCookies() for \a domain.
+    \a finished is \c true for the last chunk of the reply.
+
+    \sa loadCookies()
+*/
+
 /*!
     Creates a new QWebEngineCookieStore object with \a parent.
 */
@@ -271,6 +396,23 @@ void QWebEngineCookieStore::setCookie(const QNetworkCookie &cookie, const QUrl &
     d_ptr->setCookie(QWebEngineCallback<bool>(), cookie, origin);
 }
 
+/*!
+    \since 5.13
+
+    Adds \a cookies to the cookie store in one operation. If \a origin is empty, the origin of
+    each cookie is derived from its domain and path, as for setCookie().
+
+    \note This operation is asynchronous.
+    \sa setCookie(), cookiesChanged()
+*/
+
+void QWebEngineCookieStore::setCookies(const QList<QNetworkCookie> &cookies, const QUrl &origin)
+{
+    if (cookies.isEmpty())
+        return;
+    d_ptr->setCookies(cookies, origin);
+}
+
 /*!
     Deletes \a cookie from the cookie store.
     It is possible to provide an optional \a origin URL argument to limit the scope of the
@@ -284,6 +426,41 @@ void QWebEngineCookieStore::deleteCookie(const QNetworkCookie &cookie, const QUr
     d_ptr->deleteCookie(cookie, origin);
 }
 
+/*!
+    \since 5.13
+
+    Deletes all cookies for which \a filter returns \c true, in one operation.
+
+    The \a filter is called on the IO thread for every cookie in the store, so it must be
+    thread-safe and should be fast. Deleting all cookies is faster with deleteAllCookies().
+
+    \note This operation is asynchronous.
+    \sa deleteCookie(), cookiesChanged()
+*/
+
+void QWebEngineCookieStore::deleteCookies(const std::function<bool(const QNetworkCookie &)> &filter)
+{
+    if (!filter)
+        return;
+    d_ptr->deleteCookies(filter);
+}
+
+/*!
+    \since 5.13
+
+    Reads the cookies of \a domain and its subdomains without changing the cookie store. An empty
+    \a domain selects all cookies. The cookies are delivered in chunks through the
+    cookiesLoaded() signal, so that a large cookie jar does not block the event loop.
+
+    \note This operation is asynchronous.
+    \sa cookiesLoaded()
+*/
+
+void QWebEngineCookieStore::loadCookies(const QString &domain)
+{
+    d_ptr->loadCookies(domain);
+}
+
 /*!
     Loads all the cookies into the cookie store. The cookieAdded() signal is emitted on every
     loaded cookie. Cookies are loaded automatically when the store gets initialized, which
@@ -295,11 +472,9 @@ void QWebEngineCookieStore::deleteCookie(const QNetworkCookie &cookie, const QUr
 
 void QWebEngineCookieStore::loadAllCookies()
 {
-    //TODO: use callbacks or delete dummy ones
     if (d_ptr->m_getAllCookiesPending)
         return;
-    d_ptr->callbackDirectory.registerCallback(CallbackDirectory::GetAllCookiesCallbackId, QWebEngineCallback<const QByteArray&>());
-    //this will trigger cookieAdded signal
+    // Loading the cookies from the backing store triggers the cookieAdded signals.
     d_ptr->getAllCookies();
 }
 
@@ -357,15 +532,17 @@ void QWebEngineCookieStore::deleteAllCookies()
     The callback should not be used to execute heavy tasks since it is running on the
     IO thread and therefore blocks the Chromium networking.
 
+    Since Qt 5.13, accesses blocked by the cookie access rules do not reach the filter.
+
     \note The cookie filter also controls other features with tracking capabilities similar to
     those of cookies; including IndexedDB, DOM storage, filesystem API, service workers,
     and AppCache.
 
-    \sa deleteAllCookies(), loadAllCookies()
+    \sa deleteAllCookies(), loadAllCookies(), setDefaultCookieAccess()
 */
 void QWebEngineCookieStore::setCookieFilter(const std::function<bool(const FilterRequest &)> &filterCallback)
 {
-    d_ptr->filterCallback = filterCallback;
+    d_ptr->setFilterCallback(std::function<bool(const FilterRequest &)>(filterCallback));
 }
 
 /*!
@@ -374,7 +551,150 @@ void QWebEngineCookieStore::setCookieFilter(const std::function<bool(const Filte
 */
 void QWebEngineCookieStore::setCookieFilter(std::function<bool(const FilterRequest &)> &&filterCallback)
 {
-    d_ptr->filterCallback = std::move(filterCallback);
+    d_ptr->setFilterCallback(std::move(filterCallback));
+}
+
+/*!
+    \enum QWebEngineCookieStore::CookieAccess
+    \since 5.13
+
+    This enum describes which sites may use cookies and for how long.
+
+    \value AllowCookies Cookies can be read and written.
+    \value SessionOnlyCookies Cookies can be read and written, but are deleted from the
+            persistent cookie store when the profile is shut down.
+    \value BlockCookies Cookies can neither be read nor written.
+
+    The access rules also apply to the other storage features controlled by setCookieFilter().
+
+    \sa setDefaultCookieAccess(), setThirdPartyCookieAccess(), setCookieAccessForDomain()
+*/
+
+/*!
+    \since 5.13
+
+    Returns the access granted to sites that do not match a domain rule.
+
+    \sa setDefaultCookieAccess()
+*/
+QWebEngineCookieStore::CookieAccess QWebEngineCookieStore::defaultCookieAccess() const
+{
+    return d_ptr->m_defaultCookieAccess;
+}
+
+/*!
+    \since 5.13
+
+    Sets the \a access granted to sites that do not match a domain rule. The default is
+    \l AllowCookies.
+
+    Unlike a cookie filter, the access rules are evaluated on the IO thread without calling
+    into application code.
+
+    \sa setThirdPartyCookieAccess(), setCookieAccessForDomain()
+*/
+void QWebEngineCookieStore::setDefaultCookieAccess(CookieAccess access)
+{
+    if (d_ptr->m_defaultCookieAccess == access)
+        return;
+    d_ptr->m_defaultCookieAccess = access;
+    d_ptr->updateCookiePolicy();
+}
+
+/*!
+    \since 5.13
+
+    Returns the access granted to third-party sites that do not match a domain rule.
+
+    \sa setThirdPartyCookieAccess()
+*/
+QWebEngineCookieStore::CookieAccess QWebEngineCookieStore::thirdPartyCookieAccess() const
+{
+    return d_ptr->m_thirdPartyCookieAccess;
+}
+
+/*!
+    \since 5.13
+
+    Sets the \a access granted to third-party sites that do not match a domain rule. A site is
+    a third party when its registrable domain differs from the one of the page it is used in.
+    The third-party access can only restrict the default access further. The default is
+    \l AllowCookies.
+
+    \sa FilterRequest::thirdParty, setDefaultCookieAccess()
+*/
+void QWebEngineCookieStore::setThirdPartyCookieAccess(CookieAccess access)
+{
+    if (d_ptr->m_thirdPartyCookieAccess == access)
+        return;
+    d_ptr->m_thirdPartyCookieAccess = access;
+    d_ptr->updateCookiePolicy();
+}
+
+/*!
+    \since 5.13
+
+    Returns the domain rules set with setCookieAccessForDomain().
+*/
+QHash<QString, QWebEngineCookieStore::CookieAccess> QWebEngineCookieStore::cookieAccessForDomains() const
+{
+    return d_ptr->m_domainCookieAccess;
+}
+
+/*!
+    \since 5.13
+
+    Sets the \a access for \a domain and all of its subdomains, overriding the default and the
+    third-party access. The rule for the most specific domain applies, so
+    \c{mail.example.com} can be allowed while \c{example.com} is blocked.
+
+    \sa removeCookieAccessForDomain(), setCookieAccessForDomains()
+*/
+void QWebEngineCookieStore::setCookieAccessForDomain(const QString &domain, CookieAccess access)
+{
+    d_ptr->m_domainCookieAccess.insert(domain, access);
+    d_ptr->updateCookiePolicy();
+}
+
+/*!
+    \since 5.13
+
+    Sets the \a access for each of \a domains and their subdomains. This is equivalent to,
+    but faster than, calling setCookieAccessForDomain() for every domain.
+*/
+void QWebEngineCookieStore::setCookieAccessForDomains(const QStringList &domains, CookieAccess access)
+{
+    for (const QString &domain : domains)
+        d_ptr->m_domainCookieAccess.insert(domain, access);
+    d_ptr->updateCookiePolicy();
+}
+
+/*!
+    \since 5.13
+
+    Removes the rule for \a domain.
+
+    \sa setCookieAccessForDomain()
+*/
+void QWebEngineCookieStore::removeCookieAccessForDomain(const QString &domain)
+{
+    if (d_ptr->m_domainCookieAccess.remove(domain))
+        d_ptr->updateCookiePolicy();
+}
+
+/*!
+    \since 5.13
+
+    Removes all domain rules.
+
+    \sa setCookieAccessForDomain()
+*/
+void QWebEngineCookieStore::clearCookieAccessForDomains()
+{
+    if (d_ptr->m_domainCookieAccess.isEmpty())
+        return;
+    d_ptr->m_domainCookieAccess.clear();
+    d_ptr->updateCookiePolicy();
 }
 
 /*!
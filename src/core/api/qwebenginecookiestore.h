@@ -42,8 +42,10 @@
 
 #include <QtWebEngineCore/qtwebenginecoreglobal.h>
 
+#include <QtCore/qhash.h>
 #include <QtCore/qobject.h>
 #include <QtCore/qscopedpointer.h>
+#include <QtCore/qstringlist.h>
 #include <QtCore/qurl.h>
 #include <QtNetwork/qnetworkcookie.h>
 
@@ -68,19 +70,42 @@ public:
         bool _reservedFlag;
         ushort _reservedType;
     };
+
+    enum CookieAccess {
+        AllowCookies,
+        SessionOnlyCookies,
+        BlockCookies
+    };
+    Q_ENUM(CookieAccess)
+
     virtual ~QWebEngineCookieStore();
 
     void setCookieFilter(const std::function<bool(const FilterRequest &)> &filterCallback);
     void setCookieFilter(std::function<bool(const FilterRequest &)> &&filterCallback);
     void setCookie(const QNetworkCookie &cookie, const QUrl &origin = QUrl());
+    void setCookies(const QList<QNetworkCookie> &cookies, const QUrl &origin = QUrl());
     void deleteCookie(const QNetworkCookie &cookie, const QUrl &origin = QUrl());
+    void deleteCookies(const std::function<bool(const QNetworkCookie &)> &filter);
     void deleteSessionCookies();
     void deleteAllCookies();
     void loadAllCookies();
+    void loadCookies(const QString &domain);
+
+    CookieAccess defaultCookieAccess() const;
+    void setDefaultCookieAccess(CookieAccess access);
+    CookieAccess thirdPartyCookieAccess() const;
+    void setThirdPartyCookieAccess(CookieAccess access);
+    QHash<QString, CookieAccess> cookieAccessForDomains() const;
+    void setCookieAccessForDomain(const QString &domain, CookieAccess access);
+    void setCookieAccessForDomains(const QStringList &domains, CookieAccess access);
+    void removeCookieAccessForDomain(const QString &domain);
+    void clearCookieAccessForDomains();
 
 Q_SIGNALS:
     void cookieAdded(const QNetworkCookie &cookie);
     void cookieRemoved(const QNetworkCookie &cookie);
+    void cookiesChanged(const QList<QNetworkCookie> &added, const QList<QNetworkCookie> &removed);
+    void cookiesLoaded(const QString &domain, const QList<QNetworkCookie> &cookies, bool finished);
 
 private:
     explicit QWebEngineCookieStore(QObject *parent = Q_NULLPTR);
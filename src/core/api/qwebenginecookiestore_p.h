@@ -56,12 +56,19 @@
 #include "qwebenginecallback_p.h"
 #include "qwebenginecookiestore.h"
 
-#include <QVector>
+#include <QAtomicInt>
+#include <QHash>
+#include <QMutex>
 #include <QNetworkCookie>
+#include <QSharedPointer>
 #include <QUrl>
+#include <QVector>
+
+class GURL;
 
 namespace QtWebEngineCore {
 class CookieMonsterDelegateQt;
+class CookiePolicyQt;
 }
 
 QT_BEGIN_NAMESPACE
@@ -77,9 +84,15 @@ class QWEBENGINECORE_PRIVATE_EXPORT QWebEngineCookieStorePrivate
     friend class QTypeInfo<CookieData>;
     QWebEngineCookieStore *q_ptr;
 public:
+    typedef std::function<bool(const QWebEngineCookieStore::FilterRequest&)> FilterCallback;
+
     QtWebEngineCore::CallbackDirectory callbackDirectory;
-    std::function<bool(const QWebEngineCookieStore::FilterRequest&)> filterCallback;
+    QWebEngineCookieStore::CookieAccess m_defaultCookieAccess;
+    QWebEngineCookieStore::CookieAccess m_thirdPartyCookieAccess;
+    QHash<QString, QWebEngineCookieStore::CookieAccess> m_domainCookieAccess;
     QVector<CookieData> m_pendingUserCookies;
+    // Bulk operations requested before the cookie monster was available, in request order.
+    QVector<std::function<void()>> m_pendingBulkOperations;
     quint64 m_nextCallbackId;
     bool m_deleteSessionCookiesPending;
     bool m_deleteAllCookiesPending;
@@ -92,17 +105,38 @@ public:
     void processPendingUserCookies();
     void rejectPendingUserCookies();
     void setCookie(const QWebEngineCallback<bool> &callback, const QNetworkCookie &cookie, const QUrl &origin);
+    void setCookies(const QList<QNetworkCookie> &cookies, const QUrl &origin);
     void deleteCookie(const QNetworkCookie &cookie, const QUrl &url);
+    void deleteCookies(const std::function<bool(const QNetworkCookie &)> &filter);
     void deleteSessionCookies();
     void deleteAllCookies();
     void getAllCookies();
+    void loadCookies(const QString &domain);
+
+    void setFilterCallback(FilterCallback &&filterCallback);
+    void updateCookiePolicy();
+    QSharedPointer<const QtWebEngineCore::CookiePolicyQt> cookiePolicy();
 
-    bool canAccessCookies(const QUrl &firstPartyUrl, const QUrl &url) const;
+    // Called on the IO thread.
+    bool canAccessCookies(const GURL &firstPartyUrl, const GURL &url);
 
-    void onGetAllCallbackResult(qint64 callbackId, const QByteArray &cookieList);
     void onSetCallbackResult(qint64 callbackId, bool success);
     void onDeleteCallbackResult(qint64 callbackId, int numCookies);
     void onCookieChanged(const QNetworkCookie &cookie, bool removed);
+    void onCookiesChanged(const QList<QNetworkCookie> &added, const QList<QNetworkCookie> &removed);
+    void onCookiesLoaded(const QString &domain, const QList<QNetworkCookie> &cookies, bool finished);
+
+    // Called on the IO thread to skip converting changes nobody listens to.
+    bool hasCookieChangedReceivers() const;
+    bool hasCookiesChangedReceivers() const;
+
+private:
+    // Guards the members below, which are replaced on the UI thread and read on the IO thread.
+    QMutex m_cookiePolicyMutex;
+    QSharedPointer<const QtWebEngineCore::CookiePolicyQt> m_cookiePolicy;
+    QSharedPointer<const FilterCallback> m_filterCallback;
+    // Set while either of the above is, so the IO thread can skip the lock when both are unset.
+    QAtomicInt m_hasCookiePolicyOrFilter;
 };
 
 Q_DECLARE_TYPEINFO(QWebEngineCookieStorePrivate::CookieData, Q_MOVABLE_TYPE);
@@ -0,0 +1,298 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qwebengineframetiming.h"
+#include "qwebengineframetiming_p.h"
+
+#include "frame_timing_recorder.h"
+
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+QT_BEGIN_NAMESPACE
+
+using QtWebEngineCore::FrameTimingRecord;
+using QtWebEngineCore::FrameTimingReportData;
+
+/*!
+    \class QWebEngineFrameTiming
+    \brief The QWebEngineFrameTiming class holds the timings of one compositor frame
+    of a web page.
+
+    \since 5.13
+    \inmodule QtWebEngineCore
+
+    A frame goes through the following stages: it is submitted by the renderer,
+    committed to the Qt Quick scene graph, its textures are fetched from the GPU
+    thread, and it is presented by a swap of the window.
+
+    All timestamps are in microseconds of the monotonic clock used by Chromium,
+    the same clock as the \c ts field of Chrome trace events. They are -1 if the
+    frame did not reach the stage.
+
+    \sa QWebEngineFrameTimingReport
+*/
+
+/*! \internal */
+QWebEngineFrameTiming::QWebEngineFrameTiming()
+{
+}
+
+/*! \internal */
+QWebEngineFrameTiming::QWebEngineFrameTiming(QSharedPointer<const FrameTimingReportData> report, int index)
+    : d_ptr(report)
+    , m_index(index)
+{
+}
+
+const FrameTimingRecord *QWebEngineFrameTiming::record() const
+{
+    static const FrameTimingRecord emptyRecord;
+    return d_ptr ? &d_ptr->frames.at(m_index) : &emptyRecord;
+}
+
+/*!
+    \property QWebEngineFrameTiming::frameToken
+    \brief The token identifying the frame in Chromium.
+*/
+quint32 QWebEngineFrameTiming::frameToken() const
+{
+    return record()->frameToken;
+}
+
+/*!
+    \property QWebEngineFrameTiming::submitTime
+    \brief The time at which the renderer submitted the frame.
+*/
+qint64 QWebEngineFrameTiming::submitTime() const
+{
+    return record()->submitTime;
+}
+
+/*!
+    \property QWebEngineFrameTiming::commitStartTime
+    \brief The time at which the scene graph started to commit the frame.
+*/
+qint64 QWebEngineFrameTiming::commitStartTime() const
+{
+    return record()->commitStartTime;
+}
+
+/*!
+    \property QWebEngineFrameTiming::commitEndTime
+    \brief The time at which the scene graph nodes of the frame were updated.
+*/
+qint64 QWebEngineFrameTiming::commitEndTime() const
+{
+    return record()->commitEndTime;
+}
+
+/*!
+    \property QWebEngineFrameTiming::mailboxFetchTime
+    \brief The time at which the textures of the frame were ready to be rendered.
+*/
+qint64 QWebEngineFrameTiming::mailboxFetchTime() const
+{
+    return record()->mailboxFetchTime;
+}
+
+/*!
+    \property QWebEngineFrameTiming::swapTime
+    \brief The time at which the window presented the frame.
+*/
+qint64 QWebEngineFrameTiming::swapTime() const
+{
+    return record()->swapTime;
+}
+
+/*!
+    \property QWebEngineFrameTiming::dropped
+    \brief Whether the frame was replaced by a newer one before it could be presented.
+*/
+bool QWebEngineFrameTiming::isDropped() const
+{
+    return record()->dropped;
+}
+
+/*!
+    \property QWebEngineFrameTiming::stalled
+    \brief Whether rendering the frame had to wait for its textures longer than the budget.
+
+    The budget is 4 milliseconds, and can be changed with the
+    \c QTWEBENGINE_MAILBOX_FETCH_BUDGET environment variable, in microseconds.
+*/
+bool QWebEngineFrameTiming::isStalled() const
+{
+    return record()->stalled;
+}
+
+QWebEngineFrameTimingPrivate::NodeStatistics QWebEngineFrameTimingPrivate::nodeStatistics(const QWebEngineFrameTiming &timing)
+{
+    const QtWebEngineCore::FrameCommitStats &commitStats = timing.record()->commitStats;
+    NodeStatistics statistics;
+    statistics.reusedNodes = commitStats.reusedNodes;
+    statistics.createdNodes = commitStats.createdNodes;
+    statistics.destroyedNodes = commitStats.destroyedNodes;
+    statistics.skippedNodes = commitStats.skippedNodes;
+    return statistics;
+}
+
+/*!
+    \class QWebEngineFrameTimingReport
+    \brief The QWebEngineFrameTimingReport class holds the timings of the last
+    compositor frames of a web page.
+
+    \since 5.13
+    \inmodule QtWebEngineCore
+
+    The report is a snapshot of the timings recorded for the view currently
+    displaying the page. It contains the last 256 frames, oldest first, and
+    counts the frames dropped and stalled since the view was created.
+
+    \sa QWebEnginePage::frameTimingReport()
+*/
+
+/*! \internal */
+QWebEngineFrameTimingReport::QWebEngineFrameTimingReport()
+{
+}
+
+/*! \internal */
+QWebEngineFrameTimingReport::QWebEngineFrameTimingReport(QSharedPointer<const FrameTimingReportData> data)
+    : d_ptr(data)
+{
+}
+
+/*!
+    Returns the timings of the recorded frames, oldest first.
+*/
+QVector<QWebEngineFrameTiming> QWebEngineFrameTimingReport::frames() const
+{
+    QVector<QWebEngineFrameTiming> frames;
+    if (!d_ptr)
+        return frames;
+    frames.reserve(d_ptr->frames.size());
+    for (int i = 0; i < d_ptr->frames.size(); ++i)
+        frames.append(QWebEngineFrameTiming(d_ptr, i));
+    return frames;
+}
+
+/*!
+    \property QWebEngineFrameTimingReport::frames
+    \brief The timings of the recorded frames, oldest first, as a list of QWebEngineFrameTiming.
+*/
+QVariantList QWebEngineFrameTimingReport::frameList() const
+{
+    QVariantList frameList;
+    const QVector<QWebEngineFrameTiming> timings = frames();
+    frameList.reserve(timings.size());
+    for (const QWebEngineFrameTiming &timing : timings)
+        frameList.append(QVariant::fromValue(timing));
+    return frameList;
+}
+
+/*!
+    \property QWebEngineFrameTimingReport::droppedFrames
+    \brief The number of frames replaced by a newer one before they could be presented.
+*/
+int QWebEngineFrameTimingReport::droppedFrames() const
+{
+    return d_ptr ? d_ptr->droppedFrames : 0;
+}
+
+/*!
+    \property QWebEngineFrameTimingReport::stalledFrames
+    \brief The number of frames whose rendering had to wait for their textures longer than the budget.
+*/
+int QWebEngineFrameTimingReport::stalledFrames() const
+{
+    return d_ptr ? d_ptr->stalledFrames : 0;
+}
+
+static void appendStage(QJsonArray *events, const char *name, const FrameTimingRecord &record,
+                        qint64 startTime, qint64 endTime)
+{
+    if (startTime == -1 || endTime == -1)
+        return;
+    QJsonObject event;
+    event.insert(QStringLiteral("name"), QLatin1String(name));
+    event.insert(QStringLiteral("cat"), QStringLiteral("qtwebengine"));
+    event.insert(QStringLiteral("ph"), QStringLiteral("X"));
+    event.insert(QStringLiteral("ts"), double(startTime));
+    event.insert(QStringLiteral("dur"), double(endTime - startTime));
+    event.insert(QStringLiteral("pid"), double(QCoreApplication::applicationPid()));
+    event.insert(QStringLiteral("tid"), 0);
+    QJsonObject args;
+    args.insert(QStringLiteral("frameToken"), double(record.frameToken));
+    args.insert(QStringLiteral("dropped"), record.dropped);
+    args.insert(QStringLiteral("stalled"), record.stalled);
+    event.insert(QStringLiteral("args"), args);
+    events->append(event);
+}
+
+/*!
+    Returns the recorded frames in the Chrome trace event JSON format, which can be
+    loaded in \c chrome://tracing.
+
+    Each frame is reported as consecutive complete events, one per stage: \c Queued
+    until the commit starts, \c Commit, \c MailboxFetch until its textures are ready,
+    and \c Present until it is swapped.
+*/
+QString QWebEngineFrameTimingReport::toTraceEventJson() const
+{
+    QJsonArray events;
+    if (d_ptr) {
+        for (const FrameTimingRecord &record : d_ptr->frames) {
+            const qint64 readyTime = record.mailboxFetchTime != -1 ? record.mailboxFetchTime : record.commitEndTime;
+            appendStage(&events, "Queued", record, record.submitTime, record.commitStartTime);
+            appendStage(&events, "Commit", record, record.commitStartTime, record.commitEndTime);
+            appendStage(&events, "MailboxFetch", record, record.commitEndTime, record.mailboxFetchTime);
+            appendStage(&events, "Present", record, readyTime, record.swapTime);
+        }
+    }
+    QJsonObject trace;
+    trace.insert(QStringLiteral("traceEvents"), events);
+    trace.insert(QStringLiteral("displayTimeUnit"), QStringLiteral("ms"));
+    return QString::fromUtf8(QJsonDocument(trace).toJson(QJsonDocument::Compact));
+}
+
+QT_END_NAMESPACE
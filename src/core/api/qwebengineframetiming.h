@@ -0,0 +1,106 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QWEBENGINEFRAMETIMING_H
+#define QWEBENGINEFRAMETIMING_H
+
+#include <QtCore/qsharedpointer.h>
+#include <QtCore/qvariant.h>
+#include <QtCore/qvector.h>
+#include <QtWebEngineCore/qtwebenginecoreglobal.h>
+
+namespace QtWebEngineCore {
+class FrameTimingRecorder;
+struct FrameTimingRecord;
+struct FrameTimingReportData;
+}
+
+QT_BEGIN_NAMESPACE
+
+class QWEBENGINECORE_EXPORT QWebEngineFrameTiming {
+    Q_GADGET
+    Q_PROPERTY(quint32 frameToken READ frameToken CONSTANT FINAL)
+    Q_PROPERTY(qint64 submitTime READ submitTime CONSTANT FINAL)
+    Q_PROPERTY(qint64 commitStartTime READ commitStartTime CONSTANT FINAL)
+    Q_PROPERTY(qint64 commitEndTime READ commitEndTime CONSTANT FINAL)
+    Q_PROPERTY(qint64 mailboxFetchTime READ mailboxFetchTime CONSTANT FINAL)
+    Q_PROPERTY(qint64 swapTime READ swapTime CONSTANT FINAL)
+    Q_PROPERTY(bool dropped READ isDropped CONSTANT FINAL)
+    Q_PROPERTY(bool stalled READ isStalled CONSTANT FINAL)
+public:
+    QWebEngineFrameTiming();
+    quint32 frameToken() const;
+    qint64 submitTime() const;
+    qint64 commitStartTime() const;
+    qint64 commitEndTime() const;
+    qint64 mailboxFetchTime() const;
+    qint64 swapTime() const;
+    bool isDropped() const;
+    bool isStalled() const;
+private:
+    QWebEngineFrameTiming(QSharedPointer<const QtWebEngineCore::FrameTimingReportData> report, int index);
+    const QtWebEngineCore::FrameTimingRecord *record() const;
+    friend class QWebEngineFrameTimingReport;
+    friend class QWebEngineFrameTimingPrivate;
+    QSharedPointer<const QtWebEngineCore::FrameTimingReportData> d_ptr;
+    int m_index = -1;
+};
+
+class QWEBENGINECORE_EXPORT QWebEngineFrameTimingReport {
+    Q_GADGET
+    Q_PROPERTY(QVariantList frames READ frameList CONSTANT FINAL)
+    Q_PROPERTY(int droppedFrames READ droppedFrames CONSTANT FINAL)
+    Q_PROPERTY(int stalledFrames READ stalledFrames CONSTANT FINAL)
+public:
+    QWebEngineFrameTimingReport();
+    QVector<QWebEngineFrameTiming> frames() const;
+    int droppedFrames() const;
+    int stalledFrames() const;
+    Q_INVOKABLE QString toTraceEventJson() const;
+private:
+    QWebEngineFrameTimingReport(QSharedPointer<const QtWebEngineCore::FrameTimingReportData>);
+    QVariantList frameList() const;
+    friend class QtWebEngineCore::FrameTimingRecorder;
+    QSharedPointer<const QtWebEngineCore::FrameTimingReportData> d_ptr;
+};
+
+QT_END_NAMESPACE
+
+#endif // QWEBENGINEFRAMETIMING_H
@@ -41,14 +41,30 @@
 
 #include <QAbstractEventDispatcher>
 #include <QCoreApplication>
+#include <QThread>
 #include <QTimerEvent>
 
+static QAtomicPointer<QWebEngineMessagePumpScheduler> mainThreadScheduler;
+
 QWebEngineMessagePumpScheduler::QWebEngineMessagePumpScheduler(std::function<void()> callback)
     : m_callback(std::move(callback))
-{}
+{
+    if (QCoreApplication::instance() && QThread::currentThread() == QCoreApplication::instance()->thread())
+        mainThreadScheduler.testAndSetRelease(nullptr, this);
+}
+
+QWebEngineMessagePumpScheduler::~QWebEngineMessagePumpScheduler()
+{
+    mainThreadScheduler.testAndSetRelease(this, nullptr);
+}
 
 void QWebEngineMessagePumpScheduler::scheduleWork()
 {
+    // A single posted event is enough to run all the work scheduled until it is delivered.
+    if (!m_workPending.testAndSetAcquire(0, 1)) {
+        m_coalescedWakeups.fetchAndAddRelaxed(1);
+        return;
+    }
     QCoreApplication::postEvent(this, new QTimerEvent(0));
 }
 
@@ -63,10 +79,42 @@ void QWebEngineMessagePumpScheduler::scheduleDelayedWork(int delay)
     }
 }
 
+void QWebEngineMessagePumpScheduler::recordSlice(int tasks, bool overrun)
+{
+    m_slices.fetchAndAddRelaxed(1);
+    m_tasks.fetchAndAddRelaxed(tasks);
+    if (overrun)
+        m_sliceOverruns.fetchAndAddRelaxed(1);
+}
+
+QWebEngineMessagePumpScheduler::Statistics QWebEngineMessagePumpScheduler::statistics() const
+{
+    Statistics statistics;
+    statistics.wakeups = m_wakeups.load();
+    statistics.coalescedWakeups = m_coalescedWakeups.load();
+    statistics.slices = m_slices.load();
+    statistics.tasks = m_tasks.load();
+    statistics.sliceOverruns = m_sliceOverruns.load();
+    return statistics;
+}
+
+QWebEngineMessagePumpScheduler::Statistics QWebEngineMessagePumpScheduler::mainThreadStatistics()
+{
+    // Only read from the main thread, which is also the one that destroys the scheduler.
+    if (QWebEngineMessagePumpScheduler *scheduler = mainThreadScheduler.loadAcquire())
+        return scheduler->statistics();
+    return Statistics();
+}
+
 void QWebEngineMessagePumpScheduler::timerEvent(QTimerEvent *ev)
 {
     Q_ASSERT(!ev->timerId() || m_timerId == ev->timerId());
     killTimer(m_timerId);
     m_timerId = 0;
+    // Clear the flag before running the callback, so that work scheduled while it runs,
+    // possibly from another thread, gets its own event instead of being lost.
+    if (!ev->timerId())
+        m_workPending.storeRelease(0);
+    m_wakeups.fetchAndAddRelaxed(1);
     m_callback();
 }
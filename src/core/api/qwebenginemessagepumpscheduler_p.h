@@ -53,6 +53,7 @@
 
 #include "qtwebenginecoreglobal_p.h"
 
+#include <QtCore/qatomic.h>
 #include <QtCore/qobject.h>
 
 #include <functional>
@@ -63,16 +64,42 @@ class QWEBENGINECORE_PRIVATE_EXPORT QWebEngineMessagePumpScheduler : public QObj
 {
     Q_OBJECT
 public:
+    struct Statistics {
+        // Events delivered to the callback, and requests folded into an already pending one.
+        quint64 wakeups = 0;
+        quint64 coalescedWakeups = 0;
+        // Time slices run by the callback, the tasks executed in them, and the slices
+        // that ended with work left because they used up their time.
+        quint64 slices = 0;
+        quint64 tasks = 0;
+        quint64 sliceOverruns = 0;
+    };
+
     QWebEngineMessagePumpScheduler(std::function<void()> callback);
+    ~QWebEngineMessagePumpScheduler();
+    // May be called from any thread.
     void scheduleWork();
     void scheduleDelayedWork(int delay);
 
+    void recordSlice(int tasks, bool overrun);
+    Statistics statistics() const;
+    // The statistics of the scheduler created on the main thread, which drives the
+    // browser UI thread's message loop. They are all zero if there is none.
+    static Statistics mainThreadStatistics();
+
 protected:
     void timerEvent(QTimerEvent *ev) override;
 
 private:
     int m_timerId = 0;
     std::function<void()> m_callback;
+    // Set while an event is posted and its callback has not started yet.
+    QAtomicInt m_workPending;
+    QAtomicInteger<quint64> m_wakeups;
+    QAtomicInteger<quint64> m_coalescedWakeups;
+    QAtomicInteger<quint64> m_slices;
+    QAtomicInteger<quint64> m_tasks;
+    QAtomicInteger<quint64> m_sliceOverruns;
 };
 
 QT_END_NAMESPACE
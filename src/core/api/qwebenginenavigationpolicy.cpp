@@ -0,0 +1,243 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qwebenginenavigationpolicy.h"
+
+#include "net/navigation_policy_qt.h"
+
+#include <QtCore/QUrl>
+
+QT_BEGIN_NAMESPACE
+
+using QtWebEngineCore::NavigationPolicyQt;
+
+class QWebEngineNavigationPolicyPrivate : public QSharedData {
+public:
+    std::vector<NavigationPolicyQt::Rule> rules;
+    // Compiled on first use and dropped whenever a rule is added.
+    mutable QSharedPointer<const NavigationPolicyQt> compiled;
+};
+
+/*!
+    \class QWebEngineNavigationPolicy
+    \brief The QWebEngineNavigationPolicy class holds rules that decide about navigation
+    requests without asking the page.
+
+    \since 5.13
+    \inmodule QtWebEngineCore
+
+    A policy installed with QWebEngineProfile::setNavigationPolicy() is evaluated on the IO
+    thread for every navigation request of the profile's pages. A request that matches a rule
+    is accepted, blocked or ignored right away. Only requests that match no rule are passed to
+    QWebEnginePage::acceptNavigationRequest() or WebEngineView::navigationRequested, which
+    requires a round trip to the UI thread while the request waits.
+
+    Each rule matches a URL scheme, a host pattern, a set of navigation types and main frames,
+    subframes or both. The first rule added that matches a request decides about it. For
+    example, the following policy lets an application keep its own pages and HTTPS links
+    fast, and removes \c ads.example.com from all frames:
+
+    \code
+    QWebEngineNavigationPolicy policy;
+    policy.addRule(QWebEngineNavigationPolicy::BlockNavigation, QString(), "*.ads.example.com");
+    policy.addRule(QWebEngineNavigationPolicy::AcceptNavigation, "qrc");
+    policy.addRule(QWebEngineNavigationPolicy::AcceptNavigation, "https", QString(),
+                   { QWebEngineUrlRequestInfo::NavigationTypeLink });
+    profile->setNavigationPolicy(policy);
+    \endcode
+
+    In QML, the policy is a value type. Read WebEngineProfile::navigationPolicy, add rules to
+    the copy, and assign it back. Rules added from QML apply to all navigation types:
+
+    \code
+    var policy = profile.navigationPolicy;
+    policy.addRule(NavigationPolicy.AcceptNavigation, "qrc");
+    profile.navigationPolicy = policy;
+    \endcode
+*/
+
+/*!
+    \enum QWebEngineNavigationPolicy::Action
+
+    This enum describes what happens to a navigation request matching a rule.
+
+    \value AcceptNavigation The navigation proceeds.
+    \value BlockNavigation The navigation fails, and an error page is shown.
+    \value IgnoreNavigation The navigation is dropped, as if acceptNavigationRequest()
+           returned \c false.
+*/
+
+/*!
+    \enum QWebEngineNavigationPolicy::Frame
+
+    This enum describes the frames a rule applies to.
+
+    \value MainFrame Navigations of the top-level frame.
+    \value SubFrame Navigations of child frames.
+    \value AnyFrame Navigations of all frames.
+*/
+
+/*!
+    Constructs an empty policy.
+*/
+QWebEngineNavigationPolicy::QWebEngineNavigationPolicy()
+    : d(new QWebEngineNavigationPolicyPrivate)
+{
+}
+
+/*!
+    Constructs a copy of \a other.
+*/
+QWebEngineNavigationPolicy::QWebEngineNavigationPolicy(const QWebEngineNavigationPolicy &other)
+    : d(other.d)
+{
+}
+
+/*!
+    Assigns \a other to this policy.
+*/
+QWebEngineNavigationPolicy &QWebEngineNavigationPolicy::operator=(const QWebEngineNavigationPolicy &other)
+{
+    d = other.d;
+    return *this;
+}
+
+/*!
+    Destroys the policy.
+*/
+QWebEngineNavigationPolicy::~QWebEngineNavigationPolicy()
+{
+}
+
+/*!
+    Adds a rule that applies \a action to navigations of \a frames to URLs with \a scheme and a
+    host matching \a hostPattern, for the given \a navigationTypes.
+
+    An empty \a scheme matches all schemes. An empty \a hostPattern or \c * matches all hosts,
+    including none. A pattern of the form \c{*.example.com} matches \c example.com and all of
+    its subdomains, any other pattern matches only that exact host. An empty list of
+    \a navigationTypes matches all navigation types.
+
+    Returns \c false and leaves the policy unchanged if \a hostPattern is not a valid host name,
+    for example because it contains a wildcard anywhere but in a leading \c{*.}.
+*/
+bool QWebEngineNavigationPolicy::addRule(Action action, const QString &scheme, const QString &hostPattern,
+                                         const QList<QWebEngineUrlRequestInfo::NavigationType> &navigationTypes,
+                                         Frames frames)
+{
+    NavigationPolicyQt::Rule rule;
+    rule.action = NavigationPolicyQt::NoMatch;
+    switch (action) {
+    case AcceptNavigation:
+        rule.action = NavigationPolicyQt::Accept;
+        break;
+    case BlockNavigation:
+        rule.action = NavigationPolicyQt::Block;
+        break;
+    case IgnoreNavigation:
+        rule.action = NavigationPolicyQt::Ignore;
+        break;
+    }
+
+    rule.scheme = scheme.toLower().toStdString();
+    rule.includeSubdomains = false;
+    if (!hostPattern.isEmpty() && hostPattern != QLatin1String("*")) {
+        QString host = hostPattern.toLower();
+        if (host.startsWith(QLatin1String("*."))) {
+            rule.includeSubdomains = true;
+            host.remove(0, 2);
+        }
+        // QUrl::toAce() returns an empty string for hosts it rejects, which would match all hosts.
+        const QByteArray aceHost = host.contains(QLatin1Char('*')) ? QByteArray() : QUrl::toAce(host);
+        if (aceHost.isEmpty()) {
+            qWarning("QWebEngineNavigationPolicy::addRule: Invalid host pattern %s", qPrintable(hostPattern));
+            return false;
+        }
+        rule.host = aceHost.toStdString();
+    }
+
+    rule.navigationTypes = 0;
+    for (QWebEngineUrlRequestInfo::NavigationType type : navigationTypes)
+        rule.navigationTypes |= 1u << type;
+    if (!rule.navigationTypes)
+        rule.navigationTypes = ~0u;
+    rule.mainFrame = frames.testFlag(MainFrame);
+    rule.subFrame = frames.testFlag(SubFrame);
+
+    d->rules.push_back(std::move(rule));
+    d->compiled.reset();
+    return true;
+}
+
+/*!
+    Returns the number of rules in the policy.
+*/
+int QWebEngineNavigationPolicy::ruleCount() const
+{
+    return int(d->rules.size());
+}
+
+/*!
+    Returns whether the policy has no rules.
+*/
+bool QWebEngineNavigationPolicy::isEmpty() const
+{
+    return d->rules.empty();
+}
+
+/*!
+    Removes all rules.
+*/
+void QWebEngineNavigationPolicy::clear()
+{
+    d->rules.clear();
+    d->compiled.reset();
+}
+
+/*! \internal */
+QSharedPointer<const NavigationPolicyQt> QWebEngineNavigationPolicy::compiled() const
+{
+    if (d->rules.empty())
+        return QSharedPointer<const NavigationPolicyQt>();
+    if (!d->compiled)
+        d->compiled.reset(new NavigationPolicyQt(d->rules));
+    return d->compiled;
+}
+
+QT_END_NAMESPACE
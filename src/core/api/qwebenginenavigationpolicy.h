@@ -0,0 +1,102 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QWEBENGINENAVIGATIONPOLICY_H
+#define QWEBENGINENAVIGATIONPOLICY_H
+
+#include <QtWebEngineCore/qtwebenginecoreglobal.h>
+#include <QtWebEngineCore/qwebengineurlrequestinfo.h>
+
+#include <QtCore/qlist.h>
+#include <QtCore/qshareddata.h>
+#include <QtCore/qsharedpointer.h>
+#include <QtCore/qstring.h>
+
+namespace QtWebEngineCore {
+class NavigationPolicyQt;
+class ProfileIODataQt;
+}
+
+QT_BEGIN_NAMESPACE
+
+class QWebEngineNavigationPolicyPrivate;
+
+class QWEBENGINECORE_EXPORT QWebEngineNavigationPolicy {
+    Q_GADGET
+    Q_PROPERTY(int ruleCount READ ruleCount FINAL)
+    Q_PROPERTY(bool empty READ isEmpty FINAL)
+public:
+    enum Action {
+        AcceptNavigation,
+        BlockNavigation,
+        IgnoreNavigation
+    };
+    Q_ENUM(Action)
+
+    enum Frame {
+        MainFrame = 0x1,
+        SubFrame = 0x2,
+        AnyFrame = MainFrame | SubFrame
+    };
+    Q_DECLARE_FLAGS(Frames, Frame)
+    Q_FLAG(Frames)
+
+    QWebEngineNavigationPolicy();
+    QWebEngineNavigationPolicy(const QWebEngineNavigationPolicy &other);
+    QWebEngineNavigationPolicy &operator=(const QWebEngineNavigationPolicy &other);
+    ~QWebEngineNavigationPolicy();
+
+    Q_INVOKABLE bool addRule(Action action, const QString &scheme, const QString &hostPattern = QString(),
+                 const QList<QWebEngineUrlRequestInfo::NavigationType> &navigationTypes = QList<QWebEngineUrlRequestInfo::NavigationType>(),
+                 Frames frames = AnyFrame);
+    int ruleCount() const;
+    bool isEmpty() const;
+    Q_INVOKABLE void clear();
+
+private:
+    QSharedPointer<const QtWebEngineCore::NavigationPolicyQt> compiled() const;
+    friend class QtWebEngineCore::ProfileIODataQt;
+    QSharedDataPointer<QWebEngineNavigationPolicyPrivate> d;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(QWebEngineNavigationPolicy::Frames)
+
+QT_END_NAMESPACE
+
+#endif // QWEBENGINENAVIGATIONPOLICY_H
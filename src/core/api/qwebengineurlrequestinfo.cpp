@@ -39,6 +39,7 @@
 
 #include "qwebengineurlrequestinfo.h"
 #include "qwebengineurlrequestinfo_p.h"
+#include "qwebengineurlrequestinterceptor.h"
 
 #include "content/public/common/resource_type.h"
 
@@ -121,9 +122,73 @@ ASSERT_ENUMS_MATCH(QtWebEngineCore::WebContentsAdapterClient::OtherNavigation, Q
     \a info contains the information about the URL request and will track internally
     whether its members have been altered.
 
-    \warning All method calls to the profile on the main thread will block until
+    \warning Replacing the interceptor of the profile on the main thread will block until
     execution of this function is finished.
+
+    \sa QWebEngineAsyncUrlRequestInterceptor
+*/
+
+/*!
+    \class QWebEngineAsyncUrlRequestInterceptor
+    \inmodule QtWebEngineCore
+    \since 5.13
+    \brief The QWebEngineAsyncUrlRequestInterceptor class provides an abstract base class for
+    URL interception that can defer its decision.
+
+    Unlike QWebEngineUrlRequestInterceptor, an asynchronous interceptor does not need to decide
+    about a request before returning from interceptRequestAsync(). The request is held back
+    until finishRequest() is called for it, which allows looking up a policy on a worker thread
+    without blocking the networking of other requests.
+
+    \sa QWebEngineProfile::setRequestInterceptor()
+*/
+
+/*!
+    \fn QWebEngineAsyncUrlRequestInterceptor::QWebEngineAsyncUrlRequestInterceptor(QObject * p = 0)
+
+    Creates a new QWebEngineAsyncUrlRequestInterceptor object with \a p as parent.
+*/
+
+/*!
+    \fn void QWebEngineAsyncUrlRequestInterceptor::interceptRequestAsync(QWebEngineUrlRequestInfo *info)
+
+    Reimplementing this virtual function makes it possible to intercept URL requests
+    asynchronously. This function is executed on the IO thread and should return quickly.
+
+    \a info stays valid until it is passed to finishRequest(), which must be called for every
+    request, from any thread. The request is not started before that. Changes to \a info must
+    not be made after finishRequest() has been called.
+
+    \note If the request is canceled in the meantime, calling finishRequest() is still required
+    to release \a info.
+*/
+
+/*!
+    \internal
+
+    Asynchronous interceptors are dispatched through interceptRequestAsync() instead.
 */
+void QWebEngineAsyncUrlRequestInterceptor::interceptRequest(QWebEngineUrlRequestInfo &info)
+{
+    Q_UNUSED(info);
+}
+
+/*!
+    Applies the changes made to \a info and lets the intercepted request continue.
+
+    This function is thread-safe. \a info must not be accessed after it returns. Calling it
+    again for an already finished request has no effect as long as the request has not been
+    destroyed.
+*/
+void QWebEngineAsyncUrlRequestInterceptor::finishRequest(QWebEngineUrlRequestInfo *info)
+{
+    QWebEngineUrlRequestInfoPrivate *infoPrivate = info->d_ptr.data();
+    if (!infoPrivate->finishCallback || !infoPrivate->finishRequested.testAndSetOrdered(0, 1)) {
+        qWarning("QWebEngineAsyncUrlRequestInterceptor::finishRequest: The request has already been finished.");
+        return;
+    }
+    infoPrivate->finishCallback();
+}
 
 
 QWebEngineUrlRequestInfoPrivate::QWebEngineUrlRequestInfoPrivate(QWebEngineUrlRequestInfo::ResourceType resource, QWebEngineUrlRequestInfo::NavigationType navigation, const QUrl &u, const QUrl &fpu, const QByteArray &m)
@@ -134,6 +199,7 @@ QWebEngineUrlRequestInfoPrivate::QWebEngineUrlRequestInfoPrivate(QWebEngineUrlRe
     , firstPartyUrl(fpu)
     , method(m)
     , changed(false)
+    , finishRequested(0)
 {
 }
 
@@ -47,6 +47,7 @@
 
 namespace QtWebEngineCore {
 class NetworkDelegateQt;
+class URLRequestInterception;
 }
 
 QT_BEGIN_NAMESPACE
@@ -104,6 +105,8 @@ public:
 
 private:
     friend class QtWebEngineCore::NetworkDelegateQt;
+    friend class QtWebEngineCore::URLRequestInterception;
+    friend class QWebEngineAsyncUrlRequestInterceptor;
     Q_DISABLE_COPY(QWebEngineUrlRequestInfo)
     Q_DECLARE_PRIVATE(QWebEngineUrlRequestInfo)
 
@@ -55,10 +55,13 @@
 
 #include "qwebengineurlrequestinfo.h"
 
+#include <QAtomicInt>
 #include <QByteArray>
 #include <QHash>
 #include <QUrl>
 
+#include <functional>
+
 namespace net {
 class URLRequest;
 }
@@ -85,6 +88,12 @@ public:
     bool changed;
     QHash<QByteArray, QByteArray> extraHeaders;
 
+    // Set for infos handed to a QWebEngineAsyncUrlRequestInterceptor, the first call to
+    // finishRequest() runs it. The info is kept until its request is destroyed, so repeated
+    // calls cannot reach another request that reuses the address.
+    std::function<void()> finishCallback;
+    QAtomicInt finishRequested;
+
     QWebEngineUrlRequestInfo *q_ptr;
 };
 
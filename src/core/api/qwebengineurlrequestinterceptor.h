@@ -63,6 +63,22 @@ public:
     virtual void interceptRequest(QWebEngineUrlRequestInfo &info) = 0;
 };
 
+class QWEBENGINECORE_EXPORT QWebEngineAsyncUrlRequestInterceptor : public QWebEngineUrlRequestInterceptor
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(QWebEngineAsyncUrlRequestInterceptor)
+public:
+    explicit QWebEngineAsyncUrlRequestInterceptor(QObject *p = Q_NULLPTR)
+        : QWebEngineUrlRequestInterceptor(p)
+    {
+    }
+
+    void interceptRequest(QWebEngineUrlRequestInfo &info) override;
+    virtual void interceptRequestAsync(QWebEngineUrlRequestInfo *info) = 0;
+
+    static void finishRequest(QWebEngineUrlRequestInfo *info);
+};
+
 QT_END_NAMESPACE
 
 #endif // QWEBENINGEURLREQUESTINTERCEPTOR_H
@@ -139,6 +139,67 @@ QUrl QWebEngineUrlRequestJob::initiator() const
     return d_ptr->initiator();
 }
 
+/*!
+    \since 5.13
+
+    Returns the HTTP headers of the request, such as \c Content-Type, \c Accept or \c Range.
+    A header sent several times has one value per occurrence.
+*/
+QMultiMap<QByteArray, QByteArray> QWebEngineUrlRequestJob::requestHeaders() const
+{
+    return d_ptr->requestHeaders();
+}
+
+/*!
+    \since 5.13
+
+    Returns the body of the request, for example the data of a POST or PUT request, or
+    \c nullptr if the request has no body.
+
+    The body is a sequential device that is filled while the upload is read, as announced
+    by its QIODevice::readyRead() signal. QIODevice::readChannelFinished() is emitted once
+    the whole body has been received. The device is owned by the job.
+*/
+QIODevice *QWebEngineUrlRequestJob::requestBody() const
+{
+    return d_ptr->requestBody();
+}
+
+/*!
+    \since 5.13
+
+    Sets the HTTP status code of the reply to \a statusCode. It must be called before reply()
+    or redirect().
+
+    By default, replies have no HTTP response headers, unless additional headers are set or
+    a byte range is served.
+
+    A reply with a redirect status code and a \c Location header set through
+    setAdditionalResponseHeaders() redirects the request to that location.
+
+    \sa setAdditionalResponseHeaders()
+*/
+void QWebEngineUrlRequestJob::setResponseStatusCode(int statusCode)
+{
+    d_ptr->setResponseStatusCode(statusCode);
+}
+
+/*!
+    \since 5.13
+
+    Sets \a additionalResponseHeaders to be sent with the reply, for example
+    \c Cache-Control or \c ETag. It must be called before reply().
+
+    The \c Content-Type, \c Content-Length, \c Accept-Ranges and \c Content-Range headers
+    are set from the reply. Headers with invalid names or values are ignored.
+
+    \sa setResponseStatusCode()
+*/
+void QWebEngineUrlRequestJob::setAdditionalResponseHeaders(const QMultiMap<QByteArray, QByteArray> &additionalResponseHeaders)
+{
+    d_ptr->setAdditionalResponseHeaders(additionalResponseHeaders);
+}
+
 /*!
     Replies to the request with \a device and the MIME type \a contentType.
 
@@ -156,6 +217,12 @@ QUrl QWebEngineUrlRequestJob::initiator() const
     \code
     connect(job, &QObject::destroyed, device, &QObject::deleteLater);
     \endcode
+
+    Since Qt 5.13, if the request asks for a single byte range, \a device is random-access,
+    and no other status code than 200 has been set, only the requested range is read
+    after seeking \a device to its start, and the reply has the status code 206. Requests
+    for ranges beyond the size of \a device fail. Handlers that serve ranges themselves can
+    set the status code and the \c Content-Range header explicitly.
  */
 void QWebEngineUrlRequestJob::reply(const QByteArray &contentType, QIODevice *device)
 {
@@ -174,6 +241,9 @@ void QWebEngineUrlRequestJob::fail(Error r)
 
 /*!
     Redirects the request to \a url.
+
+    Since Qt 5.13, the redirect has the status code set by setResponseStatusCode() if it is
+    a redirect status code, such as 301 or 307, and 303 otherwise.
  */
 void QWebEngineUrlRequestJob::redirect(const QUrl &url)
 {
@@ -43,6 +43,7 @@
 #include <QtWebEngineCore/qtwebenginecoreglobal.h>
 
 #include <QtCore/qbytearray.h>
+#include <QtCore/qmap.h>
 #include <QtCore/qobject.h>
 #include <QtCore/qurl.h>
 
@@ -73,7 +74,11 @@ public:
     QUrl requestUrl() const;
     QByteArray requestMethod() const;
     QUrl initiator() const;
+    QMultiMap<QByteArray, QByteArray> requestHeaders() const;
+    QIODevice *requestBody() const;
 
+    void setResponseStatusCode(int statusCode);
+    void setAdditionalResponseHeaders(const QMultiMap<QByteArray, QByteArray> &additionalResponseHeaders);
     void reply(const QByteArray &contentType, QIODevice *device);
     void fail(Error error);
     void redirect(const QUrl &url);
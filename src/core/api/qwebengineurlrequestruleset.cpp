@@ -0,0 +1,186 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qwebengineurlrequestruleset.h"
+
+#include "net/url_request_rule_set.h"
+
+QT_BEGIN_NAMESPACE
+
+using QtWebEngineCore::URLRequestRuleSet;
+
+/*!
+    \class QWebEngineUrlRequestRuleSet
+    \brief The QWebEngineUrlRequestRuleSet class holds compiled rules for blocking and
+    redirecting URL requests.
+
+    \since 5.13
+    \inmodule QtWebEngineCore
+
+    A rule set installed with QWebEngineProfile::setUrlRequestRuleSet() is evaluated by
+    the networking code itself, before a QWebEngineUrlRequestInterceptor is asked about
+    the request. This makes it suitable for large content blocking lists.
+
+    Rules are written in a subset of the Adblock Plus filter syntax, one rule per line:
+
+    \list
+        \li \c{||example.com^} blocks requests to \c example.com and its subdomains.
+        \li \c{/banner/*.gif} blocks requests whose URL contains a match of the pattern,
+            where \c * matches any characters and \c ^ a separator character or the end
+            of the URL. A leading or trailing \c | anchors the pattern to the start or the
+            end of the URL.
+        \li \c{@@||example.com/allowed^} is an exception that lets matching requests pass
+            regardless of any blocking rule.
+        \li Options after \c $ restrict a rule to resource types: \c script, \c image,
+            \c stylesheet, \c object, \c xmlhttprequest, \c subdocument, \c document,
+            \c media, \c font, \c ping and \c other, prefixed with \c ~ to exclude them.
+            Without type options, rules do not apply to top-level documents.
+        \li The \c{redirect=}\e url option redirects matching requests to \e url instead of
+            blocking them. The URL must not contain commas.
+    \endlist
+
+    Lines starting with \c ! are comments. Element hiding rules, regular expressions, and
+    rules with other options are skipped, see skippedLineCount().
+
+    Compiling a long list takes time, so a compiled rule set can be saved with save() and
+    loaded again with load(), which maps the file into memory instead of parsing it.
+
+    Copies of a rule set share the compiled rules and the hit counters.
+*/
+
+/*!
+    Constructs a null rule set.
+*/
+QWebEngineUrlRequestRuleSet::QWebEngineUrlRequestRuleSet()
+{
+}
+
+/*! \internal */
+QWebEngineUrlRequestRuleSet::QWebEngineUrlRequestRuleSet(QSharedPointer<URLRequestRuleSet> d)
+    : d_ptr(d)
+{
+}
+
+/*!
+    Compiles the rules in \a filterList, which is UTF-8 or Latin-1 text with one rule per line.
+*/
+QWebEngineUrlRequestRuleSet QWebEngineUrlRequestRuleSet::fromFilterList(const QByteArray &filterList)
+{
+    return QWebEngineUrlRequestRuleSet(URLRequestRuleSet::compile(filterList));
+}
+
+/*!
+    Loads a rule set saved with save() from \a fileName.
+
+    Returns a null rule set if the file cannot be read or was not written by a compatible
+    version of \QWE.
+*/
+QWebEngineUrlRequestRuleSet QWebEngineUrlRequestRuleSet::load(const QString &fileName)
+{
+    return QWebEngineUrlRequestRuleSet(URLRequestRuleSet::load(fileName));
+}
+
+/*!
+    Saves the compiled rules to \a fileName. Returns whether this was successful.
+
+    Hit counts are not saved.
+*/
+bool QWebEngineUrlRequestRuleSet::save(const QString &fileName) const
+{
+    return d_ptr && d_ptr->save(fileName);
+}
+
+/*!
+    Returns whether this rule set is null, either because it was default constructed or
+    because loading it failed.
+*/
+bool QWebEngineUrlRequestRuleSet::isNull() const
+{
+    return !d_ptr;
+}
+
+/*!
+    Returns the number of rules in the set.
+*/
+int QWebEngineUrlRequestRuleSet::ruleCount() const
+{
+    return d_ptr ? d_ptr->ruleCount() : 0;
+}
+
+/*!
+    Returns the number of lines of the filter list that were not comments but could not
+    be compiled into a rule.
+*/
+int QWebEngineUrlRequestRuleSet::skippedLineCount() const
+{
+    return d_ptr ? d_ptr->skippedLineCount() : 0;
+}
+
+/*!
+    Returns the text of the rule at \a index, as it was given in the filter list.
+*/
+QByteArray QWebEngineUrlRequestRuleSet::rule(int index) const
+{
+    if (!d_ptr || index < 0 || index >= d_ptr->ruleCount())
+        return QByteArray();
+    return d_ptr->ruleText(index);
+}
+
+/*!
+    Returns how many requests the rule at \a index decided so far.
+
+    This function is thread-safe, the counters are updated while requests are evaluated.
+*/
+int QWebEngineUrlRequestRuleSet::hitCount(int index) const
+{
+    if (!d_ptr || index < 0 || index >= d_ptr->ruleCount())
+        return 0;
+    return d_ptr->hitCount(index);
+}
+
+/*!
+    Sets the hit counts of all rules to zero.
+*/
+void QWebEngineUrlRequestRuleSet::resetHitCounts()
+{
+    if (d_ptr)
+        d_ptr->resetHitCounts();
+}
+
+QT_END_NAMESPACE
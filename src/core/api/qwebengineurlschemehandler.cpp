@@ -125,4 +125,54 @@ QWebEngineUrlSchemeHandler::~QWebEngineUrlSchemeHandler()
     \sa QWebEngineUrlRequestJob
 */
 
+/*!
+    \class QWebEngineConcurrentUrlSchemeHandler
+    \brief The QWebEngineConcurrentUrlSchemeHandler class is a base class for handling custom
+    URL schemes outside of the GUI thread.
+    \since 5.13
+
+    Requests for the schemes a QWebEngineConcurrentUrlSchemeHandler is installed for are
+    dispatched to a pool of worker threads owned by the web engine, without going through
+    the GUI thread. This avoids making the GUI thread a bottleneck for pages loading many
+    resources from a custom scheme.
+
+    The requestStarted() method is called on one of the worker threads, possibly for
+    several requests at the same time, and must therefore be thread-safe. The
+    QWebEngineUrlRequestJob it receives lives on that thread, as should the QIODevice
+    passed to QWebEngineUrlRequestJob::reply(), so that its QIODevice::readyRead() signal
+    is delivered without involving the GUI thread. Otherwise the job behaves as for a
+    QWebEngineUrlSchemeHandler.
+
+    Once QWebEngineProfile::removeUrlSchemeHandler() returns, requestStarted() is no longer
+    called for the handler. Each call to requestStarted() holds a lock of the handler that
+    QWebEngineProfile::removeUrlSchemeHandler(), QWebEngineProfile::removeUrlScheme() and
+    QWebEngineProfile::removeAllUrlSchemeHandlers() wait for on the GUI thread. A call in
+    progress therefore blocks the GUI thread for as long as it runs when the handler is
+    removed, and deadlocks if it waits on the GUI thread itself. requestStarted() should
+    only pass a QIODevice to QWebEngineUrlRequestJob::reply() and return, and let the
+    device produce the data once it is read. The handler must be removed from all its
+    profiles before it is deleted.
+
+    \inmodule QtWebEngineCore
+
+    \sa QWebEngineUrlSchemeHandler
+*/
+
+/*!
+    Constructs a new URL scheme handler serving its requests on worker threads.
+
+    The handler is created with the parent \a parent.
+*/
+QWebEngineConcurrentUrlSchemeHandler::QWebEngineConcurrentUrlSchemeHandler(QObject *parent)
+    : QWebEngineUrlSchemeHandler(parent)
+{
+}
+
+/*!
+    Deletes a custom URL scheme handler.
+*/
+QWebEngineConcurrentUrlSchemeHandler::~QWebEngineConcurrentUrlSchemeHandler()
+{
+}
+
 QT_END_NAMESPACE
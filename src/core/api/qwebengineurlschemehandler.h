@@ -69,6 +69,16 @@ private:
     Q_DISABLE_COPY(QWebEngineUrlSchemeHandler)
 };
 
+class QWEBENGINECORE_EXPORT QWebEngineConcurrentUrlSchemeHandler : public QWebEngineUrlSchemeHandler {
+    Q_OBJECT
+public:
+    QWebEngineConcurrentUrlSchemeHandler(QObject *parent = Q_NULLPTR);
+    ~QWebEngineConcurrentUrlSchemeHandler();
+
+private:
+    Q_DISABLE_COPY(QWebEngineConcurrentUrlSchemeHandler)
+};
+
 QT_END_NAMESPACE
 
 #endif // QWEBENGINEURLSCHEMEHANDLER_H
@@ -0,0 +1,131 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qwebenginewebchannelstatistics.h"
+
+#include "web_contents_adapter.h"
+
+QT_BEGIN_NAMESPACE
+
+using QtWebEngineCore::WebChannelStatistics;
+
+/*!
+    \class QWebEngineWebChannelStatistics
+    \brief The QWebEngineWebChannelStatistics class holds the counters of the transport
+    between a web page and its web channel.
+
+    \since 5.13
+    \inmodule QtWebEngineCore
+
+    The statistics are a snapshot taken when they are requested. The counters start
+    when a web channel is set on the page, and are all zero while there is none.
+
+    Messages sent by the page within the same task travel to the browser process
+    together as one batch.
+
+    \sa QWebEnginePage::webChannelStatistics(), QWebEnginePage::webChannelHighWaterMark()
+*/
+
+/*! \internal */
+QWebEngineWebChannelStatistics::QWebEngineWebChannelStatistics()
+{
+}
+
+/*! \internal */
+QWebEngineWebChannelStatistics::QWebEngineWebChannelStatistics(QSharedPointer<const WebChannelStatistics> statistics)
+    : d_ptr(statistics)
+{
+}
+
+/*!
+    \property QWebEngineWebChannelStatistics::messagesReceived
+    \brief The number of messages received from the page.
+*/
+quint64 QWebEngineWebChannelStatistics::messagesReceived() const
+{
+    return d_ptr ? d_ptr->messagesReceived : 0;
+}
+
+/*!
+    \property QWebEngineWebChannelStatistics::bytesReceived
+    \brief The size of the messages received from the page, in bytes.
+*/
+quint64 QWebEngineWebChannelStatistics::bytesReceived() const
+{
+    return d_ptr ? d_ptr->bytesReceived : 0;
+}
+
+/*!
+    \property QWebEngineWebChannelStatistics::batchesReceived
+    \brief The number of batches of more than one message received from the page.
+*/
+quint64 QWebEngineWebChannelStatistics::batchesReceived() const
+{
+    return d_ptr ? d_ptr->batchesReceived : 0;
+}
+
+/*!
+    \property QWebEngineWebChannelStatistics::messagesSent
+    \brief The number of messages sent to the page.
+*/
+quint64 QWebEngineWebChannelStatistics::messagesSent() const
+{
+    return d_ptr ? d_ptr->messagesSent : 0;
+}
+
+/*!
+    \property QWebEngineWebChannelStatistics::bytesSent
+    \brief The size of the messages sent to the page, in bytes.
+*/
+quint64 QWebEngineWebChannelStatistics::bytesSent() const
+{
+    return d_ptr ? d_ptr->bytesSent : 0;
+}
+
+/*!
+    \property QWebEngineWebChannelStatistics::queueDepth
+    \brief The number of messages received from the page but not yet delivered to the channel.
+*/
+int QWebEngineWebChannelStatistics::queueDepth() const
+{
+    return d_ptr ? d_ptr->queueDepth : 0;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,78 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QWEBENGINEWEBCHANNELSTATISTICS_H
+#define QWEBENGINEWEBCHANNELSTATISTICS_H
+
+#include <QtCore/qsharedpointer.h>
+#include <QtWebEngineCore/qtwebenginecoreglobal.h>
+
+namespace QtWebEngineCore {
+class WebContentsAdapter;
+struct WebChannelStatistics;
+}
+
+QT_BEGIN_NAMESPACE
+
+class QWEBENGINECORE_EXPORT QWebEngineWebChannelStatistics {
+    Q_GADGET
+    Q_PROPERTY(quint64 messagesReceived READ messagesReceived CONSTANT FINAL)
+    Q_PROPERTY(quint64 bytesReceived READ bytesReceived CONSTANT FINAL)
+    Q_PROPERTY(quint64 batchesReceived READ batchesReceived CONSTANT FINAL)
+    Q_PROPERTY(quint64 messagesSent READ messagesSent CONSTANT FINAL)
+    Q_PROPERTY(quint64 bytesSent READ bytesSent CONSTANT FINAL)
+    Q_PROPERTY(int queueDepth READ queueDepth CONSTANT FINAL)
+public:
+    QWebEngineWebChannelStatistics();
+    quint64 messagesReceived() const;
+    quint64 bytesReceived() const;
+    quint64 batchesReceived() const;
+    quint64 messagesSent() const;
+    quint64 bytesSent() const;
+    int queueDepth() const;
+private:
+    QWebEngineWebChannelStatistics(QSharedPointer<const QtWebEngineCore::WebChannelStatistics>);
+    friend class QtWebEngineCore::WebContentsAdapter;
+    QSharedPointer<const QtWebEngineCore::WebChannelStatistics> d_ptr;
+};
+
+QT_END_NAMESPACE
+
+#endif // QWEBENGINEWEBCHANNELSTATISTICS_H
@@ -53,10 +53,12 @@
 #include "services/service_manager/public/cpp/service.h"
 #include "ui/display/screen.h"
 
+#include "net/url_request_custom_job_thread_pool.h"
 #include "service/service_qt.h"
 #include "web_engine_context.h"
 
 #include <QEventLoop>
+#include <QLoggingCategory>
 
 #if defined(OS_MACOSX)
 #include "ui/base/idle/idle.h"
@@ -73,6 +75,17 @@ namespace QtWebEngineCore {
 
 namespace {
 
+Q_LOGGING_CATEGORY(lcMessagePump, "qt.webengine.messagepump")
+
+// Time in milliseconds the pump may spend running Chromium tasks before returning
+// to the Qt event loop, so that input and painting aren't starved under heavy IPC.
+int messagePumpTimeSlice()
+{
+    bool ok = false;
+    const int timeSlice = qEnvironmentVariableIntValue("QTWEBENGINE_MESSAGE_PUMP_TIME_SLICE", &ok);
+    return ok && timeSlice >= 0 ? timeSlice : 5;
+}
+
 // Return a timeout suitable for the glib loop, -1 to block forever,
 // 0 to return right away, or a timeout in milliseconds from now.
 int GetTimeIntervalMilliseconds(const base::TimeTicks &from)
@@ -94,8 +107,17 @@ class MessagePumpForUIQt : public base::MessagePump
 public:
     MessagePumpForUIQt()
         : m_scheduler([this]() { handleScheduledWork(); })
+        , m_timeSlice(base::TimeDelta::FromMilliseconds(messagePumpTimeSlice()))
     {}
 
+    ~MessagePumpForUIQt() override
+    {
+        const QWebEngineMessagePumpScheduler::Statistics statistics = m_scheduler.statistics();
+        qCDebug(lcMessagePump, "%llu wakeups (%llu coalesced), %llu tasks in %llu slices, %llu overruns",
+                statistics.wakeups, statistics.coalescedWakeups, statistics.tasks,
+                statistics.slices, statistics.sliceOverruns);
+    }
+
     void Run(Delegate *delegate) override
     {
         if (!m_delegate)
@@ -133,11 +155,20 @@ public:
 private:
     void handleScheduledWork()
     {
-        bool more_work_is_plausible = m_delegate->DoWork();
-
+        // Drain tasks until the time slice is used up, a zero slice runs one task per wakeup.
+        const base::TimeTicks deadline = base::TimeTicks::Now() + m_timeSlice;
         base::TimeTicks delayed_work_time;
-        more_work_is_plausible |= m_delegate->DoDelayedWork(&delayed_work_time);
-
+        bool more_work_is_plausible;
+        int tasks = 0;
+        do {
+            // Each of them returns true if it ran a task.
+            const bool didWork = m_delegate->DoWork();
+            const bool didDelayedWork = m_delegate->DoDelayedWork(&delayed_work_time);
+            tasks += int(didWork) + int(didDelayedWork);
+            more_work_is_plausible = didWork || didDelayedWork;
+        } while (more_work_is_plausible && base::TimeTicks::Now() < deadline);
+
+        m_scheduler.recordSlice(tasks, more_work_is_plausible);
         if (more_work_is_plausible)
             return ScheduleWork();
 
@@ -151,6 +182,7 @@ private:
     Delegate *m_delegate = nullptr;
     QEventLoop *m_explicitLoop = nullptr;
     QWebEngineMessagePumpScheduler m_scheduler;
+    const base::TimeDelta m_timeSlice;
 };
 
 }  // anonymous namespace
@@ -181,6 +213,7 @@ void BrowserMainPartsQt::PostMainMessageLoopRun()
     // The ProfileQt's destructor uses the MessageLoop so it should be deleted
     // right before the RenderProcessHostImpl's destructor destroys it.
     WebEngineContext::current()->destroyProfileAdapter();
+    URLRequestCustomJobThreadPool::instance()->shutdown();
 }
 
 int BrowserMainPartsQt::PreCreateThreads()
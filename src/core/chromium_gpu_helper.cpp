@@ -53,6 +53,10 @@
 #include "content/gpu/gpu_child_thread.h"
 #include "gpu/ipc/service/gpu_channel_manager.h"
 
+#if defined(USE_OZONE)
+#include "ozone/gl_surface_egl_qt.h"
+#endif
+
 #ifdef Q_OS_QNX
 #include "content/common/gpu/stream_texture_qnx.h"
 #endif
@@ -85,6 +89,20 @@ unsigned int service_id(gpu::TextureBase *tex)
     return tex->service_id();
 }
 
+#if defined(USE_OZONE)
+void *create_texture_image(unsigned int serviceId)
+{
+    EGLImageKHR image = gl::GLSurfaceEGLQt::CreateTextureImage(serviceId);
+    return image == EGL_NO_IMAGE_KHR ? nullptr : image;
+}
+
+void *create_texture_image_fence()
+{
+    EGLSyncKHR sync = gl::GLSurfaceEGLQt::CreateFenceSync();
+    return sync == EGL_NO_SYNC_KHR ? nullptr : sync;
+}
+#endif
+
 #ifdef Q_OS_QNX
 EGLStreamData eglstream_connect_consumer(gpu::Texture *tex)
 {
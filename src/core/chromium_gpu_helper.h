@@ -67,6 +67,13 @@ gpu::MailboxManager *mailbox_manager();
 gpu::TextureBase* ConsumeTexture(gpu::MailboxManager *mailboxManager, unsigned target, const gpu::Mailbox& mailbox);
 unsigned int service_id(gpu::TextureBase *tex);
 
+#if defined(USE_OZONE)
+// Returns an EGLImageKHR, or null if the texture couldn't be exported.
+void *create_texture_image(unsigned int serviceId);
+// Returns an EGLSyncKHR fencing the commands issued so far, or null if it isn't supported.
+void *create_texture_image_fence();
+#endif
+
 #ifdef Q_OS_QNX
 typedef void* EGLDisplay;
 typedef void* EGLStreamKHR;
@@ -4,6 +4,7 @@
 
 // Multiply-included file, no traditional include guard.
 
+#include "base/memory/shared_memory_handle.h"
 #include "base/optional.h"
 #include "content/public/common/common_param_traits.h"
 #include "content/public/common/webplugininfo.h"
@@ -36,6 +37,13 @@ IPC_MESSAGE_ROUTED1(RenderViewObserverQt_FetchDocumentMarkup,
 IPC_MESSAGE_ROUTED1(RenderViewObserverQt_FetchDocumentInnerText,
                     uint64_t /* requestId */)
 
+// Runs the scripts one after the other in the main frame, and answers with all
+// their results at once.
+IPC_MESSAGE_ROUTED3(RenderViewObserverQt_RunJavaScript,
+                    uint64_t /* requestId */,
+                    std::vector<base::string16> /* scripts */,
+                    uint32_t /* worldId */)
+
 // User scripts messages
 IPC_MESSAGE_ROUTED1(RenderFrameObserverHelper_AddScript,
                     UserScriptData /* script */)
@@ -46,6 +54,19 @@ IPC_MESSAGE_ROUTED0(RenderFrameObserverHelper_ClearScripts)
 IPC_MESSAGE_CONTROL1(UserResourceController_AddScript, UserScriptData /* scriptContents */)
 IPC_MESSAGE_CONTROL1(UserResourceController_RemoveScript, UserScriptData /* scriptContents */)
 IPC_MESSAGE_CONTROL0(UserResourceController_ClearScripts)
+// Profile-wide scripts are sent without their source, which is mapped read-only
+// from a shared memory segment created once by the browser.
+IPC_MESSAGE_CONTROL3(UserResourceController_AddSharedScript,
+                     UserScriptData /* script without source */,
+                     base::SharedMemoryHandle /* source */,
+                     uint32_t /* sourceSize */)
+
+// WebChannel flow control: the renderer stops sending once the host has not
+// acknowledged as many messages as the high-water mark.
+IPC_MESSAGE_ROUTED1(WebChannelIPCTransport_SetHighWaterMark,
+                    uint32_t /* messages */)
+IPC_MESSAGE_ROUTED1(WebChannelIPCTransport_Acknowledge,
+                    uint32_t /* messages */)
 
 // Tells the renderer whether or not a file system access has been allowed.
 IPC_MESSAGE_ROUTED2(QtWebEngineMsg_RequestFileSystemAccessAsyncResponse,
@@ -65,6 +86,11 @@ IPC_MESSAGE_ROUTED2(RenderViewObserverHostQt_DidFetchDocumentInnerText,
                     uint64_t /* requestId */,
                     base::string16 /* innerText */)
 
+// Each result in the format of v8::ValueSerializer, or empty if it could not be serialized.
+IPC_MESSAGE_ROUTED2(RenderViewObserverHostQt_DidRunJavaScript,
+                    uint64_t /* requestId */,
+                    std::vector<std::vector<uint8_t>> /* results */)
+
 IPC_MESSAGE_ROUTED1(RenderViewObserverQt_SetBackgroundColor,
                     uint32_t /* color */)
 
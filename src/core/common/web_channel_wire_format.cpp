@@ -0,0 +1,711 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "web_channel_wire_format.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QHash>
+#include <QtCore/QJsonArray>
+#include <QtCore/QVector>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace QtWebEngineCore {
+namespace WebChannelWireFormat {
+
+namespace {
+
+// From v8/src/value-serializer.cc
+enum Tag : uint8_t {
+    VersionTag = 0xFF,
+    PaddingTag = '\0',
+    VerifyObjectCountTag = '?',
+    TheHoleTag = '-',
+    UndefinedTag = '_',
+    NullTag = '0',
+    TrueTag = 'T',
+    FalseTag = 'F',
+    Int32Tag = 'I',
+    Uint32Tag = 'U',
+    DoubleTag = 'N',
+    Utf8StringTag = 'S',
+    OneByteStringTag = '"',
+    TwoByteStringTag = 'c',
+    ObjectReferenceTag = '^',
+    BeginJSObjectTag = 'o',
+    EndJSObjectTag = '{',
+    BeginSparseJSArrayTag = 'a',
+    EndSparseJSArrayTag = '@',
+    BeginDenseJSArrayTag = 'A',
+    EndDenseJSArrayTag = '$',
+    DateTag = 'D',
+    TrueObjectTag = 'y',
+    FalseObjectTag = 'x',
+    NumberObjectTag = 'n',
+    StringObjectTag = 's',
+    RegExpTag = 'R',
+    BeginJSMapTag = ';',
+    EndJSMapTag = ':',
+    BeginJSSetTag = '\'',
+    EndJSSetTag = ',',
+    ArrayBufferTag = 'B',
+    ArrayBufferViewTag = 'V',
+};
+
+// The version written by the V8 of Chromium 69, older versions encode some values differently.
+const uint32_t wireFormatVersion = 13;
+const int maximumDepth = 1024;
+// Every reference to an object copies it, so a small message can expand exponentially.
+// The decoded values are counted roughly in bytes and limited like the size of an IPC.
+const quint64 maximumDecodedSize = 128 * 1024 * 1024;
+
+class Encoder {
+public:
+    std::vector<uint8_t> encode(const QJsonObject &message)
+    {
+        m_data.push_back(VersionTag);
+        writeVarint(wireFormatVersion);
+        writeObject(message);
+        return std::move(m_data);
+    }
+
+private:
+    void writeVarint(uint32_t value)
+    {
+        do {
+            uint8_t byte = value & 0x7f;
+            value >>= 7;
+            if (value)
+                byte |= 0x80;
+            m_data.push_back(byte);
+        } while (value);
+    }
+
+    void writeString(const QString &string)
+    {
+        const QChar *chars = string.constData();
+        const int size = string.size();
+        bool latin1 = true;
+        for (int i = 0; i < size && latin1; ++i)
+            latin1 = chars[i].unicode() <= 0xff;
+        if (latin1) {
+            m_data.push_back(OneByteStringTag);
+            writeVarint(size);
+            for (int i = 0; i < size; ++i)
+                m_data.push_back(uint8_t(chars[i].unicode()));
+            return;
+        }
+        // Keep the characters aligned like V8 does, so they can be read in place.
+        const uint32_t byteLength = size * sizeof(ushort);
+        size_t headerSize = 1;
+        for (uint32_t value = byteLength; value >= 0x80; value >>= 7)
+            ++headerSize;
+        if ((m_data.size() + 1 + headerSize) & 1)
+            m_data.push_back(PaddingTag);
+        m_data.push_back(TwoByteStringTag);
+        writeVarint(byteLength);
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(string.utf16());
+        m_data.insert(m_data.end(), bytes, bytes + byteLength);
+    }
+
+    void writeDouble(double value)
+    {
+        if (value >= std::numeric_limits<int32_t>::min() && value <= std::numeric_limits<int32_t>::max()) {
+            const int32_t integer = int32_t(value);
+            if (double(integer) == value && (integer || !std::signbit(value))) {
+                m_data.push_back(Int32Tag);
+                writeVarint((uint32_t(integer) << 1) ^ uint32_t(integer >> 31));
+                return;
+            }
+        }
+        m_data.push_back(DoubleTag);
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&value);
+        m_data.insert(m_data.end(), bytes, bytes + sizeof(value));
+    }
+
+    void writeValue(const QJsonValue &value)
+    {
+        switch (value.type()) {
+        case QJsonValue::Null:
+            m_data.push_back(NullTag);
+            break;
+        case QJsonValue::Bool:
+            m_data.push_back(value.toBool() ? TrueTag : FalseTag);
+            break;
+        case QJsonValue::Double:
+            writeDouble(value.toDouble());
+            break;
+        case QJsonValue::String:
+            writeString(value.toString());
+            break;
+        case QJsonValue::Array:
+            writeArray(value.toArray());
+            break;
+        case QJsonValue::Object:
+            writeObject(value.toObject());
+            break;
+        case QJsonValue::Undefined:
+            m_data.push_back(UndefinedTag);
+            break;
+        }
+    }
+
+    void writeArray(const QJsonArray &array)
+    {
+        m_data.push_back(BeginDenseJSArrayTag);
+        writeVarint(array.size());
+        for (const QJsonValue &value : array)
+            writeValue(value);
+        m_data.push_back(EndDenseJSArrayTag);
+        writeVarint(0);
+        writeVarint(array.size());
+    }
+
+    void writeObject(const QJsonObject &object)
+    {
+        m_data.push_back(BeginJSObjectTag);
+        for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+            writeString(it.key());
+            writeValue(it.value());
+        }
+        m_data.push_back(EndJSObjectTag);
+        writeVarint(object.size());
+    }
+
+    std::vector<uint8_t> m_data;
+};
+
+class Decoder {
+public:
+    explicit Decoder(const std::vector<uint8_t> &data, quint64 decodedSize = 0)
+        : m_position(data.data())
+        , m_end(data.data() + data.size())
+        , m_decodedSize(decodedSize)
+    {
+    }
+
+    quint64 decodedSize() const { return m_decodedSize; }
+
+    bool decode(QJsonValue *value)
+    {
+        uint8_t tag;
+        uint32_t version;
+        return readByte(&tag) && tag == VersionTag && readVarint(&version) && version == wireFormatVersion
+                && readValue(value) && m_position == m_end;
+    }
+
+private:
+    bool readByte(uint8_t *byte)
+    {
+        if (m_position >= m_end)
+            return false;
+        *byte = *m_position++;
+        return true;
+    }
+
+    bool readTag(uint8_t *tag)
+    {
+        do {
+            if (!readByte(tag))
+                return false;
+        } while (*tag == PaddingTag);
+        return true;
+    }
+
+    bool peekTag(uint8_t *tag) const
+    {
+        const uint8_t *position = m_position;
+        while (position < m_end && *position == PaddingTag)
+            ++position;
+        if (position >= m_end)
+            return false;
+        *tag = *position;
+        return true;
+    }
+
+    bool readVarint(uint32_t *value)
+    {
+        *value = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            uint8_t byte;
+            if (!readByte(&byte))
+                return false;
+            *value |= uint32_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    bool readBytes(uint32_t size, const uint8_t **bytes)
+    {
+        if (size_t(m_end - m_position) < size)
+            return false;
+        *bytes = m_position;
+        m_position += size;
+        return true;
+    }
+
+    bool readDouble(double *value)
+    {
+        const uint8_t *bytes;
+        if (!readBytes(sizeof(double), &bytes))
+            return false;
+        memcpy(value, bytes, sizeof(double));
+        return true;
+    }
+
+    bool addDecodedSize(quint64 size)
+    {
+        m_decodedSize += size;
+        return m_decodedSize <= maximumDecodedSize;
+    }
+
+    bool readString(uint8_t tag, QString *string)
+    {
+        uint32_t size;
+        const uint8_t *bytes;
+        if (!readVarint(&size) || !readBytes(size, &bytes) || !addDecodedSize(size))
+            return false;
+        switch (tag) {
+        case OneByteStringTag:
+            *string = QString::fromLatin1(reinterpret_cast<const char *>(bytes), int(size));
+            return true;
+        case TwoByteStringTag:
+            if (size & 1)
+                return false;
+            string->resize(int(size / 2));
+            memcpy(string->data(), bytes, size);
+            return true;
+        case Utf8StringTag:
+            *string = QString::fromUtf8(reinterpret_cast<const char *>(bytes), int(size));
+            return true;
+        }
+        return false;
+    }
+
+    bool readStringValue(QString *string)
+    {
+        uint8_t tag;
+        return readTag(&tag) && readString(tag, string);
+    }
+
+    // Property keys are strings or numbers, which JSON turns into strings.
+    bool readKey(QString *key)
+    {
+        QJsonValue value;
+        if (!readValue(&value))
+            return false;
+        if (value.isString())
+            *key = value.toString();
+        else if (value.isDouble())
+            *key = QString::number(value.toDouble(), 'g', 17);
+        else
+            return false;
+        return true;
+    }
+
+    // Objects get ids in the order they are started, so that repeated ones can be referenced.
+    // Each object also remembers its decoded size, which every reference to it adds again.
+    uint32_t beginObject()
+    {
+        m_objects.append(QJsonValue(QJsonValue::Undefined));
+        m_complete.append(false);
+        m_objectSizes.append(m_decodedSize);
+        return uint32_t(m_objects.size() - 1);
+    }
+
+    void endObject(uint32_t id, const QJsonValue &value)
+    {
+        m_objects[int(id)] = value;
+        m_complete[int(id)] = true;
+        m_objectSizes[int(id)] = m_decodedSize - m_objectSizes.at(int(id));
+    }
+
+    static QJsonValue numberValue(double value)
+    {
+        // Like JSON.stringify.
+        if (!std::isfinite(value))
+            return QJsonValue(QJsonValue::Null);
+        return QJsonValue(value);
+    }
+
+    bool readProperties(uint8_t endTag, QJsonObject *object, QJsonArray *array, uint32_t *count)
+    {
+        *count = 0;
+        for (;;) {
+            uint8_t tag;
+            if (!peekTag(&tag))
+                return false;
+            if (tag == endTag) {
+                readTag(&tag);
+                return true;
+            }
+            QString key;
+            QJsonValue value;
+            if (!readKey(&key) || !readValue(&value))
+                return false;
+            ++*count;
+            if (array) {
+                bool isIndex = false;
+                const uint index = key.toUInt(&isIndex);
+                if (isIndex && index < uint(array->size())) {
+                    (*array)[int(index)] = value.isUndefined() ? QJsonValue(QJsonValue::Null) : value;
+                    continue;
+                }
+            }
+            if (object && !value.isUndefined())
+                object->insert(key, value);
+        }
+    }
+
+    bool readArrayBuffer(QJsonValue *value)
+    {
+        const uint32_t id = beginObject();
+        uint32_t size;
+        const uint8_t *bytes;
+        if (!readVarint(&size) || !readBytes(size, &bytes) || !addDecodedSize(size))
+            return false;
+        const QByteArray buffer = QByteArray::fromRawData(reinterpret_cast<const char *>(bytes), int(size));
+        m_arrayBuffers.insert(id, buffer);
+        *value = QString::fromLatin1(buffer.toBase64());
+        endObject(id, *value);
+        return readArrayBufferView(buffer, value);
+    }
+
+    // A view follows the buffer it covers, or a reference to it.
+    bool readArrayBufferView(const QByteArray &buffer, QJsonValue *value)
+    {
+        uint8_t tag;
+        if (!peekTag(&tag) || tag != ArrayBufferViewTag)
+            return true;
+        readTag(&tag);
+        const uint32_t id = beginObject();
+        uint8_t subTag;
+        uint32_t offset, length;
+        if (!readByte(&subTag) || !readVarint(&offset) || !readVarint(&length)
+                || offset > uint32_t(buffer.size()) || length > uint32_t(buffer.size()) - offset
+                || !addDecodedSize(length))
+            return false;
+        *value = QString::fromLatin1(buffer.mid(int(offset), int(length)).toBase64());
+        endObject(id, *value);
+        return true;
+    }
+
+    bool readValue(QJsonValue *value)
+    {
+        if (++m_depth > maximumDepth)
+            return false;
+        const bool ok = readValueInternal(value) && addDecodedSize(1);
+        --m_depth;
+        return ok;
+    }
+
+    bool readValueInternal(QJsonValue *value)
+    {
+        uint8_t tag;
+        if (!readTag(&tag))
+            return false;
+        switch (tag) {
+        case VerifyObjectCountTag: {
+            uint32_t count;
+            return readVarint(&count) && readValue(value);
+        }
+        case UndefinedTag:
+        case TheHoleTag:
+            *value = QJsonValue(QJsonValue::Undefined);
+            return true;
+        case NullTag:
+            *value = QJsonValue(QJsonValue::Null);
+            return true;
+        case TrueTag:
+            *value = true;
+            return true;
+        case FalseTag:
+            *value = false;
+            return true;
+        case Int32Tag: {
+            uint32_t zigzag;
+            if (!readVarint(&zigzag))
+                return false;
+            *value = double(int32_t((zigzag >> 1) ^ -int32_t(zigzag & 1)));
+            return true;
+        }
+        case Uint32Tag: {
+            uint32_t number;
+            if (!readVarint(&number))
+                return false;
+            *value = double(number);
+            return true;
+        }
+        case DoubleTag: {
+            double number;
+            if (!readDouble(&number))
+                return false;
+            *value = numberValue(number);
+            return true;
+        }
+        case OneByteStringTag:
+        case TwoByteStringTag:
+        case Utf8StringTag: {
+            QString string;
+            if (!readString(tag, &string))
+                return false;
+            *value = string;
+            return true;
+        }
+        case ObjectReferenceTag: {
+            uint32_t id;
+            // A reference to an object that is not complete yet is a cycle, which JSON cannot express.
+            if (!readVarint(&id) || id >= uint32_t(m_objects.size()) || !m_complete.at(int(id))
+                    || !addDecodedSize(m_objectSizes.at(int(id))))
+                return false;
+            *value = m_objects.at(int(id));
+            auto buffer = m_arrayBuffers.constFind(id);
+            return buffer == m_arrayBuffers.constEnd() || readArrayBufferView(*buffer, value);
+        }
+        case BeginJSObjectTag: {
+            const uint32_t id = beginObject();
+            QJsonObject object;
+            uint32_t count, expectedCount;
+            if (!readProperties(EndJSObjectTag, &object, nullptr, &count)
+                    || !readVarint(&expectedCount) || count != expectedCount)
+                return false;
+            *value = object;
+            endObject(id, *value);
+            return true;
+        }
+        case BeginDenseJSArrayTag:
+        case BeginSparseJSArrayTag: {
+            const uint32_t id = beginObject();
+            uint32_t length;
+            if (!readVarint(&length))
+                return false;
+            // Every element of a dense array takes at least a byte. The holes of a sparse array
+            // take none, but each of them is decoded to a null.
+            if (tag == BeginDenseJSArrayTag ? length > uint32_t(m_end - m_position) : !addDecodedSize(length))
+                return false;
+            QJsonArray array;
+            for (uint32_t i = 0; i < length; ++i)
+                array.append(QJsonValue(QJsonValue::Null));
+            if (tag == BeginDenseJSArrayTag) {
+                for (uint32_t i = 0; i < length; ++i) {
+                    QJsonValue element;
+                    if (!readValue(&element))
+                        return false;
+                    if (!element.isUndefined())
+                        array[int(i)] = element;
+                }
+            }
+            uint32_t count, expectedCount, expectedLength;
+            const uint8_t endTag = tag == BeginDenseJSArrayTag ? EndDenseJSArrayTag : EndSparseJSArrayTag;
+            if (!readProperties(endTag, nullptr, &array, &count)
+                    || !readVarint(&expectedCount) || !readVarint(&expectedLength)
+                    || count != expectedCount || expectedLength != length)
+                return false;
+            *value = array;
+            endObject(id, *value);
+            return true;
+        }
+        case DateTag: {
+            const uint32_t id = beginObject();
+            double milliseconds;
+            if (!readDouble(&milliseconds))
+                return false;
+            if (std::isfinite(milliseconds))
+                *value = QDateTime::fromMSecsSinceEpoch(qint64(milliseconds), Qt::UTC).toString(Qt::ISODateWithMs);
+            else
+                *value = QJsonValue(QJsonValue::Null);
+            endObject(id, *value);
+            return true;
+        }
+        case TrueObjectTag:
+        case FalseObjectTag:
+            *value = tag == TrueObjectTag;
+            endObject(beginObject(), *value);
+            return true;
+        case NumberObjectTag: {
+            const uint32_t id = beginObject();
+            double number;
+            if (!readDouble(&number))
+                return false;
+            *value = numberValue(number);
+            endObject(id, *value);
+            return true;
+        }
+        case StringObjectTag: {
+            const uint32_t id = beginObject();
+            QString string;
+            if (!readStringValue(&string))
+                return false;
+            *value = string;
+            endObject(id, *value);
+            return true;
+        }
+        case RegExpTag: {
+            const uint32_t id = beginObject();
+            QString pattern;
+            uint32_t flags;
+            if (!readStringValue(&pattern) || !readVarint(&flags))
+                return false;
+            *value = QJsonObject();
+            endObject(id, *value);
+            return true;
+        }
+        case BeginJSMapTag:
+        case BeginJSSetTag: {
+            // Their entries are not own properties, so JSON.stringify writes an empty object.
+            const uint32_t id = beginObject();
+            const uint8_t endTag = tag == BeginJSMapTag ? EndJSMapTag : EndJSSetTag;
+            uint32_t count = 0, expectedCount;
+            for (;;) {
+                uint8_t next;
+                if (!peekTag(&next))
+                    return false;
+                if (next == endTag)
+                    break;
+                QJsonValue entry;
+                if (!readValue(&entry))
+                    return false;
+                ++count;
+            }
+            readTag(&tag);
+            if (!readVarint(&expectedCount) || count != expectedCount)
+                return false;
+            *value = QJsonObject();
+            endObject(id, *value);
+            return true;
+        }
+        case ArrayBufferTag:
+            return readArrayBuffer(value);
+        }
+        // Shared or transferred buffers, BigInts, WebAssembly and host objects are not supported.
+        return false;
+    }
+
+    const uint8_t *m_position;
+    const uint8_t *m_end;
+    int m_depth = 0;
+    quint64 m_decodedSize = 0;
+    QVector<QJsonValue> m_objects;
+    QVector<bool> m_complete;
+    QVector<quint64> m_objectSizes;
+    QHash<uint32_t, QByteArray> m_arrayBuffers;
+};
+
+const uint8_t batchTag[] = { 'q', 'w', 'c', 'b' };
+
+} // namespace
+
+bool isWireFormat(const std::vector<uint8_t> &data)
+{
+    return !data.empty() && data.front() == VersionTag;
+}
+
+std::vector<uint8_t> encode(const QJsonObject &message)
+{
+    return Encoder().encode(message);
+}
+
+bool decode(const std::vector<uint8_t> &data, QJsonObject *message)
+{
+    QJsonValue value;
+    if (!Decoder(data).decode(&value) || !value.isObject())
+        return false;
+    *message = value.toObject();
+    return true;
+}
+
+bool decodeValue(const std::vector<uint8_t> &data, QJsonValue *value, quint64 *decodedSize)
+{
+    if (!decodedSize)
+        return Decoder(data).decode(value);
+    Decoder decoder(data, *decodedSize);
+    const bool ok = decoder.decode(value);
+    *decodedSize = decoder.decodedSize();
+    return ok;
+}
+
+bool isBatch(const std::vector<uint8_t> &data)
+{
+    return data.size() >= sizeof(batchTag) && !memcmp(data.data(), batchTag, sizeof(batchTag));
+}
+
+std::vector<uint8_t> encodeBatch(const std::vector<std::vector<uint8_t>> &messages)
+{
+    size_t size = sizeof(batchTag);
+    for (const std::vector<uint8_t> &message : messages)
+        size += sizeof(uint32_t) + message.size();
+    std::vector<uint8_t> batch;
+    batch.reserve(size);
+    batch.insert(batch.end(), batchTag, batchTag + sizeof(batchTag));
+    for (const std::vector<uint8_t> &message : messages) {
+        const uint32_t messageSize = uint32_t(message.size());
+        const uint8_t *sizeBytes = reinterpret_cast<const uint8_t *>(&messageSize);
+        batch.insert(batch.end(), sizeBytes, sizeBytes + sizeof(messageSize));
+        batch.insert(batch.end(), message.begin(), message.end());
+    }
+    return batch;
+}
+
+bool decodeBatch(const std::vector<uint8_t> &data, std::vector<std::vector<uint8_t>> *messages)
+{
+    if (!isBatch(data))
+        return false;
+    const uint8_t *position = data.data() + sizeof(batchTag);
+    const uint8_t *end = data.data() + data.size();
+    while (position != end) {
+        uint32_t size;
+        if (size_t(end - position) < sizeof(size))
+            return false;
+        memcpy(&size, position, sizeof(size));
+        position += sizeof(size);
+        if (size_t(end - position) < size)
+            return false;
+        // Copied, as QJsonDocument::fromRawData needs its data aligned.
+        messages->emplace_back(position, position + size);
+        position += size;
+    }
+    return true;
+}
+
+} // namespace WebChannelWireFormat
+} // namespace QtWebEngineCore
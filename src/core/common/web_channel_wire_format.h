@@ -0,0 +1,74 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef WEB_CHANNEL_WIRE_FORMAT_H
+#define WEB_CHANNEL_WIRE_FORMAT_H
+
+#include <QtCore/QJsonObject>
+
+#include <vector>
+
+namespace QtWebEngineCore {
+
+// WebChannel messages in the format of v8::ValueSerializer, which the renderer
+// reads and writes directly from and to JavaScript values, without any JSON text.
+// Messages in this format start with the version tag, while the QJsonDocument
+// binary format used otherwise starts with 'qbjs'.
+namespace WebChannelWireFormat {
+
+bool isWireFormat(const std::vector<uint8_t> &data);
+std::vector<uint8_t> encode(const QJsonObject &message);
+// Values are converted as JSON.stringify would, except that ArrayBuffers and
+// their views become base64 strings of the bytes they cover.
+bool decode(const std::vector<uint8_t> &data, QJsonObject *message);
+// Same as decode, but for a value of any type, which is undefined where JSON.stringify
+// would not write one. Values decoded one after another can share the limit on the
+// decoded size by passing the same decodedSize, which is updated.
+bool decodeValue(const std::vector<uint8_t> &data, QJsonValue *value, quint64 *decodedSize = nullptr);
+
+// Messages sent together in one IPC, in either format, start with 'qwcb'
+// followed by each message prefixed with its size.
+bool isBatch(const std::vector<uint8_t> &data);
+std::vector<uint8_t> encodeBatch(const std::vector<std::vector<uint8_t>> &messages);
+bool decodeBatch(const std::vector<uint8_t> &data, std::vector<std::vector<uint8_t>> *messages);
+
+} // namespace WebChannelWireFormat
+} // namespace QtWebEngineCore
+
+#endif // WEB_CHANNEL_WIRE_FORMAT_H
@@ -40,11 +40,18 @@
 #include "compositor.h"
 
 #include "delegated_frame_node.h"
+#include "qwebengineframetiming.h"
 #include "render_widget_host_view_qt.h"
+#include "type_conversion.h"
 
 #include "components/viz/common/resources/returned_resource.h"
 #include "content/public/browser/browser_thread.h"
 #include "services/viz/public/interfaces/compositing/compositor_frame_sink.mojom.h"
+#include "ui/gfx/geometry/rect.h"
+#include "ui/gfx/presentation_feedback.h"
+
+#include <QScreen>
+#include <QWindow>
 
 namespace QtWebEngineCore {
 
@@ -86,6 +93,7 @@ void Compositor::setFrameSinkClient(viz::mojom::CompositorFrameSinkClient *frame
     //
     // TODO(juvaldma): Can there be a pending frame from the old client?
     m_resourcesToRelease.clear();
+    m_pendingPresentations.clear();
     m_frameSinkClient = frameSinkClient;
 }
 
@@ -93,15 +101,31 @@ void Compositor::setNeedsBeginFrames(bool needsBeginFrames)
 {
     DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
 
-    if (m_needsBeginFrames == needsBeginFrames)
+    m_needsBeginFrames = needsBeginFrames;
+    updateBeginFrameObservation();
+}
+
+void Compositor::setOccluded(bool occluded)
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+
+    // An occluded view doesn't present its frames, so don't let the renderer produce any.
+    m_occluded = occluded;
+    updateBeginFrameObservation();
+}
+
+void Compositor::updateBeginFrameObservation()
+{
+    const bool observe = m_needsBeginFrames && !m_occluded;
+    if (m_observingBeginFrames == observe)
         return;
 
-    if (needsBeginFrames)
+    if (observe)
         m_beginFrameSource->AddObserver(this);
     else
         m_beginFrameSource->RemoveObserver(this);
 
-    m_needsBeginFrames = needsBeginFrames;
+    m_observingBeginFrames = observe;
 }
 
 void Compositor::submitFrame(viz::CompositorFrame frame)
@@ -109,13 +133,30 @@ void Compositor::submitFrame(viz::CompositorFrame frame)
     DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
     DCHECK(!m_havePendingFrame);
 
+    m_chromiumCompositorData->frameTimings.frameSubmitted(frame.metadata.frame_token);
     m_chromiumCompositorData->frameDevicePixelRatio = frame.metadata.device_scale_factor;
-    m_chromiumCompositorData->previousFrameData = std::move(m_chromiumCompositorData->frameData);
+#ifndef QT_NO_OPENGL
+    // Start resolving the mailboxes of the new resources on the GPU thread right away,
+    // while the scene graph might still be busy rendering the previous frame.
+    m_chromiumCompositorData->mailboxFetchBatch =
+            MailboxFetchBatch::start(frame.resource_list, m_chromiumCompositorData->resourceHolders,
+                                     m_chromiumCompositorData->exportsTextureImages.load());
+#endif
+    // The damage of the root render pass is in physical pixels of the frame.
+    QRect damageRect;
+    if (!frame.render_pass_list.empty()) {
+        const viz::RenderPass *rootRenderPass = frame.render_pass_list.back().get();
+        gfx::Rect damage = rootRenderPass->damage_rect;
+        damage.Intersect(rootRenderPass->output_rect);
+        damage -= rootRenderPass->output_rect.OffsetFromOrigin();
+        if (!damage.IsEmpty())
+            damageRect = toQt(gfx::ScaleToEnclosingRect(damage, 1.f / frame.metadata.device_scale_factor));
+    }
     m_chromiumCompositorData->frameData = std::move(frame);
     m_havePendingFrame = true;
 
     // Tell viewDelegate to call updatePaintNode() soon.
-    m_viewDelegate->update();
+    m_viewDelegate->update(damageRect);
 }
 
 QSGNode *Compositor::updatePaintNode(QSGNode *oldNode)
@@ -129,22 +170,84 @@ QSGNode *Compositor::updatePaintNode(QSGNode *oldNode)
     if (!frameNode)
         frameNode = new DelegatedFrameNode;
 
+    const viz::CompositorFrameMetadata &metadata = m_chromiumCompositorData->frameData.metadata;
+    FrameTimingRecorder &frameTimings = m_chromiumCompositorData->frameTimings;
+    if (m_havePendingFrame)
+        frameTimings.commitStarted(metadata.frame_token);
+
     frameNode->commit(m_chromiumCompositorData.data(), &m_resourcesToRelease, m_viewDelegate);
 
     if (m_havePendingFrame) {
         m_havePendingFrame = false;
+        frameTimings.commitFinished(metadata.frame_token, frameNode->lastCommitStats());
         content::BrowserThread::PostTask(
             content::BrowserThread::UI, FROM_HERE,
             base::BindOnce(&Compositor::notifyFrameCommitted, m_weakPtrFactory.GetWeakPtr()));
+
+        // The frame will be presented by the first swap notified after this event,
+        // the swaps of earlier frames might still be queued.
+        const uint32_t frameToken = metadata.frame_token;
+        const bool requestFeedback = metadata.request_presentation_feedback;
+        QMetaObject::invokeMethod(&m_presentationContext,
+                                  [this, frameToken, requestFeedback]() {
+                                      addPendingPresentation(frameToken, requestFeedback);
+                                  },
+                                  Qt::QueuedConnection);
     }
-    if (m_chromiumCompositorData->frameData.metadata.request_presentation_feedback)
-        content::BrowserThread::PostTask(
-            content::BrowserThread::UI, FROM_HERE,
-            base::BindOnce(&Compositor::sendPresentationFeedback, m_weakPtrFactory.GetWeakPtr(), m_chromiumCompositorData->frameData.metadata.frame_token));
 
     return frameNode;
 }
 
+void Compositor::addPendingPresentation(uint32_t frameToken, bool requestFeedback)
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+
+    m_framesAwaitingSwap.append(frameToken);
+    if (requestFeedback)
+        m_pendingPresentations.push_back(frameToken);
+}
+
+void Compositor::notifyFrameSwapped()
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+
+    // The swap happened on the render thread shortly before, this is as close as we can tell.
+    const base::TimeTicks swapTime = base::TimeTicks::Now();
+    const base::TimeDelta interval = vsyncInterval();
+    m_beginFrameSource->OnUpdateVSyncParameters(swapTime, interval);
+
+    if (m_frameSinkClient) {
+        const gfx::PresentationFeedback feedback(swapTime, interval, gfx::PresentationFeedback::Flags::kVSync);
+        for (uint32_t frameToken : m_pendingPresentations)
+            m_frameSinkClient->DidPresentCompositorFrame(frameToken, feedback);
+    }
+    m_pendingPresentations.clear();
+
+    if (!m_framesAwaitingSwap.isEmpty()) {
+        m_chromiumCompositorData->frameTimings.framesSwapped(m_framesAwaitingSwap);
+        m_framesAwaitingSwap.clear();
+    }
+}
+
+QWebEngineFrameTimingReport Compositor::frameTimingReport() const
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+
+    return m_chromiumCompositorData->frameTimings.report();
+}
+
+base::TimeDelta Compositor::vsyncInterval() const
+{
+    qreal refreshRate = 60;
+    if (m_viewDelegate) {
+        QWindow *window = m_viewDelegate->window();
+        QScreen *screen = window ? window->screen() : nullptr;
+        if (screen && screen->refreshRate() > 1)
+            refreshRate = screen->refreshRate();
+    }
+    return base::TimeDelta::FromSecondsD(1 / refreshRate);
+}
+
 void Compositor::notifyFrameCommitted()
 {
     DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
@@ -155,18 +258,11 @@ void Compositor::notifyFrameCommitted()
     m_resourcesToRelease.clear();
 }
 
-void Compositor::sendPresentationFeedback(uint frame_token)
-{
-    gfx::PresentationFeedback dummyFeedback(base::TimeTicks::Now(), base::TimeDelta(), gfx::PresentationFeedback::Flags::kVSync);
-    m_frameSinkClient->DidPresentCompositorFrame(frame_token, dummyFeedback);
-}
-
 bool Compositor::OnBeginFrameDerivedImpl(const viz::BeginFrameArgs &args)
 {
     DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
 
     m_view->OnBeginFrame(args.frame_time);
-    m_beginFrameSource->OnUpdateVSyncParameters(args.frame_time, args.interval);
     if (m_frameSinkClient)
         m_frameSinkClient->OnBeginFrame(args);
 
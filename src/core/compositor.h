@@ -44,10 +44,13 @@
 #include <components/viz/common/frame_sinks/begin_frame_source.h>
 
 #include <QtCore/qglobal.h>
+#include <QtCore/qobject.h>
 #include <QtCore/qshareddata.h>
+#include <QtCore/qvector.h>
 
 QT_BEGIN_NAMESPACE
 class QSGNode;
+class QWebEngineFrameTimingReport;
 QT_END_NAMESPACE
 
 namespace viz {
@@ -82,6 +85,10 @@ class ChromiumCompositorData;
 //
 //   Step 4. The Compositor will return unneeded resources back to the child
 //   compositors. Go to step 1.
+//
+// BeginFrames are issued on a timer that follows the refresh rate of the screen
+// and the phase of the frames swapped by the window, through notifyFrameSwapped().
+// They are suspended while the window is occluded.
 class Compositor final : private viz::BeginFrameObserverBase
 {
 public:
@@ -91,14 +98,21 @@ public:
     void setViewDelegate(RenderWidgetHostViewQtDelegate *viewDelegate);
     void setFrameSinkClient(viz::mojom::CompositorFrameSinkClient *frameSinkClient);
     void setNeedsBeginFrames(bool needsBeginFrames);
+    void setOccluded(bool occluded);
 
     void submitFrame(viz::CompositorFrame frame);
 
     QSGNode *updatePaintNode(QSGNode *oldNode);
+    // Must be called on the UI thread in the order the window swapped its frames.
+    void notifyFrameSwapped();
+
+    QWebEngineFrameTimingReport frameTimingReport() const;
 
 private:
     void notifyFrameCommitted();
-    void sendPresentationFeedback(uint frame_token);
+    void addPendingPresentation(uint32_t frameToken, bool requestFeedback);
+    base::TimeDelta vsyncInterval() const;
+    void updateBeginFrameObservation();
 
     // viz::BeginFrameObserverBase
     bool OnBeginFrameDerivedImpl(const viz::BeginFrameArgs &args) override;
@@ -112,6 +126,15 @@ private:
     viz::mojom::CompositorFrameSinkClient *m_frameSinkClient = nullptr;
     bool m_havePendingFrame = false;
     bool m_needsBeginFrames = false;
+    bool m_occluded = false;
+    bool m_observingBeginFrames = false;
+    // Frame tokens of committed frames waiting for the next swap to report their presentation.
+    std::vector<uint32_t> m_pendingPresentations;
+    // Frame tokens of all the frames committed since the last swap, for the frame timings.
+    QVector<quint32> m_framesAwaitingSwap;
+    // Receives the frame tokens posted from the render thread through the Qt event queue,
+    // which keeps them ordered with the frame swaps forwarded by the delegate.
+    QObject m_presentationContext;
 
     base::WeakPtrFactory<Compositor> m_weakPtrFactory{this};
 
@@ -53,6 +53,7 @@ SOURCES = \
         common/qt_ipc_logging.cpp \
         common/qt_messages.cpp \
         common/user_script_data.cpp \
+        common/web_channel_wire_format.cpp \
         compositor.cpp \
         content_client_qt.cpp \
         content_browser_client_qt.cpp \
@@ -65,22 +66,28 @@ SOURCES = \
         download_manager_delegate_qt.cpp \
         favicon_manager.cpp \
         file_picker_controller.cpp \
+        frame_timing_recorder.cpp \
         javascript_dialog_controller.cpp \
         javascript_dialog_manager_qt.cpp \
         login_delegate_qt.cpp \
         media_capture_devices_dispatcher.cpp \
         native_web_keyboard_event_qt.cpp \
         net/cookie_monster_delegate_qt.cpp \
+        net/cookie_policy_qt.cpp \
         net/custom_protocol_handler.cpp \
+        net/navigation_policy_qt.cpp \
         net/network_delegate_qt.cpp \
         net/proxy_config_service_qt.cpp \
         net/qrc_protocol_handler_qt.cpp \
         net/ssl_host_state_delegate_qt.cpp \
+        net/url_request_content_job_qt.cpp \
         net/url_request_context_getter_qt.cpp \
         net/url_request_custom_job.cpp \
         net/url_request_custom_job_delegate.cpp \
         net/url_request_custom_job_proxy.cpp \
+        net/url_request_custom_job_thread_pool.cpp \
         net/url_request_qrc_job_qt.cpp \
+        net/url_request_rule_set.cpp \
         net/webui_controller_factory_qt.cpp \
         ozone/gl_context_qt.cpp \
         ozone/gl_ozone_egl_qt.cpp \
@@ -107,6 +114,7 @@ SOURCES = \
         renderer/render_frame_observer_qt.cpp \
         renderer/render_view_observer_qt.cpp \
         renderer/user_resource_controller.cpp \
+        renderer/user_script_index.cpp \
         renderer_host/user_resource_controller_host.cpp \
         resource_bundle_qt.cpp \
         resource_context_qt.cpp \
@@ -142,6 +150,7 @@ HEADERS = \
         color_chooser_controller.h \
         common/qt_messages.h \
         common/user_script_data.h \
+        common/web_channel_wire_format.h \
         compositor.h \
         content_client_qt.h \
         content_browser_client_qt.h \
@@ -155,6 +164,7 @@ HEADERS = \
         chromium_gpu_helper.h \
         favicon_manager.h \
         file_picker_controller.h \
+        frame_timing_recorder.h \
         global_descriptors_qt.h \
         javascript_dialog_controller_p.h \
         javascript_dialog_controller.h \
@@ -162,15 +172,20 @@ HEADERS = \
         login_delegate_qt.h \
         media_capture_devices_dispatcher.h \
         net/cookie_monster_delegate_qt.h \
+        net/cookie_policy_qt.h \
         net/custom_protocol_handler.h \
+        net/navigation_policy_qt.h \
         net/network_delegate_qt.h \
         net/qrc_protocol_handler_qt.h \
         net/ssl_host_state_delegate_qt.h \
+        net/url_request_content_job_qt.h \
         net/url_request_context_getter_qt.h \
         net/url_request_custom_job.h \
         net/url_request_custom_job_delegate.h \
         net/url_request_custom_job_proxy.h \
+        net/url_request_custom_job_thread_pool.h \
         net/url_request_qrc_job_qt.h \
+        net/url_request_rule_set.h \
         net/webui_controller_factory_qt.h \
         ozone/gl_context_qt.h \
         ozone/gl_ozone_egl_qt.h \
@@ -201,6 +216,7 @@ HEADERS = \
         renderer/render_frame_observer_qt.h \
         renderer/render_view_observer_qt.h \
         renderer/user_resource_controller.h \
+        renderer/user_script_index.h \
         renderer_host/user_resource_controller_host.h \
         request_controller.h \
         resource_context_qt.h \
@@ -82,7 +82,10 @@
 # include <QOpenGLFunctions>
 # include <QSGFlatColorMaterial>
 #endif
+#include <QElapsedTimer>
+#include <QLoggingCategory>
 #include <QSGTexture>
+#include <QSet>
 #include <private/qsgadaptationlayer_p.h>
 
 #include <QSGImageNode>
@@ -128,6 +131,9 @@ QT_END_NAMESPACE
 #endif
 
 namespace QtWebEngineCore {
+
+Q_LOGGING_CATEGORY(lcCompositor, "qt.webengine.compositor")
+
 #ifndef QT_NO_OPENGL
 class MailboxTexture : public QSGTexture, protected QOpenGLFunctions {
 public:
@@ -142,11 +148,15 @@ public:
 
     void setHasAlphaChannel(bool hasAlpha) { m_hasAlpha = hasAlpha; }
     gpu::MailboxHolder &mailboxHolder() { return m_mailboxHolder; }
-    void fetchTexture(gpu::MailboxManager *mailboxManager);
+    void setFetchBatch(const QSharedPointer<MailboxFetchBatch> &batch, int index);
+    MailboxFetchBatch *fetchBatch() const { return m_fetchBatch.data(); }
+    int fetchIndex() const { return m_fetchIndex; }
     void setTarget(GLenum target);
 
 private:
     gpu::MailboxHolder m_mailboxHolder;
+    QSharedPointer<MailboxFetchBatch> m_fetchBatch;
+    int m_fetchIndex;
     int m_textureId;
     QSize m_textureSize;
     bool m_hasAlpha;
@@ -158,11 +168,13 @@ private:
     EGLStreamData m_eglStreamData;
 #endif
     friend class DelegatedFrameNode;
+    friend class MailboxFetchBatch;
 };
 #endif // QT_NO_OPENGL
 class ResourceHolder {
 public:
-    ResourceHolder(const viz::TransferableResource &resource);
+    ResourceHolder(const viz::TransferableResource &resource,
+                   const QSharedPointer<MailboxFetchBatch> &fetchBatch, int fetchIndex);
     QSharedPointer<QSGTexture> initTexture(bool quadIsAllOpaque, RenderWidgetHostViewQtDelegate *apiDelegate = 0);
     QSGTexture *texture() const { return m_texture.data(); }
     viz::ReturnedResource returnResource();
@@ -172,6 +184,8 @@ public:
 private:
     QWeakPointer<QSGTexture> m_texture;
     viz::TransferableResource m_resource;
+    QSharedPointer<MailboxFetchBatch> m_fetchBatch;
+    int m_fetchIndex;
     int m_importCount;
 };
 
@@ -183,186 +197,112 @@ private:
     QSGGeometry m_geometry;
 };
 
+// Reconciles the quad nodes of one layer of a render pass. Nodes of a layer that is
+// structurally unchanged since the previous frame are updated in place, in order,
+// while the nodes of new layers are created and appended to their layer chain.
 class DelegatedNodeTreeHandler
 {
 public:
-    DelegatedNodeTreeHandler(QVector<QSGNode*> *sceneGraphNodes)
-        : m_sceneGraphNodes(sceneGraphNodes)
+    DelegatedNodeTreeHandler(RenderWidgetHostViewQtDelegate *apiDelegate)
+        : m_apiDelegate(apiDelegate)
+        , m_quadNodes(nullptr)
+        , m_nodeIndex(0)
+        , m_reuse(false)
     {
     }
 
-    virtual ~DelegatedNodeTreeHandler(){}
-
-    virtual void setupRenderPassNode(QSGTexture *, const QRect &, const QRectF &, QSGNode *) = 0;
-    virtual void setupTextureContentNode(QSGTexture *, const QRect &, const QRectF &,
-                                         QSGImageNode::TextureCoordinatesTransformMode,
-                                         QSGNode *) = 0;
-    virtual void setupSolidColorNode(const QRect &, const QColor &, QSGNode *) = 0;
-
-#ifndef QT_NO_OPENGL
-    virtual void setupDebugBorderNode(QSGGeometry *, QSGFlatColorMaterial *, QSGNode *) = 0;
-    virtual void setupYUVVideoNode(QSGTexture *, QSGTexture *, QSGTexture *, QSGTexture *,
-                           const QRectF &, const QRectF &, const QSizeF &, const QSizeF &,
-                           gfx::ColorSpace, float, float, const QRectF &,
-                                   QSGNode *) = 0;
-#ifdef GL_OES_EGL_image_external
-    virtual void setupStreamVideoNode(MailboxTexture *, const QRectF &,
-                                      const QMatrix4x4 &, QSGNode *) = 0;
-#endif // GL_OES_EGL_image_external
-#endif // QT_NO_OPENGL
-protected:
-    QVector<QSGNode*> *m_sceneGraphNodes;
-};
-
-class DelegatedNodeTreeUpdater : public DelegatedNodeTreeHandler
-{
-public:
-    DelegatedNodeTreeUpdater(QVector<QSGNode*> *sceneGraphNodes)
-        : DelegatedNodeTreeHandler(sceneGraphNodes)
-        , m_nodeIterator(sceneGraphNodes->begin())
-    {
-    }
-
-    void setupRenderPassNode(QSGTexture *layer, const QRect &rect, const QRectF &sourceRect, QSGNode *) override
-    {
-        Q_ASSERT(layer);
-        Q_ASSERT(m_nodeIterator != m_sceneGraphNodes->end());
-        QSGInternalImageNode *imageNode = static_cast<QSGInternalImageNode*>(*m_nodeIterator++);
-        imageNode->setTargetRect(rect);
-        imageNode->setInnerTargetRect(rect);
-        imageNode->setSubSourceRect(layer->convertToNormalizedSourceRect(sourceRect));
-        imageNode->setTexture(layer);
-        imageNode->update();
-    }
-
-    void setupTextureContentNode(QSGTexture *texture, const QRect &rect, const QRectF &sourceRect,
-                                 QSGImageNode::TextureCoordinatesTransformMode texCoordTransForm,
-                                 QSGNode *) override
-    {
-        Q_ASSERT(m_nodeIterator != m_sceneGraphNodes->end());
-        QSGImageNode *textureNode = static_cast<QSGImageNode*>(*m_nodeIterator++);
-        if (textureNode->texture() != texture) {
-            // Chromium sometimes uses textures that doesn't completely fit
-            // in which case the geometry needs to be recalculated even if
-            // rect and src-rect matches.
-            if (textureNode->texture()->textureSize() != texture->textureSize())
-                textureNode->markDirty(QSGImageNode::DirtyGeometry);
-            textureNode->setTexture(texture);
-        }
-        if (textureNode->textureCoordinatesTransform() != texCoordTransForm)
-            textureNode->setTextureCoordinatesTransform(texCoordTransForm);
-        if (textureNode->rect() != rect)
-            textureNode->setRect(rect);
-        if (textureNode->sourceRect() != sourceRect)
-            textureNode->setSourceRect(sourceRect);
-        if (textureNode->filtering() != texture->filtering())
-            textureNode->setFiltering(texture->filtering());
-    }
-    void setupSolidColorNode(const QRect &rect, const QColor &color, QSGNode *) override
-    {
-        Q_ASSERT(m_nodeIterator != m_sceneGraphNodes->end());
-         QSGRectangleNode *rectangleNode = static_cast<QSGRectangleNode*>(*m_nodeIterator++);
-
-         if (rectangleNode->rect() != rect)
-             rectangleNode->setRect(rect);
-         if (rectangleNode->color() != color)
-             rectangleNode->setColor(color);
-    }
-#ifndef QT_NO_OPENGL
-    void setupDebugBorderNode(QSGGeometry *geometry, QSGFlatColorMaterial *material,
-                              QSGNode *) override
-    {
-        Q_ASSERT(m_nodeIterator != m_sceneGraphNodes->end());
-        QSGGeometryNode *geometryNode = static_cast<QSGGeometryNode*>(*m_nodeIterator++);
-
-        geometryNode->setGeometry(geometry);
-        geometryNode->setMaterial(material);
-    }
-
-    void setupYUVVideoNode(QSGTexture *, QSGTexture *, QSGTexture *, QSGTexture *,
-                           const QRectF &, const QRectF &, const QSizeF &, const QSizeF &,
-                           gfx::ColorSpace, float, float, const QRectF &,
-                           QSGNode *) override
-    {
-        Q_UNREACHABLE();
-    }
-#ifdef GL_OES_EGL_image_external
-    void setupStreamVideoNode(MailboxTexture *, const QRectF &,
-                              const QMatrix4x4 &, QSGNode *) override
+    void beginLayer(QVector<QSGNode*> *quadNodes, bool reuse)
     {
-        Q_UNREACHABLE();
+        m_quadNodes = quadNodes;
+        m_nodeIndex = 0;
+        m_reuse = reuse;
     }
-#endif // GL_OES_EGL_image_external
-#endif // QT_NO_OPENGL
 
-private:
-    QVector<QSGNode*>::iterator m_nodeIterator;
-};
-
-class DelegatedNodeTreeCreator : public DelegatedNodeTreeHandler
-{
-public:
-    DelegatedNodeTreeCreator(QVector<QSGNode*> *sceneGraphNodes,
-                             RenderWidgetHostViewQtDelegate *apiDelegate)
-        : DelegatedNodeTreeHandler(sceneGraphNodes)
-        , m_apiDelegate(apiDelegate)
+    // Leaves the next reused node as it is.
+    void skipNode()
     {
+        Q_ASSERT(m_reuse && m_nodeIndex < m_quadNodes->size());
+        ++m_nodeIndex;
     }
 
     void setupRenderPassNode(QSGTexture *layer, const QRect &rect, const QRectF &sourceRect,
-                             QSGNode *layerChain) override
+                             QSGNode *layerChain)
     {
         Q_ASSERT(layer);
-        // Only QSGInternalImageNode currently supports QSGLayer textures.
-        QSGInternalImageNode *imageNode = m_apiDelegate->createInternalImageNode();
+        QSGInternalImageNode *imageNode = nextReusedNode<QSGInternalImageNode>();
+        if (!imageNode) {
+            // Only QSGInternalImageNode currently supports QSGLayer textures.
+            imageNode = m_apiDelegate->createInternalImageNode();
+            appendNode(imageNode, layerChain);
+        }
         imageNode->setTargetRect(rect);
         imageNode->setInnerTargetRect(rect);
         imageNode->setSubSourceRect(layer->convertToNormalizedSourceRect(sourceRect));
         imageNode->setTexture(layer);
         imageNode->update();
-
-        layerChain->appendChildNode(imageNode);
-        m_sceneGraphNodes->append(imageNode);
     }
 
     void setupTextureContentNode(QSGTexture *texture, const QRect &rect, const QRectF &sourceRect,
                                  QSGImageNode::TextureCoordinatesTransformMode texCoordTransForm,
-                                 QSGNode *layerChain) override
+                                 QSGNode *layerChain)
     {
+        if (QSGImageNode *textureNode = nextReusedNode<QSGImageNode>()) {
+            if (textureNode->texture() != texture) {
+                // Chromium sometimes uses textures that doesn't completely fit
+                // in which case the geometry needs to be recalculated even if
+                // rect and src-rect matches.
+                if (textureNode->texture()->textureSize() != texture->textureSize())
+                    textureNode->markDirty(QSGImageNode::DirtyGeometry);
+                textureNode->setTexture(texture);
+            }
+            if (textureNode->textureCoordinatesTransform() != texCoordTransForm)
+                textureNode->setTextureCoordinatesTransform(texCoordTransForm);
+            if (textureNode->rect() != rect)
+                textureNode->setRect(rect);
+            if (textureNode->sourceRect() != sourceRect)
+                textureNode->setSourceRect(sourceRect);
+            if (textureNode->filtering() != texture->filtering())
+                textureNode->setFiltering(texture->filtering());
+            return;
+        }
+
         QSGImageNode *textureNode = m_apiDelegate->createImageNode();
         textureNode->setTextureCoordinatesTransform(texCoordTransForm);
         textureNode->setRect(rect);
         textureNode->setSourceRect(sourceRect);
         textureNode->setTexture(texture);
         textureNode->setFiltering(texture->filtering());
-
-        layerChain->appendChildNode(textureNode);
-        m_sceneGraphNodes->append(textureNode);
+        appendNode(textureNode, layerChain);
     }
 
-    void setupSolidColorNode(const QRect &rect, const QColor &color,
-                             QSGNode *layerChain) override
+    void setupSolidColorNode(const QRect &rect, const QColor &color, QSGNode *layerChain)
     {
+        if (QSGRectangleNode *rectangleNode = nextReusedNode<QSGRectangleNode>()) {
+            if (rectangleNode->rect() != rect)
+                rectangleNode->setRect(rect);
+            if (rectangleNode->color() != color)
+                rectangleNode->setColor(color);
+            return;
+        }
+
         QSGRectangleNode *rectangleNode = m_apiDelegate->createRectangleNode();
         rectangleNode->setRect(rect);
         rectangleNode->setColor(color);
-
-        layerChain->appendChildNode(rectangleNode);
-        m_sceneGraphNodes->append(rectangleNode);
+        appendNode(rectangleNode, layerChain);
     }
 
 #ifndef QT_NO_OPENGL
     void setupDebugBorderNode(QSGGeometry *geometry, QSGFlatColorMaterial *material,
-                              QSGNode *layerChain) override
+                              QSGNode *layerChain)
     {
-        QSGGeometryNode *geometryNode = new QSGGeometryNode;
-        geometryNode->setFlags(QSGNode::OwnsGeometry | QSGNode::OwnsMaterial);
-
+        QSGGeometryNode *geometryNode = nextReusedNode<QSGGeometryNode>();
+        if (!geometryNode) {
+            geometryNode = new QSGGeometryNode;
+            geometryNode->setFlags(QSGNode::OwnsGeometry | QSGNode::OwnsMaterial);
+            appendNode(geometryNode, layerChain);
+        }
         geometryNode->setGeometry(geometry);
         geometryNode->setMaterial(material);
-
-        layerChain->appendChildNode(geometryNode);
-        m_sceneGraphNodes->append(geometryNode);
     }
 
     void setupYUVVideoNode(QSGTexture *yTexture, QSGTexture *uTexture, QSGTexture *vTexture,
@@ -370,8 +310,10 @@ public:
                            const QRectF &uvTexCoordRect, const QSizeF &yaTexSize,
                            const QSizeF &uvTexSize, gfx::ColorSpace colorspace,
                            float rMul, float rOff, const QRectF &rect,
-                           QSGNode *layerChain) override
+                           QSGNode *layerChain)
     {
+        // Layers containing video quads are never reused.
+        Q_ASSERT(!m_reuse);
         YUVVideoNode *videoNode = new YUVVideoNode(
                     yTexture,
                     uTexture,
@@ -385,37 +327,44 @@ public:
                     rMul,
                     rOff);
         videoNode->setRect(rect);
-
-        layerChain->appendChildNode(videoNode);
-        m_sceneGraphNodes->append(videoNode);
+        appendNode(videoNode, layerChain);
     }
 #ifdef GL_OES_EGL_image_external
     void setupStreamVideoNode(MailboxTexture *texture, const QRectF &rect,
-                              const QMatrix4x4 &textureMatrix, QSGNode *layerChain) override
+                              const QMatrix4x4 &textureMatrix, QSGNode *layerChain)
     {
+        Q_ASSERT(!m_reuse);
         StreamVideoNode *svideoNode = new StreamVideoNode(texture, false, ExternalTarget);
         svideoNode->setRect(rect);
         svideoNode->setTextureMatrix(textureMatrix);
-        layerChain->appendChildNode(svideoNode);
-        m_sceneGraphNodes->append(svideoNode);
+        appendNode(svideoNode, layerChain);
     }
 #endif // GL_OES_EGL_image_external
 #endif // QT_NO_OPENGL
 
 private:
+    template<class Node>
+    Node *nextReusedNode()
+    {
+        if (!m_reuse)
+            return nullptr;
+        Q_ASSERT(m_nodeIndex < m_quadNodes->size());
+        return static_cast<Node *>(m_quadNodes->at(m_nodeIndex++));
+    }
+
+    void appendNode(QSGNode *node, QSGNode *layerChain)
+    {
+        layerChain->appendChildNode(node);
+        m_quadNodes->append(node);
+    }
+
     RenderWidgetHostViewQtDelegate *m_apiDelegate;
+    QVector<QSGNode*> *m_quadNodes;
+    int m_nodeIndex;
+    bool m_reuse;
 };
 
 
-static inline QSharedPointer<QSGLayer> findRenderPassLayer(const int &id, const QVector<QPair<int, QSharedPointer<QSGLayer> > > &list)
-{
-    typedef QPair<int, QSharedPointer<QSGLayer> > Pair;
-    for (const Pair &pair : list)
-        if (pair.first == id)
-            return pair.second;
-    return QSharedPointer<QSGLayer>();
-}
-
 static QSGNode *buildRenderPassChain(QSGNode *chainParent)
 {
     // Chromium already ordered the quads from back to front for us, however the
@@ -544,8 +493,46 @@ static void deleteChromiumSync(gl::TransferableFence *sync)
     Q_ASSERT(!*sync);
 }
 
+#if defined(USE_OZONE)
+// Used to import the textures exported by Chromium into Qt contexts not sharing with it.
+typedef void (QOPENGLF_APIENTRYP EGLImageTargetTexture2DOESPtr)(GLenum target, void *image);
+typedef unsigned int (QOPENGLF_APIENTRYP EGLDestroyImageKHRPtr)(void *display, void *image);
+typedef int (QOPENGLF_APIENTRYP EGLClientWaitSyncKHRPtr)(void *display, void *sync, int flags, quint64 timeout);
+typedef int (QOPENGLF_APIENTRYP EGLWaitSyncKHRPtr)(void *display, void *sync, int flags);
+typedef unsigned int (QOPENGLF_APIENTRYP EGLDestroySyncKHRPtr)(void *display, void *sync);
+static EGLImageTargetTexture2DOESPtr glEGLImageTargetTexture2DOES_ = 0;
+static EGLDestroyImageKHRPtr eglDestroyImageKHR_ = 0;
+// The fences exported along with the images. eglWaitSyncKHR_ is optional, it lets the
+// importing context wait on the GPU instead of blocking the scene graph thread.
+static EGLClientWaitSyncKHRPtr eglClientWaitSyncKHR_ = 0;
+static EGLWaitSyncKHRPtr eglWaitSyncKHR_ = 0;
+static EGLDestroySyncKHRPtr eglDestroySyncKHR_ = 0;
+
+static bool resolveTextureImageImport(QOpenGLContext *context)
+{
+    static bool resolved = false;
+    if (!resolved) {
+        if (gl::GLSurfaceQt::HasEGLExtension("EGL_KHR_image_base")
+                && gl::GLSurfaceQt::HasEGLExtension("EGL_KHR_gl_texture_2D_image")
+                && context->hasExtension(QByteArrayLiteral("GL_OES_EGL_image"))) {
+            glEGLImageTargetTexture2DOES_ = (EGLImageTargetTexture2DOESPtr)context->getProcAddress("glEGLImageTargetTexture2DOES");
+            eglDestroyImageKHR_ = (EGLDestroyImageKHRPtr)context->getProcAddress("eglDestroyImageKHR");
+        }
+        if (gl::GLSurfaceQt::HasEGLExtension("EGL_KHR_fence_sync")) {
+            eglClientWaitSyncKHR_ = (EGLClientWaitSyncKHRPtr)context->getProcAddress("eglClientWaitSyncKHR");
+            eglDestroySyncKHR_ = (EGLDestroySyncKHRPtr)context->getProcAddress("eglDestroySyncKHR");
+            if (gl::GLSurfaceQt::HasEGLExtension("EGL_KHR_wait_sync"))
+                eglWaitSyncKHR_ = (EGLWaitSyncKHRPtr)context->getProcAddress("eglWaitSyncKHR");
+        }
+        resolved = true;
+    }
+    return glEGLImageTargetTexture2DOES_ && eglDestroyImageKHR_;
+}
+#endif
+
 MailboxTexture::MailboxTexture(const gpu::MailboxHolder &mailboxHolder, const QSize textureSize)
     : m_mailboxHolder(mailboxHolder)
+    , m_fetchIndex(-1)
     , m_textureId(0)
     , m_textureSize(textureSize)
     , m_hasAlpha(false)
@@ -580,6 +567,10 @@ MailboxTexture::~MailboxTexture()
 
 void MailboxTexture::bind()
 {
+    // Wait for the GPU thread to finish producing the texture contents only now,
+    // so that the scene graph doesn't block on fences of textures it won't draw.
+    if (m_fetchBatch)
+        m_fetchBatch->waitForFences();
     glBindTexture(m_target, m_textureId);
 #ifdef Q_OS_QNX
     if (m_target == GL_TEXTURE_EXTERNAL_OES) {
@@ -602,24 +593,236 @@ void MailboxTexture::setTarget(GLenum target)
     m_target = target;
 }
 
-void MailboxTexture::fetchTexture(gpu::MailboxManager *mailboxManager)
+void MailboxTexture::setFetchBatch(const QSharedPointer<MailboxFetchBatch> &batch, int index)
 {
-    gpu::TextureBase *tex = ConsumeTexture(mailboxManager, m_target, m_mailboxHolder.mailbox);
+    m_fetchBatch = batch;
+    m_fetchIndex = index;
+}
+
+QSharedPointer<MailboxFetchBatch> MailboxFetchBatch::start(const std::vector<viz::TransferableResource> &resources,
+                                                          const QHash<unsigned, QSharedPointer<ResourceHolder> > &heldResources,
+                                                          bool exportTextureImages)
+{
+    QSharedPointer<MailboxFetchBatch> batch(new MailboxFetchBatch);
+    batch->m_entries.reserve(resources.size());
+    batch->m_entryIndices.reserve(resources.size());
+    for (const viz::TransferableResource &resource : resources) {
+        // Resources re-imported by the child compositor were already fetched with an earlier frame.
+        if (resource.is_software || heldResources.contains(resource.id))
+            continue;
+        Entry entry;
+        entry.resourceId = resource.id;
+        entry.mailboxHolder = resource.mailbox_holder;
+        entry.textureId = 0;
+#if defined(USE_OZONE)
+        entry.textureImage = nullptr;
+        entry.textureImageFence = nullptr;
+#endif
+        batch->m_entryIndices.insert(resource.id, batch->m_entries.count());
+        batch->m_entries.append(entry);
+    }
+    if (batch->m_entries.isEmpty())
+        return QSharedPointer<MailboxFetchBatch>();
+#if defined(USE_OZONE)
+    batch->m_exportsTextureImages = exportTextureImages;
+#else
+    Q_UNUSED(exportTextureImages);
+#endif
+
+    QVector<int> indicesToPull;
+    indicesToPull.reserve(batch->m_entries.size());
+
+    gpu::SyncPointManager *syncPointManager = sync_point_manager();
+    scoped_refptr<base::SingleThreadTaskRunner> gpuTaskRunner = gpu_task_runner();
+    QMutexLocker lock(&batch->m_mutex);
+    batch->m_numPendingSyncPoints = batch->m_entries.count();
+    for (int i = 0; i < batch->m_entries.count(); ++i) {
+        const gpu::SyncToken &syncToken = batch->m_entries.at(i).mailboxHolder.sync_token;
+        const auto task = base::Bind(&MailboxFetchBatch::pullTexture, batch, i);
+        if (!syncPointManager->WaitOutOfOrder(syncToken, std::move(task)))
+            indicesToPull.append(i);
+    }
+    if (!indicesToPull.isEmpty()) {
+        auto task = base::BindOnce(&MailboxFetchBatch::pullTextures, batch, std::move(indicesToPull));
+        gpuTaskRunner->PostTask(FROM_HERE, std::move(task));
+    }
+    return batch;
+}
+
+int MailboxFetchBatch::indexOf(unsigned resourceId) const
+{
+    // The entries are immutable from the outside, only their texture IDs get resolved.
+    return m_entryIndices.value(resourceId, -1);
+}
+
+bool MailboxFetchBatch::isFetched()
+{
+    QMutexLocker lock(&m_mutex);
+    return m_numPendingSyncPoints == 0;
+}
+
+qint64 MailboxFetchBatch::waitForTextures()
+{
+    QMutexLocker lock(&m_mutex);
+    if (m_numPendingSyncPoints == 0)
+        return 0;
+    QElapsedTimer timer;
+    timer.start();
+    while (m_numPendingSyncPoints > 0)
+        m_fetchedWaitCond.wait(&m_mutex);
+    return timer.nsecsElapsed();
+}
+
+void MailboxFetchBatch::waitForFences()
+{
+    QList<gl::TransferableFence> transferredFences;
+    {
+        QMutexLocker lock(&m_mutex);
+        Q_ASSERT(m_numPendingSyncPoints == 0);
+        if (m_fencesWaited)
+            return;
+        m_fencesWaited = true;
+        m_textureFences.swap(transferredFences);
+    }
+
+    for (gl::TransferableFence sync : qAsConst(transferredFences)) {
+        // We need to wait on the fences on the Qt current context, and
+        // can therefore not use GLFence routines that uses a different
+        // concept of current context.
+        waitChromiumSync(&sync);
+        deleteChromiumSync(&sync);
+    }
+}
+
+void MailboxFetchBatch::applyTo(MailboxTexture *texture, int index) const
+{
+    const Entry &entry = m_entries.at(index);
+    texture->m_textureId = entry.textureId;
+#ifdef Q_OS_QNX
+    texture->m_eglStreamData = entry.eglStreamData;
+#endif
+}
+
+#if defined(USE_OZONE)
+unsigned MailboxFetchBatch::importTextureImage(int index, QOpenGLFunctions *funcs) const
+{
+    const Entry &entry = m_entries.at(index);
+    void *image = entry.textureImage;
+    if (!image)
+        return 0;
+
+    if (entry.textureImageFence) {
+        if (eglWaitSyncKHR_)
+            eglWaitSyncKHR_(gl::GLSurfaceQt::g_display, entry.textureImageFence, 0);
+        else
+            eglClientWaitSyncKHR_(gl::GLSurfaceQt::g_display, entry.textureImageFence, 0, EGL_FOREVER_KHR);
+    }
+
+    GLuint texture = 0;
+    funcs->glGenTextures(1, &texture);
+    funcs->glBindTexture(GL_TEXTURE_2D, texture);
+    funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glEGLImageTargetTexture2DOES_(GL_TEXTURE_2D, image);
+    return texture;
+}
+
+bool MailboxFetchBatch::hasUnfencedTextureImages() const
+{
+    for (const Entry &entry : m_entries)
+        if (entry.textureImage && !entry.textureImageFence)
+            return true;
+    return false;
+}
+#endif
+
+void MailboxFetchBatch::fetchEntry(Entry *entry, gpu::MailboxManager *mailboxManager)
+{
+    const gpu::SyncToken &syncToken = entry->mailboxHolder.sync_token;
+    if (syncToken.HasData())
+        mailboxManager->PullTextureUpdates(syncToken);
+
+    gpu::TextureBase *tex = ConsumeTexture(mailboxManager, GL_TEXTURE_2D, entry->mailboxHolder.mailbox);
 
     // The texture might already have been deleted (e.g. when navigating away from a page).
     if (tex) {
-        m_textureId = service_id(tex);
-#ifdef Q_OS_QNX
-        if (m_target == GL_TEXTURE_EXTERNAL_OES) {
-            m_eglStreamData = eglstream_connect_consumer(tex);
+        entry->textureId = service_id(tex);
+#if defined(USE_OZONE)
+        // The image has to be created from a context of Chromium's share group.
+        if (m_exportsTextureImages && !!gl::GLContext::GetCurrent()) {
+            entry->textureImage = create_texture_image(entry->textureId);
+            // Fence each image on its own, an EGLImage sibling isn't synchronized with the
+            // fences of the context it was created from. The fence is only waited for if the
+            // scene graph thread could resolve the functions to do so.
+            if (entry->textureImage && eglDestroySyncKHR_)
+                entry->textureImageFence = create_texture_image_fence();
         }
 #endif
+#ifdef Q_OS_QNX
+        // This only connects if the texture is backed by a stream, which can only be
+        // the case for textures that will be used as GL_TEXTURE_EXTERNAL_OES.
+        entry->eglStreamData = eglstream_connect_consumer(tex);
+#endif
+    }
+}
+
+void MailboxFetchBatch::pullTextures(QSharedPointer<MailboxFetchBatch> batch, const QVector<int> indices)
+{
+    gpu::MailboxManager *mailboxManager = mailbox_manager();
+    for (int index : indices)
+        batch->fetchEntry(&batch->m_entries[index], mailboxManager);
+
+    batch->fenceAndUnlockQt(indices.count());
+}
+
+void MailboxFetchBatch::pullTexture(QSharedPointer<MailboxFetchBatch> batch, int index)
+{
+    batch->fetchEntry(&batch->m_entries[index], mailbox_manager());
+    batch->fenceAndUnlockQt(1);
+}
+
+void MailboxFetchBatch::fenceAndUnlockQt(int numFetched)
+{
+    QMutexLocker lock(&m_mutex);
+    if (!!gl::GLContext::GetCurrent() && gl::GLFence::IsSupported()) {
+        // Create a fence on the Chromium GPU-thread and context
+        std::unique_ptr<gl::GLFence> fence = gl::GLFence::Create();
+        // But transfer it to something generic since we need to read it using Qt's OpenGL.
+        m_textureFences.append(fence->Transfer());
     }
+    m_numPendingSyncPoints -= numFetched;
+    // Signal the scene graph thread that the textures are ready
+    if (m_numPendingSyncPoints == 0)
+        m_fetchedWaitCond.wakeAll();
 }
 #endif //QT_NO_OPENGL
 
-ResourceHolder::ResourceHolder(const viz::TransferableResource &resource)
+MailboxFetchBatch::~MailboxFetchBatch()
+{
+#if defined(USE_OZONE) && !defined(QT_NO_OPENGL)
+    // The imported textures keep their storage alive, and the images are only
+    // exported once eglDestroyImageKHR_ was resolved.
+    for (const Entry &entry : qAsConst(m_entries)) {
+        if (entry.textureImage)
+            eglDestroyImageKHR_(gl::GLSurfaceQt::g_display, entry.textureImage);
+        if (entry.textureImageFence)
+            eglDestroySyncKHR_(gl::GLSurfaceQt::g_display, entry.textureImageFence);
+    }
+#endif
+}
+
+static void releaseSharedBitmap(void *bitmap)
+{
+    delete static_cast<viz::SharedBitmap *>(bitmap);
+}
+
+ResourceHolder::ResourceHolder(const viz::TransferableResource &resource,
+                               const QSharedPointer<MailboxFetchBatch> &fetchBatch, int fetchIndex)
     : m_resource(resource)
+    , m_fetchBatch(fetchBatch)
+    , m_fetchIndex(fetchIndex)
     , m_importCount(1)
 {
 }
@@ -640,14 +843,24 @@ QSharedPointer<QSGTexture> ResourceHolder::initTexture(bool quadNeedsBlending, R
             // from Format_ARGB32_Premultiplied to Format_RGB32 just to get hasAlphaChannel to
             // return false.
             QImage::Format format = quadNeedsBlending ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
-            QImage image = sharedBitmap
-                         ? QImage(sharedBitmap->pixels(), m_resource.size.width(), m_resource.size.height(), format)
-                         : QImage(m_resource.size.width(), m_resource.size.height(), format);
-            texture.reset(apiDelegate->createTextureFromImage(image.copy()));
+            QImage image;
+            if (sharedBitmap) {
+                // Map the shared memory directly instead of copying it. The renderer only writes
+                // into the bitmap again once the resource was returned, which happens in the same
+                // commit that drops the texture, and the image keeps the mapping alive until then.
+                viz::SharedBitmap *bitmap = sharedBitmap.release();
+                image = QImage(bitmap->pixels(), m_resource.size.width(), m_resource.size.height(), format,
+                               releaseSharedBitmap, bitmap);
+            } else {
+                image = QImage(m_resource.size.width(), m_resource.size.height(), format);
+            }
+            texture.reset(apiDelegate->createTextureFromImage(image));
         } else {
 #ifndef QT_NO_OPENGL
-            texture.reset(new MailboxTexture(m_resource.mailbox_holder, toQt(m_resource.size)));
-            static_cast<MailboxTexture *>(texture.data())->setHasAlphaChannel(quadNeedsBlending);
+            MailboxTexture *mailboxTexture = new MailboxTexture(m_resource.mailbox_holder, toQt(m_resource.size));
+            mailboxTexture->setHasAlphaChannel(quadNeedsBlending);
+            mailboxTexture->setFetchBatch(m_fetchBatch, m_fetchIndex);
+            texture.reset(mailboxTexture);
 #else
             Q_UNREACHABLE();
 #endif
@@ -697,20 +910,33 @@ RectClipNode::RectClipNode(const QRectF &rect)
 }
 
 DelegatedFrameNode::DelegatedFrameNode()
-    : m_numPendingSyncPoints(0)
+    : m_mailboxFetchBudget(4000)
 #if defined(USE_OZONE) && !defined(QT_NO_OPENGL)
     , m_contextShared(true)
 #endif
 {
     setFlag(UsePreprocess);
+    // Time in microseconds the scene graph thread may spend waiting for the GPU thread
+    // to resolve mailboxes before it gets reported as a stall.
+    bool ok = false;
+    const int budget = qEnvironmentVariableIntValue("QTWEBENGINE_MAILBOX_FETCH_BUDGET", &ok);
+    if (ok && budget >= 0)
+        m_mailboxFetchBudget = budget;
 #if defined(USE_OZONE) && !defined(QT_NO_OPENGL)
     QOpenGLContext *currentContext = QOpenGLContext::currentContext() ;
     QOpenGLContext *sharedContext = qt_gl_global_share_context();
-    if (currentContext && sharedContext && !QOpenGLContext::areSharing(currentContext, sharedContext)) {
+    // Forces the path taken for contexts not sharing with Chromium, either "eglimage" or "copy".
+    const QByteArray textureSharing = qgetenv("QTWEBENGINE_TEXTURE_SHARING");
+    if (currentContext && sharedContext
+            && (!textureSharing.isEmpty() || !QOpenGLContext::areSharing(currentContext, sharedContext))) {
+        m_textureImageSharing = textureSharing != "copy" && resolveTextureImageImport(currentContext);
         static bool allowNotSharedContextWarningShown = true;
         if (allowNotSharedContextWarningShown) {
             allowNotSharedContextWarningShown = false;
-            qWarning("Context is not shared, textures will be copied between contexts.");
+            if (m_textureImageSharing)
+                qCInfo(lcCompositor, "Context is not shared, textures will be shared between contexts through EGLImages.");
+            else
+                qWarning("Context is not shared, textures will be copied between contexts.");
         }
         m_offsurface.reset(new QOffscreenSurface);
         m_offsurface->create();
@@ -721,14 +947,26 @@ DelegatedFrameNode::DelegatedFrameNode()
 
 DelegatedFrameNode::~DelegatedFrameNode()
 {
+#ifndef QT_NO_OPENGL
+    if (QOpenGLContext::currentContext()) {
+        m_fencedBatches += m_committedBatches;
+        releaseFencedBatches();
+    }
+#endif
 }
 
 void DelegatedFrameNode::preprocess()
 {
 #ifndef QT_NO_OPENGL
+    // Fences of the previous frames' batches have normally been consumed when binding their
+    // textures, make sure the ones that didn't end up being drawn don't accumulate.
+    releaseFencedBatches();
+    m_fencedBatches += m_committedBatches;
+    m_committedBatches.clear();
+
     // With the threaded render loop the GUI thread has been unlocked at this point.
-    // We can now wait for the Chromium GPU thread to produce textures that will be
-    // rendered on our quads and fetch the IDs from the mailboxes we were given.
+    // The mailboxes were already sent to the Chromium GPU thread when the frame was
+    // submitted, so we normally only have to pick up the resolved texture IDs here.
     QList<MailboxTexture *> mailboxesToFetch;
     typedef QHash<unsigned, QSharedPointer<ResourceHolder> >::const_iterator ResourceHolderIterator;
     ResourceHolderIterator end = m_chromiumCompositorData->resourceHolders.constEnd();
@@ -737,17 +975,27 @@ void DelegatedFrameNode::preprocess()
             mailboxesToFetch.append(static_cast<MailboxTexture *>((*it)->texture()));
     }
 
+    bool stalled = false;
     if (!mailboxesToFetch.isEmpty())
-        fetchAndSyncMailboxes(mailboxesToFetch);
+        stalled = fetchAndSyncMailboxes(mailboxesToFetch);
+#else
+    const bool stalled = false;
 #endif
+    if (m_frameTimingPending) {
+        m_frameTimingPending = false;
+        m_chromiumCompositorData->frameTimings.mailboxesFetched(m_committedFrameToken, stalled);
+    }
 
-    // Then render any intermediate RenderPass in order.
-    typedef QPair<int, QSharedPointer<QSGLayer> > Pair;
-    for (const Pair &pair : qAsConst(m_sgObjects.renderPassLayers)) {
+    // Then render any intermediate RenderPass in order. Passes that weren't damaged since
+    // they were last rendered keep the contents of their non-live layer.
+    for (RenderPassNodes &passNodes : m_renderPasses) {
+        if (!passNodes.layer || !passNodes.needsUpdate)
+            continue;
         // The layer is non-live, request a one-time update here.
-        pair.second->scheduleUpdate();
+        passNodes.layer->scheduleUpdate();
         // Proceed with the actual update.
-        pair.second->updateTexture();
+        passNodes.layer->updateTexture();
+        passNodes.needsUpdate = false;
     }
 }
 
@@ -764,68 +1012,45 @@ static bool areSharedQuadStatesEqual(const viz::SharedQuadState *layerState,
     return qFuzzyCompare(layerState->opacity, prevLayerState->opacity);
 }
 
-// Compares if the frame data that we got from the Chromium Compositor is
-// *structurally* equivalent to the one of the previous frame.
-// If it is, we will just reuse and update the old nodes where necessary.
-static bool areRenderPassStructuresEqual(viz::CompositorFrame *frameData,
-                                         viz::CompositorFrame *previousFrameData)
+static bool isReusableMaterial(viz::DrawQuad::Material material)
 {
-    if (!previousFrameData)
-        return false;
-
-    if (previousFrameData->render_pass_list.size() != frameData->render_pass_list.size())
-        return false;
-
-    for (unsigned i = 0; i < frameData->render_pass_list.size(); ++i) {
-        viz::RenderPass *newPass = frameData->render_pass_list.at(i).get();
-        viz::RenderPass *prevPass = previousFrameData->render_pass_list.at(i).get();
-
-        if (newPass->id != prevPass->id)
-            return false;
-
-        if (newPass->quad_list.size() != prevPass->quad_list.size())
-            return false;
-
-        viz::QuadList::ConstBackToFrontIterator it = newPass->quad_list.BackToFrontBegin();
-        viz::QuadList::ConstBackToFrontIterator end = newPass->quad_list.BackToFrontEnd();
-        viz::QuadList::ConstBackToFrontIterator prevIt = prevPass->quad_list.BackToFrontBegin();
-        viz::QuadList::ConstBackToFrontIterator prevEnd = prevPass->quad_list.BackToFrontEnd();
-        for (; it != end && prevIt != prevEnd; ++it, ++prevIt) {
-            const viz::DrawQuad *quad = *it;
-            const viz::DrawQuad *prevQuad = *prevIt;
-            if (quad->material != prevQuad->material)
-                return false;
 #ifndef QT_NO_OPENGL
-            if (quad->material == viz::DrawQuad::YUV_VIDEO_CONTENT)
-                return false;
+    if (material == viz::DrawQuad::YUV_VIDEO_CONTENT)
+        return false;
 #ifdef GL_OES_EGL_image_external
-            if (quad->material == viz::DrawQuad::STREAM_VIDEO_CONTENT)
-                return false;
+    if (material == viz::DrawQuad::STREAM_VIDEO_CONTENT)
+        return false;
 #endif // GL_OES_EGL_image_external
 #endif // QT_NO_OPENGL
-            if (!areSharedQuadStatesEqual(quad->shared_quad_state, prevQuad->shared_quad_state))
-                return false;
-            if (quad->shared_quad_state->is_clipped && quad->visible_rect != prevQuad->visible_rect) {
-                gfx::Rect targetRect1 =
-                        cc::MathUtil::MapEnclosingClippedRect(quad->shared_quad_state->quad_to_target_transform, quad->visible_rect);
-                gfx::Rect targetRect2 =
-                        cc::MathUtil::MapEnclosingClippedRect(quad->shared_quad_state->quad_to_target_transform, prevQuad->visible_rect);
-                targetRect1.Intersect(quad->shared_quad_state->clip_rect);
-                targetRect2.Intersect(quad->shared_quad_state->clip_rect);
-                if (targetRect1.IsEmpty() != targetRect2.IsEmpty())
-                    return false;
-            }
-        }
-    }
+    Q_UNUSED(material);
     return true;
 }
 
+static int countNodes(QSGNode *node)
+{
+    int count = 1;
+    for (QSGNode *child = node->firstChild(); child; child = child->nextSibling())
+        count += countNodes(child);
+    return count;
+}
+
 void DelegatedFrameNode::commit(ChromiumCompositorData *chromiumCompositorData,
                                 std::vector<viz::ReturnedResource> *resourcesToRelease,
                                 RenderWidgetHostViewQtDelegate *apiDelegate)
 {
     m_chromiumCompositorData = chromiumCompositorData;
+#if defined(USE_OZONE) && !defined(QT_NO_OPENGL)
+    // Only the frames rendered in this node's window need their textures exported, and the
+    // next ones stop being exported once the view moved to a window sharing with Chromium.
+    m_chromiumCompositorData->exportsTextureImages.store(m_textureImageSharing);
+#endif
     viz::CompositorFrame* frameData = &m_chromiumCompositorData->frameData;
+    // The same frame is committed again when only the item changed.
+    const bool newFrame = frameData->metadata.frame_token != m_committedFrameToken;
+    if (newFrame) {
+        m_committedFrameToken = frameData->metadata.frame_token;
+        m_frameTimingPending = true;
+    }
     if (frameData->render_pass_list.empty())
         return;
 
@@ -841,54 +1066,65 @@ void DelegatedFrameNode::commit(ChromiumCompositorData *chromiumCompositorData,
     QHash<unsigned, QSharedPointer<ResourceHolder> > resourceCandidates;
     qSwap(m_chromiumCompositorData->resourceHolders, resourceCandidates);
 
+    // The mailboxes of the new resources have normally already been sent to the GPU thread
+    // by Compositor::submitFrame, otherwise start fetching them now.
+    QSharedPointer<MailboxFetchBatch> fetchBatch;
+    qSwap(m_chromiumCompositorData->mailboxFetchBatch, fetchBatch);
+#ifndef QT_NO_OPENGL
+    if (!fetchBatch)
+        fetchBatch = MailboxFetchBatch::start(frameData->resource_list, resourceCandidates,
+                                              m_chromiumCompositorData->exportsTextureImages.load());
+    if (fetchBatch)
+        m_committedBatches.append(fetchBatch);
+#endif
+
     // A frame's resource_list only contains the new resources to be added to the scene. Quads can
     // still reference resources that were added in previous frames. Add them to the list of
     // candidates to be picked up by quads, it's then our responsibility to return unused resources
     // to the producing child compositor.
     for (unsigned i = 0; i < frameData->resource_list.size(); ++i) {
         const viz::TransferableResource &res = frameData->resource_list.at(i);
-        if (QSharedPointer<ResourceHolder> resource = resourceCandidates.value(res.id))
+        if (QSharedPointer<ResourceHolder> resource = resourceCandidates.value(res.id)) {
             resource->incImportCount();
-        else
-            resourceCandidates[res.id] = QSharedPointer<ResourceHolder>(new ResourceHolder(res));
+        } else {
+            const int fetchIndex = fetchBatch ? fetchBatch->indexOf(res.id) : -1;
+            Q_ASSERT(res.is_software || fetchIndex != -1);
+            resourceCandidates[res.id] = QSharedPointer<ResourceHolder>(new ResourceHolder(res, fetchBatch, fetchIndex));
+        }
     }
 
     frameData->resource_list.clear();
-    QScopedPointer<DelegatedNodeTreeHandler> nodeHandler;
 
     const QSizeF viewportSizeInPt = apiDelegate->screenRect().size();
     const QSizeF viewportSizeF = viewportSizeInPt * devicePixelRatio;
     const QSize viewportSize(std::ceil(viewportSizeF.width()), std::ceil(viewportSizeF.height()));
-
-    // We first compare if the render passes from the previous frame data are structurally
-    // equivalent to the render passes in the current frame data. If they are, we are going
-    // to reuse the old nodes. Otherwise, we will delete the old nodes and build a new tree.
+    // The damage is relative to the previous frame, it says nothing about the nodes when the
+    // same frame is committed again, or when the viewport changed which quads are visible.
+    const bool skipUndamaged = newFrame && viewportSize == m_committedViewportSize;
+    m_committedViewportSize = viewportSize;
+
+    // Instead of comparing the whole frame with the previous one, each run of quads sharing
+    // the same SharedQuadState is matched against the layers of the same render pass in the
+    // previous frame. Layers that didn't change structurally keep their nodes, which are
+    // only updated, while the nodes of the remaining ones are created or destroyed.
     //
-    // Additionally, because we clip (i.e. don't build scene graph nodes for) quads outside
-    // of the visible area, we also have to rebuild the tree whenever the window is resized.
-    const bool buildNewTree =
-        !areRenderPassStructuresEqual(frameData, &m_chromiumCompositorData->previousFrameData) ||
-        m_sceneGraphNodes.empty() ||
-        viewportSize != m_previousViewportSize;
-
-    m_chromiumCompositorData->previousFrameData = viz::CompositorFrame();
-    SGObjects previousSGObjects;
+    // Because we clip (i.e. don't build scene graph nodes for) quads outside of the visible
+    // area, only the visible quads are part of a layer's structure, so resizing the window
+    // only rebuilds the layers whose set of visible quads changed.
+    //
+    // Each render pass also tells us which part of its output changed since the previous
+    // frame. Reused nodes of quads outside of this damage are left untouched if they were
+    // built from the same quad, and the layers of intermediate render passes that weren't
+    // damaged aren't rendered again.
+    m_lastCommitStats = CommitStats();
+    QVector<RenderPassNodes> previousRenderPasses;
+    qSwap(m_renderPasses, previousRenderPasses);
+    // Save the texture strong refs so they only go out of scope when the method returns and
+    // the new vector of texture strong refs has been filled.
     QVector<QSharedPointer<QSGTexture> > textureStrongRefs;
-    if (buildNewTree) {
-        // Keep the old objects in scope to hold a ref on layers, resources and textures
-        // that we can re-use. Destroy the remaining objects before returning.
-        qSwap(m_sgObjects, previousSGObjects);
-        // Discard the scene graph nodes from the previous frame.
-        while (QSGNode *oldChain = firstChild())
-            delete oldChain;
-        m_sceneGraphNodes.clear();
-        nodeHandler.reset(new DelegatedNodeTreeCreator(&m_sceneGraphNodes, apiDelegate));
-    } else {
-        // Save the texture strong refs so they only go out of scope when the method returns and
-        // the new vector of texture strong refs has been filled.
-        qSwap(m_sgObjects.textureStrongRefs, textureStrongRefs);
-        nodeHandler.reset(new DelegatedNodeTreeUpdater(&m_sceneGraphNodes));
-    }
+    qSwap(m_textureStrongRefs, textureStrongRefs);
+    DelegatedNodeTreeHandler nodeHandler(apiDelegate);
+
     // The RenderPasses list is actually a tree where a parent RenderPass is connected
     // to its dependencies through a RenderPassId reference in one or more RenderPassQuads.
     // The list is already ordered with intermediate RenderPasses placed before their
@@ -901,34 +1137,43 @@ void DelegatedFrameNode::commit(ChromiumCompositorData *chromiumCompositorData,
     for (unsigned i = 0; i < frameData->render_pass_list.size(); ++i) {
         viz::RenderPass *pass = frameData->render_pass_list.at(i).get();
 
+        RenderPassNodes passNodes;
+        passNodes.id = pass->id;
+        for (int j = 0; j < previousRenderPasses.size(); ++j) {
+            if (previousRenderPasses.at(j).id == passNodes.id) {
+                passNodes = previousRenderPasses.takeAt(j);
+                break;
+            }
+        }
+
         QSGNode *renderPassParent = 0;
         gfx::Rect scissorRect;
+        const int nodeChangesBefore = m_lastCommitStats.createdNodes + m_lastCommitStats.destroyedNodes;
         if (pass != rootRenderPass) {
-            QSharedPointer<QSGLayer> rpLayer;
-            if (buildNewTree) {
-                rpLayer = findRenderPassLayer(pass->id, previousSGObjects.renderPassLayers);
-                if (!rpLayer) {
-                    rpLayer = QSharedPointer<QSGLayer>(apiDelegate->createLayer());
-                    // Avoid any premature texture update since we need to wait
-                    // for the GPU thread to produce the dependent resources first.
-                    rpLayer->setLive(false);
-                }
-                QSharedPointer<QSGRootNode> rootNode(new QSGRootNode);
-                rpLayer->setItem(rootNode.data());
-                m_sgObjects.renderPassLayers.append(QPair<int,
-                                                    QSharedPointer<QSGLayer> >(pass->id, rpLayer));
-                m_sgObjects.renderPassRootNodes.append(rootNode);
-                renderPassParent = rootNode.data();
-            } else
-                rpLayer = findRenderPassLayer(pass->id, m_sgObjects.renderPassLayers);
-
+            if (!passNodes.layer) {
+                // The pass used to be the root one, its nodes are attached to the wrong parent.
+                destroyRenderPassNodes(&passNodes);
+                passNodes.layer = QSharedPointer<QSGLayer>(apiDelegate->createLayer());
+                // Avoid any premature texture update since we need to wait
+                // for the GPU thread to produce the dependent resources first.
+                passNodes.layer->setLive(false);
+                passNodes.rootNode = QSharedPointer<QSGRootNode>(new QSGRootNode);
+                passNodes.layer->setItem(passNodes.rootNode.data());
+            }
+            QSGLayer *rpLayer = passNodes.layer.data();
+            if (passNodes.outputRect != pass->output_rect)
+                passNodes.needsUpdate = true;
+            passNodes.outputRect = pass->output_rect;
             rpLayer->setRect(toQt(pass->output_rect));
             rpLayer->setSize(toQt(pass->output_rect.size()));
             rpLayer->setFormat(pass->has_transparent_background ? GL_RGBA : GL_RGB);
             rpLayer->setHasMipmaps(pass->generate_mipmap);
             rpLayer->setMirrorVertical(true);
+            renderPassParent = passNodes.rootNode.data();
             scissorRect = pass->output_rect;
         } else {
+            if (passNodes.layer)
+                destroyRenderPassNodes(&passNodes);
             renderPassParent = this;
             scissorRect = viewportRect;
             scissorRect += rootRenderPass->output_rect.OffsetFromOrigin();
@@ -936,18 +1181,49 @@ void DelegatedFrameNode::commit(ChromiumCompositorData *chromiumCompositorData,
 
         if (scissorRect.IsEmpty()) {
             holdResources(pass, resourceCandidates);
+            for (LayerNodes &layerNodes : passNodes.layers)
+                destroyLayerNodes(&layerNodes);
+            passNodes.layers.clear();
+            m_renderPasses.append(passNodes);
             continue;
         }
 
-        QSGNode *renderPassChain = nullptr;
-        if (buildNewTree)
-            renderPassChain = buildRenderPassChain(renderPassParent);
+        if (!passNodes.chain) {
+            passNodes.chain = buildRenderPassChain(renderPassParent);
+            ++m_lastCommitStats.createdNodes;
+        } else {
+            ++m_lastCommitStats.reusedNodes;
+        }
+
+        QVector<LayerNodes> previousLayers;
+        qSwap(passNodes.layers, previousLayers);
 
         base::circular_deque<std::unique_ptr<viz::DrawPolygon>> polygonQueue;
         int nextPolygonId = 0;
         int currentSortingContextId = 0;
-        const viz::SharedQuadState *currentLayerState = nullptr;
-        QSGNode *currentLayerChain = nullptr;
+        std::vector<VisibleQuad> currentLayerQuads;
+        const auto flushLayer = [&]() {
+            if (!currentLayerQuads.empty()) {
+                reconcileLayer(currentLayerQuads, pass->damage_rect, skipUndamaged, &passNodes,
+                               &previousLayers, &nodeHandler, resourceCandidates, apiDelegate);
+                currentLayerQuads.clear();
+            }
+        };
+        const auto flushSortingContext = [&]() {
+            if (polygonQueue.empty())
+                return;
+            // Polygons can be split by the BSP tree, never try to reuse their nodes.
+            LayerNodes layerNodes;
+            layerNodes.chainRoot = new QSGNode;
+            passNodes.chain->appendChildNode(layerNodes.chainRoot);
+            nodeHandler.beginLayer(&layerNodes.quadNodes, false);
+            flushPolygons(&polygonQueue, layerNodes.chainRoot,
+                          &nodeHandler, resourceCandidates, apiDelegate);
+            layerNodes.nodeCount = countNodes(layerNodes.chainRoot);
+            m_lastCommitStats.createdNodes += layerNodes.nodeCount;
+            passNodes.layers.append(layerNodes);
+        };
+
         const auto quadListBegin = pass->quad_list.BackToFrontBegin();
         const auto quadListEnd = pass->quad_list.BackToFrontEnd();
         for (auto it = quadListBegin; it != quadListEnd; ++it) {
@@ -966,8 +1242,8 @@ void DelegatedFrameNode::commit(ChromiumCompositorData *chromiumCompositorData,
             }
 
             if (quadState->sorting_context_id != currentSortingContextId) {
-                flushPolygons(&polygonQueue, renderPassChain,
-                              nodeHandler.data(), resourceCandidates, apiDelegate);
+                flushLayer();
+                flushSortingContext();
                 currentSortingContextId = quadState->sorting_context_id;
             }
 
@@ -983,17 +1259,42 @@ void DelegatedFrameNode::commit(ChromiumCompositorData *chromiumCompositorData,
                 continue;
             }
 
-            if (renderPassChain && currentLayerState != quadState) {
-                currentLayerState = quadState;
-                currentLayerChain = buildLayerChain(renderPassChain, quadState);
+            if (!currentLayerQuads.empty() && currentLayerQuads.back().quad->shared_quad_state != quadState)
+                flushLayer();
+            currentLayerQuads.push_back({ quad, targetRect });
+        }
+        flushLayer();
+        flushSortingContext();
+
+        // Whatever wasn't matched with the current frame has to go.
+        for (LayerNodes &layerNodes : previousLayers)
+            destroyLayerNodes(&layerNodes);
+
+        // Reused layers might have been reordered, restore the back-to-front order
+        // while only touching the nodes that are out of place.
+        QSGNode *previousChainRoot = nullptr;
+        for (const LayerNodes &layerNodes : qAsConst(passNodes.layers)) {
+            QSGNode *expected = previousChainRoot ? previousChainRoot->nextSibling() : passNodes.chain->firstChild();
+            if (layerNodes.chainRoot != expected) {
+                passNodes.chain->removeChildNode(layerNodes.chainRoot);
+                if (previousChainRoot)
+                    passNodes.chain->insertChildNodeAfter(layerNodes.chainRoot, previousChainRoot);
+                else
+                    passNodes.chain->prependChildNode(layerNodes.chainRoot);
             }
-
-            handleQuad(quad, currentLayerChain,
-                       nodeHandler.data(), resourceCandidates, apiDelegate);
+            previousChainRoot = layerNodes.chainRoot;
         }
-        flushPolygons(&polygonQueue, renderPassChain,
-                      nodeHandler.data(), resourceCandidates, apiDelegate);
+
+        if (!pass->damage_rect.IsEmpty()
+                || m_lastCommitStats.createdNodes + m_lastCommitStats.destroyedNodes != nodeChangesBefore)
+            passNodes.needsUpdate = true;
+        m_renderPasses.append(passNodes);
     }
+
+    // Render passes that aren't part of the frame anymore.
+    for (RenderPassNodes &passNodes : previousRenderPasses)
+        destroyRenderPassNodes(&passNodes);
+
     // Send resources of remaining candidates back to the child compositors so that
     // they can be freed or reused.
     typedef QHash<unsigned, QSharedPointer<ResourceHolder> >::const_iterator
@@ -1003,7 +1304,164 @@ void DelegatedFrameNode::commit(ChromiumCompositorData *chromiumCompositorData,
     for (ResourceHolderIterator it = resourceCandidates.constBegin(); it != end ; ++it)
         resourcesToRelease->push_back((*it)->returnResource());
 
-    m_previousViewportSize = viewportSize;
+    qCDebug(lcCompositor, "Committed frame: %d nodes reused (%d outside of the damage), %d created, %d destroyed",
+            m_lastCommitStats.reusedNodes, m_lastCommitStats.skippedNodes,
+            m_lastCommitStats.createdNodes, m_lastCommitStats.destroyedNodes);
+}
+
+void DelegatedFrameNode::reconcileLayer(const std::vector<VisibleQuad> &quads,
+                                        const gfx::Rect &damageRect,
+                                        bool skipUndamaged,
+                                        RenderPassNodes *passNodes,
+                                        QVector<LayerNodes> *previousLayers,
+                                        DelegatedNodeTreeHandler *nodeHandler,
+                                        QHash<unsigned, QSharedPointer<ResourceHolder> > &resourceCandidates,
+                                        RenderWidgetHostViewQtDelegate *apiDelegate)
+{
+    const viz::SharedQuadState *layerState = quads.front().quad->shared_quad_state;
+    QVector<viz::DrawQuad::Material> materials;
+    materials.reserve(int(quads.size()));
+    bool reusable = true;
+    for (const VisibleQuad &visibleQuad : quads) {
+        const viz::DrawQuad *quad = visibleQuad.quad;
+        materials.append(quad->material);
+        reusable = reusable && isReusableMaterial(quad->material);
+        // A quad referring to an unknown render pass doesn't get a node.
+        if (quad->material == viz::DrawQuad::RENDER_PASS
+                && !findRenderPassLayer(viz::RenderPassDrawQuad::MaterialCast(quad)->render_pass_id))
+            reusable = false;
+    }
+
+    // Layers usually keep their order, so the match is normally the first remaining entry.
+    LayerNodes layerNodes;
+    bool reuse = false;
+    if (reusable) {
+        for (int i = 0; i < previousLayers->size(); ++i) {
+            const LayerNodes &candidate = previousLayers->at(i);
+            if (candidate.reusable && candidate.materials == materials
+                    && areSharedQuadStatesEqual(layerState, &candidate.layerState)) {
+                layerNodes = previousLayers->takeAt(i);
+                reuse = true;
+                break;
+            }
+        }
+    }
+
+    if (reuse) {
+        m_lastCommitStats.reusedNodes += layerNodes.nodeCount;
+    } else {
+        layerNodes.layerState = *layerState;
+        layerNodes.materials = materials;
+        layerNodes.reusable = reusable;
+        layerNodes.chainRoot = new QSGNode;
+        passNodes->chain->appendChildNode(layerNodes.chainRoot);
+        layerNodes.layerChain = buildLayerChain(layerNodes.chainRoot, layerState);
+    }
+
+    if (reusable)
+        layerNodes.quadIdentities.resize(int(quads.size()));
+    nodeHandler->beginLayer(&layerNodes.quadNodes, reuse);
+    for (int i = 0; i < int(quads.size()); ++i) {
+        const VisibleQuad &visibleQuad = quads[i];
+        if (reuse && skipUndamaged && !visibleQuad.targetRect.Intersects(damageRect)
+                && quadIdentity(visibleQuad.quad, resourceCandidates) == layerNodes.quadIdentities.at(i)
+                && holdUndamagedQuad(visibleQuad.quad, resourceCandidates, apiDelegate)) {
+            nodeHandler->skipNode();
+            ++m_lastCommitStats.skippedNodes;
+            continue;
+        }
+        handleQuad(visibleQuad.quad, layerNodes.layerChain, nodeHandler, resourceCandidates, apiDelegate);
+        if (reusable)
+            layerNodes.quadIdentities[i] = quadIdentity(visibleQuad.quad, resourceCandidates);
+    }
+
+    if (!reuse) {
+        layerNodes.nodeCount = countNodes(layerNodes.chainRoot);
+        m_lastCommitStats.createdNodes += layerNodes.nodeCount;
+    }
+    passNodes->layers.append(layerNodes);
+}
+
+// The textures are looked up without being held, a resource without a live texture
+// identifies as a null texture, which never matches the one a node was built with.
+DelegatedFrameNode::QuadIdentity DelegatedFrameNode::quadIdentity(const viz::DrawQuad *quad,
+                                                                  const QHash<unsigned, QSharedPointer<ResourceHolder> > &resourceCandidates) const
+{
+    QuadIdentity identity;
+    identity.material = quad->material;
+    identity.rect = quad->rect;
+    for (auto resourceId : quad->resources) {
+        QSharedPointer<ResourceHolder> resource = m_chromiumCompositorData->resourceHolders.value(resourceId);
+        if (!resource)
+            resource = resourceCandidates.value(resourceId);
+        identity.resourceIds.append(resourceId);
+        identity.textures.append(resource ? resource->texture() : nullptr);
+    }
+    // The layer of a render pass is recreated when the pass stops being the root one.
+    if (quad->material == viz::DrawQuad::RENDER_PASS)
+        identity.textures.append(findRenderPassLayer(viz::RenderPassDrawQuad::MaterialCast(quad)->render_pass_id));
+    return identity;
+}
+
+// Keeps the resources and textures of a reused quad alive without updating its node.
+// The quad must identify as the one the node was built from, so that the node already
+// points to the textures held here. Returns false if the quad has to be handled.
+bool DelegatedFrameNode::holdUndamagedQuad(const viz::DrawQuad *quad,
+                                           QHash<unsigned, QSharedPointer<ResourceHolder> > &resourceCandidates,
+                                           RenderWidgetHostViewQtDelegate *apiDelegate)
+{
+    switch (quad->material) {
+    case viz::DrawQuad::RENDER_PASS:
+    case viz::DrawQuad::TEXTURE_CONTENT:
+    case viz::DrawQuad::SOLID_COLOR:
+    case viz::DrawQuad::TILED_CONTENT:
+#ifndef QT_NO_OPENGL
+    case viz::DrawQuad::DEBUG_BORDER:
+#endif
+        break;
+    default:
+        return false;
+    }
+
+    // The previous frame's strong refs are only released once the commit is done, so the
+    // textures still alive are the ones the node points to and they are held again here.
+    for (auto resourceId : quad->resources) {
+        ResourceHolder *resource = findAndHoldResource(resourceId, resourceCandidates);
+        initAndHoldTexture(resource, quad->ShouldDrawWithBlending(), apiDelegate);
+    }
+    return true;
+}
+
+void DelegatedFrameNode::destroyLayerNodes(LayerNodes *layerNodes)
+{
+    m_lastCommitStats.destroyedNodes += layerNodes->nodeCount;
+    // Deleting a node also removes it from its parent.
+    delete layerNodes->chainRoot;
+    layerNodes->chainRoot = nullptr;
+    layerNodes->layerChain = nullptr;
+    layerNodes->quadNodes.clear();
+}
+
+void DelegatedFrameNode::destroyRenderPassNodes(RenderPassNodes *passNodes)
+{
+    for (LayerNodes &layerNodes : passNodes->layers)
+        destroyLayerNodes(&layerNodes);
+    passNodes->layers.clear();
+    if (passNodes->chain) {
+        ++m_lastCommitStats.destroyedNodes;
+        delete passNodes->chain;
+        passNodes->chain = nullptr;
+    }
+    passNodes->rootNode.reset();
+    passNodes->layer.reset();
+}
+
+QSGLayer *DelegatedFrameNode::findRenderPassLayer(int id) const
+{
+    for (const RenderPassNodes &passNodes : m_renderPasses)
+        if (passNodes.id == id)
+            return passNodes.layer.data();
+    return nullptr;
 }
 
 void DelegatedFrameNode::flushPolygons(
@@ -1097,8 +1555,7 @@ void DelegatedFrameNode::handleQuad(
             ResourceHolder *resource = findAndHoldResource(renderPassQuad->mask_resource_id(), resourceCandidates);
             Q_UNUSED(resource); // FIXME: QTBUG-67652
         }
-        QSGLayer *layer =
-            findRenderPassLayer(renderPassQuad->render_pass_id, m_sgObjects.renderPassLayers).data();
+        QSGLayer *layer = findRenderPassLayer(renderPassQuad->render_pass_id);
 
         if (layer)
             nodeHandler->setupRenderPassNode(layer, toQt(quad->rect), toQt(renderPassQuad->tex_coord_rect), currentLayerChain);
@@ -1241,49 +1698,33 @@ QSGTexture *DelegatedFrameNode::initAndHoldTexture(ResourceHolder *resource, boo
     // so we can't store them with the ResourceHolder in m_chromiumCompositorData.
     // Hold them through a QSharedPointer solely on the root DelegatedFrameNode of the web view
     // and access them through a QWeakPointer from the resource holder to find them later.
-    m_sgObjects.textureStrongRefs.append(resource->initTexture(quadIsAllOpaque, apiDelegate));
-    return m_sgObjects.textureStrongRefs.last().data();
+    m_textureStrongRefs.append(resource->initTexture(quadIsAllOpaque, apiDelegate));
+    return m_textureStrongRefs.last().data();
 }
 
-void DelegatedFrameNode::fetchAndSyncMailboxes(QList<MailboxTexture *> &mailboxesToFetch)
+bool DelegatedFrameNode::fetchAndSyncMailboxes(QList<MailboxTexture *> &mailboxesToFetch)
 {
 #ifndef QT_NO_OPENGL
-    QList<gl::TransferableFence> transferredFences;
-    {
-        QMutexLocker lock(&m_mutex);
-        QVector<MailboxTexture *> mailboxesToPull;
-        mailboxesToPull.reserve(mailboxesToFetch.size());
-
-        gpu::SyncPointManager *syncPointManager = sync_point_manager();
-        scoped_refptr<base::SingleThreadTaskRunner> gpuTaskRunner = gpu_task_runner();
-        Q_ASSERT(m_numPendingSyncPoints == 0);
-        m_numPendingSyncPoints = mailboxesToFetch.count();
-        for (MailboxTexture *mailboxTexture : qAsConst(mailboxesToFetch)) {
-            gpu::SyncToken &syncToken = mailboxTexture->mailboxHolder().sync_token;
-            const auto task = base::Bind(&DelegatedFrameNode::pullTexture, this, mailboxTexture);
-            if (!syncPointManager->WaitOutOfOrder(syncToken, std::move(task)))
-                mailboxesToPull.append(mailboxTexture);
-        }
-        if (!mailboxesToPull.isEmpty()) {
-            auto task = base::BindOnce(&DelegatedFrameNode::pullTextures, this, std::move(mailboxesToPull));
-            gpuTaskRunner->PostTask(FROM_HERE, std::move(task));
+    QSet<MailboxFetchBatch *> waitedBatches;
+    qint64 stallTime = 0;
+    for (MailboxTexture *mailboxTexture : qAsConst(mailboxesToFetch)) {
+        MailboxFetchBatch *batch = mailboxTexture->fetchBatch();
+        Q_ASSERT(batch);
+        if (!waitedBatches.contains(batch)) {
+            stallTime += batch->waitForTextures();
+            waitedBatches.insert(batch);
         }
-
-        m_mailboxesFetchedWaitCond.wait(&m_mutex);
-        m_textureFences.swap(transferredFences);
+        batch->applyTo(mailboxTexture, mailboxTexture->fetchIndex());
     }
 
-    for (gl::TransferableFence sync : qAsConst(transferredFences)) {
-        // We need to wait on the fences on the Qt current context, and
-        // can therefore not use GLFence routines that uses a different
-        // concept of current context.
-        waitChromiumSync(&sync);
-        deleteChromiumSync(&sync);
-    }
+    const bool stalled = stallTime / 1000 > m_mailboxFetchBudget;
+    if (stalled)
+        qCDebug(lcCompositor, "Mailbox fetch stalled the scene graph for %lld us (budget: %lld us)",
+                stallTime / 1000, m_mailboxFetchBudget);
 
 #if defined(USE_OZONE) && !defined(QT_NO_OPENGL)
     // Workaround when context is not shared QTBUG-48969
-    // Make slow copy between two contexts.
+    // Import the textures through EGLImages if possible, or make slow copy between two contexts.
     if (!m_contextShared) {
         QOpenGLContext *currentContext = QOpenGLContext::currentContext() ;
         QOpenGLContext *sharedContext = qt_gl_global_share_context();
@@ -1293,10 +1734,45 @@ void DelegatedFrameNode::fetchAndSyncMailboxes(QList<MailboxTexture *> &mailboxe
         sharedContext->makeCurrent(m_offsurface.data());
         QOpenGLFunctions *funcs = sharedContext->functions();
 
+        // The textures are used from the current context right away, so their fences can't be
+        // deferred to bind(), and they have to be waited on from Chromium's share group.
+        for (MailboxFetchBatch *batch : qAsConst(waitedBatches))
+            batch->waitForFences();
+
+        QList<MailboxTexture *> mailboxesToCopy;
+        if (m_textureImageSharing) {
+            // Images are fenced one by one when they are imported, the whole pipeline only
+            // has to be drained if some of them couldn't get a fence.
+            for (MailboxFetchBatch *batch : qAsConst(waitedBatches)) {
+                if (batch->hasUnfencedTextureImages()) {
+                    funcs->glFinish();
+                    break;
+                }
+            }
+            currentContext->makeCurrent(surface);
+            funcs = currentContext->functions();
+            for (MailboxTexture *mailboxTexture : qAsConst(mailboxesToFetch)) {
+                GLuint texture = mailboxTexture->fetchBatch()->importTextureImage(mailboxTexture->fetchIndex(), funcs);
+                if (!texture) {
+                    // The batch was started before the images were requested, or the export failed.
+                    mailboxesToCopy.append(mailboxTexture);
+                    continue;
+                }
+                mailboxTexture->m_textureId = texture;
+                mailboxTexture->m_ownsTexture = true;
+            }
+            if (mailboxesToCopy.isEmpty())
+                return stalled;
+            sharedContext->makeCurrent(m_offsurface.data());
+            funcs = sharedContext->functions();
+        } else {
+            mailboxesToCopy = mailboxesToFetch;
+        }
+
         GLuint fbo = 0;
         funcs->glGenFramebuffers(1, &fbo);
 
-        for (MailboxTexture *mailboxTexture : qAsConst(mailboxesToFetch)) {
+        for (MailboxTexture *mailboxTexture : qAsConst(mailboxesToCopy)) {
             // Read texture into QImage from shared context.
             // Switch to shared context.
             sharedContext->makeCurrent(m_offsurface.data());
@@ -1336,69 +1812,27 @@ void DelegatedFrameNode::fetchAndSyncMailboxes(QList<MailboxTexture *> &mailboxe
         currentContext->makeCurrent(surface);
     }
 #endif
+    return stalled;
 #else
     Q_UNUSED(mailboxesToFetch)
+    return false;
 #endif //QT_NO_OPENGL
 }
 
 
-void DelegatedFrameNode::pullTextures(DelegatedFrameNode *frameNode, const QVector<MailboxTexture *> textures)
-{
-#ifndef QT_NO_OPENGL
-    gpu::MailboxManager *mailboxManager = mailbox_manager();
-    for (MailboxTexture *texture : textures) {
-        gpu::SyncToken &syncToken = texture->mailboxHolder().sync_token;
-        if (syncToken.HasData())
-            mailboxManager->PullTextureUpdates(syncToken);
-        texture->fetchTexture(mailboxManager);
-        --frameNode->m_numPendingSyncPoints;
-    }
-
-    fenceAndUnlockQt(frameNode);
-#else
-    Q_UNUSED(frameNode)
-    Q_UNUSED(textures)
-#endif
-}
-
-void DelegatedFrameNode::pullTexture(DelegatedFrameNode *frameNode, MailboxTexture *texture)
-{
-#ifndef QT_NO_OPENGL
-    gpu::MailboxManager *mailboxManager = mailbox_manager();
-    gpu::SyncToken &syncToken = texture->mailboxHolder().sync_token;
-    if (syncToken.HasData())
-        mailboxManager->PullTextureUpdates(syncToken);
-    texture->fetchTexture(mailboxManager);
-    --frameNode->m_numPendingSyncPoints;
-
-    fenceAndUnlockQt(frameNode);
-#else
-    Q_UNUSED(frameNode)
-    Q_UNUSED(texture)
-#endif
-}
-
-void DelegatedFrameNode::fenceAndUnlockQt(DelegatedFrameNode *frameNode)
+void DelegatedFrameNode::releaseFencedBatches()
 {
 #ifndef QT_NO_OPENGL
-    if (!!gl::GLContext::GetCurrent() && gl::GLFence::IsSupported()) {
-        // Create a fence on the Chromium GPU-thread and context
-        std::unique_ptr<gl::GLFence> fence = gl::GLFence::Create();
-        // But transfer it to something generic since we need to read it using Qt's OpenGL.
-        frameNode->m_textureFences.append(fence->Transfer());
+    QVector<QSharedPointer<MailboxFetchBatch> > stillPending;
+    for (const QSharedPointer<MailboxFetchBatch> &batch : qAsConst(m_fencedBatches)) {
+        // Don't block on batches that weren't needed, they will be picked up next time.
+        if (batch->isFetched())
+            batch->waitForFences();
+        else
+            stillPending.append(batch);
     }
-    if (frameNode->m_numPendingSyncPoints == 0)
-        base::ThreadTaskRunnerHandle::Get()->PostTask(FROM_HERE, base::Bind(&DelegatedFrameNode::unlockQt, frameNode));
-#else
-    Q_UNUSED(frameNode)
+    m_fencedBatches.swap(stillPending);
 #endif
 }
 
-void DelegatedFrameNode::unlockQt(DelegatedFrameNode *frameNode)
-{
-    QMutexLocker lock(&frameNode->m_mutex);
-    // Signal preprocess() the textures are ready
-    frameNode->m_mailboxesFetchedWaitCond.wakeOne();
-}
-
 } // namespace QtWebEngineCore
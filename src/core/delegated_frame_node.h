@@ -42,22 +42,29 @@
 
 #include "base/containers/circular_deque.h"
 #include "components/viz/common/quads/compositor_frame.h"
+#include "components/viz/common/quads/draw_quad.h"
 #include "components/viz/common/quads/render_pass.h"
+#include "components/viz/common/quads/shared_quad_state.h"
 #include "components/viz/common/resources/transferable_resource.h"
 #include "gpu/command_buffer/service/sync_point_manager.h"
 #include "ui/gl/gl_fence.h"
+#include <QAtomicInt>
 #include <QMutex>
 #include <QSGNode>
 #include <QSharedData>
 #include <QSharedPointer>
+#include <QVarLengthArray>
 #include <QWaitCondition>
 #include <QtGui/QOffscreenSurface>
 
 #include "chromium_gpu_helper.h"
+#include "frame_timing_recorder.h"
 #include "render_widget_host_view_qt_delegate.h"
 
 QT_BEGIN_NAMESPACE
+class QOpenGLFunctions;
 class QSGLayer;
+class QSGTexture;
 QT_END_NAMESPACE
 
 namespace gfx {
@@ -73,9 +80,75 @@ class DrawPolygon;
 namespace QtWebEngineCore {
 
 class DelegatedNodeTreeHandler;
+class MailboxFetchBatch;
 class MailboxTexture;
 class ResourceHolder;
 
+// Resolves the mailboxes of the resources added by a CompositorFrame into texture IDs on the
+// Chromium GPU thread.
+//
+// The fetch is started by Compositor::submitFrame on the UI thread, which lets the mailboxes
+// of frame N+1 be resolved while the Qt scene graph is still rendering frame N. The scene
+// graph thread then only blocks in waitForTextures() if the GPU thread hasn't caught up yet,
+// and only waits on the transferred fences right before one of the textures gets bound.
+class MailboxFetchBatch {
+public:
+    // exportTextureImages also exports the fetched textures as EGLImages, for the scene graph
+    // of a window whose context doesn't share with Chromium's.
+    static QSharedPointer<MailboxFetchBatch> start(const std::vector<viz::TransferableResource> &resources,
+                                                   const QHash<unsigned, QSharedPointer<ResourceHolder> > &heldResources,
+                                                   bool exportTextureImages);
+    ~MailboxFetchBatch();
+
+    int indexOf(unsigned resourceId) const;
+    bool isFetched();
+    // Returns the number of nanoseconds the calling thread was blocked.
+    qint64 waitForTextures();
+    void waitForFences();
+    void applyTo(MailboxTexture *texture, int index) const;
+#if defined(USE_OZONE)
+    // Creates a texture in the current context from the exported EGLImage, returns 0 if there is none.
+    // The current context first waits for the fence created along with the image.
+    unsigned importTextureImage(int index, QOpenGLFunctions *funcs) const;
+    // Whether an image was exported without a fence, and can only be used after a glFinish().
+    bool hasUnfencedTextureImages() const;
+#endif
+
+private:
+    struct Entry {
+        unsigned resourceId;
+        gpu::MailboxHolder mailboxHolder;
+        unsigned textureId;
+#if defined(USE_OZONE)
+        void *textureImage;
+        void *textureImageFence;
+#endif
+#ifdef Q_OS_QNX
+        EGLStreamData eglStreamData;
+#endif
+    };
+
+    MailboxFetchBatch() : m_numPendingSyncPoints(0), m_fencesWaited(false) { }
+    void fetchEntry(Entry *entry, gpu::MailboxManager *mailboxManager);
+    // Keeping those callbacks static and bound to a QSharedPointer keeps the batch
+    // alive until the GPU thread is done with it, even if the frame was dropped.
+    static void pullTexture(QSharedPointer<MailboxFetchBatch> batch, int index);
+    static void pullTextures(QSharedPointer<MailboxFetchBatch> batch, const QVector<int> indices);
+    void fenceAndUnlockQt(int numFetched);
+
+    QVector<Entry> m_entries;
+    // Index of each resource's entry, so looking up every resource of a large frame stays linear.
+    QHash<unsigned, int> m_entryIndices;
+    int m_numPendingSyncPoints;
+    bool m_fencesWaited;
+#if defined(USE_OZONE)
+    bool m_exportsTextureImages = false;
+#endif
+    QMutex m_mutex;
+    QWaitCondition m_fetchedWaitCond;
+    QList<gl::TransferableFence> m_textureFences;
+};
+
 // Separating this data allows another DelegatedFrameNode to reconstruct the QSGNode tree from the mailbox textures
 // and render pass information.
 class ChromiumCompositorData : public QSharedData {
@@ -83,18 +156,85 @@ public:
     ChromiumCompositorData() : frameDevicePixelRatio(1) { }
     QHash<unsigned, QSharedPointer<ResourceHolder> > resourceHolders;
     viz::CompositorFrame frameData;
-    viz::CompositorFrame previousFrameData;
+    QSharedPointer<MailboxFetchBatch> mailboxFetchBatch;
     qreal frameDevicePixelRatio;
+    FrameTimingRecorder frameTimings;
+    // Set by the DelegatedFrameNode of the window the frames are currently rendered in.
+    QAtomicInt exportsTextureImages;
 };
 
 class DelegatedFrameNode : public QSGTransformNode {
 public:
+    typedef FrameCommitStats CommitStats;
+
     DelegatedFrameNode();
     ~DelegatedFrameNode();
     void preprocess();
     void commit(ChromiumCompositorData *chromiumCompositorData, std::vector<viz::ReturnedResource> *resourcesToRelease, RenderWidgetHostViewQtDelegate *apiDelegate);
+    const CommitStats &lastCommitStats() const { return m_lastCommitStats; }
 
 private:
+    // What the node of a quad was last built from. An undamaged quad only leaves its reused
+    // node untouched if it is the same quad, drawn with the very same textures.
+    struct QuadIdentity {
+        viz::DrawQuad::Material material = viz::DrawQuad::INVALID;
+        gfx::Rect rect;
+        QVarLengthArray<unsigned, 4> resourceIds;
+        QVarLengthArray<const QSGTexture *, 4> textures;
+
+        bool operator==(const QuadIdentity &other) const
+        {
+            return material == other.material && rect == other.rect
+                    && resourceIds == other.resourceIds && textures == other.textures;
+        }
+    };
+    // The nodes built for a run of quads sharing the same SharedQuadState, or for the
+    // quads of a 3D sorting context. They are reused as long as the SharedQuadState and
+    // the materials of the visible quads stay the same from one frame to the next.
+    struct LayerNodes {
+        viz::SharedQuadState layerState;
+        QVector<viz::DrawQuad::Material> materials;
+        QSGNode *chainRoot = nullptr;
+        QSGNode *layerChain = nullptr;
+        QVector<QSGNode*> quadNodes;
+        // One per quad node, only kept for reusable layers.
+        QVector<QuadIdentity> quadIdentities;
+        int nodeCount = 0;
+        bool reusable = false;
+    };
+    struct RenderPassNodes {
+        int id = 0;
+        QSharedPointer<QSGLayer> layer;
+        QSharedPointer<QSGRootNode> rootNode;
+        QSGNode *chain = nullptr;
+        QVector<LayerNodes> layers;
+        gfx::Rect outputRect;
+        // Whether the layer texture has to be rendered again in the next preprocess().
+        bool needsUpdate = false;
+    };
+    struct VisibleQuad {
+        const viz::DrawQuad *quad;
+        gfx::Rect targetRect;
+    };
+
+    // Quads outside of damageRect are only checked against the nodes they were built with
+    // if skipUndamaged is set.
+    void reconcileLayer(const std::vector<VisibleQuad> &quads,
+        const gfx::Rect &damageRect,
+        bool skipUndamaged,
+        RenderPassNodes *passNodes,
+        QVector<LayerNodes> *previousLayers,
+        DelegatedNodeTreeHandler *nodeHandler,
+        QHash<unsigned, QSharedPointer<ResourceHolder> > &resourceCandidates,
+        RenderWidgetHostViewQtDelegate *apiDelegate);
+    QuadIdentity quadIdentity(const viz::DrawQuad *quad,
+        const QHash<unsigned, QSharedPointer<ResourceHolder> > &resourceCandidates) const;
+    bool holdUndamagedQuad(const viz::DrawQuad *quad,
+        QHash<unsigned, QSharedPointer<ResourceHolder> > &resourceCandidates,
+        RenderWidgetHostViewQtDelegate *apiDelegate);
+    void destroyLayerNodes(LayerNodes *layerNodes);
+    void destroyRenderPassNodes(RenderPassNodes *passNodes);
+    QSGLayer *findRenderPassLayer(int id) const;
     void flushPolygons(base::circular_deque<std::unique_ptr<viz::DrawPolygon> > *polygonQueue,
         QSGNode *renderPassChain,
         DelegatedNodeTreeHandler *nodeHandler,
@@ -119,13 +259,9 @@ private:
         DelegatedNodeTreeHandler *nodeHandler,
         QHash<unsigned, QSharedPointer<ResourceHolder> > &resourceCandidates,
         RenderWidgetHostViewQtDelegate *apiDelegate);
-    void fetchAndSyncMailboxes(QList<MailboxTexture *> &mailboxesToFetch);
-    // Making those callbacks static bypasses base::Bind's ref-counting requirement
-    // of the this pointer when the callback is a method.
-    static void pullTexture(DelegatedFrameNode *frameNode, MailboxTexture *mailbox);
-    static void pullTextures(DelegatedFrameNode *frameNode, const QVector<MailboxTexture *> mailboxes);
-    static void fenceAndUnlockQt(DelegatedFrameNode *frameNode);
-    static void unlockQt(DelegatedFrameNode *frameNode);
+    // Returns whether waiting for the GPU thread exceeded m_mailboxFetchBudget.
+    bool fetchAndSyncMailboxes(QList<MailboxTexture *> &mailboxesToFetch);
+    void releaseFencedBatches();
 
     ResourceHolder *findAndHoldResource(unsigned resourceId, QHash<unsigned, QSharedPointer<ResourceHolder> > &candidates);
     void holdResources(const viz::DrawQuad *quad, QHash<unsigned, QSharedPointer<ResourceHolder> > &candidates);
@@ -133,21 +269,24 @@ private:
     QSGTexture *initAndHoldTexture(ResourceHolder *resource, bool quadIsAllOpaque, RenderWidgetHostViewQtDelegate *apiDelegate = 0);
 
     QExplicitlySharedDataPointer<ChromiumCompositorData> m_chromiumCompositorData;
-    struct SGObjects {
-        QVector<QPair<int, QSharedPointer<QSGLayer> > > renderPassLayers;
-        QVector<QSharedPointer<QSGRootNode> > renderPassRootNodes;
-        QVector<QSharedPointer<QSGTexture> > textureStrongRefs;
-    } m_sgObjects;
-    QVector<QSGNode*> m_sceneGraphNodes;
-    int m_numPendingSyncPoints;
-    QWaitCondition m_mailboxesFetchedWaitCond;
-    QMutex m_mutex;
-    QList<gl::TransferableFence> m_textureFences;
+    QVector<RenderPassNodes> m_renderPasses;
+    QVector<QSharedPointer<QSGTexture> > m_textureStrongRefs;
+    CommitStats m_lastCommitStats;
+    // Batches committed with this node whose fences might not have been consumed by a bind yet.
+    QVector<QSharedPointer<MailboxFetchBatch> > m_committedBatches;
+    QVector<QSharedPointer<MailboxFetchBatch> > m_fencedBatches;
+    qint64 m_mailboxFetchBudget;
+    quint32 m_committedFrameToken = 0;
+    // The viewport of the last commit, the visible quads aren't comparable across a change.
+    QSize m_committedViewportSize;
+    // Whether the fetch of the committed frame still has to be recorded in the frame timings.
+    bool m_frameTimingPending = false;
 #if defined(USE_OZONE)
     bool m_contextShared;
+    // Whether textures are shared through EGLImages instead of being copied when the context isn't shared.
+    bool m_textureImageSharing = false;
     QScopedPointer<QOffscreenSurface> m_offsurface;
 #endif
-    QSize m_previousViewportSize;
 };
 
 } // namespace QtWebEngineCore
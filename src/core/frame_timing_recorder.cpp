@@ -0,0 +1,149 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "frame_timing_recorder.h"
+
+#include "qwebengineframetiming.h"
+
+#include "base/time/time.h"
+
+namespace QtWebEngineCore {
+
+// Enough for a few seconds of animation at common refresh rates.
+static const int kMaxRecordedFrames = 256;
+
+static qint64 now()
+{
+    return (base::TimeTicks::Now() - base::TimeTicks()).InMicroseconds();
+}
+
+FrameTimingRecorder::FrameTimingRecorder()
+{
+    m_frames.reserve(kMaxRecordedFrames);
+}
+
+FrameTimingRecord *FrameTimingRecorder::find(quint32 frameToken)
+{
+    // Stages are recorded for recent frames, search from the newest one.
+    for (int i = 1; i <= m_frames.size(); ++i) {
+        FrameTimingRecord &record = m_frames[(m_next - i + m_frames.size()) % m_frames.size()];
+        if (record.frameToken == frameToken)
+            return &record;
+    }
+    return nullptr;
+}
+
+void FrameTimingRecorder::frameSubmitted(quint32 frameToken)
+{
+    FrameTimingRecord record;
+    record.frameToken = frameToken;
+    record.submitTime = now();
+
+    QMutexLocker locker(&m_mutex);
+    if (m_frames.size() < kMaxRecordedFrames)
+        m_frames.append(record);
+    else
+        m_frames[m_next] = record;
+    m_next = (m_next + 1) % kMaxRecordedFrames;
+}
+
+void FrameTimingRecorder::commitStarted(quint32 frameToken)
+{
+    const qint64 time = now();
+    QMutexLocker locker(&m_mutex);
+    if (FrameTimingRecord *record = find(frameToken))
+        record->commitStartTime = time;
+}
+
+void FrameTimingRecorder::commitFinished(quint32 frameToken, const FrameCommitStats &stats)
+{
+    const qint64 time = now();
+    QMutexLocker locker(&m_mutex);
+    if (FrameTimingRecord *record = find(frameToken)) {
+        record->commitEndTime = time;
+        record->commitStats = stats;
+    }
+}
+
+void FrameTimingRecorder::mailboxesFetched(quint32 frameToken, bool stalled)
+{
+    const qint64 time = now();
+    QMutexLocker locker(&m_mutex);
+    FrameTimingRecord *record = find(frameToken);
+    if (!record || record->mailboxFetchTime != -1)
+        return;
+    record->mailboxFetchTime = time;
+    record->stalled = stalled;
+    if (stalled)
+        ++m_stalledFrames;
+}
+
+void FrameTimingRecorder::framesSwapped(const QVector<quint32> &frameTokens)
+{
+    const qint64 time = now();
+    QMutexLocker locker(&m_mutex);
+    for (int i = 0; i < frameTokens.size(); ++i) {
+        FrameTimingRecord *record = find(frameTokens.at(i));
+        if (!record)
+            continue;
+        if (i == frameTokens.size() - 1) {
+            record->swapTime = time;
+        } else {
+            record->dropped = true;
+            ++m_droppedFrames;
+        }
+    }
+}
+
+QWebEngineFrameTimingReport FrameTimingRecorder::report() const
+{
+    QSharedPointer<FrameTimingReportData> data(new FrameTimingReportData);
+    QMutexLocker locker(&m_mutex);
+    data->frames.reserve(m_frames.size());
+    // Oldest first.
+    const int first = m_frames.size() < kMaxRecordedFrames ? 0 : m_next;
+    for (int i = 0; i < m_frames.size(); ++i)
+        data->frames.append(m_frames.at((first + i) % m_frames.size()));
+    data->droppedFrames = m_droppedFrames;
+    data->stalledFrames = m_stalledFrames;
+    return QWebEngineFrameTimingReport(data);
+}
+
+} // namespace QtWebEngineCore
@@ -0,0 +1,112 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef FRAME_TIMING_RECORDER_H
+#define FRAME_TIMING_RECORDER_H
+
+#include <QtCore/qmutex.h>
+#include <QtCore/qvector.h>
+
+QT_BEGIN_NAMESPACE
+class QWebEngineFrameTimingReport;
+QT_END_NAMESPACE
+
+namespace QtWebEngineCore {
+
+// Number of scene graph nodes a commit could keep, had to create and deleted.
+// Skipped nodes are reused nodes left untouched since they are outside of the damage.
+struct FrameCommitStats {
+    int reusedNodes = 0;
+    int createdNodes = 0;
+    int destroyedNodes = 0;
+    int skippedNodes = 0;
+};
+
+// Timestamps are in microseconds of the monotonic clock used by Chromium,
+// or -1 if the frame didn't reach that stage.
+struct FrameTimingRecord {
+    quint32 frameToken = 0;
+    qint64 submitTime = -1;
+    qint64 commitStartTime = -1;
+    qint64 commitEndTime = -1;
+    qint64 mailboxFetchTime = -1;
+    qint64 swapTime = -1;
+    // Replaced by a newer frame before it could be swapped.
+    bool dropped = false;
+    // The scene graph waited longer than its budget for the mailboxes of the frame.
+    bool stalled = false;
+    FrameCommitStats commitStats;
+};
+
+struct FrameTimingReportData {
+    QVector<FrameTimingRecord> frames;
+    int droppedFrames = 0;
+    int stalledFrames = 0;
+};
+
+// Keeps the timings of the last compositor frames of a view, from their submission by the
+// renderer until the swap that presented them. Stages are recorded from the UI thread and
+// from the scene graph render thread.
+class FrameTimingRecorder {
+public:
+    FrameTimingRecorder();
+
+    void frameSubmitted(quint32 frameToken);
+    void commitStarted(quint32 frameToken);
+    void commitFinished(quint32 frameToken, const FrameCommitStats &stats);
+    void mailboxesFetched(quint32 frameToken, bool stalled);
+    // The last token was presented by the swap, the previous ones were dropped.
+    void framesSwapped(const QVector<quint32> &frameTokens);
+
+    QWebEngineFrameTimingReport report() const;
+
+private:
+    FrameTimingRecord *find(quint32 frameToken);
+
+    mutable QMutex m_mutex;
+    QVector<FrameTimingRecord> m_frames;
+    int m_next = 0;
+    int m_droppedFrames = 0;
+    int m_stalledFrames = 0;
+};
+
+} // namespace QtWebEngineCore
+
+#endif // FRAME_TIMING_RECORDER_H
@@ -41,13 +41,17 @@
 
 #include "base/bind.h"
 #include "base/memory/ptr_util.h"
+#include "base/strings/string_piece.h"
 #include "content/public/browser/browser_thread.h"
 #include "net/cookies/cookie_util.h"
 
 #include "api/qwebenginecookiestore.h"
 #include "api/qwebenginecookiestore_p.h"
+#include "cookie_policy_qt.h"
 #include "type_conversion.h"
 
+#include <QUrl>
+
 namespace QtWebEngineCore {
 
 static GURL sourceUrlForCookie(const QNetworkCookie &cookie) {
@@ -55,9 +59,19 @@ static GURL sourceUrlForCookie(const QNetworkCookie &cookie) {
     return net::cookie_util::CookieOriginToURL(urlFragment.toStdString(), /* is_https */ cookie.isSecure());
 }
 
+// Number of cookies passed to the UI thread per task by loadCookies().
+static const int kLoadedCookiesChunkSize = 1000;
+
+static QByteArray cookieIdentifier(const QNetworkCookie &cookie)
+{
+    return cookie.name() + '\n' + cookie.domain().toUtf8() + '\n' + cookie.path().toUtf8();
+}
+
 CookieMonsterDelegateQt::CookieMonsterDelegateQt()
     : m_client(0)
     , m_cookieMonster(nullptr)
+    , m_changesFlushPending(false)
+    , m_storagePolicy(new CookieStoragePolicyQt)
 {
 }
 
@@ -82,10 +96,11 @@ bool CookieMonsterDelegateQt::hasCookieMonster()
     return m_cookieMonster;
 }
 
-void CookieMonsterDelegateQt::getAllCookies(quint64 callbackId)
+void CookieMonsterDelegateQt::getAllCookies()
 {
-    net::CookieMonster::GetCookieListCallback callback =
-        base::BindOnce(&CookieMonsterDelegateQt::GetAllCookiesCallbackOnIOThread, this, callbackId);
+    // The cookies reach the client as change notifications while the store is loaded, so the
+    // list itself is not needed.
+    net::CookieMonster::GetCookieListCallback callback = base::BindOnce([](const net::CookieList &) {});
 
     content::BrowserThread::PostTask(content::BrowserThread::IO, FROM_HERE,
                                      base::BindOnce(&CookieMonsterDelegateQt::GetAllCookiesOnIOThread, this, std::move(callback)));
@@ -124,6 +139,35 @@ void CookieMonsterDelegateQt::SetCookieOnIOThread(
         m_cookieMonster->SetCookieWithOptionsAsync(url, cookie_line, options, std::move(callback));
 }
 
+void CookieMonsterDelegateQt::setCookies(const QList<QNetworkCookie> &cookies, const QUrl &origin)
+{
+    Q_ASSERT(hasCookieMonster());
+    Q_ASSERT(m_client);
+
+    std::vector<std::pair<GURL, std::string>> cookieLines;
+    cookieLines.reserve(cookies.size());
+    const GURL originUrl = toGurl(origin);
+    for (const QNetworkCookie &cookie : cookies)
+        cookieLines.emplace_back(origin.isEmpty() ? sourceUrlForCookie(cookie) : originUrl,
+                                 cookie.toRawForm().toStdString());
+
+    content::BrowserThread::PostTask(content::BrowserThread::IO, FROM_HERE,
+                                     base::BindOnce(&CookieMonsterDelegateQt::SetCookiesOnIOThread, this,
+                                                    std::move(cookieLines)));
+}
+
+void CookieMonsterDelegateQt::SetCookiesOnIOThread(const std::vector<std::pair<GURL, std::string>> &cookies)
+{
+    if (!m_cookieMonster)
+        return;
+
+    net::CookieOptions options;
+    options.set_include_httponly();
+
+    for (const auto &cookie : cookies)
+        m_cookieMonster->SetCookieWithOptionsAsync(cookie.first, cookie.second, options, net::CookieStore::SetCookiesCallback());
+}
+
 void CookieMonsterDelegateQt::deleteCookie(const QNetworkCookie &cookie, const QUrl &origin)
 {
     Q_ASSERT(hasCookieMonster());
@@ -142,6 +186,72 @@ void CookieMonsterDelegateQt::DeleteCookieOnIOThread(const GURL& url, const std:
         m_cookieMonster->DeleteCookieAsync(url, cookie_name, base::Closure());
 }
 
+void CookieMonsterDelegateQt::deleteCookies(const std::function<bool(const QNetworkCookie &)> &filter)
+{
+    Q_ASSERT(hasCookieMonster());
+    Q_ASSERT(m_client);
+
+    net::CookieMonster::GetCookieListCallback callback =
+        base::BindOnce(&CookieMonsterDelegateQt::DeleteMatchingCookiesOnIOThread, this, filter);
+    content::BrowserThread::PostTask(content::BrowserThread::IO, FROM_HERE,
+                                     base::BindOnce(&CookieMonsterDelegateQt::GetAllCookiesOnIOThread, this, std::move(callback)));
+}
+
+void CookieMonsterDelegateQt::DeleteMatchingCookiesOnIOThread(const std::function<bool(const QNetworkCookie &)> &filter,
+                                                              const net::CookieList &cookies)
+{
+    if (!m_cookieMonster)
+        return;
+
+    for (const net::CanonicalCookie &cookie : cookies) {
+        if (filter(toQt(cookie)))
+            m_cookieMonster->DeleteCanonicalCookieAsync(cookie, net::CookieMonster::DeleteCallback());
+    }
+}
+
+void CookieMonsterDelegateQt::loadCookies(const QString &domain)
+{
+    Q_ASSERT(hasCookieMonster());
+    Q_ASSERT(m_client);
+
+    QByteArray asciiDomain = QUrl::toAce(domain.toLower());
+    if (asciiDomain.startsWith('.'))
+        asciiDomain.remove(0, 1);
+
+    net::CookieMonster::GetCookieListCallback callback =
+        base::BindOnce(&CookieMonsterDelegateQt::LoadCookiesCallbackOnIOThread, this, domain, asciiDomain.toStdString());
+    content::BrowserThread::PostTask(content::BrowserThread::IO, FROM_HERE,
+                                     base::BindOnce(&CookieMonsterDelegateQt::GetAllCookiesOnIOThread, this, std::move(callback)));
+}
+
+void CookieMonsterDelegateQt::LoadCookiesCallbackOnIOThread(const QString &domain, const std::string &asciiDomain,
+                                                            const net::CookieList &cookies)
+{
+    QList<QNetworkCookie> chunk;
+    for (const net::CanonicalCookie &cookie : cookies) {
+        if (!asciiDomain.empty()) {
+            base::StringPiece cookieDomain(cookie.Domain());
+            if (cookieDomain.starts_with("."))
+                cookieDomain.remove_prefix(1);
+            if (cookieDomain != asciiDomain
+                    && !(cookieDomain.ends_with(asciiDomain)
+                         && cookieDomain[cookieDomain.size() - asciiDomain.size() - 1] == '.'))
+                continue;
+        }
+        chunk.append(toQt(cookie));
+        if (chunk.size() == kLoadedCookiesChunkSize) {
+            content::BrowserThread::PostTask(
+                content::BrowserThread::UI, FROM_HERE,
+                base::BindOnce(&CookieMonsterDelegateQt::LoadCookiesCallbackOnUIThread, this, domain, chunk, false));
+            chunk.clear();
+        }
+    }
+
+    content::BrowserThread::PostTask(
+        content::BrowserThread::UI, FROM_HERE,
+        base::BindOnce(&CookieMonsterDelegateQt::LoadCookiesCallbackOnUIThread, this, domain, chunk, true));
+}
+
 void CookieMonsterDelegateQt::deleteSessionCookies(quint64 callbackId)
 {
     Q_ASSERT(hasCookieMonster());
@@ -204,12 +314,13 @@ void CookieMonsterDelegateQt::setClient(QWebEngineCookieStore *client)
         return;
 
     m_client->d_func()->delegate = this;
+    m_storagePolicy->setCookiePolicy(m_client->d_func()->cookiePolicy());
 
     if (hasCookieMonster())
         m_client->d_func()->processPendingUserCookies();
 }
 
-bool CookieMonsterDelegateQt::canSetCookie(const QUrl &firstPartyUrl, const QByteArray &/*cookieLine*/, const QUrl &url) const
+bool CookieMonsterDelegateQt::canSetCookie(const GURL &firstPartyUrl, const std::string &/*cookieLine*/, const GURL &url) const
 {
     if (!m_client)
         return true;
@@ -217,7 +328,7 @@ bool CookieMonsterDelegateQt::canSetCookie(const QUrl &firstPartyUrl, const QByt
     return m_client->d_func()->canAccessCookies(firstPartyUrl, url);
 }
 
-bool CookieMonsterDelegateQt::canGetCookies(const QUrl &firstPartyUrl, const QUrl &url) const
+bool CookieMonsterDelegateQt::canGetCookies(const GURL &firstPartyUrl, const GURL &url) const
 {
     if (!m_client)
         return true;
@@ -225,23 +336,60 @@ bool CookieMonsterDelegateQt::canGetCookies(const QUrl &firstPartyUrl, const QUr
     return m_client->d_func()->canAccessCookies(firstPartyUrl, url);
 }
 
+void CookieMonsterDelegateQt::setCookiePolicy(QSharedPointer<const CookiePolicyQt> policy)
+{
+    m_storagePolicy->setCookiePolicy(std::move(policy));
+}
+
 void CookieMonsterDelegateQt::OnCookieChanged(const net::CanonicalCookie& cookie, net::CookieChangeCause cause)
 {
     if (!m_client)
         return;
-    m_client->d_func()->onCookieChanged(toQt(cookie), cause != net::CookieChangeCause::INSERTED);
-}
 
-void CookieMonsterDelegateQt::GetAllCookiesCallbackOnIOThread(qint64 callbackId, const net::CookieList &cookies)
-{
-    QByteArray rawCookies;
-    for (auto &&cookie : cookies)
-        rawCookies += toQt(cookie).toRawForm() % QByteArrayLiteral("\n");
+    QWebEngineCookieStorePrivate *client = m_client->d_func();
+    const bool notifyEach = client->hasCookieChangedReceivers();
+    const bool notifyBatched = client->hasCookiesChangedReceivers();
+    if (!notifyEach && !notifyBatched)
+        return;
+
+    const QNetworkCookie changedCookie = toQt(cookie);
+    const bool removed = cause != net::CookieChangeCause::INSERTED;
+    if (notifyEach)
+        client->onCookieChanged(changedCookie, removed);
+    if (!notifyBatched)
+        return;
 
+    QMutexLocker lock(&m_changesMutex);
+    if (removed) {
+        // A cookie added and removed again before delivery only needs to be reported as removed.
+        m_addedCookies.remove(cookieIdentifier(changedCookie));
+        m_removedCookies.append(changedCookie);
+    } else {
+        m_addedCookies.insert(cookieIdentifier(changedCookie), changedCookie);
+    }
+    if (m_changesFlushPending)
+        return;
+    m_changesFlushPending = true;
     content::BrowserThread::PostTask(
         content::BrowserThread::UI,
         FROM_HERE,
-        base::BindOnce(&CookieMonsterDelegateQt::GetAllCookiesCallbackOnUIThread, this, callbackId, rawCookies));
+        base::BindOnce(&CookieMonsterDelegateQt::FlushCookieChangesOnUIThread, this));
+}
+
+void CookieMonsterDelegateQt::FlushCookieChangesOnUIThread()
+{
+    QList<QNetworkCookie> added;
+    QList<QNetworkCookie> removed;
+    {
+        QMutexLocker lock(&m_changesMutex);
+        added = m_addedCookies.values();
+        removed.swap(m_removedCookies);
+        m_addedCookies.clear();
+        m_changesFlushPending = false;
+    }
+
+    if (m_client)
+        m_client->d_func()->onCookiesChanged(added, removed);
 }
 
 void CookieMonsterDelegateQt::SetCookieCallbackOnIOThread(qint64 callbackId, bool success)
@@ -260,10 +408,10 @@ void CookieMonsterDelegateQt::DeleteCookiesCallbackOnIOThread(qint64 callbackId,
         base::BindOnce(&CookieMonsterDelegateQt::DeleteCookiesCallbackOnUIThread, this, callbackId, numCookies));
 }
 
-void CookieMonsterDelegateQt::GetAllCookiesCallbackOnUIThread(qint64 callbackId, const QByteArray &cookies)
+void CookieMonsterDelegateQt::LoadCookiesCallbackOnUIThread(const QString &domain, const QList<QNetworkCookie> &cookies, bool finished)
 {
     if (m_client)
-        m_client->d_func()->onGetAllCallbackResult(callbackId, cookies);
+        m_client->d_func()->onCookiesLoaded(domain, cookies, finished);
 }
 
 void CookieMonsterDelegateQt::SetCookieCallbackOnUIThread(qint64 callbackId, bool success)
@@ -277,4 +425,51 @@ void CookieMonsterDelegateQt::DeleteCookiesCallbackOnUIThread(qint64 callbackId,
     if (m_client)
         m_client->d_func()->onDeleteCallbackResult(callbackId, numCookies);
 }
+
+CookieStoragePolicyQt::CookieStoragePolicyQt()
+{
+}
+
+CookieStoragePolicyQt::~CookieStoragePolicyQt()
+{
+}
+
+void CookieStoragePolicyQt::setCookiePolicy(QSharedPointer<const CookiePolicyQt> policy)
+{
+    QMutexLocker lock(&m_cookiePolicyMutex);
+    m_cookiePolicy = std::move(policy);
+}
+
+bool CookieStoragePolicyQt::IsStorageProtected(const GURL &)
+{
+    return false;
+}
+
+bool CookieStoragePolicyQt::IsStorageUnlimited(const GURL &)
+{
+    return false;
+}
+
+bool CookieStoragePolicyQt::IsStorageDurable(const GURL &)
+{
+    return false;
+}
+
+bool CookieStoragePolicyQt::IsStorageSessionOnly(const GURL &origin)
+{
+    QMutexLocker lock(&m_cookiePolicyMutex);
+    return m_cookiePolicy && m_cookiePolicy->isSessionOnly(origin);
+}
+
+bool CookieStoragePolicyQt::HasIsolatedStorage(const GURL &)
+{
+    return false;
+}
+
+bool CookieStoragePolicyQt::HasSessionOnlyOrigins()
+{
+    QMutexLocker lock(&m_cookiePolicyMutex);
+    return m_cookiePolicy && m_cookiePolicy->hasSessionOnlyRules();
+}
+
 }
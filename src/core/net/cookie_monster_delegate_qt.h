@@ -59,15 +59,24 @@ QT_WARNING_PUSH
 QT_WARNING_DISABLE_CLANG("-Wunused-parameter")
 #include "base/memory/ref_counted.h"
 #include "net/cookies/cookie_monster.h"
+#include "storage/browser/quota/special_storage_policy.h"
 QT_WARNING_POP
 
+#include <QHash>
+#include <QMutex>
 #include <QNetworkCookie>
 #include <QPointer>
+#include <QSharedPointer>
+
+#include <functional>
 
 QT_FORWARD_DECLARE_CLASS(QWebEngineCookieStore)
 
 namespace QtWebEngineCore {
 
+class CookiePolicyQt;
+class CookieStoragePolicyQt;
+
 // Extends net::CookieMonster::kDefaultCookieableSchemes with qrc, without enabling
 // cookies for the file:// scheme, which is disabled by default in Chromium.
 // Since qrc:// is similar to file:// and there are some unknowns about how
@@ -79,6 +88,14 @@ class QWEBENGINECORE_PRIVATE_EXPORT CookieMonsterDelegateQt : public base::RefCo
     QPointer<QWebEngineCookieStore> m_client;
     net::CookieMonster *m_cookieMonster;
     std::vector<std::unique_ptr<net::CookieChangeSubscription>> m_subscriptions;
+
+    // Changes collected on the IO thread until the UI thread delivers them in one signal.
+    QMutex m_changesMutex;
+    QHash<QByteArray, QNetworkCookie> m_addedCookies;
+    QList<QNetworkCookie> m_removedCookies;
+    bool m_changesFlushPending;
+
+    scoped_refptr<CookieStoragePolicyQt> m_storagePolicy;
 public:
     CookieMonsterDelegateQt();
     ~CookieMonsterDelegateQt();
@@ -86,16 +103,23 @@ public:
     bool hasCookieMonster();
 
     void setCookie(quint64 callbackId, const QNetworkCookie &cookie, const QUrl &origin);
+    void setCookies(const QList<QNetworkCookie> &cookies, const QUrl &origin);
     void deleteCookie(const QNetworkCookie &cookie, const QUrl &origin);
-    void getAllCookies(quint64 callbackId);
+    void deleteCookies(const std::function<bool(const QNetworkCookie &)> &filter);
+    void getAllCookies();
+    void loadCookies(const QString &domain);
     void deleteSessionCookies(quint64 callbackId);
     void deleteAllCookies(quint64 callbackId);
 
     void setCookieMonster(net::CookieMonster* monster);
     void setClient(QWebEngineCookieStore *client);
 
-    bool canSetCookie(const QUrl &firstPartyUrl, const QByteArray &cookieLine, const QUrl &url) const;
-    bool canGetCookies(const QUrl &firstPartyUrl, const QUrl &url) const;
+    bool canSetCookie(const GURL &firstPartyUrl, const std::string &cookieLine, const GURL &url) const;
+    bool canGetCookies(const GURL &firstPartyUrl, const GURL &url) const;
+
+    // Called on the UI thread whenever the client compiles a new policy.
+    void setCookiePolicy(QSharedPointer<const CookiePolicyQt> policy);
+    CookieStoragePolicyQt *storagePolicy() const { return m_storagePolicy.get(); }
 
     void AddStore(net::CookieStore *store);
     void OnCookieChanged(const net::CanonicalCookie &cookie, net::CookieChangeCause cause);
@@ -103,19 +127,45 @@ public:
 private:
     void GetAllCookiesOnIOThread(net::CookieMonster::GetCookieListCallback callback);
     void SetCookieOnIOThread(const GURL& url, const std::string& cookie_line, net::CookieMonster::SetCookiesCallback callback);
+    void SetCookiesOnIOThread(const std::vector<std::pair<GURL, std::string>> &cookies);
     void DeleteCookieOnIOThread(const GURL& url, const std::string& cookie_name);
+    void DeleteMatchingCookiesOnIOThread(const std::function<bool(const QNetworkCookie &)> &filter, const net::CookieList &cookies);
     void DeleteSessionCookiesOnIOThread(net::CookieMonster::DeleteCallback callback);
     void DeleteAllOnIOThread(net::CookieMonster::DeleteCallback callback);
 
-    void GetAllCookiesCallbackOnIOThread(qint64 callbackId, const net::CookieList &cookies);
+    void LoadCookiesCallbackOnIOThread(const QString &domain, const std::string &asciiDomain, const net::CookieList &cookies);
     void SetCookieCallbackOnIOThread(qint64 callbackId, bool success);
     void DeleteCookiesCallbackOnIOThread(qint64 callbackId, uint numCookies);
 
-    void GetAllCookiesCallbackOnUIThread(qint64 callbackId, const QByteArray &cookies);
+    void LoadCookiesCallbackOnUIThread(const QString &domain, const QList<QNetworkCookie> &cookies, bool finished);
+    void FlushCookieChangesOnUIThread();
     void SetCookieCallbackOnUIThread(qint64 callbackId, bool success);
     void DeleteCookiesCallbackOnUIThread(qint64 callbackId, uint numCookies);
 };
 
+// Lets the persistent cookie store drop the cookies of session-only sites when it is closed.
+// It keeps its own copy of the policy, because the store is closed on the IO thread after
+// the QWebEngineCookieStore that compiled it is gone.
+class CookieStoragePolicyQt : public storage::SpecialStoragePolicy {
+public:
+    CookieStoragePolicyQt();
+
+    void setCookiePolicy(QSharedPointer<const CookiePolicyQt> policy);
+
+    bool IsStorageProtected(const GURL &origin) override;
+    bool IsStorageUnlimited(const GURL &origin) override;
+    bool IsStorageDurable(const GURL &origin) override;
+    bool IsStorageSessionOnly(const GURL &origin) override;
+    bool HasIsolatedStorage(const GURL &origin) override;
+    bool HasSessionOnlyOrigins() override;
+
+private:
+    ~CookieStoragePolicyQt() override;
+
+    QMutex m_cookiePolicyMutex;
+    QSharedPointer<const CookiePolicyQt> m_cookiePolicy;
+};
+
 }
 
 #endif // COOKIE_MONSTER_DELEGATE_QT_H
@@ -0,0 +1,122 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "cookie_policy_qt.h"
+
+#include "net/base/registry_controlled_domains/registry_controlled_domain.h"
+#include "url/gurl.h"
+
+#include <QtCore/QUrl>
+
+#include <algorithm>
+
+namespace QtWebEngineCore {
+
+CookiePolicyQt::CookiePolicyQt(Access defaultAccess, Access thirdPartyAccess, const QHash<QString, Access> &domainAccess)
+    : m_defaultAccess(defaultAccess)
+    , m_thirdPartyAccess(thirdPartyAccess)
+    , m_hasSessionOnlyRules(defaultAccess == SessionOnly)
+{
+    m_domainAccess.reserve(domainAccess.size());
+    for (auto it = domainAccess.cbegin(); it != domainAccess.cend(); ++it) {
+        QByteArray domain = QUrl::toAce(it.key().toLower());
+        if (domain.startsWith('.'))
+            domain.remove(0, 1);
+        if (domain.isEmpty())
+            continue;
+        m_domainAccess[domain.toStdString()] = it.value();
+        if (it.value() == SessionOnly)
+            m_hasSessionOnlyRules = true;
+    }
+}
+
+std::string CookiePolicyQt::siteForUrl(const GURL &url)
+{
+    std::string site = net::registry_controlled_domains::GetDomainAndRegistry(
+                url, net::registry_controlled_domains::INCLUDE_PRIVATE_REGISTRIES);
+    if (site.empty())
+        return url.host();
+    return site;
+}
+
+bool CookiePolicyQt::lookupDomain(base::StringPiece host, Access *access) const
+{
+    if (m_domainAccess.empty() || host.empty())
+        return false;
+    if (host.back() == '.')
+        host.remove_suffix(1);
+
+    // Try the host itself and then each parent domain.
+    std::string suffix;
+    for (size_t begin = 0; begin < host.size(); ) {
+        host.substr(begin).CopyToString(&suffix);
+        auto it = m_domainAccess.find(suffix);
+        if (it != m_domainAccess.end()) {
+            *access = it->second;
+            return true;
+        }
+        size_t dot = host.find('.', begin);
+        if (dot == base::StringPiece::npos)
+            break;
+        begin = dot + 1;
+    }
+    return false;
+}
+
+CookiePolicyQt::Access CookiePolicyQt::evaluate(const GURL &url, bool thirdParty) const
+{
+    Access access;
+    if (lookupDomain(url.host_piece(), &access))
+        return access;
+    if (thirdParty)
+        return std::max(m_defaultAccess, m_thirdPartyAccess);
+    return m_defaultAccess;
+}
+
+bool CookiePolicyQt::isSessionOnly(const GURL &url) const
+{
+    if (!m_hasSessionOnlyRules)
+        return false;
+    Access access;
+    if (lookupDomain(url.host_piece(), &access))
+        return access == SessionOnly;
+    return m_defaultAccess == SessionOnly;
+}
+
+} // namespace QtWebEngineCore
@@ -0,0 +1,94 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef COOKIE_POLICY_QT_H
+#define COOKIE_POLICY_QT_H
+
+#include "base/strings/string_piece.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QString>
+
+#include <string>
+#include <unordered_map>
+
+class GURL;
+
+namespace QtWebEngineCore {
+
+// A compiled cookie policy, evaluated on the IO thread for every cookie access.
+//
+// Domain rules apply to the domain and all of its subdomains. They are stored in ASCII form in
+// a hash keyed by domain, so a lookup walks the labels of the request host from the most to
+// the least specific suffix without converting anything to Qt types. A compiled policy is
+// immutable and may be used concurrently.
+class CookiePolicyQt {
+public:
+    // Ordered from the least to the most restrictive.
+    enum Access {
+        Allow,
+        SessionOnly,
+        Block
+    };
+
+    CookiePolicyQt(Access defaultAccess, Access thirdPartyAccess, const QHash<QString, Access> &domainAccess);
+
+    // Returns the site cookies of |url| belong to: its registrable domain, or its host when it
+    // has none.
+    static std::string siteForUrl(const GURL &url);
+
+    // A domain rule matching the host of |url| wins, otherwise the default applies, restricted
+    // further by the third-party rule for |thirdParty| accesses.
+    Access evaluate(const GURL &url, bool thirdParty) const;
+    bool isSessionOnly(const GURL &url) const;
+    bool hasSessionOnlyRules() const { return m_hasSessionOnlyRules; }
+    bool isTrivial() const { return m_domainAccess.empty() && m_defaultAccess == Allow && m_thirdPartyAccess == Allow; }
+
+private:
+    bool lookupDomain(base::StringPiece host, Access *access) const;
+
+    std::unordered_map<std::string, Access> m_domainAccess;
+    Access m_defaultAccess;
+    Access m_thirdPartyAccess;
+    bool m_hasSessionOnlyRules;
+};
+
+} // namespace QtWebEngineCore
+
+#endif // COOKIE_POLICY_QT_H
@@ -46,8 +46,10 @@
 
 namespace QtWebEngineCore {
 
-CustomProtocolHandler::CustomProtocolHandler(QPointer<ProfileAdapter> profileAdapter)
+CustomProtocolHandler::CustomProtocolHandler(QPointer<ProfileAdapter> profileAdapter,
+                                             QSharedPointer<ConcurrentUrlSchemeHandlers> concurrentHandlers)
     : m_profileAdapter(profileAdapter)
+    , m_concurrentHandlers(std::move(concurrentHandlers))
 {
 }
 
@@ -56,7 +58,7 @@ net::URLRequestJob *CustomProtocolHandler::MaybeCreateJob(net::URLRequest *reque
     if (!networkDelegate)
         return new net::URLRequestErrorJob(request, Q_NULLPTR, net::ERR_ACCESS_DENIED);
 
-    return new URLRequestCustomJob(request, networkDelegate, request->url().scheme(), m_profileAdapter);
+    return new URLRequestCustomJob(request, networkDelegate, request->url().scheme(), m_profileAdapter, m_concurrentHandlers);
 }
 
 } // namespace
@@ -55,10 +55,16 @@
 #include "net/url_request/url_request_job_factory.h"
 
 #include <QtCore/QByteArray>
+#include <QtCore/QHash>
 #include <QtCore/QObject>
 #include <QtCore/QPointer>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QSharedPointer>
+
+#include <memory>
 
 QT_FORWARD_DECLARE_CLASS(QIODevice)
+QT_FORWARD_DECLARE_CLASS(QWebEngineUrlSchemeHandler)
 
 namespace net {
 class NetworkDelegate;
@@ -69,18 +75,44 @@ namespace QtWebEngineCore {
 
 class ProfileAdapter;
 
+// A QWebEngineConcurrentUrlSchemeHandler installed in a profile. It is called on the worker
+// threads with its lock held for reading, so that removing it only waits for its own calls.
+struct ConcurrentUrlSchemeHandler {
+    explicit ConcurrentUrlSchemeHandler(QWebEngineUrlSchemeHandler *handler) : handler(handler) { }
+
+    QWebEngineUrlSchemeHandler *const handler;
+    QReadWriteLock lock;
+    // Set with the lock held for writing once the handler was removed, it is never called again.
+    bool removed = false;
+};
+
+// The QWebEngineConcurrentUrlSchemeHandlers of a profile. The map is immutable, it is replaced
+// as a whole on the UI thread and read without locking on the IO and worker threads.
+class ConcurrentUrlSchemeHandlers {
+public:
+    typedef QHash<QByteArray, QSharedPointer<ConcurrentUrlSchemeHandler> > Map;
+
+    std::shared_ptr<const Map> handlers() const { return std::atomic_load(&m_handlers); }
+    void setHandlers(std::shared_ptr<const Map> handlers) { std::atomic_store(&m_handlers, std::move(handlers)); }
+
+private:
+    std::shared_ptr<const Map> m_handlers = std::make_shared<const Map>();
+};
+
 // Implements a ProtocolHandler for custom URL schemes.
 // If |network_delegate_| is NULL then all file requests will fail with ERR_ACCESS_DENIED.
 class QWEBENGINECORE_PRIVATE_EXPORT CustomProtocolHandler : public net::URLRequestJobFactory::ProtocolHandler {
 
 public:
-    CustomProtocolHandler(QPointer<ProfileAdapter> profileAdapter);
+    CustomProtocolHandler(QPointer<ProfileAdapter> profileAdapter,
+                          QSharedPointer<ConcurrentUrlSchemeHandlers> concurrentHandlers);
 
     net::URLRequestJob *MaybeCreateJob(net::URLRequest *request, net::NetworkDelegate *networkDelegate) const override;
 
 private:
     DISALLOW_COPY_AND_ASSIGN(CustomProtocolHandler);
     QPointer<ProfileAdapter> m_profileAdapter;
+    QSharedPointer<ConcurrentUrlSchemeHandlers> m_concurrentHandlers;
 };
 
 } // namespace
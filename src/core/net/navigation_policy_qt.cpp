@@ -0,0 +1,117 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "navigation_policy_qt.h"
+
+#include "base/strings/string_piece.h"
+#include "url/gurl.h"
+
+namespace QtWebEngineCore {
+
+namespace {
+const quint32 kNoRule = 0xffffffff;
+}
+
+NavigationPolicyQt::NavigationPolicyQt(std::vector<Rule> rules)
+    : m_rules(std::move(rules))
+{
+    for (quint32 i = 0; i < m_rules.size(); ++i) {
+        const Rule &rule = m_rules[i];
+        if (rule.host.empty())
+            m_anyHostRules.push_back(i);
+        else if (rule.includeSubdomains)
+            m_domainRules[rule.host].push_back(i);
+        else
+            m_hostRules[rule.host].push_back(i);
+    }
+}
+
+quint32 NavigationPolicyQt::firstMatch(const std::vector<quint32> &candidates, quint32 limit, const GURL &url,
+                                       quint32 navigationTypeBit, bool isMainFrame) const
+{
+    for (quint32 index : candidates) {
+        if (index >= limit)
+            break;
+        const Rule &rule = m_rules[index];
+        if (!(rule.navigationTypes & navigationTypeBit))
+            continue;
+        if (!(isMainFrame ? rule.mainFrame : rule.subFrame))
+            continue;
+        if (!rule.scheme.empty() && !url.SchemeIs(rule.scheme))
+            continue;
+        return index;
+    }
+    return limit;
+}
+
+NavigationPolicyQt::Action NavigationPolicyQt::evaluate(const GURL &url, int navigationType, bool isMainFrame) const
+{
+    if (m_rules.empty() || navigationType < 0 || navigationType >= 32)
+        return NoMatch;
+
+    const quint32 navigationTypeBit = 1u << navigationType;
+    quint32 best = firstMatch(m_anyHostRules, kNoRule, url, navigationTypeBit, isMainFrame);
+
+    base::StringPiece host = url.host_piece();
+    if (!host.empty() && host.back() == '.')
+        host.remove_suffix(1);
+    if (!host.empty() && (!m_hostRules.empty() || !m_domainRules.empty())) {
+        std::string suffix = host.as_string();
+        auto it = m_hostRules.find(suffix);
+        if (it != m_hostRules.end())
+            best = firstMatch(it->second, best, url, navigationTypeBit, isMainFrame);
+
+        // Try the host itself and then each parent domain.
+        for (size_t begin = 0; begin < host.size() && !m_domainRules.empty(); ) {
+            if (begin)
+                host.substr(begin).CopyToString(&suffix);
+            it = m_domainRules.find(suffix);
+            if (it != m_domainRules.end())
+                best = firstMatch(it->second, best, url, navigationTypeBit, isMainFrame);
+            size_t dot = host.find('.', begin);
+            if (dot == base::StringPiece::npos)
+                break;
+            begin = dot + 1;
+        }
+    }
+
+    return best == kNoRule ? NoMatch : m_rules[best].action;
+}
+
+} // namespace QtWebEngineCore
@@ -0,0 +1,97 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef NAVIGATION_POLICY_QT_H
+#define NAVIGATION_POLICY_QT_H
+
+#include <QtCore/qglobal.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class GURL;
+
+namespace QtWebEngineCore {
+
+// Navigation rules evaluated on the IO thread by NetworkDelegateQt, so that matching frame
+// requests are decided without asking the page on the UI thread.
+//
+// The first rule added that matches wins. Rules are indexed by exact host and by domain, and
+// the candidates of each index are kept in rule order, so a lookup only visits the host's
+// labels and the first candidate matching the scheme, navigation type and frame of each index.
+class NavigationPolicyQt {
+public:
+    enum Action {
+        NoMatch,
+        Accept,
+        Block,
+        Ignore
+    };
+
+    struct Rule {
+        Action action;
+        std::string scheme;         // empty for any scheme
+        std::string host;           // empty for any host
+        bool includeSubdomains;
+        quint32 navigationTypes;    // bit mask of WebContentsAdapterClient::NavigationType
+        bool mainFrame;
+        bool subFrame;
+    };
+
+    explicit NavigationPolicyQt(std::vector<Rule> rules);
+
+    // Runs on the IO thread, may be called concurrently.
+    Action evaluate(const GURL &url, int navigationType, bool isMainFrame) const;
+
+private:
+    typedef std::unordered_map<std::string, std::vector<quint32>> RuleIndex;
+
+    quint32 firstMatch(const std::vector<quint32> &candidates, quint32 limit, const GURL &url,
+                       quint32 navigationTypeBit, bool isMainFrame) const;
+
+    std::vector<Rule> m_rules;
+    RuleIndex m_hostRules;
+    RuleIndex m_domainRules;
+    std::vector<quint32> m_anyHostRules;
+};
+
+} // namespace QtWebEngineCore
+
+#endif // NAVIGATION_POLICY_QT_H
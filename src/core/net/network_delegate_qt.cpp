@@ -47,12 +47,16 @@
 #include "cookie_monster_delegate_qt.h"
 #include "ui/base/page_transition_types.h"
 #include "profile_io_data_qt.h"
+#include "net/navigation_policy_qt.h"
+#include "net/url_request_content_job_qt.h"
+#include "net/url_request_rule_set.h"
 #include "net/base/load_flags.h"
 #include "net/url_request/url_request.h"
 #include "qwebengineurlrequestinfo.h"
 #include "qwebengineurlrequestinfo_p.h"
 #include "qwebengineurlrequestinterceptor.h"
 #include "type_conversion.h"
+#include "web_contents_adapter.h"
 #include "web_contents_adapter_client.h"
 #include "web_contents_view_qt.h"
 
@@ -86,6 +90,9 @@ WebContentsAdapterClient::NavigationType pageTransitionToNavigationType(ui::Page
 
 namespace {
 
+// Marks requests that a URLRequestRuleSet redirect rule has redirected.
+const char kRuleRedirectKey[] = "QtWebEngineCore::RuleRedirect";
+
 QWebEngineUrlRequestInfo::ResourceType toQt(content::ResourceType resourceType)
 {
     if (resourceType >= 0 && resourceType < content::ResourceType(QWebEngineUrlRequestInfo::ResourceTypeLast))
@@ -98,6 +105,21 @@ QWebEngineUrlRequestInfo::NavigationType toQt(WebContentsAdapterClient::Navigati
     return static_cast<QWebEngineUrlRequestInfo::NavigationType>(navigationType);
 }
 
+WebContentsAdapterClient *clientForFrameTreeNodeId(int frameTreeNodeId)
+{
+    content::WebContents *webContents = content::WebContents::FromFrameTreeNodeId(frameTreeNodeId);
+    if (!webContents)
+        return nullptr;
+    return WebContentsViewQt::from(static_cast<content::WebContentsImpl*>(webContents)->GetView())->client();
+}
+
+void navigationRequestAccepted(int frameTreeNodeId)
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+    if (WebContentsAdapterClient *client = clientForFrameTreeNodeId(frameTreeNodeId))
+        client->webContentsAdapter()->navigationRequestAccepted();
+}
+
 // Notifies WebContentsAdapterClient of a new URLRequest.
 class URLRequestNotification {
 public:
@@ -151,11 +173,8 @@ private:
         // May run concurrently with cancel() so no peeking at m_request here.
 
         int error = net::OK;
-        content::WebContents *webContents = content::WebContents::FromFrameTreeNodeId(m_frameTreeNodeId);
-        if (webContents) {
+        if (WebContentsAdapterClient *client = clientForFrameTreeNodeId(m_frameTreeNodeId)) {
             int navigationRequestAction = WebContentsAdapterClient::AcceptRequest;
-            WebContentsAdapterClient *client =
-                WebContentsViewQt::from(static_cast<content::WebContentsImpl*>(webContents)->GetView())->client();
             client->navigationRequested(m_navigationType,
                                         m_url,
                                         navigationRequestAction,
@@ -164,6 +183,7 @@ private:
             switch (static_cast<WebContentsAdapterClient::NavigationRequestAction>(navigationRequestAction)) {
             case WebContentsAdapterClient::AcceptRequest:
                 error = net::OK;
+                client->webContentsAdapter()->navigationRequestAccepted();
                 break;
             case WebContentsAdapterClient::IgnoreRequest:
                 error = net::ERR_ABORTED;
@@ -204,8 +224,165 @@ private:
 
 const char URLRequestNotification::UserData::key[] = "QtWebEngineCore::URLRequestNotification";
 
+// Applies the changes an interceptor made to the request.
+int applyInterception(net::URLRequest *request, QWebEngineUrlRequestInfoPrivate *infoPrivate, const QUrl &qUrl, GURL *newUrl)
+{
+    int result = infoPrivate->shouldBlockRequest ? net::ERR_BLOCKED_BY_CLIENT : net::OK;
+
+    if (qUrl != infoPrivate->url)
+        *newUrl = toGurl(infoPrivate->url);
+
+    if (!infoPrivate->extraHeaders.isEmpty()) {
+        auto end = infoPrivate->extraHeaders.constEnd();
+        for (auto header = infoPrivate->extraHeaders.constBegin(); header != end; ++header) {
+            std::string h = header.key().toStdString();
+            if (base::LowerCaseEqualsASCII(h, "referer")) {
+                request->SetReferrer(header.value().toStdString());
+            } else {
+                request->SetExtraRequestHeaderByName(h, header.value().toStdString(), /* overwrite */ true);
+            }
+        }
+    }
+
+    return result;
+}
+
+// Returns net::ERR_IO_PENDING and takes the callback if the UI thread has to decide about the request.
+int notifyNavigationRequest(net::URLRequest *request, const QUrl &qUrl, const NavigationPolicyQt *navigationPolicy,
+                            net::CompletionOnceCallback &callback)
+{
+    const content::ResourceRequestInfo *resourceInfo = content::ResourceRequestInfo::ForRequest(request);
+    if (!resourceInfo)
+        return net::OK;
+
+    int frameTreeNodeId = resourceInfo->GetFrameTreeNodeId();
+    // Only intercept MAIN_FRAME and SUB_FRAME with an associated render frame.
+    if (!content::IsResourceTypeFrame(resourceInfo->GetResourceType()) || frameTreeNodeId == -1)
+        return net::OK;
+
+    const WebContentsAdapterClient::NavigationType navigationType =
+            pageTransitionToNavigationType(resourceInfo->GetPageTransition());
+
+    // Requests matching the navigation policy are decided here, without a round trip to the UI thread.
+    if (navigationPolicy) {
+        switch (navigationPolicy->evaluate(request->url(), navigationType, resourceInfo->IsMainFrame())) {
+        case NavigationPolicyQt::Accept:
+            content::BrowserThread::PostTask(
+                content::BrowserThread::UI,
+                FROM_HERE,
+                base::BindOnce(&navigationRequestAccepted, frameTreeNodeId));
+            return net::OK;
+        case NavigationPolicyQt::Block:
+            return net::ERR_BLOCKED_BY_CLIENT;
+        case NavigationPolicyQt::Ignore:
+            return net::ERR_ABORTED;
+        case NavigationPolicyQt::NoMatch:
+            break;
+        }
+    }
+
+    new URLRequestNotification(
+        request,
+        qUrl,
+        resourceInfo->IsMainFrame(),
+        navigationType,
+        frameTreeNodeId,
+        std::move(callback)
+    );
+
+    return net::ERR_IO_PENDING;
+}
+
 } // namespace
 
+// Holds a URLRequest back until a QWebEngineAsyncUrlRequestInterceptor has finished it.
+class URLRequestInterception {
+public:
+    URLRequestInterception(net::URLRequest *request,
+                           const QUrl &url,
+                           QWebEngineUrlRequestInfoPrivate *infoPrivate,
+                           GURL *newUrl,
+                           QSharedPointer<const NavigationPolicyQt> navigationPolicy,
+                           net::CompletionOnceCallback callback)
+        : m_request(request)
+        , m_url(url)
+        , m_info(new QWebEngineUrlRequestInfo(infoPrivate))
+        , m_newUrl(newUrl)
+        , m_navigationPolicy(std::move(navigationPolicy))
+        , m_callback(std::move(callback))
+        , m_finished(false)
+    {
+        DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+
+        m_request->SetUserData(UserData::key, std::make_unique<UserData>(this));
+
+        // The interceptor may finish on any thread, even before interceptRequestAsync() returns.
+        infoPrivate->finishCallback = [this]() {
+            content::BrowserThread::PostTask(
+                content::BrowserThread::IO,
+                FROM_HERE,
+                base::BindOnce(&URLRequestInterception::complete, base::Unretained(this)));
+        };
+    }
+
+    QWebEngineUrlRequestInfo *info() const { return m_info; }
+
+private:
+    // Calls cancel() when the URLRequest is destroyed.
+    class UserData : public base::SupportsUserData::Data {
+    public:
+        UserData(URLRequestInterception *ptr) : m_ptr(ptr) {}
+        ~UserData() { m_ptr->cancel(); }
+        static const char key[];
+    private:
+        URLRequestInterception *m_ptr;
+    };
+
+    // The info is deleted once the interceptor has finished with it and the URLRequest is gone,
+    // whichever comes last.
+    void cancel()
+    {
+        DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+
+        m_request = nullptr;
+        if (m_finished)
+            delete this;
+    }
+
+    void complete()
+    {
+        DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+
+        m_finished = true;
+        if (!m_request) {
+            delete this;
+            return;
+        }
+
+        if (m_request->status().status() != net::URLRequestStatus::CANCELED) {
+            int result = net::OK;
+            if (m_info->d_ptr->changed)
+                result = applyInterception(m_request, m_info->d_ptr.data(), m_url, m_newUrl);
+            if (result == net::OK)
+                result = notifyNavigationRequest(m_request, m_url, m_navigationPolicy.data(), m_callback);
+            if (result != net::ERR_IO_PENDING)
+                std::move(m_callback).Run(result);
+        }
+    }
+
+    ~URLRequestInterception() { delete m_info; }
+
+    net::URLRequest *m_request;
+    QUrl m_url;
+    QWebEngineUrlRequestInfo *m_info;
+    GURL *m_newUrl;
+    QSharedPointer<const NavigationPolicyQt> m_navigationPolicy;
+    net::CompletionOnceCallback m_callback;
+    bool m_finished;
+};
+
+const char URLRequestInterception::UserData::key[] = "QtWebEngineCore::URLRequestInterception";
+
 NetworkDelegateQt::NetworkDelegateQt(ProfileIODataQt *data)
     : m_profileIOData(data)
 {
@@ -216,6 +393,11 @@ int NetworkDelegateQt::OnBeforeURLRequest(net::URLRequest *request, net::Complet
     Q_ASSERT(content::BrowserThread::CurrentlyOn(content::BrowserThread::IO));
     Q_ASSERT(m_profileIOData);
 
+    // Content served from memory by setContent is loaded like the data: URL it stands in for,
+    // which never reaches the rule set, the interceptor or the navigation policy.
+    if (ContentPayloadStoreQt::isContentNavigation(request, nullptr))
+        return net::OK;
+
     const content::ResourceRequestInfo *resourceInfo = content::ResourceRequestInfo::ForRequest(request);
 
     content::ResourceType resourceType = content::RESOURCE_TYPE_LAST_TYPE;
@@ -226,6 +408,23 @@ int NetworkDelegateQt::OnBeforeURLRequest(net::URLRequest *request, net::Complet
         navigationType = pageTransitionToNavigationType(resourceInfo->GetPageTransition());
     }
 
+    // The rule set is matched on the Chromium URL, before any Qt object is created for the request.
+    // A request redirected by a rule is not redirected again, so rules cannot form a loop.
+    if (const URLRequestRuleSet *ruleSet = m_profileIOData->urlRequestRuleSet()) {
+        std::string redirectUrl;
+        const bool redirectedByRule = request->GetUserData(kRuleRedirectKey);
+        switch (ruleSet->evaluate(request->url(), resourceType, redirectedByRule ? nullptr : &redirectUrl)) {
+        case URLRequestRuleSet::Block:
+            return net::ERR_BLOCKED_BY_CLIENT;
+        case URLRequestRuleSet::Redirect:
+            request->SetUserData(kRuleRedirectKey, std::make_unique<base::SupportsUserData::Data>());
+            *newUrl = GURL(redirectUrl);
+            return net::OK;
+        case URLRequestRuleSet::NoAction:
+            break;
+        }
+    }
+
     const QUrl qUrl = toQt(request->url());
 
     QUrl firstPartyUrl = QUrl();
@@ -241,27 +440,20 @@ int NetworkDelegateQt::OnBeforeURLRequest(net::URLRequest *request, net::Complet
                                                                                            qUrl,
                                                                                            firstPartyUrl,
                                                                                            QByteArray::fromStdString(request->method()));
+        if (auto asyncInterceptor = qobject_cast<QWebEngineAsyncUrlRequestInterceptor *>(interceptor)) {
+            URLRequestInterception *interception =
+                    new URLRequestInterception(request, qUrl, infoPrivate, newUrl,
+                                               m_profileIOData->navigationPolicy(), std::move(callback));
+            asyncInterceptor->interceptRequestAsync(interception->info());
+            m_profileIOData->releaseInterceptor();
+            // We'll run the callback once the interceptor has finished the request.
+            return net::ERR_IO_PENDING;
+        }
         QWebEngineUrlRequestInfo requestInfo(infoPrivate);
         interceptor->interceptRequest(requestInfo);
         m_profileIOData->releaseInterceptor();
         if (requestInfo.changed()) {
-            int result = infoPrivate->shouldBlockRequest ? net::ERR_BLOCKED_BY_CLIENT : net::OK;
-
-            if (qUrl != infoPrivate->url)
-                *newUrl = toGurl(infoPrivate->url);
-
-            if (!infoPrivate->extraHeaders.isEmpty()) {
-                auto end = infoPrivate->extraHeaders.constEnd();
-                for (auto header = infoPrivate->extraHeaders.constBegin(); header != end; ++header) {
-                    std::string h = header.key().toStdString();
-                    if (base::LowerCaseEqualsASCII(h, "referer")) {
-                        request->SetReferrer(header.value().toStdString());
-                    } else {
-                        request->SetExtraRequestHeaderByName(h, header.value().toStdString(), /* overwrite */ true);
-                    }
-                }
-            }
-
+            int result = applyInterception(request, infoPrivate, qUrl, newUrl);
             if (result != net::OK)
                 return result;
         }
@@ -269,25 +461,8 @@ int NetworkDelegateQt::OnBeforeURLRequest(net::URLRequest *request, net::Complet
         m_profileIOData->releaseInterceptor();
     }
 
-    if (!resourceInfo)
-        return net::OK;
-
-    int frameTreeNodeId = resourceInfo->GetFrameTreeNodeId();
-    // Only intercept MAIN_FRAME and SUB_FRAME with an associated render frame.
-    if (!content::IsResourceTypeFrame(resourceType) || frameTreeNodeId == -1)
-        return net::OK;
-
-    new URLRequestNotification(
-        request,
-        qUrl,
-        resourceInfo->IsMainFrame(),
-        navigationType,
-        frameTreeNodeId,
-        std::move(callback)
-    );
-
-    // We'll run the callback after we notified the UI thread.
-    return net::ERR_IO_PENDING;
+    // We'll run the callback after we notified the UI thread, if needed.
+    return notifyNavigationRequest(request, qUrl, m_profileIOData->navigationPolicy().data(), callback);
 }
 
 void NetworkDelegateQt::OnURLRequestDestroyed(net::URLRequest*)
@@ -318,17 +493,20 @@ bool NetworkDelegateQt::OnCanEnablePrivacyMode(const GURL &url, const GURL &site
 bool NetworkDelegateQt::canSetCookies(const GURL &first_party, const GURL &url, const std::string &cookie_line) const
 {
     Q_ASSERT(m_profileIOData);
-    return m_profileIOData->canSetCookie(toQt(first_party), QByteArray::fromStdString(cookie_line), toQt(url));
+    return m_profileIOData->canSetCookie(first_party, cookie_line, url);
 }
 
 bool NetworkDelegateQt::canGetCookies(const GURL &first_party, const GURL &url) const
 {
     Q_ASSERT(m_profileIOData);
-    return m_profileIOData->canGetCookies(toQt(first_party), toQt(url));
+    return m_profileIOData->canGetCookies(first_party, url);
 }
 
-int NetworkDelegateQt::OnBeforeStartTransaction(net::URLRequest *, net::CompletionOnceCallback, net::HttpRequestHeaders *)
+int NetworkDelegateQt::OnBeforeStartTransaction(net::URLRequest *, net::CompletionOnceCallback, net::HttpRequestHeaders *headers)
 {
+    // The content token is kept across redirects of a setContent navigation, but is only for
+    // ContentRequestInterceptorQt and must not be sent to servers.
+    headers->RemoveHeader(ContentPayloadStoreQt::kTokenHeader);
     return net::OK;
 }
 
@@ -0,0 +1,198 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "url_request_content_job_qt.h"
+
+#include "base/guid.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "content/public/browser/resource_request_info.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/http/http_util.h"
+#include "net/url_request/url_request.h"
+#include "net/url_request/url_request_error_job.h"
+
+#include <cstring>
+
+using namespace net;
+namespace QtWebEngineCore {
+
+const char kContentSchemeQt[] = "qtwebengine-content";
+
+const char ContentPayloadStoreQt::kTokenHeader[] = "X-QtWebEngine-Content";
+
+bool ContentPayloadStoreQt::isContentNavigation(const URLRequest *request, std::string *token)
+{
+    std::string value;
+    if (!request->extra_request_headers().GetHeader(kTokenHeader, &value))
+        return false;
+
+    // Only the navigation issued by setContent carries the header, anything else
+    // setting it (scripts can add custom headers to fetches) is not ours to answer.
+    const content::ResourceRequestInfo *info = content::ResourceRequestInfo::ForRequest(request);
+    if (!info || info->GetResourceType() != content::RESOURCE_TYPE_MAIN_FRAME)
+        return false;
+    // The header stays on the request when the server of the base URL redirects it,
+    // the payload only answers the base URL itself.
+    if (request->url_chain().size() != 1)
+        return false;
+
+    if (token)
+        *token = value;
+    return true;
+}
+
+std::string ContentPayloadStoreQt::add(const QByteArray &data, const std::string &contentType)
+{
+    QSharedPointer<ContentPayloadQt> payload(new ContentPayloadQt);
+    payload->data = data;
+    bool hadCharset = false;
+    HttpUtil::ParseContentType(contentType, &payload->mimeType, &payload->charset, &hadCharset, nullptr);
+    if (payload->mimeType.empty()) {
+        payload->mimeType = "text/plain";
+        payload->charset = "US-ASCII";
+    }
+
+    const std::string token = base::GenerateGUID();
+    QMutexLocker lock(&m_mutex);
+    m_payloads[token] = payload;
+    return token;
+}
+
+void ContentPayloadStoreQt::remove(const std::string &token)
+{
+    QMutexLocker lock(&m_mutex);
+    m_payloads.erase(token);
+}
+
+QSharedPointer<const ContentPayloadQt> ContentPayloadStoreQt::payload(const std::string &token) const
+{
+    QMutexLocker lock(&m_mutex);
+    auto it = m_payloads.find(token);
+    if (it == m_payloads.end())
+        return QSharedPointer<const ContentPayloadQt>();
+    return it->second;
+}
+
+ContentRequestInterceptorQt::ContentRequestInterceptorQt(QSharedPointer<ContentPayloadStoreQt> store)
+    : m_store(std::move(store))
+{
+}
+
+URLRequestJob *ContentRequestInterceptorQt::MaybeInterceptRequest(URLRequest *request,
+                                                                  NetworkDelegate *networkDelegate) const
+{
+    std::string token;
+    if (!ContentPayloadStoreQt::isContentNavigation(request, &token))
+        return nullptr;
+
+    QSharedPointer<const ContentPayloadQt> payload = m_store->payload(token);
+    // The payload is gone (e.g. reloading an old entry), never fall back to the network.
+    if (!payload)
+        return new URLRequestErrorJob(request, networkDelegate, ERR_FILE_NOT_FOUND);
+    return new URLRequestContentJobQt(request, networkDelegate, std::move(payload));
+}
+
+ContentProtocolHandlerQt::ContentProtocolHandlerQt()
+{
+}
+
+URLRequestJob *ContentProtocolHandlerQt::MaybeCreateJob(URLRequest *request, NetworkDelegate *networkDelegate) const
+{
+    return new URLRequestErrorJob(request, networkDelegate, ERR_ACCESS_DENIED);
+}
+
+URLRequestContentJobQt::URLRequestContentJobQt(URLRequest *request, NetworkDelegate *networkDelegate,
+                                               QSharedPointer<const ContentPayloadQt> payload)
+    : URLRequestJob(request, networkDelegate)
+    , m_payload(std::move(payload))
+    , m_offset(0)
+    , m_weakFactory(this)
+{
+}
+
+URLRequestContentJobQt::~URLRequestContentJobQt()
+{
+}
+
+void URLRequestContentJobQt::Start()
+{
+    base::ThreadTaskRunnerHandle::Get()->PostTask(FROM_HERE, base::Bind(&URLRequestContentJobQt::startGetHead, m_weakFactory.GetWeakPtr()));
+}
+
+void URLRequestContentJobQt::Kill()
+{
+    m_weakFactory.InvalidateWeakPtrs();
+    URLRequestJob::Kill();
+}
+
+bool URLRequestContentJobQt::GetMimeType(std::string *mimeType) const
+{
+    *mimeType = m_payload->mimeType;
+    return true;
+}
+
+bool URLRequestContentJobQt::GetCharset(std::string *charset)
+{
+    if (m_payload->charset.empty())
+        return false;
+    *charset = m_payload->charset;
+    return true;
+}
+
+int URLRequestContentJobQt::ReadRawData(IOBuffer *buf, int bufSize)
+{
+    const int remaining = m_payload->data.size() - m_offset;
+    DCHECK_GE(remaining, 0);
+    if (remaining < bufSize)
+        bufSize = remaining;
+    if (bufSize <= 0)
+        return 0;
+    memcpy(buf->data(), m_payload->data.constData() + m_offset, bufSize);
+    m_offset += bufSize;
+    return bufSize;
+}
+
+void URLRequestContentJobQt::startGetHead()
+{
+    set_expected_content_size(m_payload->data.size());
+    NotifyHeadersComplete();
+}
+
+} // namespace QtWebEngineCore
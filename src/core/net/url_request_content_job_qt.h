@@ -0,0 +1,137 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef URL_REQUEST_CONTENT_JOB_QT_H_
+#define URL_REQUEST_CONTENT_JOB_QT_H_
+
+#include "net/url_request/url_request_interceptor.h"
+#include "net/url_request/url_request_job.h"
+#include "net/url_request/url_request_job_factory.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QMutex>
+#include <QtCore/QSharedPointer>
+
+#include <string>
+#include <unordered_map>
+
+namespace QtWebEngineCore {
+
+// Internal scheme setContent navigates to when there is no base URL to serve the payload for.
+extern const char kContentSchemeQt[];
+
+// Content handed to WebContentsAdapter::setContent, kept implicitly shared
+// until the navigation that displays it has read it.
+struct ContentPayloadQt {
+    QByteArray data;
+    std::string mimeType;
+    std::string charset;
+};
+
+// Thread-safe registry of setContent payloads, keyed by random tokens.
+// Filled on the UI thread and read on the IO thread.
+class ContentPayloadStoreQt {
+public:
+    // Request header carrying the token of the payload to serve.
+    static const char kTokenHeader[];
+
+    // Whether the request is the navigation issued by setContent, and if so its token.
+    static bool isContentNavigation(const net::URLRequest *request, std::string *token);
+
+    std::string add(const QByteArray &data, const std::string &contentType);
+    void remove(const std::string &token);
+    QSharedPointer<const ContentPayloadQt> payload(const std::string &token) const;
+
+private:
+    mutable QMutex m_mutex;
+    std::unordered_map<std::string, QSharedPointer<const ContentPayloadQt>> m_payloads;
+};
+
+// Answers main frame navigations tagged with ContentPayloadStoreQt::kTokenHeader
+// from the store instead of the network or the scheme handler of the base URL,
+// or of the kContentSchemeQt URL that stands in for a missing base URL.
+class ContentRequestInterceptorQt : public net::URLRequestInterceptor {
+public:
+    explicit ContentRequestInterceptorQt(QSharedPointer<ContentPayloadStoreQt> store);
+    net::URLRequestJob *MaybeInterceptRequest(net::URLRequest *request,
+                                              net::NetworkDelegate *networkDelegate) const override;
+
+private:
+    QSharedPointer<ContentPayloadStoreQt> m_store;
+
+    DISALLOW_COPY_AND_ASSIGN(ContentRequestInterceptorQt);
+};
+
+// Refuses every request for kContentSchemeQt, URLs of that scheme are only
+// answered by ContentRequestInterceptorQt and cannot be navigated to otherwise.
+class ContentProtocolHandlerQt : public net::URLRequestJobFactory::ProtocolHandler {
+public:
+    ContentProtocolHandlerQt();
+    net::URLRequestJob *MaybeCreateJob(net::URLRequest *request, net::NetworkDelegate *networkDelegate) const override;
+
+private:
+    DISALLOW_COPY_AND_ASSIGN(ContentProtocolHandlerQt);
+};
+
+// A request job that reads a setContent payload straight out of memory.
+class URLRequestContentJobQt : public net::URLRequestJob {
+public:
+    URLRequestContentJobQt(net::URLRequest *request, net::NetworkDelegate *networkDelegate,
+                           QSharedPointer<const ContentPayloadQt> payload);
+    void Start() override;
+    void Kill() override;
+    int ReadRawData(net::IOBuffer *buf, int bufSize) override;
+    bool GetMimeType(std::string *mimeType) const override;
+    bool GetCharset(std::string *charset) override;
+
+protected:
+    virtual ~URLRequestContentJobQt();
+    void startGetHead();
+
+private:
+    QSharedPointer<const ContentPayloadQt> m_payload;
+    int m_offset;
+    base::WeakPtrFactory<URLRequestContentJobQt> m_weakFactory;
+
+    DISALLOW_COPY_AND_ASSIGN(URLRequestContentJobQt);
+};
+
+} // namespace QtWebEngineCore
+
+#endif // URL_REQUEST_CONTENT_JOB_QT_H_
@@ -39,8 +39,15 @@
 
 #include "url_request_custom_job.h"
 #include "url_request_custom_job_proxy.h"
+#include "base/strings/stringprintf.h"
 #include "content/public/browser/browser_thread.h"
 #include "net/base/io_buffer.h"
+#include "net/base/upload_data_stream.h"
+#include "net/http/http_request_headers.h"
+#include "net/http/http_response_headers.h"
+#include "net/http/http_response_info.h"
+#include "net/http/http_util.h"
+#include "net/log/net_log_with_source.h"
 
 #include <QIODevice>
 
@@ -51,14 +58,21 @@ namespace QtWebEngineCore {
 URLRequestCustomJob::URLRequestCustomJob(URLRequest *request,
                                          NetworkDelegate *networkDelegate,
                                          const std::string &scheme,
-                                         QPointer<ProfileAdapter> profileAdapter)
+                                         QPointer<ProfileAdapter> profileAdapter,
+                                         QSharedPointer<ConcurrentUrlSchemeHandlers> concurrentHandlers)
     : URLRequestJob(request, networkDelegate)
-    , m_proxy(new URLRequestCustomJobProxy(this, scheme, profileAdapter))
+    , m_proxy(new URLRequestCustomJobProxy(this, scheme, profileAdapter, std::move(concurrentHandlers)))
+    , m_redirectStatusCode(0)
     , m_device(nullptr)
     , m_error(0)
     , m_pendingReadSize(0)
     , m_pendingReadPos(0)
     , m_pendingReadBuffer(nullptr)
+    , m_remainingBytes(-1)
+    , m_upload(nullptr)
+    , m_uploadReading(false)
+    , m_uploadChunkRequested(false)
+    , m_weakFactory(this)
 {
 }
 
@@ -68,17 +82,89 @@ URLRequestCustomJob::~URLRequestCustomJob()
     if (m_device && m_device->isOpen())
         m_device->close();
     m_device = nullptr;
-    content::BrowserThread::PostTask(content::BrowserThread::UI, FROM_HERE,
-                                     base::Bind(&URLRequestCustomJobProxy::release,
-                                     m_proxy));
+    m_proxy->postToDelegateThread(base::Bind(&URLRequestCustomJobProxy::release, m_proxy));
 }
 
 void URLRequestCustomJob::Start()
 {
     DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
-    content::BrowserThread::PostTask(content::BrowserThread::UI, FROM_HERE,
-                                     base::Bind(&URLRequestCustomJobProxy::initialize,
-                                     m_proxy, request()->url(), request()->method(), request()->initiator()));
+    QMultiMap<QByteArray, QByteArray> requestHeaders;
+    net::HttpRequestHeaders::Iterator it(m_requestHeaders);
+    while (it.GetNext())
+        requestHeaders.insert(QByteArray::fromStdString(it.name()), QByteArray::fromStdString(it.value()));
+
+    m_proxy->start();
+    m_proxy->postToDelegateThread(base::Bind(&URLRequestCustomJobProxy::initialize,
+                                             m_proxy, request()->url(), request()->method(), request()->initiator(),
+                                             requestHeaders, m_upload != nullptr));
+
+    if (m_upload) {
+        // Have the first chunk ready by the time the handler starts reading.
+        m_uploadChunkRequested = true;
+        m_uploadReading = true;
+        int rv = m_upload->Init(base::Bind(&URLRequestCustomJob::onUploadInitialized, m_weakFactory.GetWeakPtr()),
+                                net::NetLogWithSource());
+        if (rv != ERR_IO_PENDING)
+            onUploadInitialized(rv);
+    }
+}
+
+void URLRequestCustomJob::SetUpload(UploadDataStream *upload)
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+    m_upload = upload;
+}
+
+void URLRequestCustomJob::onUploadInitialized(int result)
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+    m_uploadReading = false;
+    if (result != OK) {
+        m_proxy->postToDelegateThread(base::Bind(&URLRequestCustomJobProxy::uploadChunk,
+                                                 m_proxy, QByteArray(), true, true));
+        m_upload = nullptr;
+        return;
+    }
+    if (m_uploadChunkRequested)
+        readUploadChunk();
+}
+
+void URLRequestCustomJob::readUploadChunk()
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+    if (!m_upload)
+        return;
+    m_uploadChunkRequested = true;
+    if (m_uploadReading)
+        return;
+    m_uploadChunkRequested = false;
+
+    if (!m_uploadBuffer)
+        m_uploadBuffer = new IOBufferWithSize(URLRequestCustomJobProxy::kUploadChunkSize);
+    m_uploadReading = true;
+    int rv = m_upload->Read(m_uploadBuffer.get(), m_uploadBuffer->size(),
+                            base::Bind(&URLRequestCustomJob::onUploadRead, m_weakFactory.GetWeakPtr()));
+    if (rv != ERR_IO_PENDING)
+        onUploadRead(rv);
+}
+
+void URLRequestCustomJob::onUploadRead(int result)
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+    m_uploadReading = false;
+    if (!m_upload)
+        return;
+    QByteArray chunk;
+    if (result > 0)
+        chunk = QByteArray(m_uploadBuffer->data(), result);
+    const bool failed = result < 0;
+    const bool finished = failed || m_upload->IsEOF();
+    m_proxy->postToDelegateThread(base::Bind(&URLRequestCustomJobProxy::uploadChunk,
+                                             m_proxy, chunk, finished, failed));
+    if (finished)
+        m_upload = nullptr;
+    else if (m_uploadChunkRequested)
+        readUploadChunk();
 }
 
 void URLRequestCustomJob::Kill()
@@ -94,9 +180,9 @@ void URLRequestCustomJob::Kill()
         m_pendingReadPos = 0;
     }
     m_device = nullptr;
-    content::BrowserThread::PostTask(content::BrowserThread::UI, FROM_HERE,
-                                     base::Bind(&URLRequestCustomJobProxy::release,
-                                     m_proxy));
+    m_upload = nullptr;
+    m_weakFactory.InvalidateWeakPtrs();
+    m_proxy->postToDelegateThread(base::Bind(&URLRequestCustomJobProxy::release, m_proxy));
     URLRequestJob::Kill();
 }
 
@@ -125,10 +211,91 @@ bool URLRequestCustomJob::IsRedirectResponse(GURL* location, int* http_status_co
     DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
     if (m_redirect.is_valid()) {
         *location = m_redirect;
-        *http_status_code = 303;
+        *http_status_code = m_redirectStatusCode;
         return true;
     }
-    return false;
+    // A reply can redirect too, with a redirect status code and a Location header.
+    std::string redirectLocation;
+    if (!m_responseHeaders || !m_responseHeaders->IsRedirect(&redirectLocation))
+        return false;
+    GURL redirectUrl = request()->url().Resolve(redirectLocation);
+    if (!redirectUrl.is_valid())
+        return false;
+    *location = redirectUrl;
+    *http_status_code = m_responseHeaders->response_code();
+    return true;
+}
+
+void URLRequestCustomJob::SetExtraRequestHeaders(const HttpRequestHeaders &headers)
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+    m_requestHeaders = headers;
+    std::string range;
+    std::vector<HttpByteRange> ranges;
+    if (!headers.GetHeader(HttpRequestHeaders::kRange, &range) || !HttpUtil::ParseRangeHeader(range, &ranges))
+        return;
+    // Multiple ranges are not supported, the whole content is returned instead.
+    if (ranges.size() == 1)
+        m_byteRange = ranges[0];
+}
+
+bool URLRequestCustomJob::prepareResponse(int statusCode, const QMultiMap<QByteArray, QByteArray> &additionalHeaders)
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+    const qint64 size = m_device->size();
+    const bool randomAccess = !m_device->isSequential() && size >= 0;
+    qint64 contentLength = size;
+    std::string contentRange;
+
+    // A handler setting its own status code serves ranges itself.
+    if (m_byteRange.IsValid() && randomAccess && (!statusCode || statusCode == 200)) {
+        if (!m_byteRange.ComputeBounds(size) || !m_device->seek(m_byteRange.first_byte_position()))
+            return false;
+        contentLength = m_byteRange.last_byte_position() - m_byteRange.first_byte_position() + 1;
+        contentRange = base::StringPrintf("bytes %lld-%lld/%lld",
+                                          static_cast<long long>(m_byteRange.first_byte_position()),
+                                          static_cast<long long>(m_byteRange.last_byte_position()),
+                                          static_cast<long long>(size));
+        m_remainingBytes = contentLength;
+        statusCode = 206;
+    }
+
+    if (contentLength > 0)
+        set_expected_content_size(contentLength);
+
+    if (!statusCode && additionalHeaders.isEmpty())
+        return true;
+
+    std::string rawHeaders = base::StringPrintf("HTTP/1.1 %d\n", statusCode ? statusCode : 200);
+    if (!m_mimeType.empty())
+        rawHeaders += "Content-Type: " + m_mimeType + "\n";
+    if (contentLength >= 0)
+        rawHeaders += base::StringPrintf("Content-Length: %lld\n", static_cast<long long>(contentLength));
+    if (randomAccess)
+        rawHeaders += "Accept-Ranges: bytes\n";
+    if (!contentRange.empty())
+        rawHeaders += "Content-Range: " + contentRange + "\n";
+    for (auto it = additionalHeaders.cbegin(); it != additionalHeaders.cend(); ++it) {
+        const std::string name = it.key().toStdString();
+        const std::string value = it.value().toStdString();
+        if (HttpUtil::IsValidHeaderName(name) && HttpUtil::IsValidHeaderValue(value))
+            rawHeaders += name + ": " + value + "\n";
+    }
+    m_responseHeaders = new HttpResponseHeaders(HttpUtil::AssembleRawHeaders(rawHeaders.c_str(), rawHeaders.size()));
+    return true;
+}
+
+void URLRequestCustomJob::GetResponseInfo(HttpResponseInfo *info)
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+    if (m_responseHeaders)
+        info->headers = m_responseHeaders;
+}
+
+int URLRequestCustomJob::GetResponseCode() const
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+    return m_responseHeaders ? m_responseHeaders->response_code() : -1;
 }
 
 int URLRequestCustomJob::ReadRawData(IOBuffer *buf, int bufSize)
@@ -136,8 +303,14 @@ int URLRequestCustomJob::ReadRawData(IOBuffer *buf, int bufSize)
     DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
     if (m_error)
         return m_error;
+    if (m_remainingBytes == 0)
+        return 0;
+    if (m_remainingBytes > 0 && m_remainingBytes < bufSize)
+        bufSize = static_cast<int>(m_remainingBytes);
     qint64 rv = m_device ? m_device->read(buf->data(), bufSize) : -1;
     if (rv > 0) {
+        if (m_remainingBytes > 0)
+            m_remainingBytes -= rv;
         return static_cast<int>(rv);
     } else if (rv == 0) {
         // Returning zero is interpreted as EOF by Chromium, so only
@@ -184,6 +357,8 @@ void URLRequestCustomJob::notifyReadyRead()
             rv = ERR_FAILED;
     } else {
         m_pendingReadPos += rv;
+        if (m_remainingBytes > 0)
+            m_remainingBytes -= rv;
         if (m_pendingReadPos < m_pendingReadSize && !m_device->atEnd())
             return;
         rv = m_pendingReadPos;
@@ -40,15 +40,21 @@
 #ifndef URL_REQUEST_CUSTOM_JOB_H_
 #define URL_REQUEST_CUSTOM_JOB_H_
 
+#include "base/memory/weak_ptr.h"
+#include "net/http/http_byte_range.h"
+#include "net/http/http_request_headers.h"
 #include "net/url_request/url_request_job.h"
 #include "url/gurl.h"
+#include <QtCore/QMap>
 #include <QtCore/QPointer>
+#include <QtCore/QSharedPointer>
 
 QT_FORWARD_DECLARE_CLASS(QIODevice)
 
 namespace QtWebEngineCore {
 
 class ProfileAdapter;
+class ConcurrentUrlSchemeHandlers;
 class URLRequestCustomJobDelegate;
 class URLRequestCustomJobProxy;
 
@@ -58,28 +64,49 @@ public:
     URLRequestCustomJob(net::URLRequest *request,
                         net::NetworkDelegate *networkDelegate,
                         const std::string &scheme,
-                        QPointer<ProfileAdapter> profileAdapter);
+                        QPointer<ProfileAdapter> profileAdapter,
+                        QSharedPointer<ConcurrentUrlSchemeHandlers> concurrentHandlers);
     void Start() override;
     void Kill() override;
     int ReadRawData(net::IOBuffer *buf, int buf_size)  override;
     bool GetMimeType(std::string *mimeType) const override;
     bool GetCharset(std::string *charset) override;
     bool IsRedirectResponse(GURL* location, int* http_status_code, bool* insecure_scheme_was_upgraded) override;
+    void SetExtraRequestHeaders(const net::HttpRequestHeaders &headers) override;
+    void SetUpload(net::UploadDataStream *upload) override;
+    void GetResponseInfo(net::HttpResponseInfo *info) override;
+    int GetResponseCode() const override;
 
 protected:
     virtual ~URLRequestCustomJob();
 
 private:
     void notifyReadyRead();
+    bool prepareResponse(int statusCode, const QMultiMap<QByteArray, QByteArray> &additionalHeaders);
+    void readUploadChunk();
+    void onUploadInitialized(int result);
+    void onUploadRead(int result);
     scoped_refptr<URLRequestCustomJobProxy> m_proxy;
     std::string m_mimeType;
     std::string m_charset;
     GURL m_redirect;
+    int m_redirectStatusCode;
     QIODevice *m_device;
     int m_error;
     int m_pendingReadSize;
     int m_pendingReadPos;
     net::IOBuffer *m_pendingReadBuffer;
+    net::HttpByteRange m_byteRange;
+    // Bytes left to read from the device when serving a byte range, otherwise -1.
+    qint64 m_remainingBytes;
+    scoped_refptr<net::HttpResponseHeaders> m_responseHeaders;
+    net::HttpRequestHeaders m_requestHeaders;
+    // The request body is read one chunk at a time, when the delegate asks for it.
+    net::UploadDataStream *m_upload;
+    scoped_refptr<net::IOBufferWithSize> m_uploadBuffer;
+    bool m_uploadReading;
+    bool m_uploadChunkRequested;
+    base::WeakPtrFactory<URLRequestCustomJob> m_weakFactory;
 
     friend class URLRequestCustomJobProxy;
 
@@ -45,17 +45,113 @@
 #include "content/public/browser/browser_thread.h"
 
 #include <QByteArray>
+#include <QIODevice>
+#include <QList>
 
 namespace QtWebEngineCore {
 
+// Sequential device receiving the request body in chunks from the IO thread. The next
+// chunk is asked for once less than a chunk is buffered, so that large uploads are never
+// held in memory in one piece.
+class URLRequestCustomJobUploadDevice : public QIODevice {
+public:
+    URLRequestCustomJobUploadDevice(URLRequestCustomJobDelegate *delegate)
+        : QIODevice(delegate)
+        , m_delegate(delegate)
+    {
+        setOpenMode(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    }
+
+    bool isSequential() const override { return true; }
+
+    qint64 bytesAvailable() const override
+    {
+        return m_bufferedSize + QIODevice::bytesAvailable();
+    }
+
+    bool atEnd() const override
+    {
+        return m_finished && !m_bufferedSize && QIODevice::atEnd();
+    }
+
+    void append(const QByteArray &chunk, bool finished, bool failed)
+    {
+        m_chunkRequested = false;
+        m_finished = finished;
+        m_failed = failed;
+        if (failed)
+            setErrorString(QStringLiteral("Failed to read the request body"));
+        if (!chunk.isEmpty()) {
+            m_chunks.append(chunk);
+            m_bufferedSize += chunk.size();
+        }
+        requestChunkIfNeeded();
+        if (!chunk.isEmpty())
+            Q_EMIT readyRead();
+        if (finished)
+            Q_EMIT readChannelFinished();
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        qint64 read = 0;
+        while (read < maxSize && !m_chunks.isEmpty()) {
+            const QByteArray &chunk = m_chunks.first();
+            const qint64 length = qMin(maxSize - read, qint64(chunk.size() - m_chunkOffset));
+            memcpy(data + read, chunk.constData() + m_chunkOffset, length);
+            read += length;
+            m_chunkOffset += length;
+            if (m_chunkOffset == chunk.size()) {
+                m_chunks.removeFirst();
+                m_chunkOffset = 0;
+            }
+        }
+        m_bufferedSize -= read;
+        requestChunkIfNeeded();
+        // A sequential device signals the end of its data by failing to read.
+        if (!read && (m_failed || m_finished))
+            return -1;
+        return read;
+    }
+
+    qint64 writeData(const char *, qint64) override
+    {
+        return -1;
+    }
+
+private:
+    void requestChunkIfNeeded()
+    {
+        if (m_finished || m_chunkRequested || m_bufferedSize >= URLRequestCustomJobProxy::kUploadChunkSize)
+            return;
+        m_chunkRequested = true;
+        m_delegate->readRequestBody();
+    }
+
+    URLRequestCustomJobDelegate *m_delegate;
+    QList<QByteArray> m_chunks;
+    int m_chunkOffset = 0;
+    qint64 m_bufferedSize = 0;
+    // The job reads the first chunk on its own.
+    bool m_chunkRequested = true;
+    bool m_finished = false;
+    bool m_failed = false;
+};
+
 URLRequestCustomJobDelegate::URLRequestCustomJobDelegate(URLRequestCustomJobProxy *proxy,
                                                          const QUrl &url,
                                                          const QByteArray &method,
-                                                         const QUrl &initiatorOrigin)
+                                                         const QUrl &initiatorOrigin,
+                                                         const QMultiMap<QByteArray, QByteArray> &requestHeaders,
+                                                         bool hasRequestBody)
     : m_proxy(proxy),
       m_request(url),
       m_method(method),
-      m_initiatorOrigin(initiatorOrigin)
+      m_initiatorOrigin(initiatorOrigin),
+      m_requestHeaders(requestHeaders),
+      m_requestBody(hasRequestBody ? new URLRequestCustomJobUploadDevice(this) : nullptr),
+      m_responseStatusCode(0)
 {
 }
 
@@ -78,13 +174,46 @@ QUrl URLRequestCustomJobDelegate::initiator() const
     return m_initiatorOrigin;
 }
 
+QMultiMap<QByteArray, QByteArray> URLRequestCustomJobDelegate::requestHeaders() const
+{
+    return m_requestHeaders;
+}
+
+QIODevice *URLRequestCustomJobDelegate::requestBody() const
+{
+    return m_requestBody;
+}
+
+void URLRequestCustomJobDelegate::appendRequestBody(const QByteArray &chunk, bool finished, bool failed)
+{
+    if (m_requestBody)
+        m_requestBody->append(chunk, finished, failed);
+}
+
+void URLRequestCustomJobDelegate::readRequestBody()
+{
+    content::BrowserThread::PostTask(content::BrowserThread::IO, FROM_HERE,
+                                     base::Bind(&URLRequestCustomJobProxy::readUpload, m_proxy));
+}
+
+void URLRequestCustomJobDelegate::setResponseStatusCode(int statusCode)
+{
+    m_responseStatusCode = statusCode;
+}
+
+void URLRequestCustomJobDelegate::setAdditionalResponseHeaders(const QMultiMap<QByteArray, QByteArray> &headers)
+{
+    m_additionalResponseHeaders = headers;
+}
+
 void URLRequestCustomJobDelegate::reply(const QByteArray &contentType, QIODevice *device)
 {
     if (device)
         QObject::connect(device, &QIODevice::readyRead, this, &URLRequestCustomJobDelegate::slotReadyRead);
     content::BrowserThread::PostTask(content::BrowserThread::IO, FROM_HERE,
                                      base::Bind(&URLRequestCustomJobProxy::reply,
-                                                m_proxy,contentType.toStdString(),device));
+                                                m_proxy, contentType.toStdString(), device,
+                                                m_responseStatusCode, m_additionalResponseHeaders));
 }
 
 void URLRequestCustomJobDelegate::slotReadyRead()
@@ -103,7 +232,7 @@ void URLRequestCustomJobDelegate::redirect(const QUrl &url)
 {
     content::BrowserThread::PostTask(content::BrowserThread::IO, FROM_HERE,
                                      base::Bind(&URLRequestCustomJobProxy::redirect,
-                                                m_proxy, toGurl(url)));
+                                                m_proxy, toGurl(url), m_responseStatusCode));
 }
 
 void URLRequestCustomJobDelegate::fail(Error error)
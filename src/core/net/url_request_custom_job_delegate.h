@@ -54,6 +54,7 @@
 #include "base/memory/ref_counted.h"
 #include "qtwebenginecoreglobal_p.h"
 
+#include <QMap>
 #include <QObject>
 #include <QUrl>
 
@@ -62,6 +63,7 @@ QT_FORWARD_DECLARE_CLASS(QIODevice)
 namespace QtWebEngineCore {
 
 class URLRequestCustomJobProxy;
+class URLRequestCustomJobUploadDevice;
 
 class QWEBENGINECORE_PRIVATE_EXPORT URLRequestCustomJobDelegate : public QObject {
     Q_OBJECT
@@ -80,7 +82,11 @@ public:
     QUrl url() const;
     QByteArray method() const;
     QUrl initiator() const;
+    QMultiMap<QByteArray, QByteArray> requestHeaders() const;
+    QIODevice *requestBody() const;
 
+    void setResponseStatusCode(int statusCode);
+    void setAdditionalResponseHeaders(const QMultiMap<QByteArray, QByteArray> &headers);
     void reply(const QByteArray &contentType, QIODevice *device);
     void redirect(const QUrl& url);
     void abort();
@@ -93,13 +99,23 @@ private:
     URLRequestCustomJobDelegate(URLRequestCustomJobProxy *proxy,
                                 const QUrl &url,
                                 const QByteArray &method,
-                                const QUrl &initiatorOrigin);
+                                const QUrl &initiatorOrigin,
+                                const QMultiMap<QByteArray, QByteArray> &requestHeaders,
+                                bool hasRequestBody);
+
+    void appendRequestBody(const QByteArray &chunk, bool finished, bool failed);
+    void readRequestBody();
 
     friend class URLRequestCustomJobProxy;
+    friend class URLRequestCustomJobUploadDevice;
     scoped_refptr<URLRequestCustomJobProxy> m_proxy;
     QUrl m_request;
     QByteArray m_method;
     QUrl m_initiatorOrigin;
+    QMultiMap<QByteArray, QByteArray> m_requestHeaders;
+    URLRequestCustomJobUploadDevice *m_requestBody;
+    int m_responseStatusCode;
+    QMultiMap<QByteArray, QByteArray> m_additionalResponseHeaders;
 };
 
 } // namespace
@@ -40,10 +40,13 @@
 #include "url_request_custom_job_proxy.h"
 #include "url_request_custom_job.h"
 #include "url_request_custom_job_delegate.h"
+#include "url_request_custom_job_thread_pool.h"
+#include "custom_protocol_handler.h"
 #include "api/qwebengineurlrequestjob.h"
 #include "profile_adapter.h"
 #include "type_conversion.h"
 #include "content/public/browser/browser_thread.h"
+#include "net/http/http_response_headers.h"
 #include "web_engine_context.h"
 
 using namespace net;
@@ -52,12 +55,15 @@ namespace QtWebEngineCore {
 
 URLRequestCustomJobProxy::URLRequestCustomJobProxy(URLRequestCustomJob *job,
                                                    const std::string &scheme,
-                                                   QPointer<ProfileAdapter> profileAdapter)
+                                                   QPointer<ProfileAdapter> profileAdapter,
+                                                   QSharedPointer<ConcurrentUrlSchemeHandlers> concurrentHandlers)
     : m_job(job)
     , m_started(false)
+    , m_workerContext(nullptr)
     , m_scheme(scheme)
     , m_delegate(nullptr)
     , m_profileAdapter(profileAdapter)
+    , m_concurrentHandlers(std::move(concurrentHandlers))
 {
     DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
 }
@@ -66,9 +72,28 @@ URLRequestCustomJobProxy::~URLRequestCustomJobProxy()
 {
 }
 
+void URLRequestCustomJobProxy::start()
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+    if (!m_concurrentHandlers)
+        return;
+    if (m_concurrentHandlers->handlers()->contains(toQByteArray(m_scheme)))
+        m_workerContext = URLRequestCustomJobThreadPool::instance()->nextContext();
+}
+
+void URLRequestCustomJobProxy::postToDelegateThread(const base::Closure &task)
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+    if (m_workerContext)
+        QMetaObject::invokeMethod(m_workerContext, [task]() { task.Run(); }, Qt::QueuedConnection);
+    else
+        content::BrowserThread::PostTask(content::BrowserThread::UI, FROM_HERE, task);
+}
+
 void URLRequestCustomJobProxy::release()
 {
-    DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+    if (!m_workerContext)
+        DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
     if (m_delegate) {
         m_delegate->deleteLater();
         m_delegate = nullptr;
@@ -85,7 +110,8 @@ void URLRequestCustomJobProxy::setReplyCharset(const std::string &charset)
     m_job->m_charset = charset;
 }
 */
-void URLRequestCustomJobProxy::reply(std::string mimeType, QIODevice *device)
+void URLRequestCustomJobProxy::reply(std::string mimeType, QIODevice *device,
+                                     int statusCode, QMultiMap<QByteArray, QByteArray> additionalHeaders)
 {
     DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
     if (!m_job)
@@ -95,10 +121,11 @@ void URLRequestCustomJobProxy::reply(std::string mimeType, QIODevice *device)
     if (m_job->m_device && !m_job->m_device->isReadable())
         m_job->m_device->open(QIODevice::ReadOnly);
 
-    qint64 size = m_job->m_device ? m_job->m_device->size() : -1;
-    if (size > 0)
-        m_job->set_expected_content_size(size);
     if (m_job->m_device && m_job->m_device->isReadable()) {
+        if (!m_job->prepareResponse(statusCode, additionalHeaders)) {
+            fail(ERR_REQUEST_RANGE_NOT_SATISFIABLE);
+            return;
+        }
         m_started = true;
         m_job->NotifyHeadersComplete();
     } else {
@@ -106,7 +133,7 @@ void URLRequestCustomJobProxy::reply(std::string mimeType, QIODevice *device)
     }
 }
 
-void URLRequestCustomJobProxy::redirect(GURL url)
+void URLRequestCustomJobProxy::redirect(GURL url, int statusCode)
 {
     DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
     if (!m_job)
@@ -114,6 +141,7 @@ void URLRequestCustomJobProxy::redirect(GURL url)
     if (m_job->m_device || m_job->m_error)
         return;
     m_job->m_redirect = url;
+    m_job->m_redirectStatusCode = HttpResponseHeaders::IsRedirectResponseCode(statusCode) ? statusCode : 303;
     m_started = true;
     m_job->NotifyHeadersComplete();
 }
@@ -152,27 +180,60 @@ void URLRequestCustomJobProxy::readyRead()
         m_job->notifyReadyRead();
 }
 
-void URLRequestCustomJobProxy::initialize(GURL url, std::string method, base::Optional<url::Origin> initiator)
+void URLRequestCustomJobProxy::readUpload()
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+    if (m_job)
+        m_job->readUploadChunk();
+}
+
+void URLRequestCustomJobProxy::uploadChunk(QByteArray chunk, bool finished, bool failed)
+{
+    // Posted after initialize(), on the thread of the delegate.
+    if (m_delegate)
+        m_delegate->appendRequestBody(chunk, finished, failed);
+}
+
+void URLRequestCustomJobProxy::initialize(GURL url, std::string method, base::Optional<url::Origin> initiator,
+                                          QMultiMap<QByteArray, QByteArray> requestHeaders, bool hasRequestBody)
 {
-    DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
     Q_ASSERT(!m_delegate);
 
-    QUrl initiatorOrigin;
-    if (initiator.has_value())
-        initiatorOrigin = QUrl::fromEncoded(QByteArray::fromStdString(initiator.value().Serialize()));
+    if (m_workerContext) {
+        QSharedPointer<ConcurrentUrlSchemeHandler> handler = m_concurrentHandlers->handlers()->value(toQByteArray(m_scheme));
+        if (!handler)
+            return;
+        // Keep the handler from being removed while it is called. Removing it blocks the UI
+        // thread until this call returns, as documented for QWebEngineConcurrentUrlSchemeHandler.
+        QReadLocker locker(&handler->lock);
+        if (!handler->removed)
+            startRequest(handler->handler, url, method, initiator, requestHeaders, hasRequestBody);
+        return;
+    }
 
+    DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
     QWebEngineUrlSchemeHandler *schemeHandler = nullptr;
 
     if (m_profileAdapter)
         schemeHandler = m_profileAdapter->customUrlSchemeHandlers()[toQByteArray(m_scheme)];
 
-    if (schemeHandler) {
-        m_delegate = new URLRequestCustomJobDelegate(this, toQt(url),
-                                                     QByteArray::fromStdString(method),
-                                                     initiatorOrigin);
-        QWebEngineUrlRequestJob *requestJob = new QWebEngineUrlRequestJob(m_delegate);
-        schemeHandler->requestStarted(requestJob);
-    }
+    if (schemeHandler)
+        startRequest(schemeHandler, url, method, initiator, requestHeaders, hasRequestBody);
+}
+
+void URLRequestCustomJobProxy::startRequest(QWebEngineUrlSchemeHandler *schemeHandler, const GURL &url,
+                                            const std::string &method, const base::Optional<url::Origin> &initiator,
+                                            const QMultiMap<QByteArray, QByteArray> &requestHeaders, bool hasRequestBody)
+{
+    QUrl initiatorOrigin;
+    if (initiator.has_value())
+        initiatorOrigin = QUrl::fromEncoded(QByteArray::fromStdString(initiator.value().Serialize()));
+
+    m_delegate = new URLRequestCustomJobDelegate(this, toQt(url),
+                                                 QByteArray::fromStdString(method),
+                                                 initiatorOrigin, requestHeaders, hasRequestBody);
+    QWebEngineUrlRequestJob *requestJob = new QWebEngineUrlRequestJob(m_delegate);
+    schemeHandler->requestStarted(requestJob);
 }
 
 } // namespace
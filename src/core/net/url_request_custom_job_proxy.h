@@ -40,49 +40,75 @@
 #ifndef URL_REQUEST_CUSTOM_JOB_PROXY_H_
 #define URL_REQUEST_CUSTOM_JOB_PROXY_H_
 
+#include "base/callback.h"
 #include "base/memory/weak_ptr.h"
 #include "base/optional.h"
 #include "url/gurl.h"
 #include "url/origin.h"
+#include <QtCore/QMap>
 #include <QtCore/QPointer>
+#include <QtCore/QSharedPointer>
 
 QT_FORWARD_DECLARE_CLASS(QIODevice)
+QT_FORWARD_DECLARE_CLASS(QWebEngineUrlSchemeHandler)
 
 namespace QtWebEngineCore {
 
 class URLRequestCustomJob;
 class URLRequestCustomJobDelegate;
 class ProfileAdapter;
+class ConcurrentUrlSchemeHandlers;
 
 // Used to comunicate between URLRequestCustomJob living on the IO thread
-// and URLRequestCustomJobDelegate living on the UI thread.
+// and URLRequestCustomJobDelegate living on the UI thread, or on a worker
+// thread of URLRequestCustomJobThreadPool for concurrent scheme handlers.
 class URLRequestCustomJobProxy
     : public base::RefCountedThreadSafe<URLRequestCustomJobProxy> {
 
 public:
+    // Size of the chunks the request body is streamed to the delegate in.
+    static const int kUploadChunkSize = 64 * 1024;
+
     URLRequestCustomJobProxy(URLRequestCustomJob *job,
                              const std::string &scheme,
-                             QPointer<ProfileAdapter> profileAdapter);
+                             QPointer<ProfileAdapter> profileAdapter,
+                             QSharedPointer<ConcurrentUrlSchemeHandlers> concurrentHandlers);
     ~URLRequestCustomJobProxy();
 
     // Called from URLRequestCustomJobDelegate via post:
     //void setReplyCharset(const std::string &);
-    void reply(std::string mimeType, QIODevice *device);
-    void redirect(GURL url);
+    void reply(std::string mimeType, QIODevice *device,
+               int statusCode, QMultiMap<QByteArray, QByteArray> additionalHeaders);
+    void redirect(GURL url, int statusCode);
     void abort();
     void fail(int error);
     void release();
-    void initialize(GURL url, std::string method, base::Optional<url::Origin> initiatorOrigin);
+    void initialize(GURL url, std::string method, base::Optional<url::Origin> initiatorOrigin,
+                    QMultiMap<QByteArray, QByteArray> requestHeaders, bool hasRequestBody);
     void readyRead();
+    void readUpload();
+    void uploadChunk(QByteArray chunk, bool finished, bool failed);
+
+    // Called from URLRequestCustomJob:
+    void start();
+    void postToDelegateThread(const base::Closure &task);
 
     // IO thread owned:
     URLRequestCustomJob *m_job;
     bool m_started;
+    // Set before the delegate is initialized if it runs on a worker thread.
+    QObject *m_workerContext;
 
-    // UI thread owned:
+    // Delegate thread owned:
     std::string m_scheme;
     URLRequestCustomJobDelegate *m_delegate;
     QPointer<ProfileAdapter> m_profileAdapter;
+    QSharedPointer<ConcurrentUrlSchemeHandlers> m_concurrentHandlers;
+
+private:
+    void startRequest(QWebEngineUrlSchemeHandler *schemeHandler, const GURL &url,
+                      const std::string &method, const base::Optional<url::Origin> &initiator,
+                      const QMultiMap<QByteArray, QByteArray> &requestHeaders, bool hasRequestBody);
 };
 
 } // namespace QtWebEngineCore
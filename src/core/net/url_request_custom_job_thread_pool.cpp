@@ -0,0 +1,105 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "url_request_custom_job_thread_pool.h"
+
+#include <QtCore/QObject>
+#include <QtCore/QThread>
+
+#include <algorithm>
+
+namespace QtWebEngineCore {
+
+Q_GLOBAL_STATIC(URLRequestCustomJobThreadPool, customJobThreadPool)
+
+URLRequestCustomJobThreadPool *URLRequestCustomJobThreadPool::instance()
+{
+    return customJobThreadPool();
+}
+
+URLRequestCustomJobThreadPool::URLRequestCustomJobThreadPool()
+{
+}
+
+URLRequestCustomJobThreadPool::~URLRequestCustomJobThreadPool()
+{
+    shutdown();
+    // The contexts are only deleted now, requests still running on the IO thread
+    // after the shutdown may post to them.
+    qDeleteAll(m_contexts);
+    qDeleteAll(m_threads);
+}
+
+void URLRequestCustomJobThreadPool::shutdown()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_shutDown)
+        return;
+    m_shutDown = true;
+    for (QThread *thread : qAsConst(m_threads)) {
+        thread->quit();
+        thread->wait();
+    }
+}
+
+QObject *URLRequestCustomJobThreadPool::nextContext()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_shutDown)
+        return nullptr;
+    if (m_threads.isEmpty()) {
+        // Scheme handlers mostly wait for their devices, a few threads are enough to keep
+        // slow handlers from delaying the others.
+        const int threadCount = std::max(2, std::min(QThread::idealThreadCount(), 4));
+        for (int i = 0; i < threadCount; ++i) {
+            QThread *thread = new QThread;
+            thread->setObjectName(QStringLiteral("QtWebEngineSchemeHandler%1").arg(i));
+            QObject *context = new QObject;
+            context->moveToThread(thread);
+            thread->start();
+            m_threads.append(thread);
+            m_contexts.append(context);
+        }
+    }
+    QObject *context = m_contexts.at(m_next);
+    m_next = (m_next + 1) % m_contexts.size();
+    return context;
+}
+
+} // namespace QtWebEngineCore
@@ -0,0 +1,79 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef URL_REQUEST_CUSTOM_JOB_THREAD_POOL_H_
+#define URL_REQUEST_CUSTOM_JOB_THREAD_POOL_H_
+
+#include <QtCore/QMutex>
+#include <QtCore/QVector>
+
+QT_FORWARD_DECLARE_CLASS(QObject)
+QT_FORWARD_DECLARE_CLASS(QThread)
+
+namespace QtWebEngineCore {
+
+// Worker threads running the QWebEngineConcurrentUrlSchemeHandlers and the delegates
+// of their requests, each with its own event loop.
+class URLRequestCustomJobThreadPool {
+public:
+    static URLRequestCustomJobThreadPool *instance();
+
+    URLRequestCustomJobThreadPool();
+    ~URLRequestCustomJobThreadPool();
+
+    // Returns an object living on one of the worker threads, in turn, to invoke
+    // the initialization of a request on. May be called from any thread, returns
+    // null once the pool was shut down.
+    QObject *nextContext();
+
+    // Stops the worker threads when the browser's main message loop is done, before
+    // the handlers and the application objects they might use are destroyed.
+    void shutdown();
+
+private:
+    QMutex m_mutex;
+    QVector<QThread *> m_threads;
+    QVector<QObject *> m_contexts;
+    int m_next = 0;
+    bool m_shutDown = false;
+};
+
+} // namespace QtWebEngineCore
+
+#endif // URL_REQUEST_CUSTOM_JOB_THREAD_POOL_H_
@@ -45,18 +45,56 @@
 #include "base/threading/thread_task_runner_handle.h"
 #include "net/base/net_errors.h"
 #include "net/base/io_buffer.h"
+#include "net/http/http_request_headers.h"
+#include "net/http/http_response_info.h"
+#include "net/http/http_util.h"
 
 #include <QUrl>
+#include <QDateTime>
 #include <QFileInfo>
+#include <QHash>
+#include <QLocale>
 #include <QMimeDatabase>
 #include <QMimeType>
+#include <QResource>
 
 using namespace net;
 namespace QtWebEngineCore {
 
+typedef QHash<QString, std::string> MimeTypeCache;
+// Only accessed on the IO thread.
+Q_GLOBAL_STATIC(MimeTypeCache, mimeTypesBySuffix)
+
+// Resolving the MIME type by content means reading the resource, so resolve it
+// by file name only and remember the result for the suffix. Names that say
+// nothing about their type still get their content inspected.
+static std::string mimeTypeForResource(const QFileInfo &fileInfo)
+{
+    // Only the last suffix, "jquery-3.3.1.min.js" has to share the entry of "js".
+    const QString suffix = fileInfo.suffix();
+    if (!suffix.isEmpty()) {
+        auto it = mimeTypesBySuffix->constFind(suffix);
+        if (it != mimeTypesBySuffix->constEnd())
+            return *it;
+    }
+    QMimeDatabase mimeDatabase;
+    if (!suffix.isEmpty()) {
+        QMimeType mimeType = mimeDatabase.mimeTypeForFile(fileInfo, QMimeDatabase::MatchExtension);
+        if (!mimeType.isDefault()) {
+            std::string name = mimeType.name().toStdString();
+            // Types matched by a longer suffix like "tar.gz" don't apply to the others.
+            if (mimeDatabase.suffixForFileName(fileInfo.fileName()) == suffix)
+                mimeTypesBySuffix->insert(suffix, name);
+            return name;
+        }
+    }
+    return mimeDatabase.mimeTypeForFile(fileInfo).name().toStdString();
+}
+
 URLRequestQrcJobQt::URLRequestQrcJobQt(URLRequest *request, NetworkDelegate *networkDelegate)
     : URLRequestJob(request, networkDelegate)
     , m_remainingBytes(0)
+    , m_data(nullptr)
     , m_weakFactory(this)
 {
 }
@@ -76,6 +114,7 @@ void URLRequestQrcJobQt::Kill()
 {
     if (m_file.isOpen())
         m_file.close();
+    m_data = nullptr;
     m_weakFactory.InvalidateWeakPtrs();
 
     URLRequestJob::Kill();
@@ -91,6 +130,19 @@ bool URLRequestQrcJobQt::GetMimeType(std::string *mimeType) const
     return false;
 }
 
+void URLRequestQrcJobQt::GetResponseInfo(HttpResponseInfo *info)
+{
+    if (m_responseHeaders)
+        info->headers = m_responseHeaders;
+}
+
+int URLRequestQrcJobQt::GetResponseCode() const
+{
+    if (m_responseHeaders)
+        return m_responseHeaders->response_code();
+    return URLRequestJob::GetResponseCode();
+}
+
 int URLRequestQrcJobQt::ReadRawData(IOBuffer *buf, int bufSize)
 {
     DCHECK_GE(m_remainingBytes, 0);
@@ -100,6 +152,12 @@ int URLRequestQrcJobQt::ReadRawData(IOBuffer *buf, int bufSize)
     }
     if (m_remainingBytes < bufSize)
         bufSize = static_cast<int>(m_remainingBytes);
+    if (m_data) {
+        memcpy(buf->data(), m_data, bufSize);
+        m_data += bufSize;
+        m_remainingBytes -= bufSize;
+        return bufSize;
+    }
     qint64 rv = m_file.read(buf->data(), bufSize);
     if (rv >= 0) {
         m_remainingBytes -= rv;
@@ -113,21 +171,65 @@ void URLRequestQrcJobQt::startGetHead()
 {
     // Get qrc file path.
     QString qrcFilePath = ':' + toQt(request_->url()).path();
-    m_file.setFileName(qrcFilePath);
-    QFileInfo qrcFileInfo(m_file);
+    QFileInfo qrcFileInfo(qrcFilePath);
     // Get qrc file mime type.
-    QMimeDatabase mimeDatabase;
-    QMimeType mimeType = mimeDatabase.mimeTypeForFile(qrcFileInfo);
-    m_mimeType = mimeType.name().toStdString();
-    // Open file
-    if (m_file.open(QIODevice::ReadOnly) && m_file.size() > 0) {
-        m_remainingBytes = m_file.size();
-        set_expected_content_size(m_remainingBytes);
-        // Notify that the headers are complete
-        NotifyHeadersComplete();
+    m_mimeType = mimeTypeForResource(qrcFileInfo);
+
+    QResource resource(qrcFilePath);
+    if (!resource.isValid() || resource.size() <= 0) {
+        qWarning("Resource %s not found or is empty", qUtf8Printable(qrcFilePath));
+        NotifyStartError(URLRequestStatus(URLRequestStatus::FAILED, ERR_INVALID_URL));
         return;
     }
-    qWarning("Resource %s not found or is empty", qUtf8Printable(qrcFilePath));
-    NotifyStartError(URLRequestStatus(URLRequestStatus::FAILED, ERR_INVALID_URL));
+
+    if (resource.isCompressed()) {
+        m_file.setFileName(qrcFilePath);
+        if (!m_file.open(QIODevice::ReadOnly) || m_file.size() <= 0) {
+            qWarning("Resource %s not found or is empty", qUtf8Printable(qrcFilePath));
+            NotifyStartError(URLRequestStatus(URLRequestStatus::FAILED, ERR_INVALID_URL));
+            return;
+        }
+        m_remainingBytes = m_file.size();
+    } else {
+        // Resource data stays mapped for as long as the resource is registered.
+        m_data = resource.data();
+        m_remainingBytes = resource.size();
+    }
+
+    // Resources compiled with a timestamp get validators, so that repeated loads
+    // can be answered from the memory cache or revalidated without a body.
+    const QDateTime lastModified = resource.lastModified();
+    if (lastModified.isValid()) {
+        const std::string etag = QStringLiteral("\"%1-%2\"").arg(lastModified.toMSecsSinceEpoch(), 0, 16)
+                                                            .arg(m_remainingBytes, 0, 16).toStdString();
+        const std::string lastModifiedString = QLocale::c().toString(lastModified.toUTC(),
+                                                                     QStringLiteral("ddd, dd MMM yyyy hh:mm:ss 'GMT'")).toStdString();
+        const HttpRequestHeaders &requestHeaders = request_->extra_request_headers();
+        std::string ifNoneMatch, ifModifiedSince;
+        bool notModified = false;
+        if (requestHeaders.GetHeader(HttpRequestHeaders::kIfNoneMatch, &ifNoneMatch))
+            notModified = ifNoneMatch == etag;
+        else if (requestHeaders.GetHeader(HttpRequestHeaders::kIfModifiedSince, &ifModifiedSince))
+            notModified = ifModifiedSince == lastModifiedString;
+        if (notModified) {
+            if (m_file.isOpen())
+                m_file.close();
+            m_data = nullptr;
+            m_remainingBytes = 0;
+        }
+
+        std::string rawHeaders = notModified ? "HTTP/1.1 304 Not Modified\n" : "HTTP/1.1 200 OK\n";
+        rawHeaders += "ETag: " + etag + "\n";
+        rawHeaders += "Last-Modified: " + lastModifiedString + "\n";
+        if (!notModified) {
+            rawHeaders += std::string(HttpRequestHeaders::kContentType) + ": " + m_mimeType + "\n";
+            rawHeaders += std::string(HttpRequestHeaders::kContentLength) + ": " + std::to_string(m_remainingBytes) + "\n";
+        }
+        m_responseHeaders = new HttpResponseHeaders(HttpUtil::AssembleRawHeaders(rawHeaders.c_str(), rawHeaders.size()));
+    }
+
+    set_expected_content_size(m_remainingBytes);
+    // Notify that the headers are complete
+    NotifyHeadersComplete();
 }
 } // namespace QtWebEngineCore
@@ -40,6 +40,7 @@
 #ifndef URL_REQUEST_QRC_JOB_QT_H_
 #define URL_REQUEST_QRC_JOB_QT_H_
 
+#include "net/http/http_response_headers.h"
 #include "net/url_request/url_request.h"
 #include "net/url_request/url_request_job.h"
 
@@ -56,6 +57,8 @@ public:
     void Kill() override;
     int ReadRawData(net::IOBuffer* buf, int buf_size)  override;;
     bool GetMimeType(std::string *mimeType) const override;
+    void GetResponseInfo(net::HttpResponseInfo *info) override;
+    int GetResponseCode() const override;
 
 protected:
     virtual ~URLRequestQrcJobQt();
@@ -64,8 +67,12 @@ protected:
 
 private:
     qint64 m_remainingBytes;
+    // Uncompressed resources are read straight from their mapped memory,
+    // only compressed ones go through m_file.
+    const uchar *m_data;
     QFile m_file;
     std::string m_mimeType;
+    scoped_refptr<net::HttpResponseHeaders> m_responseHeaders;
     base::WeakPtrFactory<URLRequestQrcJobQt> m_weakFactory;
 
     DISALLOW_COPY_AND_ASSIGN(URLRequestQrcJobQt);
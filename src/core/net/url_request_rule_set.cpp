@@ -0,0 +1,858 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "url_request_rule_set.h"
+
+#include "url/gurl.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QMap>
+#include <QtCore/QSaveFile>
+#include <QtCore/QVector>
+
+#include <QtCore/QVarLengthArray>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+namespace QtWebEngineCore {
+
+namespace {
+
+const char kMagic[8] = { 'Q', 'W', 'E', 'R', 'U', 'L', 'E', 'S' };
+const quint32 kVersion = 2;
+const quint32 kNone = 0xffffffff;
+
+enum RuleFlag : quint32 {
+    AllowRule = 0x1,
+    RedirectRule = 0x2,
+    HostAnchor = 0x4,    // "||" prefix, matches at the start of the host or one of its labels
+    StartAnchor = 0x8,   // "|" prefix
+    EndAnchor = 0x10,    // "|" suffix
+    VerifyPattern = 0x20 // the indexed literal is only part of the pattern
+};
+
+static_assert(content::RESOURCE_TYPE_LAST_TYPE < 31, "Resource types must fit in the type mask");
+const quint32 kUnknownTypeBit = 1u << 31;
+
+quint32 typeBit(content::ResourceType type)
+{
+    return type >= 0 && type < content::RESOURCE_TYPE_LAST_TYPE ? 1u << type : kUnknownTypeBit;
+}
+
+// Like Adblock, rules without type options do not apply to top level documents.
+const quint32 kDefaultTypeMask = ~typeBit(content::RESOURCE_TYPE_MAIN_FRAME);
+
+quint32 optionTypeMask(const QByteArray &option)
+{
+    if (option == "script")
+        return typeBit(content::RESOURCE_TYPE_SCRIPT);
+    if (option == "image")
+        return typeBit(content::RESOURCE_TYPE_IMAGE) | typeBit(content::RESOURCE_TYPE_FAVICON);
+    if (option == "stylesheet")
+        return typeBit(content::RESOURCE_TYPE_STYLESHEET);
+    if (option == "object")
+        return typeBit(content::RESOURCE_TYPE_OBJECT) | typeBit(content::RESOURCE_TYPE_PLUGIN_RESOURCE);
+    if (option == "xmlhttprequest")
+        return typeBit(content::RESOURCE_TYPE_XHR);
+    if (option == "subdocument")
+        return typeBit(content::RESOURCE_TYPE_SUB_FRAME);
+    if (option == "document")
+        return typeBit(content::RESOURCE_TYPE_MAIN_FRAME);
+    if (option == "media")
+        return typeBit(content::RESOURCE_TYPE_MEDIA);
+    if (option == "font")
+        return typeBit(content::RESOURCE_TYPE_FONT_RESOURCE);
+    if (option == "ping")
+        return typeBit(content::RESOURCE_TYPE_PING) | typeBit(content::RESOURCE_TYPE_CSP_REPORT);
+    if (option == "other")
+        return typeBit(content::RESOURCE_TYPE_SUB_RESOURCE) | typeBit(content::RESOURCE_TYPE_PREFETCH)
+                | typeBit(content::RESOURCE_TYPE_WORKER) | typeBit(content::RESOURCE_TYPE_SHARED_WORKER)
+                | typeBit(content::RESOURCE_TYPE_SERVICE_WORKER) | kUnknownTypeBit;
+    return 0;
+}
+
+inline char toLower(char c)
+{
+    return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+}
+
+// The "^" placeholder matches anything but a letter, a digit or one of "_-.%".
+inline bool isSeparator(char c)
+{
+    return !((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+             || c == '_' || c == '-' || c == '.' || c == '%');
+}
+
+bool isHostName(const QByteArray &pattern)
+{
+    if (pattern.isEmpty() || pattern.startsWith('.') || pattern.endsWith('.') || pattern.contains(".."))
+        return false;
+    for (char c : pattern) {
+        if (!((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '_' || c == '.'))
+            return false;
+    }
+    return true;
+}
+
+// Matches the pattern against the start of the text, to its end with toEnd. A "^" may match
+// the end of the text if it is the end of the URL. Only the last "*" seen is ever retried, so
+// the match takes linear space and at most pattern times text steps.
+template <typename Iterator>
+bool matchGlob(Iterator p, Iterator pEnd, Iterator t, Iterator tEnd, bool toEnd, bool atUrlEnd)
+{
+    Iterator starP = pEnd;
+    Iterator starT = tEnd;
+    forever {
+        if (p != pEnd && *p == '*') {
+            starP = ++p;
+            starT = t;
+            continue;
+        }
+        if (p == pEnd) {
+            if (!toEnd || t == tEnd)
+                return true;
+        } else if (t == tEnd) {
+            if (*p == '^' && atUrlEnd) {
+                ++p;
+                continue;
+            }
+        } else if (*p == '^' ? isSeparator(*t) : toLower(*t) == *p) {
+            ++p;
+            ++t;
+            continue;
+        }
+        // Let the last "*" take one more character.
+        if (starT == tEnd)
+            return false;
+        p = starP;
+        t = ++starT;
+    }
+}
+
+inline bool matchPattern(const char *p, const char *pEnd, const char *t, const char *tEnd, bool toEnd, bool atUrlEnd)
+{
+    return matchGlob(p, pEnd, t, tEnd, toEnd, atUrlEnd);
+}
+
+// Matches the pattern against the text right before tEnd, back to tBegin with toBegin.
+inline bool matchPatternBefore(const char *p, const char *pEnd, const char *tBegin, const char *tEnd, bool toBegin)
+{
+    typedef std::reverse_iterator<const char *> Reverse;
+    return matchGlob(Reverse(pEnd), Reverse(p), Reverse(tEnd), Reverse(tBegin), toBegin, false);
+}
+
+struct StringRef {
+    quint32 offset;
+    quint32 length;
+};
+
+struct RuleSetHeader {
+    char magic[8];
+    quint32 version;
+    quint32 size;
+    quint32 skippedLineCount;
+    quint32 ruleCount, ruleOffset;
+    quint32 hostNodeCount, hostNodeOffset;
+    quint32 matcherNodeCount, matcherNodeOffset;
+    quint32 matcherEdgeCount, matcherEdgeOffset;
+    quint32 ruleIndexCount, ruleIndexOffset;
+    quint32 stringSize, stringOffset;
+};
+
+struct Rule {
+    quint32 flags;
+    quint32 resourceTypes;
+    StringRef text;
+    StringRef pattern; // lower case, without anchors and options
+    StringRef redirect;
+    quint32 literalOffset, literalLength; // the indexed part of the pattern
+};
+
+// Host trie nodes are stored breadth first with the children of a node next to each
+// other and sorted by label, the root is the first node.
+struct HostNode {
+    StringRef label;
+    quint32 firstChild, childCount;
+    quint32 firstRule, ruleCount;
+};
+
+// Aho-Corasick automaton nodes, stored breadth first so that failure and output links
+// always point backwards. The output link is the closest node on the failure chain
+// that has rules, or kNone.
+struct MatcherNode {
+    quint32 firstEdge, edgeCount;
+    quint32 failure, output;
+    quint32 firstRule, ruleCount;
+};
+
+struct MatcherEdge {
+    quint32 byte;
+    quint32 target;
+};
+
+inline const RuleSetHeader *header(const uchar *data)
+{
+    return reinterpret_cast<const RuleSetHeader *>(data);
+}
+
+template <typename T>
+inline const T *table(const uchar *data, quint32 offset)
+{
+    return reinterpret_cast<const T *>(data + offset);
+}
+
+class RuleSetBuilder {
+public:
+    RuleSetBuilder()
+        : m_hostNodes(1)
+        , m_matcherNodes(1)
+    {}
+
+    void addLine(const QByteArray &line);
+    QByteArray build();
+
+private:
+    struct ParsedRule {
+        quint32 flags = 0;
+        quint32 resourceTypes = 0;
+        QByteArray text;
+        QByteArray pattern;
+        QByteArray redirect;
+        int literalOffset = 0;
+        int literalLength = 0;
+    };
+    struct TrieNode {
+        QMap<QByteArray, int> children;
+        QVector<quint32> rules;
+    };
+
+    StringRef addString(const QByteArray &string);
+    quint32 addRuleIndices(const QVector<quint32> &rules);
+    static int child(QVector<TrieNode> &nodes, int node, const QByteArray &key);
+    static QVector<int> breadthFirstOrder(const QVector<TrieNode> &nodes);
+
+    QVector<ParsedRule> m_rules;
+    QVector<TrieNode> m_hostNodes;
+    QVector<TrieNode> m_matcherNodes;
+    QByteArray m_strings;
+    QVector<quint32> m_ruleIndices;
+    quint32 m_skippedLineCount = 0;
+};
+
+void RuleSetBuilder::addLine(const QByteArray &line)
+{
+    // Comments and the list header.
+    if (line.isEmpty() || line.startsWith('!') || line.startsWith('['))
+        return;
+
+    ParsedRule rule;
+    rule.text = line;
+    QByteArray pattern = line;
+    if (pattern.startsWith("@@")) {
+        rule.flags |= AllowRule;
+        pattern.remove(0, 2);
+    }
+
+    // Element hiding and regular expression rules are not for the network stack.
+    if (line.contains("##") || line.contains("#@#") || line.contains("#?#")
+            || (pattern.size() > 1 && pattern.startsWith('/') && pattern.endsWith('/'))) {
+        ++m_skippedLineCount;
+        return;
+    }
+
+    quint32 excludedTypes = 0;
+    const int optionsIndex = pattern.lastIndexOf('$');
+    if (optionsIndex >= 0) {
+        const QList<QByteArray> options = pattern.mid(optionsIndex + 1).split(',');
+        pattern.truncate(optionsIndex);
+        for (QByteArray option : options) {
+            option = option.trimmed();
+            if (option.startsWith("redirect=")) {
+                rule.redirect = option.mid(9);
+                rule.flags |= RedirectRule;
+                continue;
+            }
+            QByteArray name = option.toLower();
+            const bool excluded = name.startsWith('~');
+            if (excluded)
+                name.remove(0, 1);
+            const quint32 mask = optionTypeMask(name);
+            // Options like third-party or domain= would need more than the URL.
+            if (!mask) {
+                ++m_skippedLineCount;
+                return;
+            }
+            if (excluded)
+                excludedTypes |= mask;
+            else
+                rule.resourceTypes |= mask;
+        }
+    }
+    if (!rule.resourceTypes)
+        rule.resourceTypes = kDefaultTypeMask;
+    rule.resourceTypes &= ~excludedTypes;
+
+    if (rule.flags & RedirectRule) {
+        if ((rule.flags & AllowRule) || !GURL(rule.redirect.toStdString()).is_valid()) {
+            ++m_skippedLineCount;
+            return;
+        }
+    }
+
+    pattern = pattern.toLower();
+    if (pattern.startsWith("||")) {
+        rule.flags |= HostAnchor;
+        pattern.remove(0, 2);
+    } else if (pattern.startsWith('|')) {
+        rule.flags |= StartAnchor;
+        pattern.remove(0, 1);
+    }
+    if (pattern.endsWith('|')) {
+        rule.flags |= EndAnchor;
+        pattern.chop(1);
+    }
+    if (pattern.startsWith('*'))
+        rule.flags &= ~(HostAnchor | StartAnchor);
+    if (pattern.endsWith('*'))
+        rule.flags &= ~EndAnchor;
+    while (pattern.startsWith('*'))
+        pattern.remove(0, 1);
+    while (pattern.endsWith('*'))
+        pattern.chop(1);
+
+    if (pattern.isEmpty() || pattern.contains('|')) {
+        ++m_skippedLineCount;
+        return;
+    }
+
+    const quint32 index = m_rules.size();
+
+    // "||host^" rules, the bulk of most lists, go into the host trie.
+    if ((rule.flags & HostAnchor) && !(rule.flags & EndAnchor) && pattern.endsWith('^')
+            && isHostName(pattern.left(pattern.size() - 1))) {
+        const QList<QByteArray> labels = pattern.left(pattern.size() - 1).split('.');
+        int node = 0;
+        for (auto label = labels.crbegin(); label != labels.crend(); ++label)
+            node = child(m_hostNodes, node, *label);
+        m_hostNodes[node].rules.append(index);
+    } else {
+        // Index the longest literal part of the pattern and verify the rest on a hit.
+        QByteArray literal;
+        int start = 0;
+        while (start < pattern.size()) {
+            int end = start;
+            while (end < pattern.size() && pattern.at(end) != '*' && pattern.at(end) != '^')
+                ++end;
+            if (end - start > literal.size()) {
+                literal = pattern.mid(start, end - start);
+                rule.literalOffset = start;
+            }
+            start = end + 1;
+        }
+        rule.literalLength = literal.size();
+        if (literal.isEmpty()) {
+            ++m_skippedLineCount;
+            return;
+        }
+        if (literal != pattern || (rule.flags & (HostAnchor | StartAnchor | EndAnchor)))
+            rule.flags |= VerifyPattern;
+        int node = 0;
+        for (char c : qAsConst(literal))
+            node = child(m_matcherNodes, node, QByteArray(1, c));
+        m_matcherNodes[node].rules.append(index);
+    }
+
+    rule.pattern = pattern;
+    m_rules.append(rule);
+}
+
+int RuleSetBuilder::child(QVector<TrieNode> &nodes, int node, const QByteArray &key)
+{
+    int next = nodes[node].children.value(key, -1);
+    if (next < 0) {
+        next = nodes.size();
+        nodes[node].children.insert(key, next);
+        nodes.append(TrieNode());
+    }
+    return next;
+}
+
+// Orders the nodes so that the children of each node are next to each other.
+QVector<int> RuleSetBuilder::breadthFirstOrder(const QVector<TrieNode> &nodes)
+{
+    QVector<int> order;
+    order.reserve(nodes.size());
+    order.append(0);
+    for (int i = 0; i < order.size(); ++i) {
+        for (int child : nodes.at(order.at(i)).children)
+            order.append(child);
+    }
+    return order;
+}
+
+StringRef RuleSetBuilder::addString(const QByteArray &string)
+{
+    StringRef ref = { quint32(m_strings.size()), quint32(string.size()) };
+    m_strings.append(string);
+    return ref;
+}
+
+quint32 RuleSetBuilder::addRuleIndices(const QVector<quint32> &rules)
+{
+    const quint32 first = m_ruleIndices.size();
+    m_ruleIndices.append(rules);
+    return first;
+}
+
+template <typename T>
+quint32 appendTable(QByteArray *blob, const QVector<T> &table)
+{
+    const quint32 offset = blob->size();
+    blob->append(reinterpret_cast<const char *>(table.constData()), table.size() * sizeof(T));
+    while (blob->size() % sizeof(quint32))
+        blob->append('\0');
+    return offset;
+}
+
+QByteArray RuleSetBuilder::build()
+{
+    QVector<Rule> rules;
+    rules.reserve(m_rules.size());
+    for (const ParsedRule &parsed : qAsConst(m_rules)) {
+        Rule rule;
+        rule.flags = parsed.flags;
+        rule.resourceTypes = parsed.resourceTypes;
+        rule.text = addString(parsed.text);
+        rule.pattern = addString(parsed.pattern);
+        rule.redirect = addString(parsed.redirect);
+        rule.literalOffset = parsed.literalOffset;
+        rule.literalLength = parsed.literalLength;
+        rules.append(rule);
+    }
+
+    const QVector<int> hostOrder = breadthFirstOrder(m_hostNodes);
+    QVector<int> hostIndex(m_hostNodes.size());
+    for (int i = 0; i < hostOrder.size(); ++i)
+        hostIndex[hostOrder.at(i)] = i;
+    QVector<HostNode> hostNodes;
+    hostNodes.reserve(hostOrder.size());
+    for (int old : hostOrder) {
+        const TrieNode &node = m_hostNodes.at(old);
+        HostNode hostNode;
+        hostNode.label = { 0, 0 };
+        hostNode.firstChild = node.children.isEmpty() ? 0 : hostIndex.at(node.children.first());
+        hostNode.childCount = node.children.size();
+        hostNode.firstRule = addRuleIndices(node.rules);
+        hostNode.ruleCount = node.rules.size();
+        hostNodes.append(hostNode);
+    }
+    for (int old : hostOrder) {
+        for (auto it = m_hostNodes.at(old).children.cbegin(); it != m_hostNodes.at(old).children.cend(); ++it)
+            hostNodes[hostIndex.at(it.value())].label = addString(it.key());
+    }
+
+    // Failure links, computed in breadth first order so shorter prefixes are done first.
+    const QVector<int> matcherOrder = breadthFirstOrder(m_matcherNodes);
+    QVector<int> failure(m_matcherNodes.size(), 0);
+    QVector<int> output(m_matcherNodes.size(), -1);
+    for (int node : matcherOrder) {
+        for (auto it = m_matcherNodes.at(node).children.cbegin(); it != m_matcherNodes.at(node).children.cend(); ++it) {
+            const int next = it.value();
+            if (node != 0) {
+                int state = failure.at(node);
+                while (state != 0 && !m_matcherNodes.at(state).children.contains(it.key()))
+                    state = failure.at(state);
+                failure[next] = m_matcherNodes.at(state).children.value(it.key(), 0);
+            }
+            const int fallback = failure.at(next);
+            output[next] = m_matcherNodes.at(fallback).rules.isEmpty() ? output.at(fallback) : fallback;
+        }
+    }
+    QVector<int> matcherIndex(m_matcherNodes.size());
+    for (int i = 0; i < matcherOrder.size(); ++i)
+        matcherIndex[matcherOrder.at(i)] = i;
+    QVector<MatcherNode> matcherNodes;
+    QVector<MatcherEdge> matcherEdges;
+    matcherNodes.reserve(matcherOrder.size());
+    for (int old : matcherOrder) {
+        const TrieNode &node = m_matcherNodes.at(old);
+        MatcherNode matcherNode;
+        matcherNode.firstEdge = matcherEdges.size();
+        matcherNode.edgeCount = node.children.size();
+        for (auto it = node.children.cbegin(); it != node.children.cend(); ++it)
+            matcherEdges.append({ uchar(it.key().at(0)), quint32(matcherIndex.at(it.value())) });
+        matcherNode.failure = matcherIndex.at(failure.at(old));
+        matcherNode.output = output.at(old) < 0 ? kNone : matcherIndex.at(output.at(old));
+        matcherNode.firstRule = addRuleIndices(node.rules);
+        matcherNode.ruleCount = node.rules.size();
+        matcherNodes.append(matcherNode);
+    }
+
+    QByteArray blob(sizeof(RuleSetHeader), '\0');
+    RuleSetHeader h;
+    memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kVersion;
+    h.skippedLineCount = m_skippedLineCount;
+    h.ruleCount = rules.size();
+    h.ruleOffset = appendTable(&blob, rules);
+    h.hostNodeCount = hostNodes.size();
+    h.hostNodeOffset = appendTable(&blob, hostNodes);
+    h.matcherNodeCount = matcherNodes.size();
+    h.matcherNodeOffset = appendTable(&blob, matcherNodes);
+    h.matcherEdgeCount = matcherEdges.size();
+    h.matcherEdgeOffset = appendTable(&blob, matcherEdges);
+    h.ruleIndexCount = m_ruleIndices.size();
+    h.ruleIndexOffset = appendTable(&blob, m_ruleIndices);
+    h.stringSize = m_strings.size();
+    h.stringOffset = blob.size();
+    blob.append(m_strings);
+    h.size = blob.size();
+    memcpy(blob.data(), &h, sizeof(h));
+    return blob;
+}
+
+} // namespace
+
+URLRequestRuleSet::URLRequestRuleSet()
+{
+}
+
+URLRequestRuleSet::~URLRequestRuleSet()
+{
+}
+
+QSharedPointer<URLRequestRuleSet> URLRequestRuleSet::compile(const QByteArray &filterList)
+{
+    RuleSetBuilder builder;
+    const QList<QByteArray> lines = filterList.split('\n');
+    for (const QByteArray &line : lines)
+        builder.addLine(line.trimmed());
+
+    QSharedPointer<URLRequestRuleSet> ruleSet(new URLRequestRuleSet);
+    ruleSet->m_compiled = builder.build();
+    if (!ruleSet->attach(reinterpret_cast<const uchar *>(ruleSet->m_compiled.constData()), ruleSet->m_compiled.size()))
+        return QSharedPointer<URLRequestRuleSet>();
+    return ruleSet;
+}
+
+QSharedPointer<URLRequestRuleSet> URLRequestRuleSet::load(const QString &fileName)
+{
+    QSharedPointer<URLRequestRuleSet> ruleSet(new URLRequestRuleSet);
+    ruleSet->m_file.reset(new QFile(fileName));
+    if (!ruleSet->m_file->open(QIODevice::ReadOnly))
+        return QSharedPointer<URLRequestRuleSet>();
+
+    const qint64 size = ruleSet->m_file->size();
+    const uchar *data = ruleSet->m_file->map(0, size);
+    if (!data) {
+        // Not every file system supports mapping, read it instead.
+        ruleSet->m_compiled = ruleSet->m_file->readAll();
+        ruleSet->m_file.reset();
+        data = reinterpret_cast<const uchar *>(ruleSet->m_compiled.constData());
+    }
+    if (!ruleSet->attach(data, size))
+        return QSharedPointer<URLRequestRuleSet>();
+    return ruleSet;
+}
+
+// Checks every table of a compiled rule set, which may come from an untrusted file, so that
+// evaluate() can use it without bounds checks and its loops terminate.
+bool URLRequestRuleSet::attach(const uchar *data, qint64 size)
+{
+    if (size < qint64(sizeof(RuleSetHeader)) || size > std::numeric_limits<quint32>::max())
+        return false;
+    const RuleSetHeader *h = header(data);
+    if (memcmp(h->magic, kMagic, sizeof(kMagic)) != 0 || h->version != kVersion || h->size != size)
+        return false;
+
+    auto validTable = [size](quint32 offset, quint32 count, size_t elementSize) {
+        return offset % sizeof(quint32) == 0 && offset >= sizeof(RuleSetHeader)
+                && quint64(offset) + quint64(count) * elementSize <= quint64(size);
+    };
+    if (!validTable(h->ruleOffset, h->ruleCount, sizeof(Rule))
+            || !validTable(h->hostNodeOffset, h->hostNodeCount, sizeof(HostNode))
+            || !validTable(h->matcherNodeOffset, h->matcherNodeCount, sizeof(MatcherNode))
+            || !validTable(h->matcherEdgeOffset, h->matcherEdgeCount, sizeof(MatcherEdge))
+            || !validTable(h->ruleIndexOffset, h->ruleIndexCount, sizeof(quint32))
+            || !validTable(h->stringOffset, h->stringSize, 1)
+            || h->ruleCount > quint32(std::numeric_limits<int>::max())
+            || h->hostNodeCount == 0 || h->matcherNodeCount == 0)
+        return false;
+
+    auto validString = [h](const StringRef &string) {
+        return quint64(string.offset) + string.length <= h->stringSize;
+    };
+    auto validRange = [](quint32 first, quint32 count, quint32 size) {
+        return quint64(first) + count <= size;
+    };
+
+    const Rule *rules = table<Rule>(data, h->ruleOffset);
+    for (quint32 i = 0; i < h->ruleCount; ++i) {
+        if (!validString(rules[i].text) || !validString(rules[i].pattern) || !validString(rules[i].redirect)
+                || !validRange(rules[i].literalOffset, rules[i].literalLength, rules[i].pattern.length))
+            return false;
+    }
+    const quint32 *ruleIndices = table<quint32>(data, h->ruleIndexOffset);
+    for (quint32 i = 0; i < h->ruleIndexCount; ++i) {
+        if (ruleIndices[i] >= h->ruleCount)
+            return false;
+    }
+    const HostNode *hostNodes = table<HostNode>(data, h->hostNodeOffset);
+    for (quint32 i = 0; i < h->hostNodeCount; ++i) {
+        const HostNode &node = hostNodes[i];
+        if (!validString(node.label) || !validRange(node.firstRule, node.ruleCount, h->ruleIndexCount)
+                || (node.childCount && (node.firstChild <= i || !validRange(node.firstChild, node.childCount, h->hostNodeCount))))
+            return false;
+    }
+    const MatcherNode *matcherNodes = table<MatcherNode>(data, h->matcherNodeOffset);
+    const MatcherEdge *matcherEdges = table<MatcherEdge>(data, h->matcherEdgeOffset);
+    for (quint32 i = 0; i < h->matcherNodeCount; ++i) {
+        const MatcherNode &node = matcherNodes[i];
+        if (!validRange(node.firstRule, node.ruleCount, h->ruleIndexCount)
+                || !validRange(node.firstEdge, node.edgeCount, h->matcherEdgeCount)
+                || (i ? node.failure >= i : node.failure != 0)
+                || (node.output != kNone && node.output >= i))
+            return false;
+        for (quint32 e = node.firstEdge; e < node.firstEdge + node.edgeCount; ++e) {
+            if (matcherEdges[e].byte > 0xff || matcherEdges[e].target <= i || matcherEdges[e].target >= h->matcherNodeCount)
+                return false;
+        }
+    }
+
+    m_data = data;
+    m_hitCounts.reset(new QAtomicInt[h->ruleCount]);
+    return true;
+}
+
+bool URLRequestRuleSet::save(const QString &fileName) const
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    const qint64 size = header(m_data)->size;
+    if (file.write(reinterpret_cast<const char *>(m_data), size) != size)
+        return false;
+    return file.commit();
+}
+
+int URLRequestRuleSet::ruleCount() const
+{
+    return header(m_data)->ruleCount;
+}
+
+int URLRequestRuleSet::skippedLineCount() const
+{
+    return header(m_data)->skippedLineCount;
+}
+
+QByteArray URLRequestRuleSet::ruleText(int index) const
+{
+    Q_ASSERT(index >= 0 && index < ruleCount());
+    const RuleSetHeader *h = header(m_data);
+    const StringRef &text = table<Rule>(m_data, h->ruleOffset)[index].text;
+    return QByteArray(table<char>(m_data, h->stringOffset + text.offset), text.length);
+}
+
+int URLRequestRuleSet::hitCount(int index) const
+{
+    Q_ASSERT(index >= 0 && index < ruleCount());
+    return m_hitCounts[index].load();
+}
+
+void URLRequestRuleSet::resetHitCounts()
+{
+    for (int i = 0; i < ruleCount(); ++i)
+        m_hitCounts[i].store(0);
+}
+
+// Verifies a rule whose literal was first found ending at hitEnd in the spec. The rest of the
+// pattern is only matched around the occurrences of the literal from there on.
+bool URLRequestRuleSet::ruleMatches(quint32 index, quint32 typeMask, const std::string &spec,
+                                    size_t hostBegin, size_t hostEnd, size_t hitEnd) const
+{
+    const RuleSetHeader *h = header(m_data);
+    const Rule &rule = table<Rule>(m_data, h->ruleOffset)[index];
+    if (!(rule.resourceTypes & typeMask))
+        return false;
+    if (!(rule.flags & VerifyPattern))
+        return true;
+    if (!rule.literalLength || hitEnd < rule.literalLength)
+        return false;
+
+    const char *pattern = table<char>(m_data, h->stringOffset + rule.pattern.offset);
+    const char *patternEnd = pattern + rule.pattern.length;
+    const char *literal = pattern + rule.literalOffset;
+    const char *literalEnd = literal + rule.literalLength;
+    const char *text = spec.data();
+    const char *textEnd = text + spec.size();
+    const bool toEnd = rule.flags & EndAnchor;
+
+    auto matchesAround = [&](const char *hit) {
+        if (!matchPattern(literalEnd, patternEnd, hit + rule.literalLength, textEnd, toEnd, true))
+            return false;
+        if (rule.flags & StartAnchor)
+            return matchPattern(pattern, literal, text, hit, true, false);
+        if (rule.flags & HostAnchor) {
+            for (size_t start = hostBegin; start < hostEnd && text + start <= hit; ++start) {
+                if ((start == hostBegin || spec[start - 1] == '.')
+                        && matchPattern(pattern, literal, text + start, hit, true, false))
+                    return true;
+            }
+            return false;
+        }
+        return matchPatternBefore(pattern, literal, text, hit, false);
+    };
+
+    const auto sameCharacter = [](char t, char p) { return toLower(t) == p; };
+    for (const char *hit = text + hitEnd - rule.literalLength; hit != textEnd;
+         hit = std::search(hit + 1, textEnd, literal, literalEnd, sameCharacter)) {
+        if (matchesAround(hit))
+            return true;
+    }
+    return false;
+}
+
+URLRequestRuleSet::Action URLRequestRuleSet::evaluate(const GURL &url, content::ResourceType resourceType,
+                                                      std::string *redirectUrl) const
+{
+    const RuleSetHeader *h = header(m_data);
+    const quint32 typeMask = typeBit(resourceType);
+    const std::string &spec = url.possibly_invalid_spec();
+    const url::Component &host = url.parsed_for_possibly_invalid_spec().host;
+    const size_t hostBegin = host.is_nonempty() ? host.begin : 0;
+    const size_t hostEnd = host.is_nonempty() ? host.end() : 0;
+    const quint32 *ruleIndices = table<quint32>(m_data, h->ruleIndexOffset);
+    const char *strings = table<char>(m_data, h->stringOffset);
+
+    // Exception rules win over any blocking rule, otherwise the first blocking rule found is used.
+    // Once a blocking rule is found only exception rules are checked, and every rule at most once.
+    quint32 blockingRule = kNone;
+    quint32 allowingRule = kNone;
+    QVarLengthArray<quint32, 32> checkedRules;
+    auto check = [&](quint32 firstRule, quint32 ruleCount, size_t hitEnd) {
+        for (quint32 i = firstRule; i < firstRule + ruleCount && allowingRule == kNone; ++i) {
+            const quint32 index = ruleIndices[i];
+            const quint32 flags = table<Rule>(m_data, h->ruleOffset)[index].flags;
+            const bool allowRule = flags & AllowRule;
+            if (!allowRule && (blockingRule != kNone || (!redirectUrl && (flags & RedirectRule))))
+                continue;
+            if (std::find(checkedRules.cbegin(), checkedRules.cend(), index) != checkedRules.cend())
+                continue;
+            checkedRules.append(index);
+            if (!ruleMatches(index, typeMask, spec, hostBegin, hostEnd, hitEnd))
+                continue;
+            if (allowRule)
+                allowingRule = index;
+            else
+                blockingRule = index;
+        }
+        return allowingRule == kNone;
+    };
+
+    // Walk the host trie from the top level domain down.
+    const HostNode *hostNodes = table<HostNode>(m_data, h->hostNodeOffset);
+    quint32 node = 0;
+    size_t labelEnd = hostEnd;
+    while (labelEnd > hostBegin) {
+        size_t labelBegin = labelEnd;
+        while (labelBegin > hostBegin && spec[labelBegin - 1] != '.')
+            --labelBegin;
+        const HostNode *first = hostNodes + hostNodes[node].firstChild;
+        const HostNode *last = first + hostNodes[node].childCount;
+        const char *label = spec.data() + labelBegin;
+        const size_t labelLength = labelEnd - labelBegin;
+        const HostNode *child = std::lower_bound(first, last, 0, [&](const HostNode &candidate, int) {
+            const int cmp = memcmp(strings + candidate.label.offset, label, std::min<size_t>(candidate.label.length, labelLength));
+            return cmp < 0 || (cmp == 0 && candidate.label.length < labelLength);
+        });
+        if (child == last || child->label.length != labelLength
+                || memcmp(strings + child->label.offset, label, labelLength) != 0)
+            break;
+        node = child - hostNodes;
+        if (!check(child->firstRule, child->ruleCount, hostEnd))
+            break;
+        if (labelBegin == hostBegin)
+            break;
+        labelEnd = labelBegin - 1;
+    }
+
+    // Run the automaton over the whole URL.
+    const MatcherNode *matcherNodes = table<MatcherNode>(m_data, h->matcherNodeOffset);
+    const MatcherEdge *matcherEdges = table<MatcherEdge>(m_data, h->matcherEdgeOffset);
+    quint32 state = 0;
+    for (size_t i = 0; i < spec.size() && allowingRule == kNone; ++i) {
+        const quint32 byte = uchar(toLower(spec[i]));
+        forever {
+            const MatcherEdge *first = matcherEdges + matcherNodes[state].firstEdge;
+            const MatcherEdge *last = first + matcherNodes[state].edgeCount;
+            const MatcherEdge *edge = std::lower_bound(first, last, byte, [](const MatcherEdge &candidate, quint32 byte) {
+                return candidate.byte < byte;
+            });
+            if (edge != last && edge->byte == byte) {
+                state = edge->target;
+                break;
+            }
+            if (state == 0)
+                break;
+            state = matcherNodes[state].failure;
+        }
+        quint32 match = matcherNodes[state].ruleCount ? state : matcherNodes[state].output;
+        while (match != kNone && check(matcherNodes[match].firstRule, matcherNodes[match].ruleCount, i + 1))
+            match = matcherNodes[match].output;
+    }
+
+    if (allowingRule != kNone) {
+        m_hitCounts[allowingRule].ref();
+        return NoAction;
+    }
+    if (blockingRule == kNone)
+        return NoAction;
+
+    m_hitCounts[blockingRule].ref();
+    const Rule &rule = table<Rule>(m_data, h->ruleOffset)[blockingRule];
+    if (!(rule.flags & RedirectRule))
+        return Block;
+    redirectUrl->assign(strings + rule.redirect.offset, rule.redirect.length);
+    return Redirect;
+}
+
+} // namespace QtWebEngineCore
@@ -0,0 +1,104 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef URL_REQUEST_RULE_SET_H_
+#define URL_REQUEST_RULE_SET_H_
+
+#include "content/public/common/resource_type.h"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QByteArray>
+#include <QtCore/QScopedArrayPointer>
+#include <QtCore/QScopedPointer>
+#include <QtCore/QSharedPointer>
+
+#include <string>
+
+QT_FORWARD_DECLARE_CLASS(QFile)
+
+class GURL;
+
+namespace QtWebEngineCore {
+
+// A compiled set of request blocking and redirect rules, evaluated on the IO thread by
+// NetworkDelegateQt before an interceptor sees the request.
+//
+// Rules use a subset of the Adblock filter syntax: "||host^" anchors match the host and its
+// subdomains and are looked up in a trie of host labels, other patterns are found with an
+// Aho-Corasick automaton over the URL and verified when they contain wildcards or anchors.
+// The compiled form is a flat blob of 32-bit tables that is used in place, so a saved rule
+// set is only mapped into memory when loaded again.
+class URLRequestRuleSet {
+public:
+    enum Action {
+        NoAction,
+        Block,
+        Redirect
+    };
+
+    static QSharedPointer<URLRequestRuleSet> compile(const QByteArray &filterList);
+    static QSharedPointer<URLRequestRuleSet> load(const QString &fileName);
+    ~URLRequestRuleSet();
+
+    bool save(const QString &fileName) const;
+
+    int ruleCount() const;
+    int skippedLineCount() const;
+    QByteArray ruleText(int index) const;
+    int hitCount(int index) const;
+    void resetHitCounts();
+
+    // Runs on the IO thread, may be called concurrently. Redirect rules are skipped without redirectUrl.
+    Action evaluate(const GURL &url, content::ResourceType resourceType, std::string *redirectUrl) const;
+
+private:
+    URLRequestRuleSet();
+    bool attach(const uchar *data, qint64 size);
+    bool ruleMatches(quint32 index, quint32 typeMask, const std::string &spec,
+                     size_t hostBegin, size_t hostEnd, size_t hitEnd) const;
+
+    QByteArray m_compiled;
+    QScopedPointer<QFile> m_file;
+    const uchar *m_data = nullptr;
+    mutable QScopedArrayPointer<QAtomicInt> m_hitCounts;
+};
+
+} // namespace QtWebEngineCore
+
+#endif // URL_REQUEST_RULE_SET_H_
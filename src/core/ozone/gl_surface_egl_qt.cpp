@@ -116,6 +116,37 @@ bool GLSurfaceEGLQt::InitializeExtensionSettingsOneOff()
     return s_initialized;
 }
 
+EGLImageKHR GLSurfaceEGLQt::CreateTextureImage(unsigned int textureId)
+{
+    const EGLint attributes[] = {
+        EGL_GL_TEXTURE_LEVEL_KHR, 0,
+        EGL_IMAGE_PRESERVED_KHR, EGL_TRUE,
+        EGL_NONE
+    };
+
+    EGLImageKHR image = eglCreateImageKHR(g_display, eglGetCurrentContext(), EGL_GL_TEXTURE_2D_KHR,
+                                          reinterpret_cast<EGLClientBuffer>(static_cast<uintptr_t>(textureId)),
+                                          attributes);
+    if (image == EGL_NO_IMAGE_KHR)
+        LOG(ERROR) << "eglCreateImageKHR failed with error " << GetLastEGLErrorString();
+    return image;
+}
+
+EGLSyncKHR GLSurfaceEGLQt::CreateFenceSync()
+{
+    if (!HasEGLExtension("EGL_KHR_fence_sync"))
+        return EGL_NO_SYNC_KHR;
+
+    EGLSyncKHR sync = eglCreateSyncKHR(g_display, EGL_SYNC_FENCE_KHR, nullptr);
+    if (sync == EGL_NO_SYNC_KHR) {
+        LOG(ERROR) << "eglCreateSyncKHR failed with error " << GetLastEGLErrorString();
+        return sync;
+    }
+    // The fence can only signal once it was flushed from this context.
+    glFlush();
+    return sync;
+}
+
 bool GLSurfaceEGL::InitializeExtensionSettingsOneOff()
 {
     return GLSurfaceEGLQt::InitializeExtensionSettingsOneOff();
@@ -53,6 +53,12 @@ public:
     static bool InitializeOneOff();
     static bool InitializeExtensionSettingsOneOff();
 
+    // Exports a texture of the current context as an EGLImage, for Qt contexts not sharing with ours.
+    static EGLImageKHR CreateTextureImage(unsigned int textureId);
+    // Fences the commands of the current context, so that the contexts importing an image can
+    // wait for them. Returns EGL_NO_SYNC_KHR if EGL fence syncs aren't supported.
+    static EGLSyncKHR CreateFenceSync();
+
     bool Initialize(GLSurfaceFormat format) override;
     void Destroy() override;
     void* GetHandle() override;
@@ -39,6 +39,7 @@
 
 #include "pdfium_document_wrapper_qt.h"
 #include <QtCore/qhash.h>
+#include <QtCore/qmutex.h>
 #include <QtGui/qimage.h>
 #include <QtGui/qpainter.h>
 
@@ -46,7 +47,9 @@
 #include "third_party/pdfium/public/fpdfview.h"
 
 namespace QtWebEngineCore {
-int PdfiumDocumentWrapperQt::m_libraryUsers = 0;
+// Guards the library initialization and every call into PDFium.
+static QBasicMutex s_pdfiumMutex;
+static int s_libraryUsers = 0;
 
 class QWEBENGINECORE_PRIVATE_EXPORT PdfiumPageWrapperQt {
 public:
@@ -121,7 +124,8 @@ PdfiumDocumentWrapperQt::PdfiumDocumentWrapperQt(const void *pdfData, size_t siz
 {
     Q_ASSERT(pdfData);
     Q_ASSERT(size);
-    if (m_libraryUsers++ == 0)
+    QMutexLocker lock(&s_pdfiumMutex);
+    if (s_libraryUsers++ == 0)
         FPDF_InitLibrary();
 
     m_documentHandle = (void *)FPDF_LoadMemDocument(pdfData, static_cast<int>(size), password);
@@ -140,6 +144,7 @@ QImage PdfiumDocumentWrapperQt::pageAsQImage(size_t index)
         return QImage();
     }
 
+    QMutexLocker lock(&s_pdfiumMutex);
     PdfiumPageWrapperQt pageWrapper((FPDF_DOCUMENT)m_documentHandle, index,
                                     m_imageSize.width(), m_imageSize.height());
     return pageWrapper.image();
@@ -147,8 +152,9 @@ QImage PdfiumDocumentWrapperQt::pageAsQImage(size_t index)
 
 PdfiumDocumentWrapperQt::~PdfiumDocumentWrapperQt()
 {
+    QMutexLocker lock(&s_pdfiumMutex);
     FPDF_CloseDocument((FPDF_DOCUMENT)m_documentHandle);
-    if (--m_libraryUsers == 0)
+    if (--s_libraryUsers == 0)
         FPDF_DestroyLibrary();
 }
 
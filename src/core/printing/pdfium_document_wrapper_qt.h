@@ -58,6 +58,8 @@
 namespace QtWebEngineCore {
 class PdfiumPageWrapperQt;
 
+// PDFium is not thread-safe, all access to it is serialized on a global lock,
+// so documents can be created, rendered and destroyed on any thread.
 class QWEBENGINECORE_PRIVATE_EXPORT PdfiumDocumentWrapperQt
 {
 public:
@@ -68,7 +70,6 @@ public:
     int pageCount() const { return m_pageCount; }
 
 private:
-    static int m_libraryUsers;
     int m_pageCount;
     void *m_documentHandle;
     QSize m_imageSize;
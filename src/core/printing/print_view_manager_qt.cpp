@@ -52,8 +52,9 @@
 #include <QtGui/qpagesize.h>
 
 #include "base/values.h"
-#include "base/memory/ref_counted_memory.h"
+#include "base/memory/shared_memory.h"
 #include "base/task_scheduler/post_task.h"
+#include "base/threading/thread_task_runner_handle.h"
 #include "chrome/browser/printing/print_job_manager.h"
 #include "chrome/browser/printing/printer_query.h"
 #include "components/printing/common/print_messages.h"
@@ -62,7 +63,6 @@
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/render_frame_host.h"
 #include "content/public/common/web_preferences.h"
-#include "printing/pdf_metafile_skia.h"
 #include "printing/print_job_constants.h"
 #include "printing/units.h"
 
@@ -72,48 +72,19 @@ namespace {
 
 static const qreal kMicronsToMillimeter = 1000.0f;
 
-static std::vector<char>
-GetStdVectorFromHandle(base::SharedMemoryHandle handle, uint32_t data_size)
-{
-    std::unique_ptr<base::SharedMemory> shared_buf(
-                new base::SharedMemory(handle, true));
-
-    if (!shared_buf->Map(data_size)) {
-        return std::vector<char>();
-    }
-
-    char* data = static_cast<char*>(shared_buf->memory());
-    return std::vector<char>(data, data + data_size);
-}
-
-static scoped_refptr<base::RefCountedBytes>
-GetBytesFromHandle(base::SharedMemoryHandle handle, uint32_t data_size)
-{
-    std::unique_ptr<base::SharedMemory> shared_buf(new base::SharedMemory(handle, true));
-
-    if (!shared_buf->Map(data_size)) {
-        return nullptr;
-    }
-
-    unsigned char* data = static_cast<unsigned char*>(shared_buf->memory());
-    std::vector<unsigned char> dataVector(data, data + data_size);
-    return base::RefCountedBytes::TakeVector(&dataVector);
-}
-
-// Write the PDF file to disk.
-static void SavePdfFile(scoped_refptr<base::RefCountedBytes> data,
+// Write the PDF file to disk straight from the shared memory it was rendered into.
+static void SavePdfFile(std::unique_ptr<base::SharedMemory> data,
+                        uint32_t dataSize,
                         const base::FilePath &path,
                         const QtWebEngineCore::PrintViewManagerQt::PrintToPDFFileCallback &saveCallback)
 {
     base::AssertBlockingAllowed();
-    DCHECK_GT(data->size(), 0U);
-
-    printing::PdfMetafileSkia metafile;
-    metafile.InitFromData(static_cast<const void*>(data->front()), data->size());
+    DCHECK_GT(dataSize, 0U);
 
     base::File file(path,
                     base::File::FLAG_CREATE_ALWAYS | base::File::FLAG_WRITE);
-    bool success = file.IsValid() && metafile.SaveTo(&file);
+    bool success = file.IsValid()
+            && file.WriteAtCurrentPos(static_cast<const char *>(data->memory()), dataSize) == static_cast<int>(dataSize);
     content::BrowserThread::PostTask(content::BrowserThread::UI,
                                      FROM_HERE,
                                      base::Bind(saveCallback, success));
@@ -223,19 +194,15 @@ void PrintViewManagerQt::PrintToPDFFileWithCallback(const QPageLayout &pageLayou
     if (callback.is_null())
         return;
 
-    if (m_printSettings || !filePath.length()) {
+    if (!filePath.length()) {
         content::BrowserThread::PostTask(content::BrowserThread::UI, FROM_HERE,
                                          base::Bind(callback, false));
         return;
     }
 
-    m_pdfOutputPath = toFilePath(filePath);
-    m_pdfSaveCallback = callback;
-    if (!PrintToPDFInternal(pageLayout, printInColor)) {
-        content::BrowserThread::PostTask(content::BrowserThread::UI, FROM_HERE,
-                                         base::Bind(callback, false));
-        resetPdfState();
-    }
+    m_pendingPdfJobs.push_back({ pageLayout, printInColor, true, toFilePath(filePath),
+                                 PrintToPDFCallback(), callback });
+    startNextPdfJob();
 }
 
 void PrintViewManagerQt::PrintToPDFWithCallback(const QPageLayout &pageLayout,
@@ -246,21 +213,53 @@ void PrintViewManagerQt::PrintToPDFWithCallback(const QPageLayout &pageLayout,
     if (callback.is_null())
         return;
 
-    // If there already is a pending print in progress, don't try starting another one.
-    if (m_printSettings) {
-        content::BrowserThread::PostTask(content::BrowserThread::UI, FROM_HERE,
-                                         base::Bind(callback, std::vector<char>()));
-        return;
+    m_pendingPdfJobs.push_back({ pageLayout, printInColor, useCustomMargins, base::FilePath(),
+                                 callback, PrintToPDFFileCallback() });
+    startNextPdfJob();
+}
+
+// The renderer handles one print preview at a time, so queued jobs start
+// only once the result of the current one has arrived.
+void PrintViewManagerQt::startNextPdfJob()
+{
+    while (!m_printSettings && !m_pendingPdfJobs.empty()) {
+        PdfPrintJob job = std::move(m_pendingPdfJobs.front());
+        m_pendingPdfJobs.pop_front();
+
+        m_pdfOutputPath = job.outputPath;
+        m_pdfPrintCallback = job.printCallback;
+        m_pdfSaveCallback = job.saveCallback;
+        if (!PrintToPDFInternal(job.pageLayout, job.printInColor, job.useCustomMargins))
+            failPdfJob();
     }
+}
 
-    m_pdfPrintCallback = callback;
-    if (!PrintToPDFInternal(pageLayout, printInColor, useCustomMargins)) {
-        content::BrowserThread::PostTask(content::BrowserThread::UI,
-                                         FROM_HERE,
-                                         base::Bind(callback, std::vector<char>()));
+// Reports failure for the current job and resets the state for the next one.
+void PrintViewManagerQt::failPdfJob()
+{
+    // The next job initiates its own print preview.
+    if (m_printPreviewRfh)
+        PrintPreviewDone();
+    if (!m_pdfPrintCallback.is_null()) {
+        content::BrowserThread::PostTask(content::BrowserThread::UI, FROM_HERE,
+                                         base::Bind(m_pdfPrintCallback, QByteArray()));
+    }
+    if (!m_pdfSaveCallback.is_null()) {
+        content::BrowserThread::PostTask(content::BrowserThread::UI, FROM_HERE,
+                                         base::Bind(m_pdfSaveCallback, false));
+    }
+    resetPdfState();
+}
 
-        resetPdfState();
+void PrintViewManagerQt::failAllPdfJobs()
+{
+    failPdfJob();
+    for (const PdfPrintJob &job : m_pendingPdfJobs) {
+        m_pdfPrintCallback = job.printCallback;
+        m_pdfSaveCallback = job.saveCallback;
+        failPdfJob();
     }
+    m_pendingPdfJobs.clear();
 }
 
 bool PrintViewManagerQt::PrintToPDFInternal(const QPageLayout &pageLayout,
@@ -276,6 +275,7 @@ bool PrintViewManagerQt::PrintToPDFInternal(const QPageLayout &pageLayout,
                                 GetWebkitPreferences().should_print_backgrounds);
     m_printSettings->SetInteger(printing::kSettingColor,
                                 printInColor ? printing::COLOR : printing::GRAYSCALE);
+    m_printSettings->GetInteger(printing::kPreviewRequestID, &m_printPreviewRequestId);
 
     if (web_contents()->ShowingInterstitialPage() || web_contents()->IsCrashed())
         return false;
@@ -303,6 +303,8 @@ base::string16 PrintViewManagerQt::RenderSourceName()
 PrintViewManagerQt::PrintViewManagerQt(content::WebContents *contents)
     : PrintViewManagerBaseQt(contents)
     , m_printPreviewRfh(nullptr)
+    , m_printPreviewRequestId(-1)
+    , m_weakFactory(this)
 {
 
 }
@@ -318,6 +320,9 @@ bool PrintViewManagerQt::OnMessageReceived(const IPC::Message& message,
         IPC_MESSAGE_HANDLER(PrintHostMsg_RequestPrintPreview, OnRequestPrintPreview)
         IPC_MESSAGE_HANDLER(PrintHostMsg_MetafileReadyForPrinting, OnMetafileReadyForPrinting);
         IPC_MESSAGE_HANDLER(PrintHostMsg_DidPreviewPage, OnDidPreviewPage)
+        IPC_MESSAGE_HANDLER(PrintHostMsg_PrintPreviewFailed, OnPrintPreviewFailed)
+        IPC_MESSAGE_HANDLER(PrintHostMsg_PrintPreviewCancelled, OnPrintPreviewFailed)
+        IPC_MESSAGE_HANDLER(PrintHostMsg_PrintPreviewInvalidPrinterSettings, OnPrintPreviewFailed)
         IPC_MESSAGE_FORWARD_DELAY_REPLY(
                 PrintHostMsg_SetupScriptedPrintPreview, &helper,
                 FrameDispatchHelper::OnSetupScriptedPrintPreview)
@@ -341,6 +346,7 @@ void PrintViewManagerQt::resetPdfState()
     m_pdfPrintCallback.Reset();
     m_pdfSaveCallback.Reset();
     m_printSettings.reset();
+    m_printPreviewRequestId = -1;
 }
 
 // IPC handlers
@@ -348,6 +354,9 @@ void PrintViewManagerQt::resetPdfState()
 void PrintViewManagerQt::OnRequestPrintPreview(
     const PrintHostMsg_RequestPrintPreview_Params &/*params*/)
 {
+    // The preview of a failed job was closed already.
+    if (!m_printPreviewRfh || !m_printSettings)
+        return;
     m_printPreviewRfh->Send(new PrintMsg_PrintPreview(m_printPreviewRfh->GetRoutingID(),
                                                       *m_printSettings));
     PrintPreviewDone();
@@ -359,25 +368,61 @@ void PrintViewManagerQt::OnMetafileReadyForPrinting(content::RenderFrameHost* rf
 {
     StopWorker(params.document_cookie);
 
+    // Taking ownership of the handle closes it, even if the result is dropped.
+    std::unique_ptr<base::SharedMemory> sharedBuf(
+                new base::SharedMemory(params.content.metafile_data_handle, true));
+
+    // A job that was failed early, for example when the navigation was stopped, can still
+    // deliver its result while the next job is running. It belongs to no callback anymore.
+    if (!m_printSettings || ids.request_id != m_printPreviewRequestId)
+        return;
+
     // Create local copies so we can reset the state and take a new pdf print job.
-    base::Callback<void(const std::vector<char>&)> pdf_print_callback = m_pdfPrintCallback;
-    base::Callback<void(bool)> pdf_save_callback = m_pdfSaveCallback;
+    PrintToPDFCallback pdf_print_callback = m_pdfPrintCallback;
+    PrintToPDFFileCallback pdf_save_callback = m_pdfSaveCallback;
     base::FilePath pdfOutputPath = m_pdfOutputPath;
 
     resetPdfState();
 
+    const uint32_t dataSize = params.content.data_size;
+    const bool mapped = dataSize > 0 && sharedBuf->Map(dataSize);
+
     if (!pdf_print_callback.is_null()) {
-        std::vector<char> data_vector = GetStdVectorFromHandle(params.content.metafile_data_handle,
-                                                               params.content.data_size);
+        QByteArray data;
+        if (mapped)
+            data = QByteArray(static_cast<const char *>(sharedBuf->memory()), dataSize);
         content::BrowserThread::PostTask(content::BrowserThread::UI,
                                          FROM_HERE,
-                                         base::Bind(pdf_print_callback, data_vector));
-    } else {
-        scoped_refptr<base::RefCountedBytes> data_bytes
-                = GetBytesFromHandle(params.content.metafile_data_handle, params.content.data_size);
+                                         base::Bind(pdf_print_callback, data));
+    } else if (mapped) {
         base::PostTaskWithTraits(FROM_HERE, {base::MayBlock()},
-                                 base::BindOnce(&SavePdfFile, data_bytes, pdfOutputPath, pdf_save_callback));
+                                 base::BindOnce(&SavePdfFile, std::move(sharedBuf), dataSize,
+                                                pdfOutputPath, pdf_save_callback));
+    } else {
+        content::BrowserThread::PostTask(content::BrowserThread::UI,
+                                         FROM_HERE,
+                                         base::Bind(pdf_save_callback, false));
     }
+
+    base::ThreadTaskRunnerHandle::Get()->PostTask(FROM_HERE,
+                                                  base::BindOnce(&PrintViewManagerQt::startNextPdfJob,
+                                                                 m_weakFactory.GetWeakPtr()));
+}
+
+// The renderer produced no document for the current job, so no
+// MetafileReadyForPrinting follows and the queue must move on from here.
+void PrintViewManagerQt::OnPrintPreviewFailed(content::RenderFrameHost* rfh,
+                                              int documentCookie,
+                                              const PrintHostMsg_PreviewIds &ids)
+{
+    StopWorker(documentCookie);
+    if (!m_printSettings || ids.request_id != m_printPreviewRequestId)
+        return;
+    if (rfh == m_printPreviewRfh)
+        PrintPreviewDone();
+
+    failPdfJob();
+    startNextPdfJob();
 }
 
 void PrintViewManagerQt::OnDidShowPrintDialog()
@@ -393,24 +438,14 @@ void PrintViewManagerQt::DidStartLoading()
 // Cancels the print job.
 void PrintViewManagerQt::NavigationStopped()
 {
-    if (!m_pdfPrintCallback.is_null()) {
-        content::BrowserThread::PostTask(content::BrowserThread::UI,
-                                         FROM_HERE,
-                                         base::Bind(m_pdfPrintCallback, std::vector<char>()));
-    }
-    resetPdfState();
+    failAllPdfJobs();
     PrintViewManagerBaseQt::NavigationStopped();
 }
 
 void PrintViewManagerQt::RenderProcessGone(base::TerminationStatus status)
 {
     PrintViewManagerBaseQt::RenderProcessGone(status);
-    if (!m_pdfPrintCallback.is_null()) {
-        content::BrowserThread::PostTask(content::BrowserThread::UI,
-                                         FROM_HERE,
-                                         base::Bind(m_pdfPrintCallback, std::vector<char>()));
-    }
-    resetPdfState();
+    failAllPdfJobs();
 }
 
 void PrintViewManagerQt::OnDidPreviewPage(content::RenderFrameHost* rfh,
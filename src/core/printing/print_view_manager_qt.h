@@ -47,7 +47,9 @@
 #include "print_view_manager_base_qt.h"
 
 #include "qtwebenginecoreglobal_p.h"
+#include "base/containers/circular_deque.h"
 #include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
 #include "base/strings/string16.h"
 #include "components/prefs/pref_member.h"
 #include "components/printing/browser/print_manager.h"
@@ -56,6 +58,9 @@
 #include "content/public/browser/notification_registrar.h"
 #include "content/public/browser/web_contents_user_data.h"
 
+#include <QtCore/qbytearray.h>
+#include <QtGui/qpagelayout.h>
+
 struct PrintHostMsg_RequestPrintPreview_Params;
 struct PrintHostMsg_DidPreviewDocument_Params;
 
@@ -72,7 +77,6 @@ class PrintQueriesQueue;
 }
 
 QT_BEGIN_NAMESPACE
-class QPageLayout;
 class QString;
 QT_END_NAMESPACE
 
@@ -83,10 +87,11 @@ class PrintViewManagerQt
 {
 public:
     ~PrintViewManagerQt() override;
-    typedef base::Callback<void(const std::vector<char> &result)> PrintToPDFCallback;
+    typedef base::Callback<void(const QByteArray &result)> PrintToPDFCallback;
     typedef base::Callback<void(bool success)> PrintToPDFFileCallback;
 
     // Method to print a page to a Pdf document with page size \a pageSize in location \a filePath.
+    // Requests of both kinds are queued and run one after another.
     void PrintToPDFFileWithCallback(const QPageLayout &pageLayout,
                                     bool printInColor,
                                     const QString &filePath,
@@ -119,6 +124,9 @@ protected:
     void OnMetafileReadyForPrinting(content::RenderFrameHost* rfh,
                                     const PrintHostMsg_DidPreviewDocument_Params& params,
                                     const PrintHostMsg_PreviewIds &ids);
+    void OnPrintPreviewFailed(content::RenderFrameHost* rfh,
+                              int documentCookie,
+                              const PrintHostMsg_PreviewIds &ids);
     void OnSetupScriptedPrintPreview(content::RenderFrameHost* rfh,
                                       IPC::Message* reply_msg);
     void OnDidPreviewPage(content::RenderFrameHost* rfh,
@@ -129,7 +137,19 @@ protected:
     bool PrintToPDFInternal(const QPageLayout &, bool printInColor, bool useCustomMargins = true);
 
 private:
+    struct PdfPrintJob {
+        QPageLayout pageLayout;
+        bool printInColor;
+        bool useCustomMargins;
+        base::FilePath outputPath;
+        PrintToPDFCallback printCallback;
+        PrintToPDFFileCallback saveCallback;
+    };
+
     void resetPdfState();
+    void startNextPdfJob();
+    void failPdfJob();
+    void failAllPdfJobs();
     // content::WebContentsObserver implementation.
     void DidStartLoading() override;
     void PrintPreviewDone();
@@ -140,6 +160,10 @@ private:
     PrintToPDFCallback m_pdfPrintCallback;
     PrintToPDFFileCallback m_pdfSaveCallback;
     std::unique_ptr<base::DictionaryValue> m_printSettings;
+    // The preview request ID of the current job, which the renderer sends back with its result.
+    int m_printPreviewRequestId;
+    base::circular_deque<PdfPrintJob> m_pendingPdfJobs;
+    base::WeakPtrFactory<PrintViewManagerQt> m_weakFactory;
     friend class content::WebContentsUserData<PrintViewManagerQt>;
     DISALLOW_COPY_AND_ASSIGN(PrintViewManagerQt);
     struct FrameDispatchHelper;
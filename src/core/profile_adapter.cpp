@@ -47,6 +47,7 @@
 #include "api/qwebengineurlscheme.h"
 #include "content_client_qt.h"
 #include "download_manager_delegate_qt.h"
+#include "net/custom_protocol_handler.h"
 #include "net/url_request_context_getter_qt.h"
 #include "permission_manager_qt.h"
 #include "profile_qt.h"
@@ -83,6 +84,7 @@ ProfileAdapter::ProfileAdapter(const QString &storageName):
     , m_persistentCookiesPolicy(AllowPersistentCookies)
     , m_visitedLinksPolicy(TrackVisitedLinksOnDisk)
     , m_httpCacheMaxSize(0)
+    , m_concurrentUrlSchemeHandlers(new ConcurrentUrlSchemeHandlers)
 {
     WebEngineContext::current()->addProfileAdapter(this);
     // creation of profile requires webengine context
@@ -168,6 +170,30 @@ void ProfileAdapter::setRequestInterceptor(QWebEngineUrlRequestInterceptor *inte
         m_profile->m_profileIOData->updateRequestInterceptor();
 }
 
+QWebEngineUrlRequestRuleSet ProfileAdapter::urlRequestRuleSet() const
+{
+    return m_urlRequestRuleSet;
+}
+
+void ProfileAdapter::setUrlRequestRuleSet(const QWebEngineUrlRequestRuleSet &ruleSet)
+{
+    m_urlRequestRuleSet = ruleSet;
+    if (m_profile->m_urlRequestContextGetter.get())
+        m_profile->m_profileIOData->updateUrlRequestRuleSet();
+}
+
+QWebEngineNavigationPolicy ProfileAdapter::navigationPolicy() const
+{
+    return m_navigationPolicy;
+}
+
+void ProfileAdapter::setNavigationPolicy(const QWebEngineNavigationPolicy &policy)
+{
+    m_navigationPolicy = policy;
+    if (m_profile->m_urlRequestContextGetter.get())
+        m_profile->m_profileIOData->updateNavigationPolicy();
+}
+
 void ProfileAdapter::addClient(ProfileAdapterClient *adapterClient)
 {
     m_clients.append(adapterClient);
@@ -411,6 +437,11 @@ const QHash<QByteArray, QWebEngineUrlSchemeHandler *> &ProfileAdapter::customUrl
     return m_customUrlSchemeHandlers;
 }
 
+QSharedPointer<ConcurrentUrlSchemeHandlers> ProfileAdapter::concurrentUrlSchemeHandlers() const
+{
+    return m_concurrentUrlSchemeHandlers;
+}
+
 const QList<QByteArray> ProfileAdapter::customUrlSchemes() const
 {
     return m_customUrlSchemeHandlers.keys();
@@ -418,6 +449,26 @@ const QList<QByteArray> ProfileAdapter::customUrlSchemes() const
 
 void ProfileAdapter::updateCustomUrlSchemeHandlers()
 {
+    const std::shared_ptr<const ConcurrentUrlSchemeHandlers::Map> previous = m_concurrentUrlSchemeHandlers->handlers();
+    auto handlers = std::make_shared<ConcurrentUrlSchemeHandlers::Map>();
+    for (auto it = m_customUrlSchemeHandlers.cbegin(); it != m_customUrlSchemeHandlers.cend(); ++it) {
+        if (!qobject_cast<QWebEngineConcurrentUrlSchemeHandler *>(it.value()))
+            continue;
+        QSharedPointer<ConcurrentUrlSchemeHandler> handler = previous->value(it.key());
+        if (!handler || handler->handler != it.value())
+            handler.reset(new ConcurrentUrlSchemeHandler(it.value()));
+        handlers->insert(it.key(), handler);
+    }
+    m_concurrentUrlSchemeHandlers->setHandlers(handlers);
+
+    // Requests started from now on only find the new handlers. Wait for the calls in progress
+    // to the handlers that were removed, the requests that still found them see them removed.
+    for (auto it = previous->cbegin(); it != previous->cend(); ++it) {
+        if (handlers->value(it.key()) == it.value())
+            continue;
+        QWriteLocker locker(&it.value()->lock);
+        it.value()->removed = true;
+    }
     if (m_profile->m_urlRequestContextGetter.get())
         m_profile->m_profileIOData->updateJobFactory();
 }
@@ -455,6 +506,7 @@ bool ProfileAdapter::addCustomUrlSchemeHandler(const QByteArray &scheme, QWebEng
         QByteArrayLiteral("data"),
         QByteArrayLiteral("javascript"),
         QByteArrayLiteral("qrc"),
+        QByteArrayLiteral("qtwebengine-content"),
         // See also kStandardURLSchemes in url/url_util.cc (through url::IsStandard below)
     };
 
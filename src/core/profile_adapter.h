@@ -57,11 +57,14 @@
 #include <QList>
 #include <QPointer>
 #include <QScopedPointer>
+#include <QSharedPointer>
 #include <QString>
 #include <QVector>
 
 #include "api/qwebenginecookiestore.h"
+#include "api/qwebenginenavigationpolicy.h"
 #include "api/qwebengineurlrequestinterceptor.h"
+#include "api/qwebengineurlrequestruleset.h"
 #include "api/qwebengineurlschemehandler.h"
 
 QT_FORWARD_DECLARE_CLASS(QObject)
@@ -69,6 +72,7 @@ QT_FORWARD_DECLARE_CLASS(QObject)
 namespace QtWebEngineCore {
 
 class ProfileAdapterClient;
+class ConcurrentUrlSchemeHandlers;
 class DownloadManagerDelegateQt;
 class ProfileQt;
 class UserResourceControllerHost;
@@ -93,6 +97,12 @@ public:
     QWebEngineUrlRequestInterceptor* requestInterceptor();
     void setRequestInterceptor(QWebEngineUrlRequestInterceptor *interceptor);
 
+    QWebEngineUrlRequestRuleSet urlRequestRuleSet() const;
+    void setUrlRequestRuleSet(const QWebEngineUrlRequestRuleSet &ruleSet);
+
+    QWebEngineNavigationPolicy navigationPolicy() const;
+    void setNavigationPolicy(const QWebEngineNavigationPolicy &policy);
+
     QList<ProfileAdapterClient*> clients() { return m_clients; }
     void addClient(ProfileAdapterClient *adapterClient);
     void removeClient(ProfileAdapterClient *adapterClient);
@@ -177,6 +187,7 @@ public:
     bool persistVisitedLinks() const;
 
     const QHash<QByteArray, QWebEngineUrlSchemeHandler *> &customUrlSchemeHandlers() const;
+    QSharedPointer<ConcurrentUrlSchemeHandlers> concurrentUrlSchemeHandlers() const;
     const QList<QByteArray> customUrlSchemes() const;
     void clearCustomUrlSchemeHandlers();
     bool addCustomUrlSchemeHandler(const QByteArray &, QWebEngineUrlSchemeHandler *);
@@ -205,6 +216,8 @@ private:
     QScopedPointer<UserResourceControllerHost> m_userResourceController;
     QScopedPointer<QWebEngineCookieStore> m_cookieStore;
     QPointer<QWebEngineUrlRequestInterceptor> m_requestInterceptor;
+    QWebEngineUrlRequestRuleSet m_urlRequestRuleSet;
+    QWebEngineNavigationPolicy m_navigationPolicy;
 
     QString m_dataPath;
     QString m_cachePath;
@@ -214,6 +227,7 @@ private:
     PersistentCookiesPolicy m_persistentCookiesPolicy;
     VisitedLinksPolicy m_visitedLinksPolicy;
     QHash<QByteArray, QWebEngineUrlSchemeHandler *> m_customUrlSchemeHandlers;
+    QSharedPointer<ConcurrentUrlSchemeHandlers> m_concurrentUrlSchemeHandlers;
     QList<ProfileAdapterClient*> m_clients;
     QVector<WebContentsAdapterClient *> m_webContentsAdapterClients;
     int m_httpCacheMaxSize;
@@ -79,9 +79,12 @@
 
 #include "net/cookie_monster_delegate_qt.h"
 #include "net/custom_protocol_handler.h"
+#include "net/navigation_policy_qt.h"
 #include "net/network_delegate_qt.h"
 #include "net/proxy_config_service_qt.h"
 #include "net/qrc_protocol_handler_qt.h"
+#include "net/url_request_content_job_qt.h"
+#include "net/url_request_rule_set.h"
 #include "net/url_request_context_getter_qt.h"
 #include "profile_qt.h"
 #include "resource_context_qt.h"
@@ -154,6 +157,7 @@ static net::HttpNetworkSession::Params generateNetworkSessionParams(bool ignoreC
 
 ProfileIODataQt::ProfileIODataQt(ProfileQt *profile)
     : m_profile(profile),
+      m_contentPayloadStore(new ContentPayloadStoreQt),
       m_mutex(QMutex::Recursive),
       m_weakPtrFactory(this)
 {
@@ -371,7 +375,7 @@ void ProfileIODataQt::generateCookieStore()
                 toFilePath(m_cookiesPath),
                 false,
                 true,
-                nullptr)
+                m_cookieDelegate->storagePolicy())
             );
         break;
     case ProfileAdapter::ForcePersistentCookies:
@@ -380,7 +384,7 @@ void ProfileIODataQt::generateCookieStore()
                 toFilePath(m_cookiesPath),
                 true,
                 true,
-                nullptr)
+                m_cookieDelegate->storagePolicy())
             );
         break;
     }
@@ -485,6 +489,7 @@ void ProfileIODataQt::generateJobFactory()
     jobFactory->SetProtocolHandler(kQrcSchemeQt,
                                    std::unique_ptr<net::URLRequestJobFactory::ProtocolHandler>(
                                        new QrcProtocolHandlerQt()));
+    jobFactory->SetProtocolHandler(kContentSchemeQt, std::make_unique<ContentProtocolHandlerQt>());
     jobFactory->SetProtocolHandler(url::kFtpScheme,
             net::FtpProtocolHandler::Create(m_urlRequestContext->host_resolver()));
 
@@ -492,7 +497,7 @@ void ProfileIODataQt::generateJobFactory()
     for (const QByteArray &scheme : qAsConst(m_installedCustomSchemes)) {
         jobFactory->SetProtocolHandler(scheme.toStdString(),
                                        std::unique_ptr<net::URLRequestJobFactory::ProtocolHandler>(
-                                           new CustomProtocolHandler(m_profileAdapter)));
+                                           new CustomProtocolHandler(m_profileAdapter, m_concurrentUrlSchemeHandlers)));
     }
 
     m_baseJobFactory = jobFactory.get();
@@ -507,6 +512,12 @@ void ProfileIODataQt::generateJobFactory()
 
     m_requestInterceptors.clear();
 
+    // setContent payloads are tagged navigations to the base URL, answer them
+    // before any scheme handler or embedder interceptor gets to see them.
+    topJobFactory.reset(new net::URLRequestInterceptingJobFactory(
+                            std::move(topJobFactory),
+                            std::make_unique<ContentRequestInterceptorQt>(m_contentPayloadStore)));
+
     if (m_protocolHandlerInterceptor) {
         m_protocolHandlerInterceptor->Chain(std::move(topJobFactory));
         topJobFactory = std::move(m_protocolHandlerInterceptor);
@@ -538,7 +549,7 @@ void ProfileIODataQt::regenerateJobFactory()
     for (const QByteArray &scheme : qAsConst(m_installedCustomSchemes)) {
         m_baseJobFactory->SetProtocolHandler(scheme.toStdString(),
                                              std::unique_ptr<net::URLRequestJobFactory::ProtocolHandler>(
-                                                 new CustomProtocolHandler(m_profileAdapter)));
+                                                 new CustomProtocolHandler(m_profileAdapter, m_concurrentUrlSchemeHandlers)));
     }
 }
 
@@ -554,7 +565,9 @@ void ProfileIODataQt::setRequestContextData(content::ProtocolHandlerMap *protoco
 void ProfileIODataQt::setFullConfiguration()
 {
     Q_ASSERT(content::BrowserThread::CurrentlyOn(content::BrowserThread::UI));
-    m_requestInterceptor = m_profileAdapter->requestInterceptor();
+    publishRequestInterceptor(m_profileAdapter->requestInterceptor());
+    m_urlRequestRuleSet = m_profileAdapter->urlRequestRuleSet().d_ptr;
+    m_navigationPolicy = m_profileAdapter->navigationPolicy().compiled();
     m_persistentCookiesPolicy = m_profileAdapter->persistentCookiesPolicy();
     m_cookiesPath = m_profileAdapter->cookiesPath();
     m_channelIdPath = m_profileAdapter->channelIdPath();
@@ -564,6 +577,7 @@ void ProfileIODataQt::setFullConfiguration()
     m_httpCachePath = m_profileAdapter->httpCachePath();
     m_httpCacheMaxSize = m_profileAdapter->httpCacheMaxSize();
     m_customUrlSchemes = m_profileAdapter->customUrlSchemes();
+    m_concurrentUrlSchemeHandlers = m_profileAdapter->concurrentUrlSchemeHandlers();
     m_dataPath = m_profileAdapter->dataPath();
 }
 
@@ -665,28 +679,98 @@ void ProfileIODataQt::updateJobFactory()
 void ProfileIODataQt::updateRequestInterceptor()
 {
     Q_ASSERT(content::BrowserThread::CurrentlyOn(content::BrowserThread::UI));
-    QMutexLocker lock(&m_mutex);
-    m_requestInterceptor = m_profileAdapter->requestInterceptor();
+    publishRequestInterceptor(m_profileAdapter->requestInterceptor());
     // We in this case do not need to regenerate any Chromium classes.
 }
 
+// The interceptor is published through an atomic pointer so that the io thread never takes
+// m_mutex while intercepting. The io thread announces the interceptor it is about to call in
+// m_requestInterceptorInUse, and the ui thread waits for it to move on before returning from
+// an update, so the application may delete the previous interceptor afterwards. Only the read
+// of the other thread's pointer needs to be a full barrier, hence fetchAndAddOrdered(0).
+void ProfileIODataQt::publishRequestInterceptor(QWebEngineUrlRequestInterceptor *interceptor)
+{
+    Q_ASSERT(content::BrowserThread::CurrentlyOn(content::BrowserThread::UI));
+    QWebEngineUrlRequestInterceptor *previous = m_requestInterceptor.fetchAndStoreOrdered(interceptor);
+    if (!previous || previous == interceptor)
+        return;
+    // Block until the IO thread is done with the previous interceptor, it may be deleted after this.
+    QMutexLocker locker(&m_requestInterceptorMutex);
+    m_requestInterceptorWaiters.ref();
+    while (m_requestInterceptorInUse.fetchAndAddOrdered(0) == previous)
+        m_requestInterceptorReleased.wait(&m_requestInterceptorMutex);
+    m_requestInterceptorWaiters.deref();
+}
+
+void ProfileIODataQt::updateUrlRequestRuleSet()
+{
+    Q_ASSERT(content::BrowserThread::CurrentlyOn(content::BrowserThread::UI));
+    QMutexLocker lock(&m_mutex);
+    QSharedPointer<URLRequestRuleSet> ruleSet = m_profileAdapter->urlRequestRuleSet().d_ptr;
+    // Once the io thread is running, the rule set is only swapped there so that
+    // NetworkDelegateQt can evaluate it without locking.
+    if (m_initialized)
+        content::BrowserThread::PostTask(content::BrowserThread::IO, FROM_HERE,
+                                         base::Bind(&ProfileIODataQt::setUrlRequestRuleSet, m_weakPtr, ruleSet));
+    else
+        m_urlRequestRuleSet = ruleSet;
+}
+
+void ProfileIODataQt::setUrlRequestRuleSet(QSharedPointer<URLRequestRuleSet> ruleSet)
+{
+    Q_ASSERT(content::BrowserThread::CurrentlyOn(content::BrowserThread::IO));
+    m_urlRequestRuleSet = ruleSet;
+}
+
+void ProfileIODataQt::updateNavigationPolicy()
+{
+    Q_ASSERT(content::BrowserThread::CurrentlyOn(content::BrowserThread::UI));
+    QMutexLocker lock(&m_mutex);
+    QSharedPointer<const NavigationPolicyQt> policy = m_profileAdapter->navigationPolicy().compiled();
+    // Swapped on the io thread like the url request rule set.
+    if (m_initialized)
+        content::BrowserThread::PostTask(content::BrowserThread::IO, FROM_HERE,
+                                         base::Bind(&ProfileIODataQt::setNavigationPolicy, m_weakPtr, policy));
+    else
+        m_navigationPolicy = policy;
+}
+
+void ProfileIODataQt::setNavigationPolicy(QSharedPointer<const NavigationPolicyQt> policy)
+{
+    Q_ASSERT(content::BrowserThread::CurrentlyOn(content::BrowserThread::IO));
+    m_navigationPolicy = policy;
+}
+
 QWebEngineUrlRequestInterceptor *ProfileIODataQt::acquireInterceptor()
 {
-    m_mutex.lock();
-    return m_requestInterceptor;
+    Q_ASSERT(content::BrowserThread::CurrentlyOn(content::BrowserThread::IO));
+    QWebEngineUrlRequestInterceptor *interceptor = m_requestInterceptor.loadAcquire();
+    forever {
+        m_requestInterceptorInUse.fetchAndStoreOrdered(interceptor);
+        QWebEngineUrlRequestInterceptor *current = m_requestInterceptor.fetchAndAddOrdered(0);
+        if (current == interceptor)
+            return interceptor;
+        interceptor = current;
+    }
 }
 
 void ProfileIODataQt::releaseInterceptor()
 {
-    m_mutex.unlock();
+    Q_ASSERT(content::BrowserThread::CurrentlyOn(content::BrowserThread::IO));
+    m_requestInterceptorInUse.fetchAndStoreOrdered(nullptr);
+    // Only take the lock if publishRequestInterceptor() is waiting for the release.
+    if (m_requestInterceptorWaiters.fetchAndAddOrdered(0)) {
+        QMutexLocker locker(&m_requestInterceptorMutex);
+        m_requestInterceptorReleased.wakeAll();
+    }
 }
 
-bool ProfileIODataQt::canSetCookie(const QUrl &firstPartyUrl, const QByteArray &cookieLine, const QUrl &url) const
+bool ProfileIODataQt::canSetCookie(const GURL &firstPartyUrl, const std::string &cookieLine, const GURL &url) const
 {
-    return m_cookieDelegate->canSetCookie(firstPartyUrl,cookieLine, url);
+    return m_cookieDelegate->canSetCookie(firstPartyUrl, cookieLine, url);
 }
 
-bool ProfileIODataQt::canGetCookies(const QUrl &firstPartyUrl, const QUrl &url) const
+bool ProfileIODataQt::canGetCookies(const GURL &firstPartyUrl, const GURL &url) const
 {
     return m_cookieDelegate->canGetCookies(firstPartyUrl, url);
 }
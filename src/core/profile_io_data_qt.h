@@ -48,6 +48,7 @@
 #include <QtCore/QString>
 #include <QtCore/QPointer>
 #include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
 
 namespace net {
 class DhcpPacFileFetcherFactory;
@@ -63,7 +64,10 @@ class TransportSecurityPersister;
 
 namespace QtWebEngineCore {
 
+class ContentPayloadStoreQt;
+class NavigationPolicyQt;
 class ProfileQt;
+class URLRequestRuleSet;
 
 // ProfileIOData contains data that lives on the IOthread
 // we still use shared memebers and use mutex which breaks
@@ -89,12 +93,18 @@ public:
     void generateUserAgent();
     void generateJobFactory();
     void regenerateJobFactory();
-    bool canSetCookie(const QUrl &firstPartyUrl, const QByteArray &cookieLine, const QUrl &url) const;
-    bool canGetCookies(const QUrl &firstPartyUrl, const QUrl &url) const;
+    bool canSetCookie(const GURL &firstPartyUrl, const std::string &cookieLine, const GURL &url) const;
+    bool canGetCookies(const GURL &firstPartyUrl, const GURL &url) const;
 
-    // Used in NetworkDelegateQt::OnBeforeURLRequest.
+    // Used in NetworkDelegateQt::OnBeforeURLRequest, runs on io thread without locking.
     QWebEngineUrlRequestInterceptor *acquireInterceptor();
     void releaseInterceptor();
+    // Used in NetworkDelegateQt::OnBeforeURLRequest, runs on io thread.
+    const URLRequestRuleSet *urlRequestRuleSet() const { return m_urlRequestRuleSet.data(); }
+    // Used in NetworkDelegateQt for frame requests, runs on io thread.
+    const QSharedPointer<const NavigationPolicyQt> &navigationPolicy() const { return m_navigationPolicy; }
+    // Payloads of WebContentsAdapter::setContent, filled on ui thread and served on io thread.
+    QSharedPointer<ContentPayloadStoreQt> contentPayloadStore() const { return m_contentPayloadStore; }
 
     void setRequestContextData(content::ProtocolHandlerMap *protocolHandlers,
                                content::URLRequestInterceptorScopedVector request_interceptors);
@@ -105,10 +115,16 @@ public:
     void updateHttpCache(); // runs on ui thread
     void updateJobFactory(); // runs on ui thread
     void updateRequestInterceptor(); // runs on ui thread
+    void updateUrlRequestRuleSet(); // runs on ui thread
+    void updateNavigationPolicy(); // runs on ui thread
     void requestStorageGeneration(); //runs on ui thread
     void createProxyConfig(); //runs on ui thread
 
 private:
+    void publishRequestInterceptor(QWebEngineUrlRequestInterceptor *interceptor); // runs on ui thread
+    void setUrlRequestRuleSet(QSharedPointer<URLRequestRuleSet> ruleSet);
+    void setNavigationPolicy(QSharedPointer<const NavigationPolicyQt> policy);
+
     ProfileQt *m_profile;
     std::unique_ptr<net::URLRequestContextStorage> m_storage;
     std::unique_ptr<net::NetworkDelegate> m_networkDelegate;
@@ -138,7 +154,15 @@ private:
     QString m_httpCachePath;
     QList<QByteArray> m_customUrlSchemes;
     QList<QByteArray> m_installedCustomSchemes;
-    QWebEngineUrlRequestInterceptor* m_requestInterceptor = nullptr;
+    QSharedPointer<ConcurrentUrlSchemeHandlers> m_concurrentUrlSchemeHandlers;
+    QAtomicPointer<QWebEngineUrlRequestInterceptor> m_requestInterceptor;
+    QAtomicPointer<QWebEngineUrlRequestInterceptor> m_requestInterceptorInUse;
+    QAtomicInt m_requestInterceptorWaiters;
+    QMutex m_requestInterceptorMutex;
+    QWaitCondition m_requestInterceptorReleased;
+    QSharedPointer<URLRequestRuleSet> m_urlRequestRuleSet;
+    QSharedPointer<const NavigationPolicyQt> m_navigationPolicy;
+    QSharedPointer<ContentPayloadStoreQt> m_contentPayloadStore;
     QMutex m_mutex;
     int m_httpCacheMaxSize = 0;
     bool m_initialized = false;
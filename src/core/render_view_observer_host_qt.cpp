@@ -40,6 +40,7 @@
 #include "render_view_observer_host_qt.h"
 
 #include "common/qt_messages.h"
+#include "common/web_channel_wire_format.h"
 #include "content/public/browser/render_view_host.h"
 #include "content/public/browser/web_contents.h"
 
@@ -47,6 +48,8 @@
 #include "type_conversion.h"
 #include "web_contents_adapter_client.h"
 
+#include <QtCore/QJsonArray>
+
 namespace QtWebEngineCore {
 
 RenderViewObserverHostQt::RenderViewObserverHostQt(content::WebContents *webContents, WebContentsAdapterClient *adapterClient)
@@ -69,6 +72,18 @@ void RenderViewObserverHostQt::fetchDocumentInnerText(quint64 requestId)
                         web_contents()->GetRenderViewHost()->GetRoutingID(), requestId));
 }
 
+void RenderViewObserverHostQt::runJavaScript(quint64 requestId, const QStringList &scripts, quint32 worldId)
+{
+    std::vector<base::string16> sources;
+    sources.reserve(scripts.size());
+    for (const QString &script : scripts)
+        sources.push_back(toString16(script));
+    web_contents()->GetRenderViewHost()->Send(
+                new RenderViewObserverQt_RunJavaScript(
+                    web_contents()->GetRenderViewHost()->GetRoutingID(),
+                    requestId, sources, worldId));
+}
+
 bool RenderViewObserverHostQt::OnMessageReceived(const IPC::Message& message)
 {
     bool handled = true;
@@ -77,6 +92,8 @@ bool RenderViewObserverHostQt::OnMessageReceived(const IPC::Message& message)
                             onDidFetchDocumentMarkup)
         IPC_MESSAGE_HANDLER(RenderViewObserverHostQt_DidFetchDocumentInnerText,
                             onDidFetchDocumentInnerText)
+        IPC_MESSAGE_HANDLER(RenderViewObserverHostQt_DidRunJavaScript,
+                            onDidRunJavaScript)
         IPC_MESSAGE_UNHANDLED(handled = false)
     IPC_END_MESSAGE_MAP()
     return handled;
@@ -93,4 +110,20 @@ void RenderViewObserverHostQt::onDidFetchDocumentInnerText(quint64 requestId, co
     m_adapterClient->didFetchDocumentInnerText(requestId, toQt(innerText));
 }
 
+void RenderViewObserverHostQt::onDidRunJavaScript(quint64 requestId, const std::vector<std::vector<uint8_t>> &results)
+{
+    // Results that JSON cannot express, including undefined, are null like in JSON.stringify([...]).
+    // The decoder limits what each result may expand to, and the results of a batch share
+    // that limit, so a batch cannot expand to a multiple of it either.
+    QJsonArray values;
+    quint64 decodedSize = 0;
+    for (const std::vector<uint8_t> &result : results) {
+        QJsonValue value;
+        if (!result.empty() && !WebChannelWireFormat::decodeValue(result, &value, &decodedSize))
+            value = QJsonValue();
+        values.append(value);
+    }
+    m_adapterClient->didRunJavaScriptBatch(requestId, values);
+}
+
 } // namespace QtWebEngineCore
@@ -42,7 +42,9 @@
 
 #include "content/public/browser/web_contents_observer.h"
 
-#include <QtGlobal>
+#include <QtCore/QStringList>
+
+#include <vector>
 
 namespace content {
     class WebContents;
@@ -58,11 +60,13 @@ public:
     RenderViewObserverHostQt(content::WebContents*, WebContentsAdapterClient *adapterClient);
     void fetchDocumentMarkup(quint64 requestId);
     void fetchDocumentInnerText(quint64 requestId);
+    void runJavaScript(quint64 requestId, const QStringList &scripts, quint32 worldId);
 
 private:
     bool OnMessageReceived(const IPC::Message& message) override;
     void onDidFetchDocumentMarkup(quint64 requestId, const base::string16& markup);
     void onDidFetchDocumentInnerText(quint64 requestId, const base::string16& innerText);
+    void onDidRunJavaScript(quint64 requestId, const std::vector<std::vector<uint8_t>> &results);
 
     WebContentsAdapterClient *m_adapterClient;
 };
@@ -43,6 +43,7 @@
 #include "chromium_overrides.h"
 #include "common/qt_messages.h"
 #include "compositor.h"
+#include "qwebengineframetiming.h"
 #include "qtwebenginecoreglobal_p.h"
 #include "render_widget_host_view_qt_delegate.h"
 #include "type_conversion.h"
@@ -961,6 +962,25 @@ void RenderWidgetHostViewQt::windowChanged()
 {
     if (m_delegate && m_delegate->window())
         host()->NotifyScreenInfoChanged();
+    windowVisibilityChanged();
+}
+
+void RenderWidgetHostViewQt::windowVisibilityChanged()
+{
+    QWindow *window = m_delegate ? m_delegate->window() : nullptr;
+    const bool occluded = window && (window->visibility() == QWindow::Hidden
+                                     || window->visibility() == QWindow::Minimized);
+    m_compositor->setOccluded(occluded);
+}
+
+void RenderWidgetHostViewQt::notifyFrameSwapped()
+{
+    m_compositor->notifyFrameSwapped();
+}
+
+QWebEngineFrameTimingReport RenderWidgetHostViewQt::frameTimingReport() const
+{
+    return m_compositor->frameTimingReport();
 }
 
 bool RenderWidgetHostViewQt::forwardEvent(QEvent *event)
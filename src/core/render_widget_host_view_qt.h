@@ -62,6 +62,7 @@
 
 QT_BEGIN_NAMESPACE
 class QAccessibleInterface;
+class QWebEngineFrameTimingReport;
 QT_END_NAMESPACE
 
 namespace content {
@@ -174,6 +175,8 @@ public:
     void notifyHidden() override;
     void windowBoundsChanged() override;
     void windowChanged() override;
+    void windowVisibilityChanged() override;
+    void notifyFrameSwapped() override;
     bool forwardEvent(QEvent *) override;
     QVariant inputMethodQuery(Qt::InputMethodQuery query) override;
     void closePopup() override;
@@ -183,6 +186,8 @@ public:
     void OnSelectionBoundsChanged(content::TextInputManager *text_input_manager, RenderWidgetHostViewBase *updated_view) override;
     void OnTextSelectionChanged(content::TextInputManager *text_input_manager, RenderWidgetHostViewBase *updated_view) override;
 
+    QWebEngineFrameTimingReport frameTimingReport() const;
+
     void handleMouseEvent(QMouseEvent*);
     void handleKeyEvent(QKeyEvent*);
     void handleWheelEvent(QWheelEvent*);
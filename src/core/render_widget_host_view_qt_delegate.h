@@ -83,6 +83,9 @@ public:
     virtual void notifyHidden() = 0;
     virtual void windowBoundsChanged() = 0;
     virtual void windowChanged() = 0;
+    virtual void windowVisibilityChanged() = 0;
+    // Must be called on the GUI thread once the window presented a frame, in the order of the frames.
+    virtual void notifyFrameSwapped() = 0;
     virtual bool forwardEvent(QEvent *) = 0;
     virtual QVariant inputMethodQuery(Qt::InputMethodQuery query) = 0;
     virtual void closePopup() = 0;
@@ -107,7 +110,10 @@ public:
     virtual QSGInternalImageNode *createInternalImageNode() = 0;
     virtual QSGImageNode *createImageNode() = 0;
     virtual QSGRectangleNode *createRectangleNode() = 0;
-    virtual void update() = 0;
+    // damageRect is the part of the view that changed, in view coordinates, or a null
+    // rectangle if the whole view has to be repainted. It's only a hint for delegates able
+    // to repaint partially, the paint node always has to be updated.
+    virtual void update(const QRect &damageRect = QRect()) = 0;
     virtual void updateCursor(const QCursor &) = 0;
     virtual void resize(int width, int height) = 0;
     virtual void move(const QPoint &) = 0;
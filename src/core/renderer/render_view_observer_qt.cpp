@@ -42,14 +42,18 @@
 #include "common/qt_messages.h"
 
 #include "components/web_cache/renderer/web_cache_impl.h"
+#include "content/public/common/isolated_world_ids.h"
 #include "content/public/renderer/render_view.h"
+#include "third_party/blink/public/web/blink.h"
 #include "third_party/blink/public/web/web_document.h"
 #include "third_party/blink/public/web/web_element.h"
 #include "third_party/blink/public/web/web_frame.h"
 #include "third_party/blink/public/web/web_frame_content_dumper.h"
 #include "third_party/blink/public/web/web_frame_widget.h"
 #include "third_party/blink/public/web/web_local_frame.h"
+#include "third_party/blink/public/web/web_script_source.h"
 #include "third_party/blink/public/web/web_view.h"
+#include "v8/include/v8.h"
 
 RenderViewObserverQt::RenderViewObserverQt(
         content::RenderView* render_view,
@@ -78,6 +82,145 @@ void RenderViewObserverQt::onFetchDocumentInnerText(quint64 requestId)
     Send(new RenderViewObserverHostQt_DidFetchDocumentInnerText(routing_id(), requestId, text.Utf16()));
 }
 
+static blink::WebLocalFrame *localMainFrame(content::RenderView *renderView)
+{
+    blink::WebFrame *frame = renderView->GetWebView()->MainFrame();
+    return frame->IsWebLocalFrame() ? frame->ToWebLocalFrame() : nullptr;
+}
+
+// Longer arrays could not be decoded by the browser anyway.
+static const uint32_t kMaximumResultArrayLength = 128 * 1024 * 1024;
+
+// Copies the members of a result that can be cloned, the way JSON.stringify() walks it:
+// members that cannot be cloned, such as functions or DOM nodes, are left out of objects and
+// become null in arrays. Leaves |copy| empty for a value that cannot be cloned, and returns
+// false for values JSON.stringify() throws on, such as cycles.
+static bool cloneableCopy(v8::Isolate *isolate, v8::Local<v8::Context> context, v8::Local<v8::Value> value,
+                          std::vector<v8::Local<v8::Object>> *ancestors, v8::Local<v8::Value> *copy)
+{
+    *copy = v8::Local<v8::Value>();
+    if (value->IsFunction() || value->IsSymbol() || value->IsProxy())
+        return true;
+    if (!value->IsObject() || value->IsArrayBuffer() || value->IsArrayBufferView() || value->IsDate()
+            || value->IsStringObject() || value->IsNumberObject() || value->IsBooleanObject()) {
+        *copy = value;
+        return true;
+    }
+    v8::Local<v8::Object> object = value.As<v8::Object>();
+    // Their entries are not own properties, so JSON.stringify() writes an empty object.
+    if (value->IsMap() || value->IsSet() || value->IsRegExp() || value->IsSymbolObject()) {
+        *copy = v8::Object::New(isolate);
+        return true;
+    }
+    // Wrappers of DOM objects.
+    if (object->InternalFieldCount() > 0)
+        return true;
+    for (v8::Local<v8::Object> ancestor : *ancestors) {
+        if (ancestor->StrictEquals(object))
+            return false;
+    }
+
+    ancestors->push_back(object);
+    v8::EscapableHandleScope handleScope(isolate);
+    v8::Local<v8::Object> result;
+    if (value->IsArray()) {
+        const uint32_t length = value.As<v8::Array>()->Length();
+        if (length > kMaximumResultArrayLength)
+            return false;
+        result = v8::Array::New(isolate, int(length));
+        for (uint32_t i = 0; i < length; ++i) {
+            v8::Local<v8::Value> element, elementCopy;
+            if (!object->Get(context, i).ToLocal(&element)
+                    || !cloneableCopy(isolate, context, element, ancestors, &elementCopy))
+                return false;
+            if (elementCopy.IsEmpty())
+                elementCopy = v8::Null(isolate);
+            if (!result->Set(context, i, elementCopy).FromMaybe(false))
+                return false;
+        }
+    } else {
+        v8::Local<v8::Array> keys;
+        if (!object->GetOwnPropertyNames(context).ToLocal(&keys))
+            return false;
+        result = v8::Object::New(isolate);
+        for (uint32_t i = 0; i < keys->Length(); ++i) {
+            v8::Local<v8::Value> key, member, memberCopy;
+            if (!keys->Get(context, i).ToLocal(&key) || !object->Get(context, key).ToLocal(&member)
+                    || !cloneableCopy(isolate, context, member, ancestors, &memberCopy))
+                return false;
+            if (memberCopy.IsEmpty() || memberCopy->IsUndefined())
+                continue;
+            if (!result->Set(context, key, memberCopy).FromMaybe(false))
+                return false;
+        }
+    }
+    ancestors->pop_back();
+    *copy = handleScope.Escape(result);
+    return true;
+}
+
+// The result is written with v8::ValueSerializer, which the browser decodes straight into
+// a QJsonValue, instead of going through a base::Value tree. A result that cannot be cloned
+// is left empty.
+static std::vector<uint8_t> serializeResult(v8::Isolate *isolate, v8::Local<v8::Context> context,
+                                            v8::Local<v8::Value> result)
+{
+    if (result.IsEmpty() || context.IsEmpty())
+        return std::vector<uint8_t>();
+    v8::Context::Scope contextScope(context);
+    v8::TryCatch tryCatch(isolate);
+    std::vector<v8::Local<v8::Object>> ancestors;
+    v8::Local<v8::Value> copy;
+    if (!cloneableCopy(isolate, context, result, &ancestors, &copy) || copy.IsEmpty())
+        return std::vector<uint8_t>();
+    v8::ValueSerializer serializer(isolate);
+    serializer.WriteHeader();
+    if (!serializer.WriteValue(context, copy).FromMaybe(false))
+        return std::vector<uint8_t>();
+    std::pair<uint8_t *, size_t> buffer = serializer.Release();
+    std::vector<uint8_t> data(buffer.first, buffer.first + buffer.second);
+    free(buffer.first);
+    return data;
+}
+
+void RenderViewObserverQt::onRunJavaScript(quint64 requestId, const std::vector<base::string16> &scripts, quint32 worldId)
+{
+    std::vector<std::vector<uint8_t>> results;
+    // Blink aborts on world ids beyond the range reserved for embedders, every script of
+    // such a batch results in null instead.
+    if (worldId > content::ISOLATED_WORLD_ID_MAX) {
+        results.resize(scripts.size());
+        Send(new RenderViewObserverHostQt_DidRunJavaScript(routing_id(), requestId, results));
+        return;
+    }
+    results.reserve(scripts.size());
+    v8::Isolate *isolate = blink::MainThreadIsolate();
+    for (const base::string16 &script : scripts) {
+        // A script may navigate the main frame away to another process.
+        blink::WebLocalFrame *frame = localMainFrame(render_view());
+        if (!frame) {
+            results.emplace_back();
+            continue;
+        }
+        v8::HandleScope handleScope(isolate);
+        const blink::WebScriptSource source(blink::WebString::FromUTF16(script));
+        v8::Local<v8::Value> result;
+        v8::Local<v8::Context> context;
+        if (worldId == 0) {
+            result = frame->ExecuteScriptAndReturnValue(source);
+            context = frame->MainWorldScriptContext();
+        } else {
+            blink::WebVector<v8::Local<v8::Value>> values;
+            frame->ExecuteScriptInIsolatedWorld(worldId, &source, 1, &values);
+            if (values.size() == 1)
+                result = values[0];
+            context = frame->IsolatedWorldScriptContext(worldId);
+        }
+        results.push_back(serializeResult(isolate, context, result));
+    }
+    Send(new RenderViewObserverHostQt_DidRunJavaScript(routing_id(), requestId, results));
+}
+
 void RenderViewObserverQt::onSetBackgroundColor(quint32 color)
 {
     render_view()->GetWebFrameWidget()->SetBaseBackgroundColor(color);
@@ -94,6 +237,7 @@ bool RenderViewObserverQt::OnMessageReceived(const IPC::Message& message)
     IPC_BEGIN_MESSAGE_MAP(RenderViewObserverQt, message)
         IPC_MESSAGE_HANDLER(RenderViewObserverQt_FetchDocumentMarkup, onFetchDocumentMarkup)
         IPC_MESSAGE_HANDLER(RenderViewObserverQt_FetchDocumentInnerText, onFetchDocumentInnerText)
+        IPC_MESSAGE_HANDLER(RenderViewObserverQt_RunJavaScript, onRunJavaScript)
         IPC_MESSAGE_HANDLER(RenderViewObserverQt_SetBackgroundColor, onSetBackgroundColor)
         IPC_MESSAGE_UNHANDLED(handled = false)
     IPC_END_MESSAGE_MAP()
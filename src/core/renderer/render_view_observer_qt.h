@@ -39,10 +39,13 @@
 #ifndef RENDER_VIEW_OBSERVER_QT_H
 #define RENDER_VIEW_OBSERVER_QT_H
 
+#include "base/strings/string16.h"
 #include "content/public/renderer/render_view_observer.h"
 
 #include <QtGlobal>
 
+#include <vector>
+
 namespace web_cache {
 class WebCacheImpl;
 }
@@ -55,6 +58,7 @@ public:
 private:
     void onFetchDocumentMarkup(quint64 requestId);
     void onFetchDocumentInnerText(quint64 requestId);
+    void onRunJavaScript(quint64 requestId, const std::vector<base::string16> &scripts, quint32 worldId);
     void onSetBackgroundColor(quint32 color);
 
     void OnDestruct() override;
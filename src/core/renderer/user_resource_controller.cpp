@@ -41,12 +41,10 @@
 
 #include "base/memory/weak_ptr.h"
 #include "base/pending_task.h"
-#include "base/strings/pattern.h"
 #include "content/public/renderer/render_frame.h"
 #include "content/public/renderer/render_view.h"
 #include "content/public/renderer/render_frame_observer.h"
 #include "content/public/renderer/render_view_observer.h"
-#include "extensions/common/url_pattern.h"
 #include "third_party/blink/public/web/web_document.h"
 #include "third_party/blink/public/web/web_local_frame.h"
 #include "third_party/blink/public/web/web_script_source.h"
@@ -58,8 +56,9 @@
 #include "type_conversion.h"
 #include "user_script.h"
 
-#include <QRegularExpression>
+#include <QVector>
 
+#include <algorithm>
 #include <bitset>
 
 Q_GLOBAL_STATIC(UserResourceController, qt_webengine_userResourceController)
@@ -69,67 +68,6 @@ static content::RenderView * const globalScriptsIndex = 0;
 // Scripts meant to run after the load event will be run 500ms after DOMContentLoaded if the load event doesn't come within that delay.
 static const int afterLoadTimeout = 500;
 
-static int validUserScriptSchemes()
-{
-    return URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS | URLPattern::SCHEME_FILE;
-}
-
-static bool regexMatchesURL(const std::string &pat, const GURL &url) {
-    QRegularExpression qre(QtWebEngineCore::toQt(pat));
-    qre.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
-    if (!qre.isValid())
-        return false;
-    return qre.match(QtWebEngineCore::toQt(url.spec())).hasMatch();
-}
-
-static bool includeRuleMatchesURL(const std::string &pat, const GURL &url)
-{
-    // Match patterns for greasemonkey's @include and @exclude rules which can
-    // be either strings with wildcards or regular expressions.
-    if (pat.front() == '/' && pat.back() == '/') {
-        std::string re(++pat.cbegin(), --pat.cend());
-        if (regexMatchesURL(re, url))
-            return true;
-    } else if (base::MatchPattern(url.spec(), pat)) {
-        return true;
-    }
-    return false;
-}
-
-static bool scriptMatchesURL(const UserScriptData &scriptData, const GURL &url) {
-    // Logic taken from Chromium (extensions/common/user_script.cc)
-    bool matchFound;
-    if (!scriptData.urlPatterns.empty()) {
-        matchFound = false;
-        for (auto it = scriptData.urlPatterns.begin(), end = scriptData.urlPatterns.end(); it != end; ++it) {
-            URLPattern urlPattern(validUserScriptSchemes());
-            if (urlPattern.Parse(*it) == URLPattern::PARSE_SUCCESS && urlPattern.MatchesURL(url))
-                matchFound = true;
-        }
-        if (!matchFound)
-            return false;
-    }
-
-    if (!scriptData.globs.empty()) {
-        matchFound = false;
-        for (auto it = scriptData.globs.begin(), end = scriptData.globs.end(); it != end; ++it) {
-            if (includeRuleMatchesURL(*it, url))
-                matchFound = true;
-        }
-        if (!matchFound)
-            return false;
-    }
-
-    if (!scriptData.excludeGlobs.empty()) {
-        for (auto it = scriptData.excludeGlobs.begin(), end = scriptData.excludeGlobs.end(); it != end; ++it) {
-            if (includeRuleMatchesURL(*it, url))
-                return false;
-        }
-    }
-
-    return true;
-}
-
 class UserResourceController::RenderFrameObserverHelper : public content::RenderFrameObserver
 {
 public:
@@ -196,22 +134,54 @@ void UserResourceController::runScripts(UserScriptData::InjectionPoint p, blink:
     if (!renderView)
         return;
 
-    QList<uint64_t> scriptsToRun = m_viewUserScriptMap.value(0).toList();
-    scriptsToRun.append(m_viewUserScriptMap.value(renderView).toList());
+    const GURL url(frame->GetDocument().Url());
+    QString spec;
 
-    for (uint64_t id : qAsConst(scriptsToRun)) {
-        const UserScriptData &script = m_scripts.value(id);
-        if (script.injectionPoint != p
-                || (!script.injectForSubframes && !isMainFrame))
-            continue;
-        if (!scriptMatchesURL(script, frame->GetDocument().Url()))
+    // The indexes keep the scripts alive even if they are removed while one of them runs.
+    const QSharedPointer<const UserScriptIndex> indexes[] = { scriptIndex(globalScriptsIndex), scriptIndex(renderView) };
+    for (const QSharedPointer<const UserScriptIndex> &index : indexes) {
+        QVector<const CompiledUserScript *> candidates;
+        index->collectCandidates(p, url, &candidates);
+        if (candidates.isEmpty())
             continue;
-        blink::WebScriptSource source(blink::WebString::FromUTF8(script.source), script.url);
-        if (script.worldId)
-            frame->ExecuteScriptInIsolatedWorld(script.worldId, source);
-        else
-            frame->ExecuteScript(source);
+        if (spec.isNull())
+            spec = QtWebEngineCore::toQt(url.spec());
+
+        // Run the scripts in the order they were created, a script may have been found through several hosts.
+        auto byId = [](const CompiledUserScript *a, const CompiledUserScript *b) { return a->data().scriptId < b->data().scriptId; };
+        std::sort(candidates.begin(), candidates.end(), byId);
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+        for (const CompiledUserScript *compiled : qAsConst(candidates)) {
+            const UserScriptData &script = compiled->data();
+            if (!script.injectForSubframes && !isMainFrame)
+                continue;
+            if (!compiled->matchesURL(url, spec))
+                continue;
+            // The source is decoded once per process. Compiled code is only reused as far as
+            // V8's compilation cache for this process keeps it.
+            blink::WebScriptSource source(compiled->source(), script.url);
+            if (script.worldId)
+                frame->ExecuteScriptInIsolatedWorld(script.worldId, source);
+            else
+                frame->ExecuteScript(source);
+        }
+    }
+}
+
+QSharedPointer<const UserScriptIndex> UserResourceController::scriptIndex(const content::RenderView *view)
+{
+    auto it = m_scriptIndexes.constFind(view);
+    if (it != m_scriptIndexes.constEnd())
+        return *it;
+
+    QSharedPointer<UserScriptIndex> index(new UserScriptIndex);
+    for (uint64_t id : m_viewUserScriptMap.value(view)) {
+        if (QSharedPointer<const CompiledUserScript> script = m_scripts.value(id))
+            index->add(script);
     }
+    m_scriptIndexes.insert(view, index);
+    return index;
 }
 
 void UserResourceController::RunScriptsAtDocumentEnd(content::RenderFrame *render_frame)
@@ -327,6 +297,7 @@ bool UserResourceController::OnControlMessageReceived(const IPC::Message &messag
     bool handled = true;
     IPC_BEGIN_MESSAGE_MAP(UserResourceController, message)
         IPC_MESSAGE_HANDLER(UserResourceController_AddScript, onAddScript)
+        IPC_MESSAGE_HANDLER(UserResourceController_AddSharedScript, onAddSharedScript)
         IPC_MESSAGE_HANDLER(UserResourceController_RemoveScript, onRemoveScript)
         IPC_MESSAGE_HANDLER(UserResourceController_ClearScripts, onClearScripts)
         IPC_MESSAGE_UNHANDLED(handled = false)
@@ -364,16 +335,26 @@ void UserResourceController::renderViewDestroyed(content::RenderView *renderView
         m_scripts.remove(id);
     }
     m_viewUserScriptMap.remove(renderView);
+    m_scriptIndexes.remove(renderView);
 }
 
 void UserResourceController::addScriptForView(const UserScriptData &script, content::RenderView *view)
+{
+    // Compiled once here rather than every time a frame is matched.
+    addCompiledScriptForView(QSharedPointer<const CompiledUserScript>(new CompiledUserScript(script)), view);
+}
+
+void UserResourceController::addCompiledScriptForView(const QSharedPointer<const CompiledUserScript> &script,
+                                                      content::RenderView *view)
 {
     ViewUserScriptMap::iterator it = m_viewUserScriptMap.find(view);
     if (it == m_viewUserScriptMap.end())
         it = m_viewUserScriptMap.insert(view, UserScriptSet());
 
-    (*it).insert(script.scriptId);
-    m_scripts.insert(script.scriptId, script);
+    const uint64_t scriptId = script->data().scriptId;
+    (*it).insert(scriptId);
+    m_scripts.insert(scriptId, script);
+    m_scriptIndexes.remove(view);
 }
 
 void UserResourceController::removeScriptForView(const UserScriptData &script, content::RenderView *view)
@@ -384,6 +365,7 @@ void UserResourceController::removeScriptForView(const UserScriptData &script, c
 
     (*it).remove(script.scriptId);
     m_scripts.remove(script.scriptId);
+    m_scriptIndexes.remove(view);
 }
 
 void UserResourceController::clearScriptsForView(content::RenderView *view)
@@ -395,6 +377,7 @@ void UserResourceController::clearScriptsForView(content::RenderView *view)
         m_scripts.remove(id);
 
     m_viewUserScriptMap.remove(view);
+    m_scriptIndexes.remove(view);
 }
 
 void UserResourceController::onAddScript(const UserScriptData &script)
@@ -402,6 +385,17 @@ void UserResourceController::onAddScript(const UserScriptData &script)
     addScriptForView(script, globalScriptsIndex);
 }
 
+void UserResourceController::onAddSharedScript(const UserScriptData &script, const base::SharedMemoryHandle &source,
+                                               uint32_t sourceSize)
+{
+    // The mapping is released once the script has decoded its copy of the source.
+    const UserScriptBuffer buffer(source, sourceSize);
+    if (!buffer.isValid())
+        return;
+    addCompiledScriptForView(QSharedPointer<const CompiledUserScript>(new CompiledUserScript(script, &buffer)),
+                             globalScriptsIndex);
+}
+
 void UserResourceController::onRemoveScript(const UserScriptData &script)
 {
     removeScriptForView(script, globalScriptsIndex);
@@ -43,9 +43,11 @@
 #include "content/public/renderer/render_thread_observer.h"
 
 #include "common/user_script_data.h"
+#include "user_script_index.h"
 
 #include <QtCore/QHash>
 #include <QtCore/QSet>
+#include <QtCore/QSharedPointer>
 
 namespace blink {
 class WebLocalFrame;
@@ -80,15 +82,20 @@ private:
     bool OnControlMessageReceived(const IPC::Message &message) override;
 
     void onAddScript(const UserScriptData &);
+    void onAddSharedScript(const UserScriptData &, const base::SharedMemoryHandle &source, uint32_t sourceSize);
     void onRemoveScript(const UserScriptData &);
     void onClearScripts();
 
+    void addCompiledScriptForView(const QSharedPointer<const CompiledUserScript> &, content::RenderView *);
     void runScripts(UserScriptData::InjectionPoint, blink::WebLocalFrame *);
+    QSharedPointer<const UserScriptIndex> scriptIndex(const content::RenderView *);
 
     typedef QSet<uint64_t> UserScriptSet;
     typedef QHash<const content::RenderView *, UserScriptSet> ViewUserScriptMap;
     ViewUserScriptMap m_viewUserScriptMap;
-    QHash<uint64_t, UserScriptData> m_scripts;
+    QHash<uint64_t, QSharedPointer<const CompiledUserScript>> m_scripts;
+    // Built when scripts are run and dropped whenever the scripts of the view change.
+    QHash<const content::RenderView *, QSharedPointer<const UserScriptIndex>> m_scriptIndexes;
 
     friend class RenderFrameObserverHelper;
 };
@@ -0,0 +1,178 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "user_script_index.h"
+
+#include "base/strings/pattern.h"
+
+#include "type_conversion.h"
+
+#include <QtCore/QSet>
+
+#include <algorithm>
+
+static int validUserScriptSchemes()
+{
+    return URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS | URLPattern::SCHEME_FILE;
+}
+
+UserScriptBuffer::UserScriptBuffer(const base::SharedMemoryHandle &handle, size_t size)
+    : m_memory(new base::SharedMemory(handle, true))
+{
+    if (!size || !m_memory->Map(size)) {
+        m_memory.reset();
+        return;
+    }
+    m_data = static_cast<const char *>(m_memory->memory());
+    m_size = size;
+}
+
+CompiledUserScript::CompiledUserScript(const UserScriptData &data, const UserScriptBuffer *source)
+    : m_data(data)
+{
+    // Decoded once here rather than every time the script is run.
+    if (source)
+        m_source = blink::WebString::FromUTF8(source->data(), source->size());
+    else
+        m_source = blink::WebString::FromUTF8(m_data.source);
+    m_data.source.clear();
+
+    // Patterns that fail to parse are dropped here, but still keep the script
+    // from matching anything, see matchesURL().
+    for (const std::string &pattern : data.urlPatterns) {
+        URLPattern urlPattern(validUserScriptSchemes());
+        if (urlPattern.Parse(pattern) == URLPattern::PARSE_SUCCESS)
+            m_urlPatterns.push_back(urlPattern);
+    }
+    for (const std::string &glob : data.globs)
+        m_includeRules.push_back(compileRule(glob));
+    for (const std::string &glob : data.excludeGlobs)
+        m_excludeRules.push_back(compileRule(glob));
+}
+
+CompiledUserScript::IncludeRule CompiledUserScript::compileRule(const std::string &pattern)
+{
+    // Match patterns for greasemonkey's @include and @exclude rules which can
+    // be either strings with wildcards or regular expressions.
+    IncludeRule rule;
+    if (pattern.size() > 1 && pattern.front() == '/' && pattern.back() == '/') {
+        rule.isRegex = true;
+        rule.regex = QRegularExpression(QtWebEngineCore::toQt(pattern.substr(1, pattern.size() - 2)),
+                                        QRegularExpression::CaseInsensitiveOption);
+        rule.regex.optimize();
+    } else {
+        rule.glob = pattern;
+    }
+    return rule;
+}
+
+bool CompiledUserScript::ruleMatchesURL(const IncludeRule &rule, const GURL &url, const QString &spec)
+{
+    if (rule.isRegex)
+        return rule.regex.isValid() && rule.regex.match(spec).hasMatch();
+    return base::MatchPattern(url.spec(), rule.glob);
+}
+
+bool CompiledUserScript::matchesURL(const GURL &url, const QString &spec) const
+{
+    // Logic taken from Chromium (extensions/common/user_script.cc)
+    if (!m_data.urlPatterns.empty()) {
+        if (std::none_of(m_urlPatterns.cbegin(), m_urlPatterns.cend(),
+                         [&url](const URLPattern &pattern) { return pattern.MatchesURL(url); }))
+            return false;
+    }
+
+    auto matches = [&url, &spec](const IncludeRule &rule) { return ruleMatchesURL(rule, url, spec); };
+    if (!m_includeRules.empty() && std::none_of(m_includeRules.cbegin(), m_includeRules.cend(), matches))
+        return false;
+    if (std::any_of(m_excludeRules.cbegin(), m_excludeRules.cend(), matches))
+        return false;
+
+    return true;
+}
+
+void UserScriptIndex::add(const QSharedPointer<const CompiledUserScript> &script)
+{
+    const CompiledUserScript *compiled = script.data();
+    const uint8_t p = compiled->data().injectionPoint;
+    if (p >= sizeof(m_buckets) / sizeof(m_buckets[0]))
+        return;
+    m_scripts.append(script);
+    Bucket &bucket = m_buckets[p];
+
+    // Without URL patterns only the globs restrict the script, which can match any host.
+    bool anyHost = compiled->urlPatterns().empty();
+    QSet<QByteArray> hosts;
+    for (const URLPattern &pattern : compiled->urlPatterns()) {
+        if (pattern.match_all_urls() || pattern.host().empty()) {
+            anyHost = true;
+            break;
+        }
+        hosts.insert(QByteArray::fromStdString(pattern.host()).toLower());
+    }
+
+    if (anyHost) {
+        bucket.anyHost.append(compiled);
+        return;
+    }
+    for (const QByteArray &host : qAsConst(hosts))
+        bucket.byHost[host].append(compiled);
+}
+
+void UserScriptIndex::collectCandidates(UserScriptData::InjectionPoint p, const GURL &url,
+                                        QVector<const CompiledUserScript *> *candidates) const
+{
+    const Bucket &bucket = m_buckets[p];
+    *candidates += bucket.anyHost;
+    if (bucket.byHost.isEmpty())
+        return;
+
+    // Look up the host and each of its parent domains, for patterns matching subdomains.
+    const base::StringPiece host = url.host_piece();
+    size_t begin = 0;
+    while (begin < host.size()) {
+        auto it = bucket.byHost.constFind(QByteArray::fromRawData(host.data() + begin, int(host.size() - begin)));
+        if (it != bucket.byHost.constEnd())
+            *candidates += *it;
+        const size_t dot = host.find('.', begin);
+        if (dot == base::StringPiece::npos)
+            break;
+        begin = dot + 1;
+    }
+}
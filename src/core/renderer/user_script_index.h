@@ -0,0 +1,124 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef USER_SCRIPT_INDEX_H
+#define USER_SCRIPT_INDEX_H
+
+#include "base/memory/shared_memory.h"
+#include "extensions/common/url_pattern.h"
+#include "third_party/blink/public/platform/web_string.h"
+
+#include "common/user_script_data.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QRegularExpression>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QVector>
+
+#include <memory>
+
+// Bytes mapped read-only from a shared memory segment of the browser, unmapped again
+// when the buffer is destroyed.
+class UserScriptBuffer {
+public:
+    UserScriptBuffer(const base::SharedMemoryHandle &handle, size_t size);
+
+    bool isValid() const { return m_data; }
+    const char *data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    Q_DISABLE_COPY(UserScriptBuffer)
+    std::unique_ptr<base::SharedMemory> m_memory;
+    const char *m_data = nullptr;
+    size_t m_size = 0;
+};
+
+// A user script with its URL patterns parsed and its @include and @exclude
+// rules compiled, so matching a URL does not parse anything.
+class CompiledUserScript {
+public:
+    // Takes the source from data unless it is given as a shared buffer, either way the
+    // script keeps its own decoded copy.
+    explicit CompiledUserScript(const UserScriptData &data, const UserScriptBuffer *source = nullptr);
+
+    const UserScriptData &data() const { return m_data; }
+    const std::vector<URLPattern> &urlPatterns() const { return m_urlPatterns; }
+    const blink::WebString &source() const { return m_source; }
+
+    // spec is url.spec() converted once by the caller for the regular expressions.
+    bool matchesURL(const GURL &url, const QString &spec) const;
+
+private:
+    struct IncludeRule {
+        std::string glob;
+        QRegularExpression regex;
+        bool isRegex = false;
+    };
+    static IncludeRule compileRule(const std::string &pattern);
+    static bool ruleMatchesURL(const IncludeRule &rule, const GURL &url, const QString &spec);
+
+    UserScriptData m_data;
+    blink::WebString m_source;
+    std::vector<URLPattern> m_urlPatterns;
+    std::vector<IncludeRule> m_includeRules;
+    std::vector<IncludeRule> m_excludeRules;
+};
+
+// Buckets the scripts of one view by injection point and by the hosts of their
+// URL patterns, so that only candidates are matched against a frame's URL.
+class UserScriptIndex {
+public:
+    void add(const QSharedPointer<const CompiledUserScript> &script);
+
+    // Appends the scripts that may match url to candidates, in no particular order.
+    void collectCandidates(UserScriptData::InjectionPoint p, const GURL &url,
+                           QVector<const CompiledUserScript *> *candidates) const;
+
+private:
+    struct Bucket {
+        QVector<const CompiledUserScript *> anyHost;
+        QHash<QByteArray, QVector<const CompiledUserScript *>> byHost;
+    };
+    Bucket m_buckets[UserScriptData::DocumentElementCreation + 1];
+    QVector<QSharedPointer<const CompiledUserScript>> m_scripts;
+};
+
+#endif // USER_SCRIPT_INDEX_H
@@ -43,7 +43,9 @@
 #include "renderer/web_channel_ipc_transport.h"
 
 #include "common/qt_messages.h"
+#include "common/web_channel_wire_format.h"
 
+#include "base/threading/thread_task_runner_handle.h"
 #include "content/public/renderer/render_frame.h"
 #include "gin/arguments.h"
 #include "gin/handle.h"
@@ -59,26 +61,43 @@
 
 #include <QJsonDocument>
 
+#include <algorithm>
+
 namespace QtWebEngineCore {
 
 class WebChannelTransport : public gin::Wrappable<WebChannelTransport> {
 public:
     static gin::WrapperInfo kWrapperInfo;
-    static void Install(blink::WebLocalFrame *frame, uint worldId);
+    static void Install(blink::WebLocalFrame *frame, uint worldId, base::WeakPtr<WebChannelIPCTransport> transport);
     static void Uninstall(blink::WebLocalFrame *frame, uint worldId);
 private:
-    WebChannelTransport() {}
+    WebChannelTransport(base::WeakPtr<WebChannelIPCTransport> transport) : m_transport(transport) {}
     void NativeQtSendMessage(gin::Arguments *args);
 
     // gin::WrappableBase
     gin::ObjectTemplateBuilder GetObjectTemplateBuilder(v8::Isolate *isolate) override;
 
+    base::WeakPtr<WebChannelIPCTransport> m_transport;
+
     DISALLOW_COPY_AND_ASSIGN(WebChannelTransport);
 };
 
+static v8::Local<v8::Object> transportObject(v8::Isolate *isolate, v8::Local<v8::Context> context)
+{
+    v8::Local<v8::Object> global(context->Global());
+    v8::Local<v8::Value> qtObjectValue(global->Get(gin::StringToV8(isolate, "qt")));
+    if (qtObjectValue.IsEmpty() || !qtObjectValue->IsObject())
+        return v8::Local<v8::Object>();
+    v8::Local<v8::Object> qtObject = v8::Local<v8::Object>::Cast(qtObjectValue);
+    v8::Local<v8::Value> webChannelObjectValue(qtObject->Get(gin::StringToV8(isolate, "webChannelTransport")));
+    if (webChannelObjectValue.IsEmpty() || !webChannelObjectValue->IsObject())
+        return v8::Local<v8::Object>();
+    return v8::Local<v8::Object>::Cast(webChannelObjectValue);
+}
+
 gin::WrapperInfo WebChannelTransport::kWrapperInfo = { gin::kEmbedderNativeGin };
 
-void WebChannelTransport::Install(blink::WebLocalFrame *frame, uint worldId)
+void WebChannelTransport::Install(blink::WebLocalFrame *frame, uint worldId, base::WeakPtr<WebChannelIPCTransport> transport)
 {
     v8::Isolate *isolate = blink::MainThreadIsolate();
     v8::HandleScope handleScope(isolate);
@@ -89,7 +108,7 @@ void WebChannelTransport::Install(blink::WebLocalFrame *frame, uint worldId)
         context = frame->IsolatedWorldScriptContext(worldId);
     v8::Context::Scope contextScope(context);
 
-    gin::Handle<WebChannelTransport> transport = gin::CreateHandle(isolate, new WebChannelTransport);
+    gin::Handle<WebChannelTransport> transportHandle = gin::CreateHandle(isolate, new WebChannelTransport(transport));
 
     v8::Local<v8::Object> global = context->Global();
     v8::Local<v8::Value> qtObjectValue = global->Get(gin::StringToV8(isolate, "qt"));
@@ -100,7 +119,7 @@ void WebChannelTransport::Install(blink::WebLocalFrame *frame, uint worldId)
     } else {
         qtObject = v8::Local<v8::Object>::Cast(qtObjectValue);
     }
-    qtObject->Set(gin::StringToV8(isolate, "webChannelTransport"), transport.ToV8());
+    qtObject->Set(gin::StringToV8(isolate, "webChannelTransport"), transportHandle.ToV8());
 }
 
 void WebChannelTransport::Uninstall(blink::WebLocalFrame *frame, uint worldId)
@@ -128,8 +147,9 @@ void WebChannelTransport::NativeQtSendMessage(gin::Arguments *args)
     if (!frame || !frame->View())
         return;
 
+    // Only the frame the transport was installed in may use it, as before batching.
     content::RenderFrame *renderFrame = content::RenderFrame::FromWebFrame(frame);
-    if (!renderFrame)
+    if (!renderFrame || !m_transport || m_transport->renderFrame() != renderFrame)
         return;
 
     v8::Local<v8::Value> jsonValue;
@@ -138,8 +158,22 @@ void WebChannelTransport::NativeQtSendMessage(gin::Arguments *args)
         return;
     }
 
+    if (jsonValue->IsObject()) {
+        // Structured clone of the message, which the host reads without any JSON text.
+        v8::Isolate *isolate = args->isolate();
+        v8::ValueSerializer serializer(isolate);
+        serializer.WriteHeader();
+        if (!serializer.WriteValue(isolate->GetCurrentContext(), jsonValue).FromMaybe(false))
+            return; // The serializer has thrown an exception.
+        std::pair<uint8_t *, size_t> buffer = serializer.Release();
+        std::vector<uint8_t> message(buffer.first, buffer.first + buffer.second);
+        free(buffer.first);
+        args->Return(m_transport->queueMessage(std::move(message)));
+        return;
+    }
+
     if (!jsonValue->IsString()) {
-        args->ThrowTypeError("Expected string");
+        args->ThrowTypeError("Expected string or object");
         return;
     }
     v8::Local<v8::String> jsonString = v8::Local<v8::String>::Cast(jsonValue);
@@ -158,9 +192,7 @@ void WebChannelTransport::NativeQtSendMessage(gin::Arguments *args)
 
     int size = 0;
     const char *rawData = doc.rawData(&size);
-    qtwebchannel::mojom::WebChannelTransportHostAssociatedPtr webChannelTransport;
-    renderFrame->GetRemoteAssociatedInterfaces()->GetInterface(&webChannelTransport);
-    webChannelTransport->DispatchWebChannelMessage(std::vector<uint8_t>(rawData, rawData + size));
+    args->Return(m_transport->queueMessage(std::vector<uint8_t>(rawData, rawData + size)));
 }
 
 gin::ObjectTemplateBuilder WebChannelTransport::GetObjectTemplateBuilder(v8::Isolate *isolate)
@@ -194,9 +226,11 @@ void WebChannelIPCTransport::SetWorldId(uint32_t worldId)
 
     m_worldInitialized = true;
     m_worldId = worldId;
+    // Messages from before are not acknowledged by a new host.
+    m_messagesInFlight = 0;
 
     if (m_canUseContext)
-        WebChannelTransport::Install(render_frame()->GetWebFrame(), m_worldId);
+        WebChannelTransport::Install(render_frame()->GetWebFrame(), m_worldId, m_weakPtrFactory.GetWeakPtr());
 }
 
 void WebChannelIPCTransport::ResetWorldId()
@@ -206,6 +240,103 @@ void WebChannelIPCTransport::ResetWorldId()
 
     m_worldInitialized = false;
     m_worldId = 0;
+    m_pendingMessages.clear();
+    m_messagesInFlight = 0;
+    m_backPressured = false;
+}
+
+bool WebChannelIPCTransport::queueMessage(std::vector<uint8_t> message)
+{
+    if (m_pendingMessages.size() + m_messagesInFlight >= m_highWaterMark) {
+        m_backPressured = true;
+        return false;
+    }
+    m_pendingMessages.push_back(std::move(message));
+    if (!m_flushScheduled) {
+        m_flushScheduled = true;
+        base::ThreadTaskRunnerHandle::Get()->PostTask(
+                FROM_HERE, base::BindOnce(&WebChannelIPCTransport::flushMessages, m_weakPtrFactory.GetWeakPtr()));
+    }
+    return true;
+}
+
+void WebChannelIPCTransport::flushMessages()
+{
+    m_flushScheduled = false;
+    std::vector<std::vector<uint8_t>> batch;
+    while (!m_pendingMessages.empty() && m_messagesInFlight < m_highWaterMark) {
+        batch.push_back(std::move(m_pendingMessages.front()));
+        m_pendingMessages.pop_front();
+        ++m_messagesInFlight;
+    }
+    if (batch.empty())
+        return;
+
+    qtwebchannel::mojom::WebChannelTransportHostAssociatedPtr webChannelTransport;
+    render_frame()->GetRemoteAssociatedInterfaces()->GetInterface(&webChannelTransport);
+    if (batch.size() == 1)
+        webChannelTransport->DispatchWebChannelMessage(batch.front());
+    else
+        webChannelTransport->DispatchWebChannelMessage(WebChannelWireFormat::encodeBatch(batch));
+}
+
+bool WebChannelIPCTransport::OnMessageReceived(const IPC::Message &message)
+{
+    bool handled = true;
+    IPC_BEGIN_MESSAGE_MAP(WebChannelIPCTransport, message)
+        IPC_MESSAGE_HANDLER(WebChannelIPCTransport_SetHighWaterMark, onSetHighWaterMark)
+        IPC_MESSAGE_HANDLER(WebChannelIPCTransport_Acknowledge, onAcknowledge)
+        IPC_MESSAGE_UNHANDLED(handled = false)
+    IPC_END_MESSAGE_MAP()
+    return handled;
+}
+
+void WebChannelIPCTransport::onSetHighWaterMark(uint32_t messages)
+{
+    m_highWaterMark = std::max(messages, 1u);
+    flushMessages();
+    checkDrained();
+}
+
+void WebChannelIPCTransport::onAcknowledge(uint32_t messages)
+{
+    m_messagesInFlight -= std::min(messages, m_messagesInFlight);
+    flushMessages();
+    checkDrained();
+}
+
+void WebChannelIPCTransport::checkDrained()
+{
+    if (m_backPressured && m_pendingMessages.size() + m_messagesInFlight < m_highWaterMark) {
+        m_backPressured = false;
+        notifyDrained();
+    }
+}
+
+// Tells the page it can send again after send() has returned false.
+void WebChannelIPCTransport::notifyDrained()
+{
+    if (!m_worldInitialized || !m_canUseContext)
+        return;
+
+    blink::WebLocalFrame *frame = render_frame()->GetWebFrame();
+    v8::Isolate *isolate = blink::MainThreadIsolate();
+    v8::HandleScope handleScope(isolate);
+    v8::Local<v8::Context> context;
+    if (m_worldId == 0)
+        context = frame->MainWorldScriptContext();
+    else
+        context = frame->IsolatedWorldScriptContext(m_worldId);
+    v8::Context::Scope contextScope(context);
+
+    v8::Local<v8::Object> webChannelObject = transportObject(isolate, context);
+    if (webChannelObject.IsEmpty())
+        return;
+    v8::Local<v8::Value> callbackValue(webChannelObject->Get(gin::StringToV8(isolate, "ondrain")));
+    if (callbackValue.IsEmpty() || !callbackValue->IsFunction())
+        return;
+    v8::Local<v8::Function> callback = v8::Local<v8::Function>::Cast(callbackValue);
+    frame->CallFunctionEvenIfScriptDisabled(callback, webChannelObject, 0, nullptr);
 }
 
 void WebChannelIPCTransport::DispatchWebChannelMessage(const std::vector<uint8_t> &binaryJson, uint32_t worldId)
@@ -213,11 +344,6 @@ void WebChannelIPCTransport::DispatchWebChannelMessage(const std::vector<uint8_t
     DCHECK(m_canUseContext);
     DCHECK(m_worldId == worldId);
 
-    QJsonDocument doc = QJsonDocument::fromRawData(reinterpret_cast<const char *>(binaryJson.data()),
-                                                   binaryJson.size(), QJsonDocument::BypassValidation);
-    DCHECK(doc.isObject());
-    QByteArray json = doc.toJson(QJsonDocument::Compact);
-
     blink::WebLocalFrame *frame = render_frame()->GetWebFrame();
     v8::Isolate *isolate = blink::MainThreadIsolate();
     v8::HandleScope handleScope(isolate);
@@ -228,26 +354,37 @@ void WebChannelIPCTransport::DispatchWebChannelMessage(const std::vector<uint8_t
         context = frame->IsolatedWorldScriptContext(worldId);
     v8::Context::Scope contextScope(context);
 
-    v8::Local<v8::Object> global(context->Global());
-    v8::Local<v8::Value> qtObjectValue(global->Get(gin::StringToV8(isolate, "qt")));
-    if (qtObjectValue.IsEmpty() || !qtObjectValue->IsObject())
-        return;
-    v8::Local<v8::Object> qtObject = v8::Local<v8::Object>::Cast(qtObjectValue);
-    v8::Local<v8::Value> webChannelObjectValue(qtObject->Get(gin::StringToV8(isolate, "webChannelTransport")));
-    if (webChannelObjectValue.IsEmpty() || !webChannelObjectValue->IsObject())
+    v8::Local<v8::Object> webChannelObject = transportObject(isolate, context);
+    if (webChannelObject.IsEmpty())
         return;
-    v8::Local<v8::Object> webChannelObject = v8::Local<v8::Object>::Cast(webChannelObjectValue);
     v8::Local<v8::Value> callbackValue(webChannelObject->Get(gin::StringToV8(isolate, "onmessage")));
     if (callbackValue.IsEmpty() || !callbackValue->IsFunction()) {
         LOG(WARNING) << "onmessage is not a callable property of qt.webChannelTransport. Some things might not work as expected.";
         return;
     }
 
+    // Messages in the wire format are handed over as objects, which qwebchannel.js accepts
+    // as well as the JSON text of the others.
+    v8::Local<v8::Value> data;
+    if (WebChannelWireFormat::isWireFormat(binaryJson)) {
+        v8::ValueDeserializer deserializer(isolate, binaryJson.data(), binaryJson.size());
+        if (!deserializer.ReadHeader(context).FromMaybe(false) || !deserializer.ReadValue(context).ToLocal(&data)) {
+            LOG(WARNING) << "Could not read a webchannel message.";
+            return;
+        }
+    } else {
+        QJsonDocument doc = QJsonDocument::fromRawData(reinterpret_cast<const char *>(binaryJson.data()),
+                                                       binaryJson.size(), QJsonDocument::BypassValidation);
+        DCHECK(doc.isObject());
+        QByteArray json = doc.toJson(QJsonDocument::Compact);
+        data = v8::String::NewFromUtf8(isolate, json.constData(), v8::String::kNormalString, json.size());
+    }
+
     v8::Local<v8::Object> messageObject(v8::Object::New(isolate));
     v8::Maybe<bool> wasSet = messageObject->DefineOwnProperty(
                 context,
                 v8::String::NewFromUtf8(isolate, "data"),
-                v8::String::NewFromUtf8(isolate, json.constData(), v8::String::kNormalString, json.size()),
+                data,
                 v8::PropertyAttribute(v8::ReadOnly | v8::DontDelete));
     DCHECK(!wasSet.IsNothing() && wasSet.FromJust());
 
@@ -267,7 +404,7 @@ void WebChannelIPCTransport::DidClearWindowObject()
     if (!m_canUseContext) {
         m_canUseContext = true;
         if (m_worldInitialized)
-            WebChannelTransport::Install(render_frame()->GetWebFrame(), m_worldId);
+            WebChannelTransport::Install(render_frame()->GetWebFrame(), m_worldId, m_weakPtrFactory.GetWeakPtr());
     }
 }
 
@@ -40,6 +40,7 @@
 #ifndef WEB_CHANNEL_IPC_TRANSPORT_H
 #define WEB_CHANNEL_IPC_TRANSPORT_H
 
+#include "base/memory/weak_ptr.h"
 #include "content/public/renderer/render_frame_observer.h"
 #include "services/service_manager/public/cpp/binder_registry.h"
 #include "mojo/public/cpp/bindings/associated_binding_set.h"
@@ -47,6 +48,9 @@
 
 #include <QtCore/qglobal.h>
 
+#include <deque>
+#include <limits>
+
 namespace QtWebEngineCore {
 
 class WebChannelIPCTransport: private content::RenderFrameObserver,
@@ -54,6 +58,11 @@ class WebChannelIPCTransport: private content::RenderFrameObserver,
 public:
     WebChannelIPCTransport(content::RenderFrame *);
 
+    // Sends the message along with the others queued in the same task. Returns
+    // false and drops the message once the high-water mark is reached.
+    bool queueMessage(std::vector<uint8_t> message);
+    content::RenderFrame *renderFrame() const { return render_frame(); }
+
 private:
     // qtwebchannel::mojom::WebChannelTransportRender
     void SetWorldId(uint32_t worldId) override;
@@ -64,8 +73,15 @@ private:
     void WillReleaseScriptContext(v8::Local<v8::Context> context, int worldId) override;
     void DidClearWindowObject() override;
     void OnDestruct() override;
+    bool OnMessageReceived(const IPC::Message &message) override;
     void BindRequest(qtwebchannel::mojom::WebChannelTransportRenderAssociatedRequest request);
 
+    void onSetHighWaterMark(uint32_t messages);
+    void onAcknowledge(uint32_t messages);
+    void flushMessages();
+    void checkDrained();
+    void notifyDrained();
+
 private:
     // The worldId from our WebChannelIPCTransportHost or empty when there is no
     // WebChannelIPCTransportHost.
@@ -74,6 +90,15 @@ private:
     // True means it's currently OK to manipulate the frame's script context.
     bool m_canUseContext = false;
     mojo::AssociatedBindingSet<qtwebchannel::mojom::WebChannelTransportRender> m_binding;
+
+    std::deque<std::vector<uint8_t>> m_pendingMessages;
+    // Sent, but not yet acknowledged by the host.
+    uint32_t m_messagesInFlight = 0;
+    uint32_t m_highWaterMark = std::numeric_limits<uint32_t>::max();
+    bool m_flushScheduled = false;
+    // Set when send() has returned false, until the page is told it can send again.
+    bool m_backPressured = false;
+    base::WeakPtrFactory<WebChannelIPCTransport> m_weakPtrFactory{this};
 };
 
 } // namespace
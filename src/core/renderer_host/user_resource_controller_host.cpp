@@ -39,6 +39,8 @@
 
 #include "user_resource_controller_host.h"
 
+#include "base/memory/shared_memory.h"
+#include "base/sha1.h"
 #include "common/qt_messages.h"
 #include "type_conversion.h"
 #include "web_contents_adapter.h"
@@ -48,9 +50,40 @@
 #include "content/public/browser/render_frame_host.h"
 #include "content/public/browser/web_contents.h"
 #include "content/public/browser/web_contents_observer.h"
+#include "content/public/common/isolated_world_ids.h"
 
 namespace QtWebEngineCore {
 
+// A source is written once to shared memory instead of being sent inline to every renderer.
+// Renderers map it only to decode their own copy, so neither the source nor the code compiled
+// from it is shared between processes.
+struct UserResourceControllerHost::SharedSource {
+    std::unique_ptr<base::SharedMemory> source;
+    uint32_t sourceSize = 0;
+    int scriptCount = 0;
+};
+
+static std::unique_ptr<base::SharedMemory> createReadOnlySharedMemory(const void *data, size_t size)
+{
+    base::SharedMemoryCreateOptions options;
+    options.size = size;
+    options.share_read_only = true;
+    std::unique_ptr<base::SharedMemory> memory(new base::SharedMemory);
+    if (!size || !memory->Create(options) || !memory->Map(size))
+        return nullptr;
+    memcpy(memory->memory(), data, size);
+    // Only the read-only handles given to the renderers are needed from now on.
+    memory->Unmap();
+    return memory;
+}
+
+static UserScriptData withoutSource(const UserScriptData &data)
+{
+    UserScriptData stripped(data);
+    stripped.source.clear();
+    return stripped;
+}
+
 class UserResourceControllerHost::WebContentsObserverHelper : public content::WebContentsObserver {
 public:
     WebContentsObserverHelper(UserResourceControllerHost *, content::WebContents *);
@@ -118,13 +151,20 @@ void UserResourceControllerHost::addUserScript(const UserScript &script, WebCont
 {
     if (script.isNull())
         return;
+    // Blink aborts the renderer on world ids beyond the range reserved for embedders.
+    if (script.worldId() > content::ISOLATED_WORLD_ID_MAX) {
+        qWarning("User script %s ignored: world id %u is out of range, the maximum is %d.",
+                 qPrintable(script.name()), script.worldId(), int(content::ISOLATED_WORLD_ID_MAX));
+        return;
+    }
     // Global scripts should be dispatched to all our render processes.
     const bool isProfileWideScript = !adapter;
     if (isProfileWideScript) {
         if (!m_profileWideScripts.contains(script)) {
             m_profileWideScripts.append(script);
+            shareSource(script);
             for (content::RenderProcessHost *renderer : qAsConst(m_observedProcesses))
-                renderer->Send(new UserResourceController_AddScript(script.data()));
+                sendProfileWideScript(renderer, script);
         }
     } else {
         content::WebContents *contents = adapter->webContents();
@@ -169,8 +209,10 @@ bool UserResourceControllerHost::removeUserScript(const UserScript &script, WebC
                 = std::find(m_profileWideScripts.begin(), m_profileWideScripts.end(), script);
         if (it == m_profileWideScripts.end())
             return false;
+        const UserScriptData data = withoutSource((*it).data());
         for (content::RenderProcessHost *renderer : qAsConst(m_observedProcesses))
-            renderer->Send(new UserResourceController_RemoveScript((*it).data()));
+            renderer->Send(new UserResourceController_RemoveScript(data));
+        releaseSource(*it);
         m_profileWideScripts.erase(it);
     } else {
         content::WebContents *contents = adapter->webContents();
@@ -194,6 +236,8 @@ void UserResourceControllerHost::clearAllScripts(WebContentsAdapter *adapter)
     const bool isProfileWideScript = !adapter;
     if (isProfileWideScript) {
         m_profileWideScripts.clear();
+        m_sharedSources.clear();
+        m_sharedSourceHashes.clear();
         for (content::RenderProcessHost *renderer : qAsConst(m_observedProcesses))
             renderer->Send(new UserResourceController_ClearScripts);
     } else {
@@ -231,7 +275,42 @@ void UserResourceControllerHost::renderProcessStartedWithHost(content::RenderPro
     renderer->AddObserver(m_renderProcessObserver.data());
     m_observedProcesses.insert(renderer);
     for (const UserScript &script : qAsConst(m_profileWideScripts))
+        sendProfileWideScript(renderer, script);
+}
+
+void UserResourceControllerHost::shareSource(const UserScript &script)
+{
+    const std::string &source = script.data().source;
+    if (source.empty())
+        return;
+    const std::string hash = base::SHA1HashString(source);
+    QSharedPointer<SharedSource> &shared = m_sharedSources[QByteArray::fromStdString(hash)];
+    if (!shared) {
+        shared.reset(new SharedSource);
+        shared->source = createReadOnlySharedMemory(source.data(), source.size());
+        shared->sourceSize = source.size();
+    }
+    ++shared->scriptCount;
+    m_sharedSourceHashes.insert(script.data().scriptId, QByteArray::fromStdString(hash));
+}
+
+void UserResourceControllerHost::releaseSource(const UserScript &script)
+{
+    const QByteArray hash = m_sharedSourceHashes.take(script.data().scriptId);
+    auto it = m_sharedSources.find(hash);
+    if (it != m_sharedSources.end() && --(*it)->scriptCount == 0)
+        m_sharedSources.erase(it);
+}
+
+void UserResourceControllerHost::sendProfileWideScript(content::RenderProcessHost *renderer, const UserScript &script)
+{
+    const QSharedPointer<SharedSource> shared = m_sharedSources.value(m_sharedSourceHashes.value(script.data().scriptId));
+    if (!shared || !shared->source) {
         renderer->Send(new UserResourceController_AddScript(script.data()));
+        return;
+    }
+    renderer->Send(new UserResourceController_AddSharedScript(withoutSource(script.data()),
+                                                              shared->source->GetReadOnlyHandle(), shared->sourceSize));
 }
 
 void UserResourceControllerHost::webContentsDestroyed(content::WebContents *contents)
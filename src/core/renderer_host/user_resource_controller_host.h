@@ -53,8 +53,10 @@
 
 #include "qtwebenginecoreglobal_p.h"
 
+#include <QtCore/QHash>
 #include <QtCore/QSet>
 #include <QtCore/QScopedPointer>
+#include <QtCore/QSharedPointer>
 #include "user_script.h"
 
 namespace content {
@@ -85,13 +87,20 @@ private:
     Q_DISABLE_COPY(UserResourceControllerHost)
     class WebContentsObserverHelper;
     class RenderProcessObserverHelper;
+    struct SharedSource;
 
     void webContentsDestroyed(content::WebContents *);
+    void shareSource(const UserScript &script);
+    void releaseSource(const UserScript &script);
+    void sendProfileWideScript(content::RenderProcessHost *renderer, const UserScript &script);
 
     QList<UserScript> m_profileWideScripts;
     typedef QHash<content::WebContents *, QList<UserScript>> ContentsScriptsMap;
     ContentsScriptsMap m_perContentsScripts;
     QSet<content::RenderProcessHost *> m_observedProcesses;
+    // The sources of profile-wide scripts by SHA-1, and the hash of each script by id.
+    QHash<QByteArray, QSharedPointer<SharedSource>> m_sharedSources;
+    QHash<uint64_t, QByteArray> m_sharedSourceHashes;
     QScopedPointer<RenderProcessObserverHelper> m_renderProcessObserver;
 };
 
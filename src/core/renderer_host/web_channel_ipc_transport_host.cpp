@@ -39,18 +39,22 @@
 
 #include "web_channel_ipc_transport_host.h"
 
+#include "content/public/browser/navigation_handle.h"
 #include "content/public/browser/render_frame_host.h"
 #include "content/public/browser/render_process_host.h"
 #include "content/public/browser/web_contents.h"
+#include "base/threading/thread_task_runner_handle.h"
 #include "third_party/blink/public/common/associated_interfaces/associated_interface_provider.h"
 #include "third_party/blink/public/common/associated_interfaces/associated_interface_registry.h"
 #include "services/service_manager/public/cpp/interface_provider.h"
 #include "qtwebengine/browser/qtwebchannel.mojom.h"
 #include "common/qt_messages.h"
+#include "common/web_channel_wire_format.h"
 
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QLoggingCategory>
+#include <QPointer>
 
 #include <QtCore/private/qjson_p.h>
 
@@ -58,6 +62,9 @@ namespace QtWebEngineCore {
 
 Q_LOGGING_CATEGORY(log, "qt.webengine.webchanneltransport");
 
+// Messages dispatched to the channel before returning to the event loop.
+static const int dispatchChunkSize = 64;
+
 inline QDebug operator<<(QDebug stream, content::RenderFrameHost *frame)
 {
     return stream << "frame " << frame->GetRoutingID() << " in process " << frame->GetProcess()->GetID();
@@ -94,16 +101,35 @@ uint WebChannelIPCTransportHost::worldId() const
 
 void WebChannelIPCTransportHost::sendMessage(const QJsonObject &message)
 {
-    QJsonDocument doc(message);
-    int size = 0;
-    const char *rawData = doc.rawData(&size);
     content::RenderFrameHost *frame = web_contents()->GetMainFrame();
     qtwebchannel::mojom::WebChannelTransportRenderAssociatedPtr webChannelTransport;
     frame->GetRemoteAssociatedInterfaces()->GetInterface(&webChannelTransport);
-    qCDebug(log).nospace() << "sending webchannel message to " << frame << ": " << doc;
+    qCDebug(log).nospace() << "sending webchannel message to " << frame << ": " << message;
+    ++m_statistics.messagesSent;
+    if (m_useWireFormat) {
+        std::vector<uint8_t> data = WebChannelWireFormat::encode(message);
+        m_statistics.bytesSent += data.size();
+        webChannelTransport->DispatchWebChannelMessage(data, m_worldId);
+        return;
+    }
+    QJsonDocument doc(message);
+    int size = 0;
+    const char *rawData = doc.rawData(&size);
+    m_statistics.bytesSent += size;
     webChannelTransport->DispatchWebChannelMessage(std::vector<uint8_t>(rawData, rawData + size), m_worldId);
 }
 
+void WebChannelIPCTransportHost::setHighWaterMark(uint32_t messages)
+{
+    if (m_highWaterMark == messages)
+        return;
+    m_highWaterMark = messages;
+    for (content::RenderFrameHost *frame : web_contents()->GetAllFrames()) {
+        if (frame->IsRenderFrameLive())
+            frame->Send(new WebChannelIPCTransport_SetHighWaterMark(frame->GetRoutingID(), m_highWaterMark));
+    }
+}
+
 void WebChannelIPCTransportHost::setWorldId(uint32_t worldId)
 {
     if (m_worldId == worldId)
@@ -118,6 +144,8 @@ void WebChannelIPCTransportHost::setWorldId(content::RenderFrameHost *frame, uin
     if (!frame->IsRenderFrameLive())
         return;
     qCDebug(log).nospace() << "sending setWorldId(" << worldId << ") message to " << frame;
+    if (m_highWaterMark)
+        frame->Send(new WebChannelIPCTransport_SetHighWaterMark(frame->GetRoutingID(), m_highWaterMark));
     qtwebchannel::mojom::WebChannelTransportRenderAssociatedPtr webChannelTransport;
     frame->GetRemoteAssociatedInterfaces()->GetInterface(&webChannelTransport);
     webChannelTransport->SetWorldId(worldId);
@@ -136,9 +164,88 @@ void WebChannelIPCTransportHost::resetWorldId()
 
 void WebChannelIPCTransportHost::DispatchWebChannelMessage(const std::vector<uint8_t> &binaryJson)
 {
-    content::RenderFrameHost *frame = web_contents()->GetMainFrame();
+    content::RenderFrameHost *frame = m_binding.GetCurrentTargetFrame();
 
-    if (m_binding.GetCurrentTargetFrame() != frame) {
+    std::vector<std::vector<uint8_t>> messages;
+    if (WebChannelWireFormat::isBatch(binaryJson)) {
+        if (!WebChannelWireFormat::decodeBatch(binaryJson, &messages)) {
+            qCCritical(log).nospace() << "received invalid webchannel batch from " << frame;
+            return;
+        }
+        ++m_statistics.batchesReceived;
+    } else {
+        messages.push_back(binaryJson);
+    }
+    m_statistics.bytesReceived += binaryJson.size();
+
+    // Only the main frame talks to the channel, the others just get their messages acknowledged.
+    const int processId = frame->GetProcess()->GetID();
+    const int routingId = frame->GetRoutingID();
+    if (frame != web_contents()->GetMainFrame()) {
+        acknowledge(processId, routingId, messages.size());
+        return;
+    }
+
+    for (std::vector<uint8_t> &message : messages)
+        m_pendingMessages.push_back({ std::move(message), processId, routingId });
+    m_statistics.queueDepth = int(m_pendingMessages.size());
+    if (!m_dispatchScheduled) {
+        m_dispatchScheduled = true;
+        base::ThreadTaskRunnerHandle::Get()->PostTask(
+                FROM_HERE, base::BindOnce(&WebChannelIPCTransportHost::dispatchPendingMessages,
+                                          m_weakPtrFactory.GetWeakPtr()));
+    }
+}
+
+void WebChannelIPCTransportHost::dispatchPendingMessages()
+{
+    m_dispatchScheduled = false;
+    // Receivers of messageReceived may delete the transport, by unsetting the channel.
+    QPointer<WebChannelIPCTransportHost> guard(this);
+    int processId = 0;
+    int routingId = 0;
+    uint32_t dispatched = 0;
+    for (int i = 0; i < dispatchChunkSize && !m_pendingMessages.empty(); ++i) {
+        PendingMessage message = std::move(m_pendingMessages.front());
+        m_pendingMessages.pop_front();
+        m_statistics.queueDepth = int(m_pendingMessages.size());
+        if (dispatched && (message.processId != processId || message.routingId != routingId)) {
+            acknowledge(processId, routingId, dispatched);
+            dispatched = 0;
+        }
+        processId = message.processId;
+        routingId = message.routingId;
+        ++dispatched;
+
+        content::RenderFrameHost *frame = content::RenderFrameHost::FromID(processId, routingId);
+        if (frame && frame == web_contents()->GetMainFrame())
+            dispatchMessage(frame, message.data);
+        if (!guard)
+            return;
+    }
+    if (dispatched)
+        acknowledge(processId, routingId, dispatched);
+    if (!m_pendingMessages.empty() && !m_dispatchScheduled) {
+        m_dispatchScheduled = true;
+        base::ThreadTaskRunnerHandle::Get()->PostTask(
+                FROM_HERE, base::BindOnce(&WebChannelIPCTransportHost::dispatchPendingMessages,
+                                          m_weakPtrFactory.GetWeakPtr()));
+    }
+}
+
+void WebChannelIPCTransportHost::dispatchMessage(content::RenderFrameHost *frame, const std::vector<uint8_t> &binaryJson)
+{
+    ++m_statistics.messagesReceived;
+
+    if (WebChannelWireFormat::isWireFormat(binaryJson)) {
+        QJsonObject message;
+        if (!WebChannelWireFormat::decode(binaryJson, &message)) {
+            qCCritical(log).nospace() << "received invalid webchannel message from " << frame;
+            return;
+        }
+        m_useWireFormat = true;
+        qCDebug(log).nospace() << "received webchannel message from " << frame << ": " << message;
+        Q_EMIT messageReceived(message, this);
         return;
     }
 
@@ -158,9 +265,23 @@ void WebChannelIPCTransportHost::DispatchWebChannelMessage(const std::vector<uin
     Q_EMIT messageReceived(doc.object(), this);
 }
 
+void WebChannelIPCTransportHost::acknowledge(int processId, int routingId, uint32_t count)
+{
+    content::RenderFrameHost *frame = content::RenderFrameHost::FromID(processId, routingId);
+    if (frame && frame->IsRenderFrameLive())
+        frame->Send(new WebChannelIPCTransport_Acknowledge(routingId, count));
+}
+
 void WebChannelIPCTransportHost::RenderFrameCreated(content::RenderFrameHost *frame)
 {
     setWorldId(frame, m_worldId);
 }
 
+void WebChannelIPCTransportHost::DidFinishNavigation(content::NavigationHandle *navigation)
+{
+    // A new document has to ask for the wire format again.
+    if (navigation->IsInMainFrame() && navigation->HasCommitted() && !navigation->IsSameDocument())
+        m_useWireFormat = false;
+}
+
 } // namespace QtWebEngineCore
@@ -41,7 +41,9 @@
 #define WEB_CHANNEL_IPC_TRANSPORT_H
 
 #include "qtwebenginecoreglobal.h"
+#include "web_contents_adapter.h"
 
+#include "base/memory/weak_ptr.h"
 #include "content/public/browser/web_contents_observer.h"
 #include "services/service_manager/public/cpp/binder_registry.h"
 #include "content/public/browser/web_contents_binding_set.h"
@@ -49,6 +51,8 @@
 
 #include <QWebChannelAbstractTransport>
 
+#include <deque>
+
 QT_FORWARD_DECLARE_CLASS(QString)
 
 namespace QtWebEngineCore {
@@ -62,6 +66,8 @@ public:
 
     void setWorldId(uint32_t worldId);
     uint32_t worldId() const;
+    void setHighWaterMark(uint32_t messages);
+    const WebChannelStatistics &statistics() const { return m_statistics; }
 
     // QWebChannelAbstractTransport
     void sendMessage(const QJsonObject &message) override;
@@ -70,9 +76,13 @@ private:
     void setWorldId(content::RenderFrameHost *frame, uint32_t worldId);
     void resetWorldId();
     void onWebChannelMessage(const std::vector<char> &message);
+    void dispatchPendingMessages();
+    void dispatchMessage(content::RenderFrameHost *frame, const std::vector<uint8_t> &binaryJson);
+    void acknowledge(int processId, int routingId, uint32_t count);
 
     // WebContentsObserver
     void RenderFrameCreated(content::RenderFrameHost *frame) override;
+    void DidFinishNavigation(content::NavigationHandle *navigation) override;
 
     // qtwebchannel::mojom::WebChannelTransportHost
     void DispatchWebChannelMessage(const std::vector<uint8_t> &binaryJson) override;
@@ -80,7 +90,22 @@ private:
     // Empty only during construction/destruction. Synchronized to all the
     // WebChannelIPCTransports/RenderFrames in the observed WebContents.
     uint32_t m_worldId;
+    // Set once the page sends a message in the V8 wire format, and answered in it from then on.
+    bool m_useWireFormat = false;
     content::WebContentsFrameBindingSet<qtwebchannel::mojom::WebChannelTransportHost> m_binding;
+
+    // Messages are dispatched a few at a time, and acknowledged to the frame that sent
+    // them once dispatched, so that a chatty page cannot monopolize the UI thread.
+    struct PendingMessage {
+        std::vector<uint8_t> data;
+        int processId;
+        int routingId;
+    };
+    std::deque<PendingMessage> m_pendingMessages;
+    bool m_dispatchScheduled = false;
+    uint32_t m_highWaterMark = 0;
+    WebChannelStatistics m_statistics;
+    base::WeakPtrFactory<WebChannelIPCTransportHost> m_weakPtrFactory{this};
 };
 
 } // namespace
@@ -49,11 +49,14 @@
 #include "devtools_frontend_qt.h"
 #include "download_manager_delegate_qt.h"
 #include "media_capture_devices_dispatcher.h"
+#include "net/url_request_content_job_qt.h"
 #if QT_CONFIG(webengine_printing_and_pdf)
 #include "printing/print_view_manager_qt.h"
 #endif
 #include "profile_qt.h"
 #include "qwebenginecallback_p.h"
+#include "qwebengineframetiming.h"
+#include "qwebenginewebchannelstatistics.h"
 #include "render_view_observer_host_qt.h"
 #include "render_widget_host_view_qt.h"
 #include "type_conversion.h"
@@ -62,6 +65,7 @@
 #include "web_engine_settings.h"
 
 #include "base/command_line.h"
+#include "base/strings/utf_string_conversions.h"
 #include "base/run_loop.h"
 #include "base/values.h"
 #include "content/browser/renderer_host/render_view_host_impl.h"
@@ -98,6 +102,7 @@
 #include <QDir>
 #include <QGuiApplication>
 #include <QPageLayout>
+#include <QSet>
 #include <QStringList>
 #include <QStyleHints>
 #include <QTimer>
@@ -124,6 +129,22 @@ namespace QtWebEngineCore {
 static const int kTestWindowWidth = 800;
 static const int kTestWindowHeight = 600;
 static const int kHistoryStreamVersion = 3;
+// Key of the NavigationEntry extra data holding the token of its setContent payload.
+static const char kContentPayloadTokenKey[] = "qtwebengine-content-token";
+
+// Length of the data: URL setContent builds, without building it.
+static size_t dataUrlLength(const QByteArray &data, const QString &mimeType)
+{
+    // QByteArray::toPercentEncoding turns every byte but the unreserved ones into %XX.
+    size_t length = mimeType.isEmpty() ? strlen("data:text/plain;charset=US-ASCII,")
+                                       : strlen("data:,") + mimeType.toUtf8().size();
+    for (const char c : data) {
+        const bool unreserved = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+                || c == '-' || c == '.' || c == '_' || c == '~';
+        length += unreserved ? 1 : 3;
+    }
+    return length;
+}
 
 static QVariant fromJSValue(const base::Value *result)
 {
@@ -210,10 +231,10 @@ static void callbackOnEvaluateJS(WebContentsAdapterClient *adapterClient, quint6
 #if QT_CONFIG(webengine_printing_and_pdf)
 static void callbackOnPrintingFinished(WebContentsAdapterClient *adapterClient,
                                        int requestId,
-                                       const std::vector<char>& result)
+                                       const QByteArray &result)
 {
     if (requestId)
-        adapterClient->didPrintPage(requestId, QByteArray(result.data(), result.size()));
+        adapterClient->didPrintPage(requestId, result);
 }
 
 static void callbackOnPdfSavingFinished(WebContentsAdapterClient *adapterClient,
@@ -430,6 +451,8 @@ WebContentsAdapter::~WebContentsAdapter()
     if (m_devToolsFrontend)
         closeDevToolsFrontend();
     Q_ASSERT(!m_devToolsFrontend);
+    for (const QByteArray &token : qAsConst(m_contentPayloadTokens))
+        m_contentPayloadStore->remove(token.toStdString());
 }
 
 void WebContentsAdapter::setClient(WebContentsAdapterClient *adapterClient)
@@ -680,6 +703,11 @@ void WebContentsAdapter::setContent(const QByteArray &data, const QString &mimeT
 
     CHECK_VALID_RENDER_WIDGET_HOST_VIEW(m_webContents->GetRenderViewHost());
 
+    if (dataUrlLength(data, mimeType) > url::kMaxURLChars) {
+        loadContentFromMemory(data, mimeType, baseUrl);
+        return;
+    }
+
     QByteArray encodedData = data.toPercentEncoding();
     std::string urlString;
     if (!mimeType.isEmpty())
@@ -690,7 +718,8 @@ void WebContentsAdapter::setContent(const QByteArray &data, const QString &mimeT
 
     GURL dataUrlToLoad(urlString);
     if (dataUrlToLoad.spec().size() > url::kMaxURLChars) {
-        m_adapterClient->loadFinished(false, baseUrl, false, net::ERR_ABORTED);
+        // Canonicalizing the MIME type made it grow past the limit.
+        loadContentFromMemory(data, mimeType, baseUrl);
         return;
     }
     content::NavigationController::LoadURLParams params((dataUrlToLoad));
@@ -705,6 +734,69 @@ void WebContentsAdapter::setContent(const QByteArray &data, const QString &mimeT
     m_webContents->CollapseSelection();
 }
 
+// Navigates to the base URL itself and lets ContentRequestInterceptorQt answer
+// the navigation with the shared payload, so neither percent-encoding nor the
+// URL length limit apply. Like the data: URL, the navigation bypasses the rule
+// set, the request interceptor and the navigation policy, and may load local
+// resources. Base URLs that are not loaded through the network stack (empty,
+// invalid or non-standard ones) are replaced by an internal kContentSchemeQt URL,
+// which has an opaque origin like the data: URL would have had, and only shown
+// as the base URL or about:blank. The payload lives as long as a navigation
+// entry refers to it, so reloading and going back keep working.
+void WebContentsAdapter::loadContentFromMemory(const QByteArray &data, const QString &mimeType, const QUrl &baseUrl)
+{
+    if (!m_contentPayloadStore)
+        m_contentPayloadStore = profile()->m_profileIOData->contentPayloadStore();
+    const std::string token = m_contentPayloadStore->add(data, mimeType.toStdString());
+    m_contentPayloadTokens.append(QByteArray::fromStdString(token));
+
+    GURL url = toGurl(baseUrl);
+    const bool internalUrl = !url.is_valid() || !url.IsStandard();
+    if (internalUrl)
+        url = GURL(std::string(kContentSchemeQt) + ":" + token);
+
+    content::NavigationController::LoadURLParams params(url);
+    params.extra_headers = std::string(ContentPayloadStoreQt::kTokenHeader) + ": " + token + "\r\n";
+    params.can_load_local_resources = true;
+    params.transition_type = ui::PageTransitionFromInt(ui::PAGE_TRANSITION_TYPED | ui::PAGE_TRANSITION_FROM_API);
+    params.override_user_agent = content::NavigationController::UA_OVERRIDE_TRUE;
+    m_webContents->GetController().LoadURLWithParams(params);
+    if (content::NavigationEntry *entry = m_webContents->GetController().GetPendingEntry()) {
+        entry->SetExtraData(kContentPayloadTokenKey, base::ASCIIToUTF16(token));
+        if (internalUrl)
+            entry->SetVirtualURL(baseUrl.isEmpty() ? GURL(url::kAboutBlankURL) : toGurl(baseUrl));
+    }
+    releaseUnusedContentPayloads();
+    focusIfNecessary();
+    m_webContents->CollapseSelection();
+}
+
+void WebContentsAdapter::releaseUnusedContentPayloads()
+{
+    if (m_contentPayloadTokens.isEmpty())
+        return;
+
+    QSet<QByteArray> usedTokens;
+    const content::NavigationController &controller = m_webContents->GetController();
+    auto addToken = [&usedTokens](content::NavigationEntry *entry) {
+        base::string16 token;
+        if (entry && entry->GetExtraData(kContentPayloadTokenKey, &token))
+            usedTokens.insert(QByteArray::fromStdString(base::UTF16ToASCII(token)));
+    };
+    for (int i = 0; i < controller.GetEntryCount(); ++i)
+        addToken(controller.GetEntryAtIndex(i));
+    addToken(controller.GetPendingEntry());
+
+    for (auto it = m_contentPayloadTokens.begin(); it != m_contentPayloadTokens.end();) {
+        if (usedTokens.contains(*it)) {
+            ++it;
+        } else {
+            m_contentPayloadStore->remove(it->toStdString());
+            it = m_contentPayloadTokens.erase(it);
+        }
+    }
+}
+
 void WebContentsAdapter::save(const QString &filePath, int savePageFormat)
 {
     CHECK_INITIALIZED();
@@ -884,6 +976,7 @@ void WebContentsAdapter::clearNavigationHistory()
     CHECK_INITIALIZED();
     if (m_webContents->GetController().CanPruneAllButLastCommitted())
         m_webContents->GetController().PruneAllButLastCommitted();
+    releaseUnusedContentPayloads();
 }
 
 void WebContentsAdapter::serializeNavigationHistory(QDataStream &output)
@@ -968,6 +1061,13 @@ quint64 WebContentsAdapter::runJavaScriptCallbackResult(const QString &javaScrip
     return m_nextRequestId++;
 }
 
+quint64 WebContentsAdapter::runJavaScriptBatch(const QStringList &javaScripts, quint32 worldId)
+{
+    CHECK_INITIALIZED(0);
+    m_renderViewObserverHost->runJavaScript(m_nextRequestId, javaScripts, worldId);
+    return m_nextRequestId++;
+}
+
 quint64 WebContentsAdapter::fetchDocumentMarkup()
 {
     CHECK_INITIALIZED(0);
@@ -1100,6 +1200,14 @@ bool WebContentsAdapter::recentlyAudible()
     return m_webContents->IsCurrentlyAudible();
 }
 
+QWebEngineFrameTimingReport WebContentsAdapter::frameTimingReport() const
+{
+    CHECK_INITIALIZED(QWebEngineFrameTimingReport());
+    if (RenderWidgetHostViewQt *rwhv = static_cast<RenderWidgetHostViewQt *>(m_webContents->GetRenderWidgetHostView()))
+        return rwhv->frameTimingReport();
+    return QWebEngineFrameTimingReport();
+}
+
 void WebContentsAdapter::copyImageAt(const QPoint &location)
 {
     CHECK_INITIALIZED();
@@ -1311,9 +1419,10 @@ void WebContentsAdapter::setWebChannel(QWebChannel *channel, uint worldId)
     if (m_webChannel == channel && m_webChannelWorld == worldId)
         return;
 
-    if (!m_webChannelTransport.get())
+    if (!m_webChannelTransport.get()) {
         m_webChannelTransport.reset(new WebChannelIPCTransportHost(m_webContents.get(), worldId));
-    else {
+        m_webChannelTransport->setHighWaterMark(m_webChannelHighWaterMark);
+    } else {
         if (m_webChannel != channel)
             m_webChannel->disconnectFrom(m_webChannelTransport.get());
         if (m_webChannelWorld != worldId)
@@ -1329,6 +1438,26 @@ void WebContentsAdapter::setWebChannel(QWebChannel *channel, uint worldId)
     }
     channel->connectTo(m_webChannelTransport.get());
 }
+
+QWebEngineWebChannelStatistics WebContentsAdapter::webChannelStatistics() const
+{
+    if (!m_webChannelTransport)
+        return QWebEngineWebChannelStatistics();
+    return QWebEngineWebChannelStatistics(
+            QSharedPointer<const WebChannelStatistics>::create(m_webChannelTransport->statistics()));
+}
+
+uint WebContentsAdapter::webChannelHighWaterMark() const
+{
+    return m_webChannelHighWaterMark;
+}
+
+void WebContentsAdapter::setWebChannelHighWaterMark(uint messages)
+{
+    m_webChannelHighWaterMark = qMax(1u, messages);
+    if (m_webChannelTransport)
+        m_webChannelTransport->setHighWaterMark(m_webChannelHighWaterMark);
+}
 #endif
 
 #if QT_CONFIG(draganddrop)
@@ -1608,6 +1737,15 @@ bool WebContentsAdapter::isFindTextInProgress() const
     return m_lastFindRequestId != m_webContentsDelegate->lastReceivedFindReply();
 }
 
+// Called on the UI thread for every accepted navigation request, whether the client or the
+// profile's navigation policy accepted it.
+void WebContentsAdapter::navigationRequestAccepted()
+{
+    CHECK_INITIALIZED();
+    if (isFindTextInProgress())
+        stopFinding();
+}
+
 bool WebContentsAdapter::hasFocusedFrame() const
 {
     CHECK_INITIALIZED(false);
@@ -60,6 +60,7 @@
 #include <QScopedPointer>
 #include <QSharedPointer>
 #include <QString>
+#include <QStringList>
 #include <QUrl>
 
 namespace content {
@@ -79,10 +80,13 @@ class QPageLayout;
 class QString;
 class QTemporaryDir;
 class QWebChannel;
+class QWebEngineFrameTimingReport;
+class QWebEngineWebChannelStatistics;
 QT_END_NAMESPACE
 
 namespace QtWebEngineCore {
 
+class ContentPayloadStoreQt;
 class DevToolsFrontendQt;
 class FaviconManager;
 class MessagePassingInterface;
@@ -91,6 +95,17 @@ class RenderViewObserverHostQt;
 class WebChannelIPCTransportHost;
 class WebEngineContext;
 
+// Counters of the transport between a page and its web channel.
+struct WebChannelStatistics {
+    quint64 messagesReceived = 0;
+    quint64 bytesReceived = 0;
+    quint64 batchesReceived = 0;
+    quint64 messagesSent = 0;
+    quint64 bytesSent = 0;
+    // Messages received but not yet dispatched to the channel.
+    int queueDepth = 0;
+};
+
 class QWEBENGINECORE_PRIVATE_EXPORT WebContentsAdapter : public QEnableSharedFromThis<WebContentsAdapter> {
 public:
     static QSharedPointer<WebContentsAdapter> createFromSerializedNavigationHistory(QDataStream &input, WebContentsAdapterClient *adapterClient);
@@ -145,6 +160,7 @@ public:
     qreal currentZoomFactor() const;
     void runJavaScript(const QString &javaScript, quint32 worldId);
     quint64 runJavaScriptCallbackResult(const QString &javaScript, quint32 worldId);
+    quint64 runJavaScriptBatch(const QStringList &javaScripts, quint32 worldId);
     quint64 fetchDocumentMarkup();
     quint64 fetchDocumentInnerText();
     quint64 findText(const QString &subString, bool caseSensitively, bool findBackward);
@@ -156,6 +172,7 @@ public:
     bool isAudioMuted() const;
     void setAudioMuted(bool mute);
     bool recentlyAudible();
+    QWebEngineFrameTimingReport frameTimingReport() const;
 
     // Must match blink::WebMediaPlayerAction::Type.
     enum MediaPlayerAction {
@@ -192,6 +209,10 @@ public:
 #if QT_CONFIG(webengine_webchannel)
     QWebChannel *webChannel() const;
     void setWebChannel(QWebChannel *, uint worldId);
+    QWebEngineWebChannelStatistics webChannelStatistics() const;
+    // The number of messages the page may have waiting for the channel before send() refuses more.
+    uint webChannelHighWaterMark() const;
+    void setWebChannelHighWaterMark(uint messages);
 #endif
     FaviconManager *faviconManager();
 
@@ -218,15 +239,19 @@ public:
     void focusIfNecessary();
     bool isFindTextInProgress() const;
     bool hasFocusedFrame() const;
+    void navigationRequestAccepted();
 
     // meant to be used within WebEngineCore only
     void initialize(content::SiteInstance *site);
     content::WebContents *webContents() const;
+    // Frees the setContent payloads that no navigation entry refers to anymore.
+    void releaseUnusedContentPayloads();
 
 private:
     Q_DISABLE_COPY(WebContentsAdapter)
     void waitForUpdateDragActionCalled();
     bool handleDropDataFileContents(const content::DropData &dropData, QMimeData *mimeData);
+    void loadContentFromMemory(const QByteArray &data, const QString &mimeType, const QUrl &baseUrl);
 
     ProfileAdapter *m_profileAdapter;
     std::unique_ptr<content::WebContents> m_webContents;
@@ -236,6 +261,7 @@ private:
     std::unique_ptr<WebChannelIPCTransportHost> m_webChannelTransport;
     QWebChannel *m_webChannel;
     unsigned int m_webChannelWorld;
+    uint m_webChannelHighWaterMark = 1000;
 #endif
     WebContentsAdapterClient *m_adapterClient;
     quint64 m_nextRequestId;
@@ -247,6 +273,8 @@ private:
     QPointF m_lastDragScreenPos;
     std::unique_ptr<QTemporaryDir> m_dndTmpDir;
     DevToolsFrontendQt *m_devToolsFrontend;
+    QSharedPointer<ContentPayloadStoreQt> m_contentPayloadStore;
+    QList<QByteArray> m_contentPayloadTokens;
 };
 
 } // namespace QtWebEngineCore
@@ -62,6 +62,7 @@
 
 QT_FORWARD_DECLARE_CLASS(CertificateErrorController)
 QT_FORWARD_DECLARE_CLASS(ClientCertSelectController)
+QT_FORWARD_DECLARE_CLASS(QJsonArray)
 QT_FORWARD_DECLARE_CLASS(QKeyEvent)
 QT_FORWARD_DECLARE_CLASS(QVariant)
 QT_FORWARD_DECLARE_CLASS(QWebEngineQuotaRequest)
@@ -441,6 +442,8 @@ public:
     virtual void runFileChooser(QSharedPointer<FilePickerController>) = 0;
     virtual void showColorDialog(QSharedPointer<ColorChooserController>) = 0;
     virtual void didRunJavaScript(quint64 requestId, const QVariant& result) = 0;
+    // Only clients that call WebContentsAdapter::runJavaScriptBatch() receive this.
+    virtual void didRunJavaScriptBatch(quint64 /*requestId*/, const QJsonArray &/*results*/) { }
     virtual void didFetchDocumentMarkup(quint64 requestId, const QString& result) = 0;
     virtual void didFetchDocumentInnerText(quint64 requestId, const QString& result) = 0;
     virtual void didFindText(quint64 requestId, int matchCount) = 0;
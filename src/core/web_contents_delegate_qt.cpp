@@ -339,6 +339,9 @@ void WebContentsDelegateQt::DidFinishNavigation(content::NavigationHandle *navig
     if (!navigation_handle->IsInMainFrame())
         return;
 
+    // The navigation may have dropped entries, or the pending one, along with their content.
+    webContentsAdapter()->releaseUnusedContentPayloads();
+
     if (navigation_handle->HasCommitted() && !navigation_handle->IsErrorPage()) {
         ProfileAdapter *profileAdapter = m_viewClient->profileAdapter();
         // VisistedLinksMaster asserts !IsOffTheRecord().
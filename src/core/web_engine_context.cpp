@@ -363,6 +363,13 @@ WebEngineContext::WebEngineContext()
         QWebEngineUrlScheme::registerScheme(qrcScheme);
     }
 
+    // Internal scheme of setContent payloads that come without a usable base URL.
+    // Gets an opaque origin like the data: URLs used for smaller payloads.
+    QWebEngineUrlScheme contentScheme(QByteArrayLiteral("qtwebengine-content"));
+    contentScheme.setFlags(QWebEngineUrlScheme::LocalAccessAllowed
+                           | QWebEngineUrlScheme::NoAccessAllowed);
+    QWebEngineUrlScheme::registerScheme(contentScheme);
+
     QWebEngineUrlScheme::lockSchemes();
 
     // Allow us to inject javascript like any webview toolkit.
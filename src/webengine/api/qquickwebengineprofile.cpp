@@ -942,4 +942,39 @@ QQmlListProperty<QQuickWebEngineScript> QQuickWebEngineProfile::userScripts()
                                                    d->userScripts_clear);
 }
 
+
+/*!
+    \qmlproperty NavigationPolicy WebEngineProfile::navigationPolicy
+    \since QtWebEngine 1.9
+
+    The rules that decide about navigation requests of the views that use this profile,
+    without emitting WebEngineView::navigationRequested for matching requests.
+
+    The policy is a value type: read it, add rules to the copy, and assign it back.
+    Assign an empty policy to remove it.
+
+    \sa QWebEngineNavigationPolicy
+*/
+
+/*!
+    \property QQuickWebEngineProfile::navigationPolicy
+    \since 5.13
+
+    \brief The navigation policy evaluated on the IO thread for the views of this profile.
+
+    \sa QWebEngineNavigationPolicy, QWebEngineProfile::setNavigationPolicy()
+*/
+void QQuickWebEngineProfile::setNavigationPolicy(const QWebEngineNavigationPolicy &policy)
+{
+    Q_D(QQuickWebEngineProfile);
+    d->profileAdapter()->setNavigationPolicy(policy);
+    emit navigationPolicyChanged();
+}
+
+QWebEngineNavigationPolicy QQuickWebEngineProfile::navigationPolicy() const
+{
+    const Q_D(QQuickWebEngineProfile);
+    return d->profileAdapter()->navigationPolicy();
+}
+
 QT_END_NAMESPACE
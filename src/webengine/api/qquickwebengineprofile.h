@@ -47,6 +47,7 @@
 #include <QtCore/QScopedPointer>
 #include <QtCore/QString>
 #include <QtQml/QQmlListProperty>
+#include <QtWebEngineCore/qwebenginenavigationpolicy.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -72,6 +73,7 @@ class Q_WEBENGINE_EXPORT QQuickWebEngineProfile : public QObject {
     Q_PROPERTY(QStringList spellCheckLanguages READ spellCheckLanguages WRITE setSpellCheckLanguages NOTIFY spellCheckLanguagesChanged FINAL REVISION 3)
     Q_PROPERTY(bool spellCheckEnabled READ isSpellCheckEnabled WRITE setSpellCheckEnabled NOTIFY spellCheckEnabledChanged FINAL REVISION 3)
     Q_PROPERTY(QQmlListProperty<QQuickWebEngineScript> userScripts READ userScripts FINAL REVISION 4)
+    Q_PROPERTY(QWebEngineNavigationPolicy navigationPolicy READ navigationPolicy WRITE setNavigationPolicy NOTIFY navigationPolicyChanged FINAL REVISION 5)
 
 public:
     QQuickWebEngineProfile(QObject *parent = Q_NULLPTR);
@@ -137,6 +139,9 @@ public:
 
     QQmlListProperty<QQuickWebEngineScript> userScripts();
 
+    void setNavigationPolicy(const QWebEngineNavigationPolicy &policy);
+    QWebEngineNavigationPolicy navigationPolicy() const;
+
     static QQuickWebEngineProfile *defaultProfile();
 
 Q_SIGNALS:
@@ -151,6 +156,7 @@ Q_SIGNALS:
     Q_REVISION(1) void httpAcceptLanguageChanged();
     Q_REVISION(3) void spellCheckLanguagesChanged();
     Q_REVISION(3) void spellCheckEnabledChanged();
+    Q_REVISION(5) void navigationPolicyChanged();
 
     void downloadRequested(QQuickWebEngineDownloadItem *download);
     void downloadFinished(QQuickWebEngineDownloadItem *download);
@@ -125,6 +125,7 @@ QQuickWebEngineViewPrivate::QQuickWebEngineViewPrivate()
     , devicePixelRatio(QGuiApplication::primaryScreen()->devicePixelRatio())
     , m_webChannel(0)
     , m_webChannelWorld(0)
+    , m_webChannelHighWaterMark(1000)
     , m_isBeingAdopted(false)
     , m_dpiScale(1.0)
     , m_backgroundColor(Qt::white)
@@ -271,8 +272,6 @@ void QQuickWebEngineViewPrivate::navigationRequested(int navigationType, const Q
     Q_EMIT q->navigationRequested(&navigationRequest);
 
     navigationRequestAction = navigationRequest.action();
-    if ((navigationRequestAction == WebContentsAdapterClient::AcceptRequest) && adapter->isFindTextInProgress())
-        adapter->stopFinding();
 }
 
 void QQuickWebEngineViewPrivate::javascriptDialog(QSharedPointer<JavaScriptDialogController> dialog)
@@ -823,6 +822,7 @@ void QQuickWebEngineViewPrivate::initializationFinished()
     }
 
 #if QT_CONFIG(webengine_webchannel)
+    adapter->setWebChannelHighWaterMark(m_webChannelHighWaterMark);
     if (m_webChannel)
         adapter->setWebChannel(m_webChannel, m_webChannelWorld);
 #endif
@@ -1329,6 +1329,12 @@ bool QQuickWebEngineView::recentlyAudible() const
     return d->adapter->recentlyAudible();
 }
 
+QWebEngineFrameTimingReport QQuickWebEngineView::frameTimingReport() const
+{
+    const Q_D(QQuickWebEngineView);
+    return d->adapter->frameTimingReport();
+}
+
 void QQuickWebEngineView::printToPdf(const QString& filePath, PrintedPageSizeId pageSizeId, PrintedPageOrientation orientation)
 {
 #if QT_CONFIG(webengine_printing_and_pdf)
@@ -1459,6 +1465,39 @@ void QQuickWebEngineView::setWebChannelWorld(uint webChannelWorld)
 #endif
 }
 
+uint QQuickWebEngineView::webChannelHighWaterMark() const
+{
+    Q_D(const QQuickWebEngineView);
+    return d->m_webChannelHighWaterMark;
+}
+
+void QQuickWebEngineView::setWebChannelHighWaterMark(uint webChannelHighWaterMark)
+{
+#if QT_CONFIG(webengine_webchannel)
+    Q_D(QQuickWebEngineView);
+    webChannelHighWaterMark = qMax(1u, webChannelHighWaterMark);
+    if (d->m_webChannelHighWaterMark == webChannelHighWaterMark)
+        return;
+    d->m_webChannelHighWaterMark = webChannelHighWaterMark;
+    if (d->profileInitialized())
+        d->adapter->setWebChannelHighWaterMark(webChannelHighWaterMark);
+    Q_EMIT webChannelHighWaterMarkChanged(webChannelHighWaterMark);
+#else
+    Q_UNUSED(webChannelHighWaterMark)
+    qWarning("WebEngine compiled without webchannel support");
+#endif
+}
+
+QWebEngineWebChannelStatistics QQuickWebEngineView::webChannelStatistics() const
+{
+#if QT_CONFIG(webengine_webchannel)
+    Q_D(const QQuickWebEngineView);
+    return d->adapter->webChannelStatistics();
+#else
+    return QWebEngineWebChannelStatistics();
+#endif
+}
+
 QQuickWebEngineView *QQuickWebEngineView::inspectedView() const
 {
     Q_D(const QQuickWebEngineView);
@@ -53,6 +53,8 @@
 
 #include <QtWebEngineCore/private/qtwebenginecoreglobal_p.h>
 #include <QtWebEngine/private/qtwebengineglobal_p.h>
+#include <QtWebEngineCore/qwebengineframetiming.h>
+#include <QtWebEngineCore/qwebenginewebchannelstatistics.h>
 #include "qquickwebenginescript.h"
 #include <QQuickItem>
 #include <QtGui/qcolor.h>
@@ -129,6 +131,7 @@ class Q_WEBENGINE_PRIVATE_EXPORT QQuickWebEngineView : public QQuickItem {
     Q_PROPERTY(bool audioMuted READ isAudioMuted WRITE setAudioMuted NOTIFY audioMutedChanged FINAL REVISION 3)
     Q_PROPERTY(bool recentlyAudible READ recentlyAudible NOTIFY recentlyAudibleChanged FINAL REVISION 3)
     Q_PROPERTY(uint webChannelWorld READ webChannelWorld WRITE setWebChannelWorld NOTIFY webChannelWorldChanged REVISION 3 FINAL)
+    Q_PROPERTY(uint webChannelHighWaterMark READ webChannelHighWaterMark WRITE setWebChannelHighWaterMark NOTIFY webChannelHighWaterMarkChanged REVISION 9 FINAL)
 
     Q_PROPERTY(QQuickWebEngineView *inspectedView READ inspectedView WRITE setInspectedView NOTIFY inspectedViewChanged REVISION 7 FINAL)
     Q_PROPERTY(QQuickWebEngineView *devToolsView READ devToolsView WRITE setDevToolsView NOTIFY devToolsViewChanged REVISION 7 FINAL)
@@ -471,11 +474,15 @@ public:
     QQuickWebEngineHistory *navigationHistory() const;
     uint webChannelWorld() const;
     void setWebChannelWorld(uint);
+    uint webChannelHighWaterMark() const;
+    void setWebChannelHighWaterMark(uint);
+    Q_REVISION(9) Q_INVOKABLE QWebEngineWebChannelStatistics webChannelStatistics() const;
     Q_REVISION(8) Q_INVOKABLE QQuickWebEngineAction *action(WebAction action);
 
     bool isAudioMuted() const;
     void setAudioMuted(bool muted);
     bool recentlyAudible() const;
+    Q_REVISION(9) Q_INVOKABLE QWebEngineFrameTimingReport frameTimingReport() const;
 
 #if QT_CONFIG(webengine_testsupport)
     QQuickWebEngineTestSupport *testSupport() const;
@@ -550,6 +557,7 @@ Q_SIGNALS:
     Q_REVISION(7) void devToolsViewChanged();
     Q_REVISION(7) void registerProtocolHandlerRequested(const QWebEngineRegisterProtocolHandlerRequest &request);
     Q_REVISION(8) void printRequested();
+    Q_REVISION(9) void webChannelHighWaterMarkChanged(uint);
 
 #if QT_CONFIG(webengine_testsupport)
     void testSupportChanged();
@@ -53,6 +53,9 @@
 #include "qquickwebenginesingleton_p.h"
 #include "qquickwebengineview_p.h"
 #include "qquickwebengineaction_p.h"
+#include "qwebengineframetiming.h"
+#include "qwebenginenavigationpolicy.h"
+#include "qwebenginewebchannelstatistics.h"
 #include "qwebenginequotarequest.h"
 #include "qwebengineregisterprotocolhandlerrequest.h"
 #include "qtwebengineversion.h"
@@ -91,11 +94,13 @@ public:
         qmlRegisterType<QQuickWebEngineView, 6>(uri, 1, 6, "WebEngineView");
         qmlRegisterType<QQuickWebEngineView, 7>(uri, 1, 7, "WebEngineView");
         qmlRegisterType<QQuickWebEngineView, 8>(uri, 1, 8, "WebEngineView");
+        qmlRegisterType<QQuickWebEngineView, 9>(uri, 1, 9, "WebEngineView");
         qmlRegisterType<QQuickWebEngineProfile>(uri, 1, 1, "WebEngineProfile");
         qmlRegisterType<QQuickWebEngineProfile, 1>(uri, 1, 2, "WebEngineProfile");
         qmlRegisterType<QQuickWebEngineProfile, 2>(uri, 1, 3, "WebEngineProfile");
         qmlRegisterType<QQuickWebEngineProfile, 3>(uri, 1, 4, "WebEngineProfile");
         qmlRegisterType<QQuickWebEngineProfile, 4>(uri, 1, 5, "WebEngineProfile");
+        qmlRegisterType<QQuickWebEngineProfile, 5>(uri, 1, 9, "WebEngineProfile");
         qmlRegisterType<QQuickWebEngineScript>(uri, 1, 1, "WebEngineScript");
         qmlRegisterUncreatableType<QQuickWebEngineCertificateError>(uri, 1, 1, "WebEngineCertificateError", msgUncreatableType("WebEngineCertificateError"));
         qmlRegisterUncreatableType<QQuickWebEngineDownloadItem>(uri, 1, 1, "WebEngineDownloadItem",
@@ -153,6 +158,18 @@ public:
         qmlRegisterUncreatableType<QWebEngineRegisterProtocolHandlerRequest>(uri, 1, 7, "RegisterProtocolHandlerRequest",
                                                                              msgUncreatableType("RegisterProtocolHandlerRequest"));
         qmlRegisterUncreatableType<QQuickWebEngineAction>(uri, 1, 8, "WebEngineAction", msgUncreatableType("WebEngineAction"));
+        qRegisterMetaType<QWebEngineFrameTiming>();
+        qmlRegisterUncreatableType<QWebEngineFrameTiming>(uri, 1, 9, "FrameTiming",
+                                                          msgUncreatableType("FrameTiming"));
+        qRegisterMetaType<QWebEngineFrameTimingReport>();
+        qmlRegisterUncreatableType<QWebEngineFrameTimingReport>(uri, 1, 9, "FrameTimingReport",
+                                                                msgUncreatableType("FrameTimingReport"));
+        qRegisterMetaType<QWebEngineWebChannelStatistics>();
+        qmlRegisterUncreatableType<QWebEngineWebChannelStatistics>(uri, 1, 9, "WebChannelStatistics",
+                                                                   msgUncreatableType("WebChannelStatistics"));
+        qRegisterMetaType<QWebEngineNavigationPolicy>();
+        qmlRegisterUncreatableType<QWebEngineNavigationPolicy>(uri, 1, 9, "NavigationPolicy",
+                                                               msgUncreatableType("NavigationPolicy"));
     }
 
 private:
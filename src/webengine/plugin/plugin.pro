@@ -1,7 +1,7 @@
 CXX_MODULE = qml
 TARGET = qtwebengineplugin
 TARGETPATH = QtWebEngine
-IMPORT_VERSION = 1.8
+IMPORT_VERSION = 1.9
 
 QT += webengine qml quick
 QT_PRIVATE += core-private webenginecore-private webengine-private
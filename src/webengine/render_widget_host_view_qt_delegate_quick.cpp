@@ -183,8 +183,10 @@ QSGRectangleNode *RenderWidgetHostViewQtDelegateQuick::createRectangleNode()
     return QQuickItem::window()->createRectangleNode();
 }
 
-void RenderWidgetHostViewQtDelegateQuick::update()
+void RenderWidgetHostViewQtDelegateQuick::update(const QRect &)
 {
+    // QQuickItem has no partial update. The paint node update that follows only rebuilds
+    // the nodes of the quads inside the damage of the frame, see DelegatedFrameNode.
     QQuickItem::update();
 }
 
@@ -344,6 +346,10 @@ void RenderWidgetHostViewQtDelegateQuick::itemChange(ItemChange change, const It
         if (value.window) {
             m_windowConnections.append(connect(value.window, SIGNAL(xChanged(int)), SLOT(onWindowPosChanged())));
             m_windowConnections.append(connect(value.window, SIGNAL(yChanged(int)), SLOT(onWindowPosChanged())));
+            m_windowConnections.append(connect(value.window, SIGNAL(visibilityChanged(QWindow::Visibility)), SLOT(onWindowVisibilityChanged())));
+            // frameSwapped is emitted by the render thread, always queue it to keep it ordered
+            // with the frames the compositor committed on that thread.
+            m_windowConnections.append(connect(value.window, SIGNAL(frameSwapped()), SLOT(onFrameSwapped()), Qt::QueuedConnection));
             if (!m_isPopup)
                 m_windowConnections.append(connect(value.window, SIGNAL(closing(QQuickCloseEvent *)), SLOT(onHide())));
         }
@@ -367,6 +373,16 @@ void RenderWidgetHostViewQtDelegateQuick::onWindowPosChanged()
     m_client->windowBoundsChanged();
 }
 
+void RenderWidgetHostViewQtDelegateQuick::onWindowVisibilityChanged()
+{
+    m_client->windowVisibilityChanged();
+}
+
+void RenderWidgetHostViewQtDelegateQuick::onFrameSwapped()
+{
+    m_client->notifyFrameSwapped();
+}
+
 void RenderWidgetHostViewQtDelegateQuick::onHide()
 {
     QFocusEvent event(QEvent::FocusOut, Qt::OtherFocusReason);
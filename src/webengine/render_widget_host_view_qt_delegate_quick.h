@@ -74,7 +74,7 @@ public:
     QSGInternalImageNode *createInternalImageNode() override;
     QSGImageNode *createImageNode() override;
     QSGRectangleNode *createRectangleNode() override;
-    void update() override;
+    void update(const QRect &damageRect) override;
     void updateCursor(const QCursor &) override;
     void resize(int width, int height) override;
     void move(const QPoint&) override { }
@@ -105,6 +105,8 @@ protected:
 
 private slots:
     void onWindowPosChanged();
+    void onWindowVisibilityChanged();
+    void onFrameSwapped();
     void onHide();
 
 private:
@@ -119,10 +119,10 @@ QSGRectangleNode *RenderWidgetHostViewQtDelegateQuickWindow::createRectangleNode
     return m_realDelegate->createRectangleNode();
 }
 
-void RenderWidgetHostViewQtDelegateQuickWindow::update()
+void RenderWidgetHostViewQtDelegateQuickWindow::update(const QRect &damageRect)
 {
     QQuickWindow::update();
-    m_realDelegate->update();
+    m_realDelegate->update(damageRect);
 }
 
 void RenderWidgetHostViewQtDelegateQuickWindow::updateCursor(const QCursor &cursor)
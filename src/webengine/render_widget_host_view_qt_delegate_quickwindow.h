@@ -71,7 +71,7 @@ public:
     QSGInternalImageNode *createInternalImageNode() override;
     QSGImageNode *createImageNode() override;
     QSGRectangleNode *createRectangleNode() override;
-    void update() override;
+    void update(const QRect &damageRect) override;
     void updateCursor(const QCursor &) override;
     void resize(int width, int height) override;
     void move(const QPoint &screenPos) override;
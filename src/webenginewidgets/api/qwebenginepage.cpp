@@ -48,9 +48,10 @@
 #include "file_picker_controller.h"
 #include "javascript_dialog_controller.h"
 #if QT_CONFIG(webengine_printing_and_pdf)
-#include "printing/pdfium_document_wrapper_qt.h"
+#include "printer_worker.h"
 #endif
 #include "qwebenginecertificateerror.h"
+#include "qwebengineframetiming.h"
 #include "qwebenginefullscreenrequest.h"
 #include "qwebenginehistory.h"
 #include "qwebenginehistory_p.h"
@@ -62,6 +63,7 @@
 #include "qwebenginesettings.h"
 #include "qwebengineview.h"
 #include "qwebengineview_p.h"
+#include "qwebenginewebchannelstatistics.h"
 #include "render_widget_host_view_qt_delegate_widget.h"
 #include "web_contents_adapter.h"
 #include "web_engine_settings.h"
@@ -97,6 +99,7 @@
 #endif
 #include <QStandardPaths>
 #include <QStyle>
+#include <QThread>
 #include <QTimer>
 #include <QUrl>
 
@@ -106,89 +109,6 @@ using namespace QtWebEngineCore;
 
 static const int MaxTooltipLength = 1024;
 
-#if QT_CONFIG(webengine_printing_and_pdf)
-static bool printPdfDataOnPrinter(const QByteArray& data, QPrinter& printer)
-{
-    if (!data.size()) {
-        qWarning("Failure to print on printer %ls: Print result data is empty.",
-                 qUtf16Printable(printer.printerName()));
-        return false;
-    }
-
-    QSize pageSize = printer.pageRect().size();
-    PdfiumDocumentWrapperQt pdfiumWrapper(data.constData(), data.size(), pageSize);
-
-    int toPage = printer.toPage();
-    int fromPage = printer.fromPage();
-    bool ascendingOrder = true;
-
-    if (fromPage == 0 && toPage == 0) {
-        fromPage = 1;
-        toPage = pdfiumWrapper.pageCount();
-    }
-    fromPage = qMax(1, fromPage);
-    toPage = qMin(pdfiumWrapper.pageCount(), toPage);
-
-    if (printer.pageOrder() == QPrinter::LastPageFirst) {
-        qSwap(fromPage, toPage);
-        ascendingOrder = false;
-    }
-
-    int pageCopies = 1;
-    int documentCopies = 1;
-
-    if (!printer.supportsMultipleCopies())
-        documentCopies = printer.copyCount();
-
-    if (printer.collateCopies()) {
-        pageCopies = documentCopies;
-        documentCopies = 1;
-    }
-
-    QPainter painter;
-    if (!painter.begin(&printer)) {
-        qWarning("Failure to print on printer %ls: Could not open printer for painting.",
-                  qUtf16Printable(printer.printerName()));
-        return false;
-    }
-
-    for (int printedDocuments = 0; printedDocuments < documentCopies; printedDocuments++) {
-        int currentPageIndex = fromPage;
-        while (true) {
-            for (int printedPages = 0; printedPages < pageCopies; printedPages++) {
-                if (printer.printerState() == QPrinter::Aborted
-                        || printer.printerState() == QPrinter::Error)
-                    return false;
-
-                QImage currentImage = pdfiumWrapper.pageAsQImage(currentPageIndex - 1);
-                if (currentImage.isNull())
-                    return false;
-
-                // Painting operations are automatically clipped to the bounds of the drawable part of the page.
-                painter.drawImage(QRect(0, 0, pageSize.width(), pageSize.height()), currentImage, currentImage.rect());
-                if (printedPages < pageCopies - 1)
-                    printer.newPage();
-            }
-
-            if (currentPageIndex == toPage)
-                break;
-
-            if (ascendingOrder)
-                currentPageIndex++;
-            else
-                currentPageIndex--;
-
-            printer.newPage();
-        }
-        if (printedDocuments < documentCopies - 1)
-            printer.newPage();
-    }
-    painter.end();
-
-    return true;
-}
-#endif // QT_CONFIG(webengine_printing_and_pdf)
-
 static QWebEnginePage::WebWindowType toWindowType(WebContentsAdapterClient::WindowOpenDisposition disposition)
 {
     switch (disposition) {
@@ -239,6 +159,7 @@ QWebEnginePagePrivate::QWebEnginePagePrivate(QWebEngineProfile *_profile)
     , fullscreenMode(false)
     , webChannel(nullptr)
     , webChannelWorldId(QWebEngineScript::MainWorld)
+    , webChannelHighWaterMark(1000)
     , defaultAudioMuted(false)
     , defaultZoomFactor(1.0)
 #if QT_CONFIG(webengine_printing_and_pdf)
@@ -262,6 +183,12 @@ QWebEnginePagePrivate::QWebEnginePagePrivate(QWebEngineProfile *_profile)
 
 QWebEnginePagePrivate::~QWebEnginePagePrivate()
 {
+#if QT_CONFIG(webengine_printing_and_pdf)
+    if (currentPrinterWorker) {
+        currentPrinterWorker->cancel();
+        stopPrinterThread();
+    }
+#endif
     delete history;
     delete settings;
     profile->d_ptr->removeWebContentsAdapterClient(this);
@@ -284,6 +211,7 @@ void QWebEnginePagePrivate::initializationFinished()
     if (m_backgroundColor != Qt::white)
         adapter->setBackgroundColor(m_backgroundColor);
 #if QT_CONFIG(webengine_webchannel)
+    adapter->setWebChannelHighWaterMark(webChannelHighWaterMark);
     if (webChannel)
         adapter->setWebChannel(webChannel, webChannelWorldId);
 #endif
@@ -487,6 +415,11 @@ void QWebEnginePagePrivate::didRunJavaScript(quint64 requestId, const QVariant&
     m_callbacks.invoke(requestId, result);
 }
 
+void QWebEnginePagePrivate::didRunJavaScriptBatch(quint64 requestId, const QJsonArray &results)
+{
+    m_callbacks.invoke(requestId, results);
+}
+
 void QWebEnginePagePrivate::didFetchDocumentMarkup(quint64 requestId, const QString& result)
 {
     m_callbacks.invoke(requestId, result);
@@ -511,10 +444,25 @@ void QWebEnginePagePrivate::didPrintPage(quint64 requestId, const QByteArray &re
         return;
     }
 
-    bool printerResult = printPdfDataOnPrinter(result, *currentPrinter);
+    if (currentPrinterCancelled) {
+        currentPrinter = nullptr;
+        m_callbacks.invoke(requestId, false);
+        return;
+    }
 
-    currentPrinter = nullptr;
-    m_callbacks.invoke(requestId, printerResult);
+    // Rasterizing and painting the pages takes long, keep the event loop running meanwhile.
+    Q_Q(QWebEnginePage);
+    currentPrinterThread = new QThread;
+    currentPrinterWorker = new PrinterWorker(result, currentPrinter);
+    currentPrinterWorker->moveToThread(currentPrinterThread);
+    QObject::connect(currentPrinterThread, &QThread::started, currentPrinterWorker, &PrinterWorker::print);
+    QObject::connect(currentPrinterWorker, &PrinterWorker::pagePrinted, q, &QWebEnginePage::printProgress);
+    QObject::connect(currentPrinterWorker, &PrinterWorker::resultReady, q, [this, requestId] (bool success) {
+        stopPrinterThread();
+        currentPrinter = nullptr;
+        m_callbacks.invoke(requestId, success);
+    });
+    currentPrinterThread->start();
 #else
     // we should never enter this branch, but just for safe-keeping...
     Q_UNUSED(result);
@@ -522,6 +470,19 @@ void QWebEnginePagePrivate::didPrintPage(quint64 requestId, const QByteArray &re
 #endif
 }
 
+#if QT_CONFIG(webengine_printing_and_pdf)
+void QWebEnginePagePrivate::stopPrinterThread()
+{
+    currentPrinterThread->quit();
+    currentPrinterThread->wait();
+    // The worker is idle once its thread has finished.
+    delete currentPrinterWorker;
+    delete currentPrinterThread;
+    currentPrinterWorker = nullptr;
+    currentPrinterThread = nullptr;
+}
+#endif
+
 bool QWebEnginePagePrivate::passOnFocus(bool reverse)
 {
     if (view)
@@ -942,6 +903,17 @@ QWebEnginePage::QWebEnginePage(QObject* parent)
     \sa printToPdf()
 */
 
+/*!
+    \fn void QWebEnginePage::printProgress(int printedPages, int totalPages)
+    \since 5.13
+
+    This signal is emitted while print() paints pages on the printer.
+    \a printedPages is the number of pages painted so far, out of \a totalPages
+    pages including all copies.
+
+    \sa print(), cancelPrint()
+*/
+
 /*!
     \property QWebEnginePage::scrollPosition
     \since 5.7
@@ -1102,6 +1074,65 @@ void QWebEnginePage::setWebChannel(QWebChannel *channel, uint worldId)
 #endif
 }
 
+/*!
+    \since 5.13
+
+    Returns the number of messages the page may have waiting for the web channel
+    before \c qt.webChannelTransport.send() refuses more.
+
+    The default is 1000 messages.
+
+    \sa setWebChannelHighWaterMark(), webChannelStatistics()
+*/
+uint QWebEnginePage::webChannelHighWaterMark() const
+{
+    Q_D(const QWebEnginePage);
+    return d->webChannelHighWaterMark;
+}
+
+/*!
+    \since 5.13
+
+    Sets the number of messages the page may have waiting for the web channel to \a messages.
+
+    Messages the page sends are waiting from the moment \c qt.webChannelTransport.send()
+    accepts them until they are delivered to the channel. Once as many as \a messages are
+    waiting, \c send() returns \c false and drops the message, and the \c ondrain handler
+    of the transport is called when the page can send again. A value of 0 is treated as 1.
+
+    \sa webChannelHighWaterMark(), webChannelStatistics()
+*/
+void QWebEnginePage::setWebChannelHighWaterMark(uint messages)
+{
+#if QT_CONFIG(webengine_webchannel)
+    Q_D(QWebEnginePage);
+    d->webChannelHighWaterMark = qMax(1u, messages);
+    d->adapter->setWebChannelHighWaterMark(d->webChannelHighWaterMark);
+#else
+    Q_UNUSED(messages)
+    qWarning("WebEngine compiled without webchannel support");
+#endif
+}
+
+/*!
+    \since 5.13
+
+    Returns the counters of the transport between the page and its web channel.
+
+    The statistics are all zero while no web channel is set.
+
+    \sa setWebChannel(), webChannelHighWaterMark()
+*/
+QWebEngineWebChannelStatistics QWebEnginePage::webChannelStatistics() const
+{
+#if QT_CONFIG(webengine_webchannel)
+    Q_D(const QWebEnginePage);
+    return d->adapter->webChannelStatistics();
+#else
+    return QWebEngineWebChannelStatistics();
+#endif
+}
+
 /*!
     \property QWebEnginePage::backgroundColor
     \brief The page's background color behind the document's body.
@@ -1190,6 +1221,20 @@ bool QWebEnginePage::recentlyAudible() const
     return d->adapter->isInitialized() && d->adapter->recentlyAudible();
 }
 
+/*!
+    \since 5.13
+
+    Returns the timings of the last frames rendered by the page, from their submission
+    by the renderer until the swap of the window that presented them.
+
+    The report is empty if the page has not rendered any frame yet.
+*/
+QWebEngineFrameTimingReport QWebEnginePage::frameTimingReport() const
+{
+    Q_D(const QWebEnginePage);
+    return d->adapter->frameTimingReport();
+}
+
 void QWebEnginePage::setView(QWidget *newViewBase)
 {
     QWebEnginePagePrivate::bindPageAndView(this, qobject_cast<QWebEngineView *>(newViewBase));
@@ -1732,8 +1777,6 @@ void QWebEnginePagePrivate::navigationRequested(int navigationType, const QUrl &
 {
     Q_Q(QWebEnginePage);
     bool accepted = q->acceptNavigationRequest(url, static_cast<QWebEnginePage::NavigationType>(navigationType), isMainFrame);
-    if (accepted && adapter->isFindTextInProgress())
-        adapter->stopFinding();
     navigationRequestAction = accepted ? WebContentsAdapterClient::AcceptRequest : WebContentsAdapterClient::IgnoreRequest;
 }
 
@@ -2177,6 +2220,14 @@ void QWebEnginePage::runJavaScript(const QString& scriptSource, quint32 worldId,
     d->m_callbacks.registerCallback(requestId, resultCallback);
 }
 
+void QWebEnginePage::runJavaScript(const QStringList &scripts, quint32 worldId, const QWebEngineCallback<const QJsonArray &> &resultCallback)
+{
+    Q_D(QWebEnginePage);
+    d->ensureInitialized();
+    quint64 requestId = d->adapter->runJavaScriptBatch(scripts, worldId);
+    d->m_callbacks.registerCallback(requestId, resultCallback);
+}
+
 /*!
     Returns the collection of scripts that are injected into the page.
 
@@ -2430,6 +2481,9 @@ QSizeF QWebEnginePage::contentsSize() const
     pdfPrintingFinished().
 
     If a file already exists at the provided file path, it will be overwritten.
+
+    Since Qt 5.13, requests made while another one is in progress are queued
+    and processed in order, instead of failing.
     \since 5.7
     \sa pdfPrintingFinished()
 */
@@ -2462,6 +2516,9 @@ void QWebEnginePage::printToPdf(const QString &filePath, const QPageLayout &page
     during page destruction. When QWebEnginePage is deleted, the callback is triggered with an invalid
     value and it is not safe to use the corresponding QWebEnginePage or QWebEngineView instance inside it.
 
+    Since Qt 5.13, requests made while another one is in progress are queued
+    and processed in order, instead of failing.
+
     \since 5.7
 */
 void QWebEnginePage::printToPdf(const QWebEngineCallback<const QByteArray&> &resultCallback, const QPageLayout &pageLayout)
@@ -2491,9 +2548,10 @@ void QWebEnginePage::printToPdf(const QWebEngineCallback<const QByteArray&> &res
     has been called.
 
     \note The rendering of the current content into a temporary PDF document is asynchronous and does
-    not block the main thread. However, the subsequent rendering of PDF into \a printer runs on the
-    main thread and will therefore block the event loop. Moreover, printing runs on the browser
-    process, which is by default not sandboxed.
+    not block the main thread. Since Qt 5.13, the subsequent rendering of PDF into \a printer runs on
+    a separate thread as well, so \a printer must not be used until \a resultCallback has been called.
+    Progress is reported by printProgress(), and cancelPrint() aborts printing. Moreover, printing
+    runs on the browser process, which is by default not sandboxed.
 
     The \a resultCallback must take a boolean as parameter. If printing was successful, this
     boolean will have the value \c true, otherwise, its value will be \c false.
@@ -2514,6 +2572,7 @@ void QWebEnginePage::print(QPrinter *printer, const QWebEngineCallback<bool> &re
         return;
     }
     d->currentPrinter = printer;
+    d->currentPrinterCancelled = false;
     d->ensureInitialized();
     quint64 requestId = d->adapter->printToPDFCallbackResult(printer->pageLayout(),
                                                              printer->colorMode() == QPrinter::Color,
@@ -2525,6 +2584,25 @@ void QWebEnginePage::print(QPrinter *printer, const QWebEngineCallback<bool> &re
 #endif
 }
 
+/*!
+    Cancels printing started by print(). The printer is aborted and the result callback
+    of print() is called with \c false. Does nothing if no printing is in progress.
+
+    \since 5.13
+    \sa printProgress()
+*/
+void QWebEnginePage::cancelPrint()
+{
+#if QT_CONFIG(webengine_printing_and_pdf)
+    Q_D(QWebEnginePage);
+    if (!d->currentPrinter)
+        return;
+    d->currentPrinterCancelled = true;
+    if (d->currentPrinterWorker)
+        d->currentPrinterWorker->cancel();
+#endif
+}
+
 /*!
     \since 5.7
 
@@ -62,6 +62,7 @@ class QWebChannel;
 class QWebEngineCertificateError;
 class QWebEngineClientCertificateSelection;
 class QWebEngineContextMenuData;
+class QWebEngineFrameTimingReport;
 class QWebEngineFullScreenRequest;
 class QWebEngineHistory;
 class QWebEnginePage;
@@ -71,6 +72,7 @@ class QWebEngineQuotaRequest;
 class QWebEngineRegisterProtocolHandlerRequest;
 class QWebEngineScriptCollection;
 class QWebEngineSettings;
+class QWebEngineWebChannelStatistics;
 
 class QWEBENGINEWIDGETS_EXPORT QWebEnginePage : public QObject {
     Q_OBJECT
@@ -278,12 +280,16 @@ public:
     void runJavaScript(const QString& scriptSource, quint32 worldId);
     void runJavaScript(const QString& scriptSource, const QWebEngineCallback<const QVariant &> &resultCallback);
     void runJavaScript(const QString& scriptSource, quint32 worldId, const QWebEngineCallback<const QVariant &> &resultCallback);
+    void runJavaScript(const QStringList &scripts, quint32 worldId, const QWebEngineCallback<const QJsonArray &> &resultCallback);
     QWebEngineScriptCollection &scripts();
     QWebEngineSettings *settings() const;
 
     QWebChannel *webChannel() const;
     void setWebChannel(QWebChannel *);
     void setWebChannel(QWebChannel *, uint worldId);
+    uint webChannelHighWaterMark() const;
+    void setWebChannelHighWaterMark(uint messages);
+    QWebEngineWebChannelStatistics webChannelStatistics() const;
     QColor backgroundColor() const;
     void setBackgroundColor(const QColor &color);
 
@@ -294,9 +300,12 @@ public:
     void setAudioMuted(bool muted);
     bool recentlyAudible() const;
 
+    QWebEngineFrameTimingReport frameTimingReport() const;
+
     void printToPdf(const QString &filePath, const QPageLayout &layout = QPageLayout(QPageSize(QPageSize::A4), QPageLayout::Portrait, QMarginsF()));
     void printToPdf(const QWebEngineCallback<const QByteArray&> &resultCallback, const QPageLayout &layout = QPageLayout(QPageSize(QPageSize::A4), QPageLayout::Portrait, QMarginsF()));
     void print(QPrinter *printer, const QWebEngineCallback<bool> &resultCallback);
+    void cancelPrint();
 
     void setInspectedPage(QWebEnginePage *page);
     QWebEnginePage *inspectedPage() const;
@@ -342,6 +351,7 @@ Q_SIGNALS:
 
     void pdfPrintingFinished(const QString &filePath, bool success);
     void printRequested();
+    void printProgress(int printedPages, int totalPages);
 
 protected:
     virtual QWebEnginePage *createWindow(WebWindowType type);
@@ -64,12 +64,14 @@
 #include <QtCore/QTimer>
 
 namespace QtWebEngineCore {
+class PrinterWorker;
 class RenderWidgetHostViewQtDelegate;
 class RenderWidgetHostViewQtDelegateWidget;
 class WebContentsAdapter;
 }
 
 QT_BEGIN_NAMESPACE
+class QThread;
 class QWebEngineHistory;
 class QWebEnginePage;
 class QWebEngineProfile;
@@ -121,6 +123,7 @@ public:
     void runFileChooser(QSharedPointer<QtWebEngineCore::FilePickerController>) override;
     void showColorDialog(QSharedPointer<QtWebEngineCore::ColorChooserController>) override;
     void didRunJavaScript(quint64 requestId, const QVariant& result) override;
+    void didRunJavaScriptBatch(quint64 requestId, const QJsonArray &results) override;
     void didFetchDocumentMarkup(quint64 requestId, const QString& result) override;
     void didFetchDocumentInnerText(quint64 requestId, const QString& result) override;
     void didFindText(quint64 requestId, int matchCount) override;
@@ -169,7 +172,11 @@ public:
 
     void setFullScreenMode(bool);
     void ensureInitialized() const;
+#if QT_CONFIG(webengine_printing_and_pdf)
+    void stopPrinterThread();
+#endif
 
+    static QWebEnginePagePrivate *get(QWebEnginePage *page) { return page->d_func(); }
     static void bindPageAndView(QWebEnginePage *page, QWebEngineView *view);
     static void bindPageAndWidget(QWebEnginePage *page,
                                   QtWebEngineCore::RenderWidgetHostViewQtDelegateWidget *widget);
@@ -188,6 +195,7 @@ public:
     bool fullscreenMode;
     QWebChannel *webChannel;
     unsigned int webChannelWorldId;
+    uint webChannelHighWaterMark;
     QUrl iconUrl;
     bool m_navigationActionTriggered;
     QPointer<QWebEnginePage> inspectedPage;
@@ -201,6 +209,9 @@ public:
     mutable QAction *actions[QWebEnginePage::WebActionCount];
 #if QT_CONFIG(webengine_printing_and_pdf)
     QPrinter *currentPrinter;
+    QtWebEngineCore::PrinterWorker *currentPrinterWorker = nullptr;
+    QThread *currentPrinterThread = nullptr;
+    bool currentPrinterCancelled = false;
 #endif
 };
 
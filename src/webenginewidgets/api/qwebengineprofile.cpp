@@ -52,6 +52,8 @@
 #include "visited_links_manager_qt.h"
 #include "web_engine_settings.h"
 
+#include <QtWebEngineCore/qwebenginenavigationpolicy.h>
+#include <QtWebEngineCore/qwebengineurlrequestruleset.h>
 #include <QtWebEngineCore/qwebengineurlscheme.h>
 
 QT_BEGIN_NAMESPACE
@@ -558,6 +560,66 @@ void QWebEngineProfile::setRequestInterceptor(QWebEngineUrlRequestInterceptor *i
     d->profileAdapter()->setRequestInterceptor(interceptor);
 }
 
+/*!
+    Installs \a ruleSet to block or redirect URL requests of this profile.
+
+    The rules are evaluated on the IO thread for every request before the request
+    interceptor is called, and requests they block or redirect do not reach the
+    interceptor. Setting a new rule set replaces the previous one for requests that
+    have not been evaluated yet. Pass a null rule set to remove it.
+
+    \since 5.13
+    \sa urlRequestRuleSet(), QWebEngineUrlRequestRuleSet
+*/
+void QWebEngineProfile::setUrlRequestRuleSet(const QWebEngineUrlRequestRuleSet &ruleSet)
+{
+    Q_D(QWebEngineProfile);
+    d->profileAdapter()->setUrlRequestRuleSet(ruleSet);
+}
+
+/*!
+    Returns the rule set installed on this profile, which can be used to read the hit counts of
+    its rules.
+
+    \since 5.13
+    \sa setUrlRequestRuleSet()
+*/
+QWebEngineUrlRequestRuleSet QWebEngineProfile::urlRequestRuleSet() const
+{
+    const Q_D(QWebEngineProfile);
+    return d->profileAdapter()->urlRequestRuleSet();
+}
+
+/*!
+    Installs \a policy to decide about navigation requests of the pages of this profile.
+
+    The policy is evaluated on the IO thread. Navigation requests matching one of its rules
+    are accepted, blocked or ignored without calling QWebEnginePage::acceptNavigationRequest(),
+    which saves a round trip to the UI thread for each of them. Setting a new policy replaces
+    the previous one for navigations that have not been evaluated yet. Pass an empty policy to
+    remove it.
+
+    \since 5.13
+    \sa navigationPolicy(), QWebEngineNavigationPolicy
+*/
+void QWebEngineProfile::setNavigationPolicy(const QWebEngineNavigationPolicy &policy)
+{
+    Q_D(QWebEngineProfile);
+    d->profileAdapter()->setNavigationPolicy(policy);
+}
+
+/*!
+    Returns the navigation policy installed on this profile.
+
+    \since 5.13
+    \sa setNavigationPolicy()
+*/
+QWebEngineNavigationPolicy QWebEngineProfile::navigationPolicy() const
+{
+    const Q_D(QWebEngineProfile);
+    return d->profileAdapter()->navigationPolicy();
+}
+
 /*!
     Clears all links from the visited links database.
 
@@ -52,12 +52,14 @@ class QObject;
 class QUrl;
 class QWebEngineCookieStore;
 class QWebEngineDownloadItem;
+class QWebEngineNavigationPolicy;
 class QWebEnginePage;
 class QWebEnginePagePrivate;
 class QWebEngineProfilePrivate;
 class QWebEngineSettings;
 class QWebEngineScriptCollection;
 class QWebEngineUrlRequestInterceptor;
+class QWebEngineUrlRequestRuleSet;
 class QWebEngineUrlSchemeHandler;
 
 class QWEBENGINEWIDGETS_EXPORT QWebEngineProfile : public QObject {
@@ -108,6 +110,12 @@ public:
     QWebEngineCookieStore* cookieStore();
     void setRequestInterceptor(QWebEngineUrlRequestInterceptor *interceptor);
 
+    QWebEngineUrlRequestRuleSet urlRequestRuleSet() const;
+    void setUrlRequestRuleSet(const QWebEngineUrlRequestRuleSet &ruleSet);
+
+    QWebEngineNavigationPolicy navigationPolicy() const;
+    void setNavigationPolicy(const QWebEngineNavigationPolicy &policy);
+
     void clearAllVisitedLinks();
     void clearVisitedLinks(const QList<QUrl> &urls);
     bool visitedLinksContainsUrl(const QUrl &url) const;
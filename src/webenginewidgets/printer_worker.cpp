@@ -0,0 +1,233 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "printer_worker.h"
+
+#include "printing/pdfium_document_wrapper_qt.h"
+
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QPainter>
+#include <QPrinter>
+#include <QRunnable>
+#include <QVector>
+#include <QWaitCondition>
+
+namespace QtWebEngineCore {
+
+// Pages are rasterized at twice the printer resolution, so only a few are kept ahead.
+static const int kLookAheadPages = 2;
+
+// Shared with the rasterization tasks.
+struct PrinterPageQueue {
+    QMutex mutex;
+    QWaitCondition pageReady;
+    QHash<int, QImage> images; // by position in the print sequence
+    bool cancelled = false;
+    QByteArray data; // PDFium reads the document from this memory
+    QScopedPointer<PdfiumDocumentWrapperQt> document;
+};
+
+class PageRasterTask : public QRunnable
+{
+public:
+    PageRasterTask(QSharedPointer<PrinterPageQueue> pages, int position, int pageIndex)
+        : m_pages(std::move(pages))
+        , m_position(position)
+        , m_pageIndex(pageIndex)
+    {
+    }
+
+    void run() override
+    {
+        {
+            QMutexLocker lock(&m_pages->mutex);
+            if (m_pages->cancelled)
+                return;
+        }
+        QImage image = m_pages->document->pageAsQImage(m_pageIndex);
+        QMutexLocker lock(&m_pages->mutex);
+        m_pages->images.insert(m_position, image);
+        m_pages->pageReady.wakeAll();
+    }
+
+private:
+    QSharedPointer<PrinterPageQueue> m_pages;
+    int m_position;
+    int m_pageIndex;
+};
+
+PrinterWorker::PrinterWorker(const QByteArray &data, QPrinter *printer)
+    : m_data(data)
+    , m_printer(printer)
+    , m_pages(new PrinterPageQueue)
+{
+    m_rasterPool.setMaxThreadCount(1);
+}
+
+PrinterWorker::~PrinterWorker()
+{
+}
+
+void PrinterWorker::cancel()
+{
+    QMutexLocker lock(&m_pages->mutex);
+    m_pages->cancelled = true;
+    m_pages->pageReady.wakeAll();
+    lock.unlock();
+    m_rasterPool.clear();
+}
+
+void PrinterWorker::print()
+{
+    bool success = printPages();
+    // Stops rasterization of pages that will not be printed anymore.
+    if (!success)
+        cancel();
+    Q_EMIT resultReady(success);
+}
+
+bool PrinterWorker::printPages()
+{
+    if (!m_data.size()) {
+        qWarning("Failure to print on printer %ls: Print result data is empty.",
+                 qUtf16Printable(m_printer->printerName()));
+        return false;
+    }
+
+    QSize pageSize = m_printer->pageRect().size();
+    m_pages->data = m_data;
+    m_pages->document.reset(new PdfiumDocumentWrapperQt(m_pages->data.constData(), m_pages->data.size(), pageSize));
+    const int pageCount = m_pages->document->pageCount();
+
+    int toPage = m_printer->toPage();
+    int fromPage = m_printer->fromPage();
+    bool ascendingOrder = true;
+
+    if (fromPage == 0 && toPage == 0) {
+        fromPage = 1;
+        toPage = pageCount;
+    }
+    fromPage = qMax(1, fromPage);
+    toPage = qMin(pageCount, toPage);
+
+    if (m_printer->pageOrder() == QPrinter::LastPageFirst) {
+        qSwap(fromPage, toPage);
+        ascendingOrder = false;
+    }
+
+    if (ascendingOrder ? fromPage > toPage : fromPage < toPage) {
+        qWarning("Failure to print on printer %ls: No pages in the requested range.",
+                 qUtf16Printable(m_printer->printerName()));
+        return false;
+    }
+
+    int pageCopies = 1;
+    int documentCopies = 1;
+
+    if (!m_printer->supportsMultipleCopies())
+        documentCopies = m_printer->copyCount();
+
+    if (m_printer->collateCopies()) {
+        pageCopies = documentCopies;
+        documentCopies = 1;
+    }
+
+    // Page indices in printing order, each of them is painted pageCopies times.
+    QVector<int> sequence;
+    for (int printedDocuments = 0; printedDocuments < documentCopies; printedDocuments++) {
+        for (int currentPageIndex = fromPage; ; currentPageIndex += ascendingOrder ? 1 : -1) {
+            sequence.append(currentPageIndex - 1);
+            if (currentPageIndex == toPage)
+                break;
+        }
+    }
+
+    QPainter painter;
+    if (!painter.begin(m_printer)) {
+        qWarning("Failure to print on printer %ls: Could not open printer for painting.",
+                  qUtf16Printable(m_printer->printerName()));
+        return false;
+    }
+
+    const int totalPages = sequence.size() * pageCopies;
+    int printedPages = 0;
+    int scheduledPages = 0;
+    for (int position = 0; position < sequence.size(); position++) {
+        for (; scheduledPages < sequence.size() && scheduledPages <= position + kLookAheadPages; scheduledPages++)
+            m_rasterPool.start(new PageRasterTask(m_pages, scheduledPages, sequence.at(scheduledPages)));
+
+        QImage currentImage;
+        {
+            QMutexLocker lock(&m_pages->mutex);
+            while (!m_pages->cancelled && !m_pages->images.contains(position))
+                m_pages->pageReady.wait(&m_pages->mutex);
+            if (m_pages->cancelled) {
+                m_printer->abort();
+                return false;
+            }
+            currentImage = m_pages->images.take(position);
+        }
+        if (currentImage.isNull()) {
+            m_printer->abort();
+            return false;
+        }
+
+        if (position > 0)
+            m_printer->newPage();
+        for (int copy = 0; copy < pageCopies; copy++) {
+            if (m_printer->printerState() == QPrinter::Aborted
+                    || m_printer->printerState() == QPrinter::Error)
+                return false;
+            if (copy > 0)
+                m_printer->newPage();
+
+            // Painting operations are automatically clipped to the bounds of the drawable part of the page.
+            painter.drawImage(QRect(0, 0, pageSize.width(), pageSize.height()), currentImage, currentImage.rect());
+            Q_EMIT pagePrinted(++printedPages, totalPages);
+        }
+    }
+    painter.end();
+
+    return true;
+}
+
+} // namespace QtWebEngineCore
@@ -0,0 +1,89 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef PRINTER_WORKER_H
+#define PRINTER_WORKER_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QObject>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QThreadPool>
+
+QT_BEGIN_NAMESPACE
+class QPrinter;
+QT_END_NAMESPACE
+
+namespace QtWebEngineCore {
+
+struct PrinterPageQueue;
+
+// Prints PDF data on a QPrinter from a dedicated thread. Pages are rasterized
+// on a single helper thread a few pages ahead of the painting, and each page
+// is rasterized once no matter how many collated copies of it are printed.
+class PrinterWorker : public QObject
+{
+    Q_OBJECT
+public:
+    PrinterWorker(const QByteArray &data, QPrinter *printer);
+    virtual ~PrinterWorker();
+
+    // Thread-safe, makes print() abort the printer and report failure.
+    void cancel();
+
+public Q_SLOTS:
+    void print();
+
+Q_SIGNALS:
+    void pagePrinted(int printedPages, int totalPages);
+    void resultReady(bool success);
+
+private:
+    bool printPages();
+
+    QByteArray m_data;
+    QPrinter *m_printer;
+    QSharedPointer<PrinterPageQueue> m_pages;
+    // PDFium calls are serialized, so more than one rasterization thread would only wait.
+    QThreadPool m_rasterPool;
+};
+
+} // namespace QtWebEngineCore
+
+#endif // PRINTER_WORKER_H
@@ -158,6 +158,11 @@ RenderWidgetHostViewQtDelegateWidget::RenderWidgetHostViewQtDelegateWidget(Rende
 
     setContent(QUrl(), nullptr, m_rootItem.data());
 
+    // The offscreen window of the QQuickWidget doesn't swap, its frame is presented with the
+    // next repaint of the widget, which the queued connection lets happen first.
+    connect(quickWindow(), &QQuickWindow::afterRendering,
+            this, &RenderWidgetHostViewQtDelegateWidget::onFrameSwapped, Qt::QueuedConnection);
+
     connectRemoveParentBeforeParentDelete();
 }
 
@@ -310,9 +315,14 @@ QSGRectangleNode *RenderWidgetHostViewQtDelegateWidget::createRectangleNode()
     return quickWindow()->createRectangleNode();
 }
 
-void RenderWidgetHostViewQtDelegateWidget::update()
+void RenderWidgetHostViewQtDelegateWidget::update(const QRect &damageRect)
 {
+    // The paint node is updated either way, the rectangle limits what the widget repaints.
     m_rootItem->update();
+    if (damageRect.isNull())
+        QQuickWidget::update();
+    else
+        QQuickWidget::update(damageRect);
 }
 
 void RenderWidgetHostViewQtDelegateWidget::updateCursor(const QCursor &cursor)
@@ -354,7 +364,7 @@ void RenderWidgetHostViewQtDelegateWidget::setClearColor(const QColor &color)
     bool isTranslucent = color.alpha() < 255;
     setAttribute(Qt::WA_AlwaysStackOnTop, isTranslucent);
     setAttribute(Qt::WA_OpaquePaintEvent, !isTranslucent);
-    update();
+    update(QRect());
 }
 
 QVariant RenderWidgetHostViewQtDelegateWidget::inputMethodQuery(Qt::InputMethodQuery query) const
@@ -387,6 +397,7 @@ void RenderWidgetHostViewQtDelegateWidget::showEvent(QShowEvent *event)
     if (QWindow *w = window()) {
         m_windowConnections.append(connect(w, SIGNAL(xChanged(int)), SLOT(onWindowPosChanged())));
         m_windowConnections.append(connect(w, SIGNAL(yChanged(int)), SLOT(onWindowPosChanged())));
+        m_windowConnections.append(connect(w, SIGNAL(visibilityChanged(QWindow::Visibility)), SLOT(onWindowVisibilityChanged())));
     }
     m_client->windowChanged();
     m_client->notifyShown();
@@ -490,4 +501,14 @@ void RenderWidgetHostViewQtDelegateWidget::onWindowPosChanged()
     m_client->windowBoundsChanged();
 }
 
+void RenderWidgetHostViewQtDelegateWidget::onWindowVisibilityChanged()
+{
+    m_client->windowVisibilityChanged();
+}
+
+void RenderWidgetHostViewQtDelegateWidget::onFrameSwapped()
+{
+    m_client->notifyFrameSwapped();
+}
+
 } // namespace QtWebEngineCore
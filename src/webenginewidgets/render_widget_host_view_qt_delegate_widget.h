@@ -81,7 +81,7 @@ public:
     QSGInternalImageNode *createInternalImageNode() override;
     QSGImageNode *createImageNode() override;
     QSGRectangleNode *createRectangleNode() override;
-    void update() override;
+    void update(const QRect &damageRect) override;
     void updateCursor(const QCursor &) override;
     void resize(int width, int height) override;
     void move(const QPoint &screenPos) override;
@@ -101,6 +101,8 @@ protected:
 
 private slots:
     void onWindowPosChanged();
+    void onWindowVisibilityChanged();
+    void onFrameSwapped();
     void connectRemoveParentBeforeParentDelete();
     void removeParentBeforeParentDelete();
 
@@ -2,6 +2,7 @@ TEMPLATE = subdirs
 
 SUBDIRS += \
     qwebenginecookiestore \
+    qwebenginemessagepumpscheduler \
     qwebengineurlrequestinterceptor \
 
 # QTBUG-60268
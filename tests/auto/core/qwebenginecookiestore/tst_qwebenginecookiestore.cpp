@@ -53,6 +53,9 @@ private Q_SLOTS:
     void batchCookieTasks();
     void basicFilter();
     void html5featureFilter();
+    void cookieAccessRules();
+    void sessionOnlyCookiesPurgedOnRestart();
+    void bulkCookieTasks();
 
 private:
     QWebEngineProfile m_profile;
@@ -194,7 +197,13 @@ void tst_QWebEngineCookieStore::basicFilter()
     QWebEngineCookieStore *client = m_profile.cookieStore();
 
     QAtomicInt accessTested = 0;
-    client->setCookieFilter([&](const QWebEngineCookieStore::FilterRequest &){ ++accessTested; return true;});
+    QAtomicInt firstPartyAccesses = 0;
+    client->setCookieFilter([&](const QWebEngineCookieStore::FilterRequest &request) {
+        ++accessTested;
+        if (!request.thirdParty)
+            ++firstPartyAccesses;
+        return true;
+    });
 
     QSignalSpy loadSpy(&page, SIGNAL(loadFinished(bool)));
     QSignalSpy cookieAddedSpy(client, SIGNAL(cookieAdded(const QNetworkCookie &)));
@@ -206,6 +215,8 @@ void tst_QWebEngineCookieStore::basicFilter()
     QVERIFY(loadSpy.takeFirst().takeFirst().toBool());
     QTRY_COMPARE(cookieAddedSpy.count(), 2);
     QTRY_COMPARE(accessTested.loadAcquire(), 2);
+    // URLs without a host are never in the same domain, not even as their own first party:
+    QCOMPARE(firstPartyAccesses.loadAcquire(), 0);
 
     client->deleteAllCookies();
     QTRY_COMPARE(cookieRemovedSpy.count(), 2);
@@ -245,5 +256,136 @@ void tst_QWebEngineCookieStore::html5featureFilter()
     QTRY_VERIFY(callbackTriggered);
 }
 
+void tst_QWebEngineCookieStore::cookieAccessRules()
+{
+    QWebEnginePage page(&m_profile);
+    QWebEngineCookieStore *client = m_profile.cookieStore();
+
+    client->setCookieAccessForDomain(QStringLiteral(".Example.com"), QWebEngineCookieStore::BlockCookies);
+    client->setCookieAccessForDomains({ QStringLiteral("mail.example.com"), QStringLiteral("example.org") },
+                                      QWebEngineCookieStore::SessionOnlyCookies);
+    QCOMPARE(client->cookieAccessForDomains().size(), 3);
+    QCOMPARE(client->cookieAccessForDomains().value(QStringLiteral("example.org")), QWebEngineCookieStore::SessionOnlyCookies);
+    client->removeCookieAccessForDomain(QStringLiteral("example.org"));
+    QCOMPARE(client->cookieAccessForDomains().size(), 2);
+    client->clearCookieAccessForDomains();
+    QVERIFY(client->cookieAccessForDomains().isEmpty());
+
+    QAtomicInt accessTested = 0;
+    client->setCookieFilter([&](const QWebEngineCookieStore::FilterRequest &){ ++accessTested; return true;});
+    client->setDefaultCookieAccess(QWebEngineCookieStore::BlockCookies);
+    QCOMPARE(client->defaultCookieAccess(), QWebEngineCookieStore::BlockCookies);
+
+    QSignalSpy loadSpy(&page, SIGNAL(loadFinished(bool)));
+    QSignalSpy cookieAddedSpy(client, SIGNAL(cookieAdded(const QNetworkCookie &)));
+
+    page.load(QUrl("qrc:///resources/index.html"));
+    QTRY_COMPARE(loadSpy.count(), 1);
+    QVERIFY(loadSpy.takeFirst().takeFirst().toBool());
+    // Reading the cookies goes through the cookie store after the writes made by onload,
+    // and blocked accesses do not reach the filter:
+    QCOMPARE(evaluateJavaScriptSync(&page, "document.cookie").toString(), QString());
+    QCOMPARE(cookieAddedSpy.count(), 0);
+    QCOMPARE(accessTested.loadAcquire(), 0);
+
+    client->setDefaultCookieAccess(QWebEngineCookieStore::AllowCookies);
+    page.triggerAction(QWebEnginePage::ReloadAndBypassCache);
+    QTRY_COMPARE(loadSpy.count(), 1);
+    QVERIFY(loadSpy.takeFirst().takeFirst().toBool());
+    QTRY_COMPARE(cookieAddedSpy.count(), 2);
+    QTRY_COMPARE(accessTested.loadAcquire(), 2);
+
+    client->setCookieFilter(nullptr);
+}
+
+void tst_QWebEngineCookieStore::sessionOnlyCookiesPurgedOnRestart()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QDateTime expiry = QDateTime::currentDateTimeUtc().addDays(1);
+
+    {
+        QWebEngineProfile profile(QStringLiteral("SessionOnlyCookies"));
+        profile.setPersistentStoragePath(tempDir.path());
+        QCOMPARE(profile.persistentCookiesPolicy(), QWebEngineProfile::AllowPersistentCookies);
+        QWebEngineCookieStore *client = profile.cookieStore();
+        client->setCookieAccessForDomain(QStringLiteral("example.org"), QWebEngineCookieStore::SessionOnlyCookies);
+
+        QSignalSpy cookieAddedSpy(client, SIGNAL(cookieAdded(const QNetworkCookie &)));
+        QNetworkCookie sessionOnly(QByteArrayLiteral("sessionOnly"), QByteArrayLiteral("1"));
+        sessionOnly.setExpirationDate(expiry);
+        QNetworkCookie persistent(QByteArrayLiteral("persistent"), QByteArrayLiteral("1"));
+        persistent.setExpirationDate(expiry);
+        client->setCookie(sessionOnly, QUrl("http://www.example.org/"));
+        client->setCookie(persistent, QUrl("http://www.example.com/"));
+
+        // The cookie store is created with the first page.
+        QWebEnginePage page(&profile);
+        QSignalSpy loadSpy(&page, SIGNAL(loadFinished(bool)));
+        page.load(QUrl("qrc:///resources/content.html"));
+        QTRY_COMPARE(loadSpy.count(), 1);
+        QTRY_COMPARE(cookieAddedSpy.count(), 2);
+    }
+    // Give the IO thread time to close the cookie database.
+    QTest::qWait(500);
+
+    QWebEngineProfile profile(QStringLiteral("SessionOnlyCookies"));
+    profile.setPersistentStoragePath(tempDir.path());
+    QWebEngineCookieStore *client = profile.cookieStore();
+    QSignalSpy cookieAddedSpy(client, SIGNAL(cookieAdded(const QNetworkCookie &)));
+    QWebEnginePage page(&profile);
+    QSignalSpy loadSpy(&page, SIGNAL(loadFinished(bool)));
+    page.load(QUrl("qrc:///resources/content.html"));
+    QTRY_COMPARE(loadSpy.count(), 1);
+    client->loadAllCookies();
+    QTRY_COMPARE(cookieAddedSpy.count(), 1);
+    const QNetworkCookie cookie = cookieAddedSpy.at(0).at(0).value<QNetworkCookie>();
+    QCOMPARE(cookie.name(), QByteArrayLiteral("persistent"));
+}
+
+void tst_QWebEngineCookieStore::bulkCookieTasks()
+{
+    QWebEnginePage page(&m_profile);
+    QWebEngineCookieStore *client = m_profile.cookieStore();
+
+    QList<QNetworkCookie> added;
+    QList<QNetworkCookie> removed;
+    int changeSignals = 0;
+    connect(client, &QWebEngineCookieStore::cookiesChanged, &page,
+            [&](const QList<QNetworkCookie> &a, const QList<QNetworkCookie> &r) { added += a; removed += r; ++changeSignals; });
+
+    QList<QNetworkCookie> cookies;
+    for (int i = 0; i < 100; ++i)
+        cookies.append(QNetworkCookie(QByteArrayLiteral("bulk") + QByteArray::number(i), QByteArrayLiteral("value")));
+    cookies.append(QNetworkCookie::parseCookies(QByteArrayLiteral("other=1; Domain=.example.org; Path=/")).first());
+    client->setCookies(cookies.mid(0, 100), QUrl("http://www.example.com/"));
+    client->setCookies(cookies.mid(100));
+
+    QSignalSpy loadSpy(&page, SIGNAL(loadFinished(bool)));
+    page.load(QUrl("qrc:///resources/content.html"));
+    QTRY_COMPARE(loadSpy.count(), 1);
+
+    QTRY_COMPARE(added.count(), 101);
+    QVERIFY(removed.isEmpty());
+    QVERIFY(changeSignals < 101);
+
+    QList<QNetworkCookie> loaded;
+    bool loadFinished = false;
+    connect(client, &QWebEngineCookieStore::cookiesLoaded, &page,
+            [&](const QString &domain, const QList<QNetworkCookie> &c, bool finished) {
+        QCOMPARE(domain, QStringLiteral("example.com"));
+        loaded += c;
+        loadFinished = finished;
+    });
+    client->loadCookies(QStringLiteral("example.com"));
+    QTRY_VERIFY(loadFinished);
+    QCOMPARE(loaded.count(), 100);
+
+    client->deleteCookies([](const QNetworkCookie &cookie) { return cookie.name().startsWith("bulk1"); });
+    // bulk1 and bulk10 to bulk19
+    QTRY_COMPARE(removed.count(), 11);
+    QCOMPARE(added.count(), 101);
+}
+
 QTEST_MAIN(tst_QWebEngineCookieStore)
 #include "tst_qwebenginecookiestore.moc"
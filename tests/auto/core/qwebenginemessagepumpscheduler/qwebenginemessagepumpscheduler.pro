@@ -0,0 +1,2 @@
+include(../tests.pri)
+QT_PRIVATE += webenginecore-private
@@ -0,0 +1,102 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtWebEngineCore/private/qwebenginemessagepumpscheduler_p.h>
+#include <QtWebEngineWidgets/qwebenginepage.h>
+
+class tst_QWebEngineMessagePumpScheduler : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void coalesceWakeups();
+    void recordSlices();
+    void mainThreadStatistics();
+};
+
+void tst_QWebEngineMessagePumpScheduler::coalesceWakeups()
+{
+    int calls = 0;
+    QWebEngineMessagePumpScheduler scheduler([&calls]() { ++calls; });
+    scheduler.scheduleWork();
+    scheduler.scheduleWork();
+    scheduler.scheduleWork();
+    QTRY_COMPARE(calls, 1);
+
+    QWebEngineMessagePumpScheduler::Statistics statistics = scheduler.statistics();
+    QCOMPARE(statistics.wakeups, quint64(1));
+    QCOMPARE(statistics.coalescedWakeups, quint64(2));
+
+    // Work scheduled once the event was delivered needs a new one.
+    scheduler.scheduleWork();
+    QTRY_COMPARE(calls, 2);
+    statistics = scheduler.statistics();
+    QCOMPARE(statistics.wakeups, quint64(2));
+    QCOMPARE(statistics.coalescedWakeups, quint64(2));
+}
+
+void tst_QWebEngineMessagePumpScheduler::recordSlices()
+{
+    QWebEngineMessagePumpScheduler scheduler([]() { });
+    scheduler.recordSlice(4, false);
+    scheduler.recordSlice(0, false);
+    scheduler.recordSlice(7, true);
+
+    const QWebEngineMessagePumpScheduler::Statistics statistics = scheduler.statistics();
+    QCOMPARE(statistics.slices, quint64(3));
+    QCOMPARE(statistics.tasks, quint64(11));
+    QCOMPARE(statistics.sliceOverruns, quint64(1));
+    QCOMPARE(statistics.wakeups, quint64(0));
+}
+
+void tst_QWebEngineMessagePumpScheduler::mainThreadStatistics()
+{
+    QWebEnginePage page;
+    QSignalSpy loadFinishedSpy(&page, &QWebEnginePage::loadFinished);
+    page.setHtml(QStringLiteral("<html><body>first</body></html>"));
+    QTRY_COMPARE(loadFinishedSpy.count(), 1);
+
+    const QWebEngineMessagePumpScheduler::Statistics before = QWebEngineMessagePumpScheduler::mainThreadStatistics();
+    QVERIFY(before.wakeups > 0);
+    QVERIFY(before.slices > 0);
+    QVERIFY(before.tasks > 0);
+    QVERIFY(before.sliceOverruns <= before.slices);
+
+    page.setHtml(QStringLiteral("<html><body>second</body></html>"));
+    QTRY_COMPARE(loadFinishedSpy.count(), 2);
+
+    // Loading a page runs tasks on the UI thread, each slice is run by a wakeup.
+    const QWebEngineMessagePumpScheduler::Statistics after = QWebEngineMessagePumpScheduler::mainThreadStatistics();
+    QVERIFY(after.tasks > before.tasks);
+    QVERIFY(after.slices > before.slices);
+    QVERIFY(after.wakeups >= after.slices);
+}
+
+QTEST_MAIN(tst_QWebEngineMessagePumpScheduler)
+#include "tst_qwebenginemessagepumpscheduler.moc"
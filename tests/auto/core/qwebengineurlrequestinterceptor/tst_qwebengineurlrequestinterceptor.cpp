@@ -28,8 +28,10 @@
 
 #include "../../widgets/util.h"
 #include <QtTest/QtTest>
+#include <QtWebEngineCore/qwebenginenavigationpolicy.h>
 #include <QtWebEngineCore/qwebengineurlrequestinfo.h>
 #include <QtWebEngineCore/qwebengineurlrequestinterceptor.h>
+#include <QtWebEngineCore/qwebengineurlrequestruleset.h>
 #include <QtWebEngineWidgets/qwebenginepage.h>
 #include <QtWebEngineWidgets/qwebengineprofile.h>
 #include <QtWebEngineWidgets/qwebenginesettings.h>
@@ -53,6 +55,7 @@ private Q_SLOTS:
     void initTestCase();
     void cleanupTestCase();
     void interceptRequest();
+    void interceptRequestAsync();
     void ipv6HostEncoding();
     void requestedUrl();
     void setUrlSameUrl();
@@ -63,6 +66,8 @@ private Q_SLOTS:
     void requestInterceptorByResourceType();
     void firstPartyUrlHttp();
     void passRefererHeader();
+    void urlRequestRuleSet();
+    void navigationPolicy();
 };
 
 tst_QWebEngineUrlRequestInterceptor::tst_QWebEngineUrlRequestInterceptor()
@@ -217,6 +222,73 @@ void tst_QWebEngineUrlRequestInterceptor::interceptRequest()
     QCOMPARE(observer.requestInfos.count(), 1);
 }
 
+class AsyncRequestInterceptor : public QWebEngineAsyncUrlRequestInterceptor
+{
+public:
+    QAtomicInt requestCount;
+
+    void interceptRequestAsync(QWebEngineUrlRequestInfo *info) override
+    {
+        // Decide on another thread to make sure the request waits for us.
+        QThreadPool::globalInstance()->start(new Task(this, info));
+    }
+
+private:
+    class Task : public QRunnable
+    {
+    public:
+        Task(AsyncRequestInterceptor *interceptor, QWebEngineUrlRequestInfo *info)
+            : m_interceptor(interceptor), m_info(info) { }
+
+        void run() override
+        {
+            QThread::msleep(10);
+            if (m_info->requestUrl().scheme() != QLatin1String("blob")) {
+                m_info->block(m_info->requestMethod() != QByteArrayLiteral("GET"));
+                if (m_info->requestUrl().toString().endsWith(QLatin1String("__placeholder__")))
+                    m_info->redirect(QUrl("qrc:///resources/content.html"));
+                m_interceptor->requestCount.ref();
+            }
+            QWebEngineAsyncUrlRequestInterceptor::finishRequest(m_info);
+        }
+
+    private:
+        AsyncRequestInterceptor *m_interceptor;
+        QWebEngineUrlRequestInfo *m_info;
+    };
+};
+
+void tst_QWebEngineUrlRequestInterceptor::interceptRequestAsync()
+{
+    QWebEngineProfile profile;
+    profile.settings()->setAttribute(QWebEngineSettings::ErrorPageEnabled, false);
+    AsyncRequestInterceptor interceptor;
+    profile.setRequestInterceptor(&interceptor);
+
+    QWebEnginePage page(&profile);
+    QSignalSpy loadSpy(&page, SIGNAL(loadFinished(bool)));
+
+    page.load(QUrl("qrc:///resources/index.html"));
+    QTRY_COMPARE(loadSpy.count(), 1);
+    QVERIFY(loadSpy.takeFirst().takeFirst().toBool());
+
+    QVariant ok;
+    page.runJavaScript("post();", [&ok](const QVariant result){ ok = result; });
+    QTRY_VERIFY(ok.toBool());
+    QTRY_COMPARE(loadSpy.count(), 1);
+    // We block non-GET requests, so this should not succeed.
+    QVERIFY(!loadSpy.takeFirst().takeFirst().toBool());
+
+    page.load(QUrl("qrc:///resources/__placeholder__"));
+    QTRY_COMPARE(loadSpy.count(), 1);
+    // The redirection for __placeholder__ should succeed.
+    QVERIFY(loadSpy.takeFirst().takeFirst().toBool());
+    QCOMPARE(interceptor.requestCount.load(), 4);
+
+    profile.setRequestInterceptor(nullptr);
+    QThreadPool::globalInstance()->waitForDone();
+}
+
 class LocalhostContentProvider : public QWebEngineUrlRequestInterceptor
 {
 public:
@@ -530,5 +602,136 @@ void tst_QWebEngineUrlRequestInterceptor::passRefererHeader()
     QVERIFY(succeeded);
 }
 
+void tst_QWebEngineUrlRequestInterceptor::urlRequestRuleSet()
+{
+    const QByteArray filterList =
+            "[Adblock Plus 2.0]\n"
+            "! Blocks by host, by path and by resource type\n"
+            "||example.org^\n"
+            "/script.js$script\n"
+            "/style.css\n"
+            "@@|qrc:///resources/style.css\n"
+            "example.org##.banner\n"
+            "/ads/*$third-party\n";
+
+    QWebEngineUrlRequestRuleSet compiled = QWebEngineUrlRequestRuleSet::fromFilterList(filterList);
+    QVERIFY(!compiled.isNull());
+    QCOMPARE(compiled.ruleCount(), 4);
+    QCOMPARE(compiled.skippedLineCount(), 2);
+    QCOMPARE(compiled.rule(1), QByteArrayLiteral("/script.js$script"));
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString fileName = tempDir.filePath(QStringLiteral("rules.bin"));
+    QVERIFY(compiled.save(fileName));
+    QWebEngineUrlRequestRuleSet ruleSet = QWebEngineUrlRequestRuleSet::load(fileName);
+    QVERIFY(!ruleSet.isNull());
+    QCOMPARE(ruleSet.ruleCount(), compiled.ruleCount());
+    for (int i = 0; i < ruleSet.ruleCount(); ++i)
+        QCOMPARE(ruleSet.rule(i), compiled.rule(i));
+    QVERIFY(QWebEngineUrlRequestRuleSet::load(tempDir.filePath(QStringLiteral("missing.bin"))).isNull());
+
+    QWebEngineProfile profile;
+    TestRequestInterceptor interceptor(/* intercept */ false);
+    profile.setRequestInterceptor(&interceptor);
+    profile.setUrlRequestRuleSet(ruleSet);
+    QCOMPARE(profile.urlRequestRuleSet().ruleCount(), 4);
+
+    QWebEnginePage page(&profile);
+    QSignalSpy loadSpy(&page, SIGNAL(loadFinished(bool)));
+    page.load(QUrl("qrc:///resources/resource.html"));
+    QTRY_COMPARE(loadSpy.count(), 1);
+
+    // Blocked requests never reach the interceptor, allowed ones do.
+    QVERIFY(interceptor.getUrlRequestForType(QWebEngineUrlRequestInfo::ResourceTypeScript).isEmpty());
+    QCOMPARE(interceptor.getUrlRequestForType(QWebEngineUrlRequestInfo::ResourceTypeStylesheet).count(), 1);
+    QCOMPARE(ruleSet.hitCount(0), 0);
+    QCOMPARE(ruleSet.hitCount(1), 1);
+    QCOMPARE(ruleSet.hitCount(2), 0);
+    QCOMPARE(ruleSet.hitCount(3), 1);
+
+    ruleSet.resetHitCounts();
+    QCOMPARE(ruleSet.hitCount(1), 0);
+
+    // Removing the rule set lets the script through again.
+    profile.setUrlRequestRuleSet(QWebEngineUrlRequestRuleSet());
+    interceptor.requestInfos.clear();
+    loadSpy.clear();
+    page.triggerAction(QWebEnginePage::ReloadAndBypassCache);
+    QTRY_COMPARE(loadSpy.count(), 1);
+    QCOMPARE(interceptor.getUrlRequestForType(QWebEngineUrlRequestInfo::ResourceTypeScript).count(), 1);
+    QCOMPARE(ruleSet.hitCount(1), 0);
+
+    // Redirect rules do not apply to a request that a rule has redirected already.
+    QWebEngineUrlRequestRuleSet redirectRules = QWebEngineUrlRequestRuleSet::fromFilterList(
+            "/style.css$redirect=qrc:///resources/other.css\n"
+            "/other.css$redirect=qrc:///resources/style.css\n");
+    QCOMPARE(redirectRules.ruleCount(), 2);
+    profile.setUrlRequestRuleSet(redirectRules);
+    interceptor.requestInfos.clear();
+    loadSpy.clear();
+    page.triggerAction(QWebEnginePage::ReloadAndBypassCache);
+    QTRY_COMPARE(loadSpy.count(), 1);
+    const QList<RequestInfo> stylesheets = interceptor.getUrlRequestForType(QWebEngineUrlRequestInfo::ResourceTypeStylesheet);
+    QCOMPARE(stylesheets.count(), 1);
+    QCOMPARE(stylesheets.at(0).requestUrl, QUrl("qrc:///resources/other.css"));
+    QCOMPARE(redirectRules.hitCount(0), 1);
+    QCOMPARE(redirectRules.hitCount(1), 0);
+}
+
+class NavigationRequestPage : public QWebEnginePage
+{
+public:
+    NavigationRequestPage(QWebEngineProfile *profile) : QWebEnginePage(profile) {}
+    QList<QUrl> requestedUrls;
+
+protected:
+    bool acceptNavigationRequest(const QUrl &url, NavigationType, bool) override
+    {
+        requestedUrls.append(url);
+        return true;
+    }
+};
+
+void tst_QWebEngineUrlRequestInterceptor::navigationPolicy()
+{
+    QWebEngineNavigationPolicy policy;
+    QVERIFY(policy.isEmpty());
+    QVERIFY(policy.addRule(QWebEngineNavigationPolicy::AcceptNavigation, QStringLiteral("qrc"), QString(),
+                           { QWebEngineUrlRequestInfo::NavigationTypeTyped }, QWebEngineNavigationPolicy::MainFrame));
+    QVERIFY(policy.addRule(QWebEngineNavigationPolicy::IgnoreNavigation, QStringLiteral("qrc"), QString(),
+                           {}, QWebEngineNavigationPolicy::SubFrame));
+    QCOMPARE(policy.ruleCount(), 2);
+    // Host patterns that are not host names are rejected instead of matching all hosts:
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("Invalid host pattern ads\\*\\.example\\.com"));
+    QVERIFY(!policy.addRule(QWebEngineNavigationPolicy::BlockNavigation, QString(), QStringLiteral("ads*.example.com")));
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("Invalid host pattern \\*\\."));
+    QVERIFY(!policy.addRule(QWebEngineNavigationPolicy::BlockNavigation, QString(), QStringLiteral("*.")));
+    QCOMPARE(policy.ruleCount(), 2);
+
+    QWebEngineProfile profile;
+    TestRequestInterceptor interceptor(/* intercept */ false);
+    profile.setRequestInterceptor(&interceptor);
+    profile.setNavigationPolicy(policy);
+    QCOMPARE(profile.navigationPolicy().ruleCount(), 2);
+
+    NavigationRequestPage page(&profile);
+    QSignalSpy loadSpy(&page, SIGNAL(loadFinished(bool)));
+    page.load(QUrl("qrc:///resources/iframe.html"));
+    QTRY_COMPARE(loadSpy.count(), 1);
+
+    // Both frames were decided by the policy, and the ignored subframe never loaded its own subframe.
+    QVERIFY(page.requestedUrls.isEmpty());
+    QCOMPARE(interceptor.getUrlRequestForType(QWebEngineUrlRequestInfo::ResourceTypeMainFrame).count(), 1);
+    QCOMPARE(interceptor.getUrlRequestForType(QWebEngineUrlRequestInfo::ResourceTypeSubFrame).count(), 1);
+
+    // Without a policy, every frame is passed to the page.
+    loadSpy.clear();
+    profile.setNavigationPolicy(QWebEngineNavigationPolicy());
+    page.triggerAction(QWebEnginePage::Reload);
+    QTRY_COMPARE(loadSpy.count(), 1);
+    QTRY_COMPARE(page.requestedUrls.count(), 3);
+}
+
 QTEST_MAIN(tst_QWebEngineUrlRequestInterceptor)
 #include "tst_qwebengineurlrequestinterceptor.moc"
@@ -35,8 +35,11 @@
 #include <QtTest/QtTest>
 #include <QtWebEngine/QQuickWebEngineProfile>
 #include <QtWebEngine/QQuickWebEngineScript>
+#include <QtWebEngineCore/QWebEngineFrameTiming>
+#include <QtWebEngineCore/QWebEngineNavigationPolicy>
 #include <QtWebEngineCore/QWebEngineQuotaRequest>
 #include <QtWebEngineCore/QWebEngineRegisterProtocolHandlerRequest>
+#include <QtWebEngineCore/QWebEngineWebChannelStatistics>
 #include <private/qquickwebengineview_p.h>
 #include <private/qquickwebengineaction_p.h>
 #include <private/qquickwebenginecertificateerror_p.h>
@@ -77,8 +80,12 @@ static const QList<const QMetaObject *> typesToCheck = QList<const QMetaObject *
     << &QQuickWebEngineFileDialogRequest::staticMetaObject
     << &QQuickWebEngineFormValidationMessageRequest::staticMetaObject
     << &QQuickWebEngineContextMenuRequest::staticMetaObject
+    << &QWebEngineFrameTiming::staticMetaObject
+    << &QWebEngineFrameTimingReport::staticMetaObject
+    << &QWebEngineNavigationPolicy::staticMetaObject
     << &QWebEngineQuotaRequest::staticMetaObject
     << &QWebEngineRegisterProtocolHandlerRequest::staticMetaObject
+    << &QWebEngineWebChannelStatistics::staticMetaObject
     ;
 
 static QList<const char *> knownEnumNames = QList<const char *>();
@@ -92,6 +99,7 @@ static const QStringList hardcodedTypes = QStringList()
     << "QQuickWebEngineErrorPage*"
     << "const QQuickWebEngineContextMenuData*"
     << "QWebEngineCookieStore*"
+    << "QList<QWebEngineUrlRequestInfo::NavigationType>"
     ;
 
 static const QStringList expectedAPI = QStringList()
@@ -311,6 +319,8 @@ static const QStringList expectedAPI = QStringList()
     << "QQuickWebEngineProfile.httpCacheTypeChanged() --> void"
     << "QQuickWebEngineProfile.httpUserAgent --> QString"
     << "QQuickWebEngineProfile.httpUserAgentChanged() --> void"
+    << "QQuickWebEngineProfile.navigationPolicy --> QWebEngineNavigationPolicy"
+    << "QQuickWebEngineProfile.navigationPolicyChanged() --> void"
     << "QQuickWebEngineProfile.offTheRecord --> bool"
     << "QQuickWebEngineProfile.offTheRecordChanged() --> void"
     << "QQuickWebEngineProfile.persistentCookiesPolicy --> PersistentCookiesPolicy"
@@ -649,6 +659,7 @@ static const QStringList expectedAPI = QStringList()
     << "QQuickWebEngineView.findText(QString) --> void"
     << "QQuickWebEngineView.findText(QString,FindFlags) --> void"
     << "QQuickWebEngineView.findText(QString,FindFlags,QJSValue) --> void"
+    << "QQuickWebEngineView.frameTimingReport() --> QWebEngineFrameTimingReport"
     << "QQuickWebEngineView.formValidationMessageRequested(QQuickWebEngineFormValidationMessageRequest*) --> void"
     << "QQuickWebEngineView.fullScreenCancelled() --> void"
     << "QQuickWebEngineView.fullScreenRequested(QQuickWebEngineFullScreenRequest) --> void"
@@ -714,11 +725,39 @@ static const QStringList expectedAPI = QStringList()
     << "QQuickWebEngineView.userScripts --> QQmlListProperty<QQuickWebEngineScript>"
     << "QQuickWebEngineView.webChannel --> QQmlWebChannel*"
     << "QQuickWebEngineView.webChannelChanged() --> void"
+    << "QQuickWebEngineView.webChannelHighWaterMark --> uint"
+    << "QQuickWebEngineView.webChannelHighWaterMarkChanged(uint) --> void"
+    << "QQuickWebEngineView.webChannelStatistics() --> QWebEngineWebChannelStatistics"
     << "QQuickWebEngineView.webChannelWorld --> uint"
     << "QQuickWebEngineView.webChannelWorldChanged(uint) --> void"
     << "QQuickWebEngineView.windowCloseRequested() --> void"
     << "QQuickWebEngineView.zoomFactor --> double"
     << "QQuickWebEngineView.zoomFactorChanged(double) --> void"
+    << "QWebEngineFrameTiming.commitEndTime --> qlonglong"
+    << "QWebEngineFrameTiming.commitStartTime --> qlonglong"
+    << "QWebEngineFrameTiming.dropped --> bool"
+    << "QWebEngineFrameTiming.frameToken --> uint"
+    << "QWebEngineFrameTiming.mailboxFetchTime --> qlonglong"
+    << "QWebEngineFrameTiming.stalled --> bool"
+    << "QWebEngineFrameTiming.submitTime --> qlonglong"
+    << "QWebEngineFrameTiming.swapTime --> qlonglong"
+    << "QWebEngineFrameTimingReport.droppedFrames --> int"
+    << "QWebEngineFrameTimingReport.frames --> QVariantList"
+    << "QWebEngineFrameTimingReport.stalledFrames --> int"
+    << "QWebEngineFrameTimingReport.toTraceEventJson() --> QString"
+    << "QWebEngineNavigationPolicy.AcceptNavigation --> Action"
+    << "QWebEngineNavigationPolicy.AnyFrame --> Frames"
+    << "QWebEngineNavigationPolicy.BlockNavigation --> Action"
+    << "QWebEngineNavigationPolicy.IgnoreNavigation --> Action"
+    << "QWebEngineNavigationPolicy.MainFrame --> Frames"
+    << "QWebEngineNavigationPolicy.SubFrame --> Frames"
+    << "QWebEngineNavigationPolicy.addRule(Action,QString) --> bool"
+    << "QWebEngineNavigationPolicy.addRule(Action,QString,QString) --> bool"
+    << "QWebEngineNavigationPolicy.addRule(Action,QString,QString,QList<QWebEngineUrlRequestInfo::NavigationType>) --> bool"
+    << "QWebEngineNavigationPolicy.addRule(Action,QString,QString,QList<QWebEngineUrlRequestInfo::NavigationType>,Frames) --> bool"
+    << "QWebEngineNavigationPolicy.clear() --> void"
+    << "QWebEngineNavigationPolicy.empty --> bool"
+    << "QWebEngineNavigationPolicy.ruleCount --> int"
     << "QWebEngineQuotaRequest.accept() --> void"
     << "QWebEngineQuotaRequest.origin --> QUrl"
     << "QWebEngineQuotaRequest.reject() --> void"
@@ -727,6 +766,12 @@ static const QStringList expectedAPI = QStringList()
     << "QWebEngineRegisterProtocolHandlerRequest.origin --> QUrl"
     << "QWebEngineRegisterProtocolHandlerRequest.reject() --> void"
     << "QWebEngineRegisterProtocolHandlerRequest.scheme --> QString"
+    << "QWebEngineWebChannelStatistics.batchesReceived --> qulonglong"
+    << "QWebEngineWebChannelStatistics.bytesReceived --> qulonglong"
+    << "QWebEngineWebChannelStatistics.bytesSent --> qulonglong"
+    << "QWebEngineWebChannelStatistics.messagesReceived --> qulonglong"
+    << "QWebEngineWebChannelStatistics.messagesSent --> qulonglong"
+    << "QWebEngineWebChannelStatistics.queueDepth --> int"
     ;
 
 static bool isCheckedEnum(const QByteArray &typeName)
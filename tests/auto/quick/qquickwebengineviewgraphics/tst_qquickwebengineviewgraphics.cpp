@@ -36,6 +36,7 @@
 #include <qtwebengineglobal.h>
 #include <private/qquickwebenginetestsupport_p.h>
 #include <private/qquickwebengineview_p.h>
+#include <private/qwebengineframetiming_p.h>
 
 class TestView : public QQuickView {
     Q_OBJECT
@@ -75,6 +76,13 @@ private Q_SLOTS:
     void showHideShow();
     void simpleAcceleratedLayer();
     void reparentToOtherWindow();
+    void updateDamagedLayerOnly();
+    void redrawAfterViewportChange();
+    void unfetchedMailbox();
+    void mailboxReleasedBeforeCommit();
+    void addRemoveAndReorderLayers();
+    void forcedTextureSharing_data();
+    void forcedTextureSharing();
 
 private:
     void setHtml(const QString &html);
@@ -85,15 +93,36 @@ private:
 static const QString greenSquare("<div style=\"background-color: #00ff00; position:absolute; left:50px; top: 50px; width: 50px; height: 50px;\"></div>");
 static const QString acLayerGreenSquare("<div style=\"background-color: #00ff00; position:absolute; left:50px; top: 50px; width: 50px; height: 50px; transform: translateZ(0); -webkit-transform: translateZ(0);\"></div>");
 
+static const QString acLayerRedSquare("<div id=\"square\" style=\"background-color: #ff0000; position:absolute; left:50px; top: 50px; width: 50px; height: 50px; transform: translateZ(0); -webkit-transform: translateZ(0);\"></div>");
+
+static const QString webGLGreenSquare("<canvas id=\"canvas\" width=\"50\" height=\"50\" style=\"position:absolute; left:50px; top: 50px;\"></canvas>"
+                                      "<script>"
+                                      "var canvas = document.getElementById('canvas');"
+                                      "var gl = canvas.getContext('webgl');"
+                                      "if (gl) { gl.clearColor(0, 1, 0, 1); gl.clear(gl.COLOR_BUFFER_BIT); }"
+                                      "document.title = gl ? 'webgl' : 'nowebgl';"
+                                      "</script>");
+
+static QString acLayerSquare(const QString &id, const QString &color, int zIndex)
+{
+    return QStringLiteral("<div id=\"%1\" style=\"background-color: %2; position:absolute; left:50px; top: 50px; width: 50px; height: 50px; z-index: %3; transform: translateZ(0); -webkit-transform: translateZ(0);\"></div>")
+            .arg(id, color).arg(zIndex);
+}
+
+static QImage get150x150ReferenceImage(const QColor &color)
+{
+    QImage reference(150, 150, QImage::Format_RGB32);
+    reference.fill(Qt::white);
+    QPainter painter(&reference);
+    painter.fillRect(50, 50, 50, 50, color);
+    return reference;
+}
+
 static QImage get150x150GreenReferenceImage()
 {
     static QImage reference;
-    if (reference.isNull()) {
-        reference = QImage(150, 150, QImage::Format_RGB32);
-        reference.fill(Qt::white);
-        QPainter painter(&reference);
-        painter.fillRect(50, 50, 50, 50, QColor("#00ff00"));
-    }
+    if (reference.isNull())
+        reference = get150x150ReferenceImage(QColor("#00ff00"));
     return reference;
 }
 
@@ -120,6 +149,7 @@ void tst_QQuickWebEngineViewGraphics::init()
 
 void tst_QQuickWebEngineViewGraphics::cleanup()
 {
+    qunsetenv("QTWEBENGINE_TEXTURE_SHARING");
 }
 
 void tst_QQuickWebEngineViewGraphics::simpleGraphics()
@@ -178,6 +208,144 @@ void tst_QQuickWebEngineViewGraphics::reparentToOtherWindow()
     QCOMPARE(window.grabWindow(), get150x150GreenReferenceImage());
 }
 
+void tst_QQuickWebEngineViewGraphics::updateDamagedLayerOnly()
+{
+    // Only the accelerated layer is damaged, the rest of the page must be
+    // kept as it was and the layer itself must not be skipped.
+    setHtml(acLayerRedSquare);
+    QQuickWebEngineView *webEngineView = static_cast<QQuickWebEngineView *>(m_view->rootObject());
+    webEngineView->runJavaScript(QStringLiteral("document.getElementById('square').style.backgroundColor = '#00ff00'"));
+    QTRY_COMPARE(m_view->grabWindow(), get150x150GreenReferenceImage());
+    QCOMPARE(m_view->grabWindow(), get150x150GreenReferenceImage());
+}
+
+void tst_QQuickWebEngineViewGraphics::redrawAfterViewportChange()
+{
+    // A viewport change moves every quad, no node may be kept from the
+    // previous frame because it was outside of the damage rect.
+    setHtml(acLayerGreenSquare);
+    QCOMPARE(m_view->grabWindow(), get150x150GreenReferenceImage());
+
+    QQuickItem *webEngineView = m_view->rootObject();
+    webEngineView->setSize(QSizeF(100, 100));
+    QTRY_COMPARE(m_view->grabWindow().copy(0, 0, 100, 100), get150x150GreenReferenceImage().copy(0, 0, 100, 100));
+    webEngineView->setSize(QSizeF(150, 150));
+    QTRY_COMPARE(m_view->grabWindow(), get150x150GreenReferenceImage());
+}
+
+void tst_QQuickWebEngineViewGraphics::unfetchedMailbox()
+{
+    // The first frame showing the canvas refers to a mailbox that has no texture yet.
+    setHtml(webGLGreenSquare);
+    if (m_view->rootObject()->property("title").toString() != QLatin1String("webgl"))
+        QSKIP("WebGL is not available");
+    QTRY_COMPARE(m_view->grabWindow(), get150x150GreenReferenceImage());
+}
+
+void tst_QQuickWebEngineViewGraphics::mailboxReleasedBeforeCommit()
+{
+    // Every frame of the animation brings a new mailbox, and the resources of the last ones
+    // are returned while their fetch might still be pending when the canvas is removed.
+    setHtml(webGLGreenSquare);
+    if (m_view->rootObject()->property("title").toString() != QLatin1String("webgl"))
+        QSKIP("WebGL is not available");
+    QSignalSpy exposeSpy(m_view.data(), SIGNAL(exposeChanged()));
+    m_view->show();
+    QVERIFY(exposeSpy.wait());
+
+    QQuickWebEngineView *webEngineView = static_cast<QQuickWebEngineView *>(m_view->rootObject());
+    webEngineView->runJavaScript(QStringLiteral(
+            "var frames = 30;"
+            "function draw() {"
+            "    gl.clearColor(frames % 2, 1, 0, 1);"
+            "    gl.clear(gl.COLOR_BUFFER_BIT);"
+            "    if (--frames > 0) {"
+            "        requestAnimationFrame(draw);"
+            "        return;"
+            "    }"
+            "    canvas.remove();"
+            "    document.body.insertAdjacentHTML('beforeend', '%1');"
+            "    document.title = 'done';"
+            "}"
+            "requestAnimationFrame(draw);").arg(greenSquare));
+    QTRY_COMPARE(m_view->rootObject()->property("title").toString(), QStringLiteral("done"));
+    QTRY_COMPARE(m_view->grabWindow(), get150x150GreenReferenceImage());
+
+    // The frame shown again after hiding the view must not refer to released textures.
+    m_view->hide();
+    QVERIFY(exposeSpy.wait());
+    m_view->show();
+    QVERIFY(exposeSpy.wait());
+    QTRY_COMPARE(m_view->grabWindow(), get150x150GreenReferenceImage());
+}
+
+void tst_QQuickWebEngineViewGraphics::addRemoveAndReorderLayers()
+{
+    setHtml(acLayerSquare("red", "#ff0000", 1) + acLayerSquare("green", "#00ff00", 2));
+    QQuickWebEngineView *webEngineView = static_cast<QQuickWebEngineView *>(m_view->rootObject());
+    QCOMPARE(m_view->grabWindow(), get150x150GreenReferenceImage());
+
+    webEngineView->runJavaScript(QStringLiteral("document.getElementById('red').style.zIndex = 3"));
+    QTRY_COMPARE(m_view->grabWindow(), get150x150ReferenceImage(QColor("#ff0000")));
+
+    webEngineView->runJavaScript(QStringLiteral("document.body.insertAdjacentHTML('beforeend', '%1')")
+                                 .arg(acLayerSquare("blue", "#0000ff", 4)));
+    QTRY_COMPARE(m_view->grabWindow(), get150x150ReferenceImage(QColor("#0000ff")));
+
+    webEngineView->runJavaScript(QStringLiteral("document.getElementById('blue').remove();"
+                                                "document.getElementById('red').remove()"));
+    QTRY_COMPARE(m_view->grabWindow(), get150x150GreenReferenceImage());
+
+    // The layers that stayed must have kept their nodes while others were added and removed.
+    bool reusedWhileCreating = false;
+    bool reusedWhileDestroying = false;
+    const QVector<QWebEngineFrameTiming> frames = webEngineView->frameTimingReport().frames();
+    for (const QWebEngineFrameTiming &frame : frames) {
+        if (frame.commitEndTime() == -1)
+            continue;
+        const QWebEngineFrameTimingPrivate::NodeStatistics statistics = QWebEngineFrameTimingPrivate::nodeStatistics(frame);
+        if (statistics.reusedNodes > 0 && statistics.createdNodes > 0)
+            reusedWhileCreating = true;
+        if (statistics.reusedNodes > 0 && statistics.destroyedNodes > 0)
+            reusedWhileDestroying = true;
+    }
+    QVERIFY(reusedWhileCreating);
+    QVERIFY(reusedWhileDestroying);
+}
+
+void tst_QQuickWebEngineViewGraphics::forcedTextureSharing_data()
+{
+    QTest::addColumn<QByteArray>("textureSharing");
+    QTest::newRow("eglimage") << QByteArrayLiteral("eglimage");
+    QTest::newRow("copy") << QByteArrayLiteral("copy");
+}
+
+void tst_QQuickWebEngineViewGraphics::forcedTextureSharing()
+{
+    // Takes the path of windows whose context doesn't share with Chromium's, which is
+    // otherwise only hit with some drivers. Falls back to copying where the EGLImages
+    // can't be imported, headless Mesa (llvmpipe) supports both.
+    QFETCH(QByteArray, textureSharing);
+    qputenv("QTWEBENGINE_TEXTURE_SHARING", textureSharing);
+    setHtml(acLayerGreenSquare);
+    QCOMPARE(m_view->grabWindow(), get150x150GreenReferenceImage());
+
+    QQuickWebEngineView *webEngineView = static_cast<QQuickWebEngineView *>(m_view->rootObject());
+    webEngineView->runJavaScript(QStringLiteral("document.body.insertAdjacentHTML('beforeend', '%1')")
+                                 .arg(acLayerSquare("blue", "#0000ff", 1)));
+    QTRY_COMPARE(m_view->grabWindow(), get150x150ReferenceImage(QColor("#0000ff")));
+
+    // The textures of the frames shown in a window sharing with Chromium must not be
+    // exported anymore, and must still be displayed.
+    qunsetenv("QTWEBENGINE_TEXTURE_SHARING");
+    QQuickWindow window;
+    window.resize(m_view->size());
+    window.create();
+    webEngineView->setParentItem(window.contentItem());
+    webEngineView->runJavaScript(QStringLiteral("document.getElementById('blue').remove()"));
+    QTRY_COMPARE(window.grabWindow(), get150x150GreenReferenceImage());
+}
+
 void tst_QQuickWebEngineViewGraphics::setHtml(const QString &html)
 {
     QString htmlData = QUrl::toPercentEncoding(html);
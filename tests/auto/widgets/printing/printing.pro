@@ -2,7 +2,7 @@ include($$QTWEBENGINE_OUT_ROOT/src/core/qtwebenginecore-config.pri) # workaround
 QT_FOR_CONFIG += webenginecore-private
 
 include(../tests.pri)
-QT *= core-private webenginecore-private
+QT *= core-private webenginecore-private printsupport
 
 qtConfig(webengine-poppler-cpp) {
     CONFIG += link_pkgconfig
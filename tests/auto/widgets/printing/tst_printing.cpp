@@ -28,6 +28,10 @@
 
 #include <QtWebEngineCore/private/qtwebenginecoreglobal_p.h>
 #include <QWebEnginePage>
+#include <QFileInfo>
+#include <QPaintEngine>
+#include <QPrintEngine>
+#include <QPrinter>
 #include <QTemporaryDir>
 #include <QTest>
 #include <QSignalSpy>
@@ -38,12 +42,81 @@
 #include <poppler-page.h>
 #endif
 
+// Counts the pages printed on it, and lets the caller print copies of the document
+// since it can't make them itself.
+class CountingPrintEngine : public QPaintEngine, public QPrintEngine
+{
+public:
+    CountingPrintEngine()
+        : m_state(QPrinter::Idle)
+    {
+        m_properties.insert(PPK_QPageLayout, QVariant::fromValue(
+                QPageLayout(QPageSize(QPageSize::A4), QPageLayout::Portrait, QMarginsF())));
+        m_properties.insert(PPK_PageRect, QRect(0, 0, 595, 842));
+        m_properties.insert(PPK_PaperRect, QRect(0, 0, 595, 842));
+        m_properties.insert(PPK_Resolution, 72);
+        m_properties.insert(PPK_CopyCount, 1);
+        m_properties.insert(PPK_CollateCopies, false);
+        m_properties.insert(PPK_SupportsMultipleCopies, false);
+        m_properties.insert(PPK_PageOrder, QPrinter::FirstPageFirst);
+        m_properties.insert(PPK_ColorMode, QPrinter::Color);
+    }
+
+    // QPaintEngine
+    bool begin(QPaintDevice *) override { m_state = QPrinter::Active; return true; }
+    bool end() override { m_state = QPrinter::Idle; return true; }
+    void updateState(const QPaintEngineState &) override { }
+    void drawPixmap(const QRectF &, const QPixmap &, const QRectF &) override { }
+    void drawImage(const QRectF &, const QImage &, const QRectF &, Qt::ImageConversionFlags) override { m_paintedPages.ref(); }
+    Type type() const override { return QPaintEngine::User; }
+
+    // QPrintEngine
+    void setProperty(PrintEnginePropertyKey key, const QVariant &value) override { m_properties.insert(key, value); }
+    QVariant property(PrintEnginePropertyKey key) const override { return m_properties.value(key); }
+    bool newPage() override { m_newPages.ref(); return true; }
+    bool abort() override { m_state = QPrinter::Aborted; return true; }
+    QPrinter::PrinterState printerState() const override { return m_state; }
+    int metric(QPaintDevice::PaintDeviceMetric metric) const override
+    {
+        switch (metric) {
+        case QPaintDevice::PdmWidth: return 595;
+        case QPaintDevice::PdmHeight: return 842;
+        case QPaintDevice::PdmWidthMM: return 210;
+        case QPaintDevice::PdmHeightMM: return 297;
+        case QPaintDevice::PdmNumColors: return INT_MAX;
+        case QPaintDevice::PdmDepth: return 32;
+        case QPaintDevice::PdmDevicePixelRatio: return 1;
+        case QPaintDevice::PdmDevicePixelRatioScaled: return 1 * QPaintDevice::devicePixelRatioFScale();
+        default: return 72;
+        }
+    }
+
+    QAtomicInt m_paintedPages;
+    QAtomicInt m_newPages;
+
+private:
+    QHash<int, QVariant> m_properties;
+    QPrinter::PrinterState m_state;
+};
+
+class CountingPrinter : public QPrinter
+{
+public:
+    CountingPrinter() { setEngines(&m_engine, &m_engine); }
+    CountingPrintEngine m_engine;
+};
+
 class tst_Printing : public QObject
 {
     Q_OBJECT
 private slots:
     void printToPdfBasic();
+    void printToPdfQueued();
+    void printToPdfAfterStop();
     void printRequest();
+    void printOnPrinter();
+    void printOnPrinterCopies_data();
+    void printOnPrinterCopies();
 #if QT_CONFIG(webengine_poppler_cpp) && defined(Q_OS_LINUX) && defined(__GLIBCXX__)
     void printToPdfPoppler();
 #endif
@@ -89,6 +162,54 @@ void tst_Printing::printToPdfBasic()
     QCOMPARE(failedInvalidLayoutSpy.waitForResult().length(), 0);
 }
 
+void tst_Printing::printToPdfQueued()
+{
+    QTemporaryDir tempDir(QDir::tempPath() + "/tst_qwebengineview-XXXXXX");
+    QVERIFY(tempDir.isValid());
+    QWebEnginePage page;
+    QSignalSpy spy(&page, &QWebEnginePage::loadFinished);
+    page.load(QUrl("qrc:///resources/basic_printing_page.html"));
+    QTRY_VERIFY(spy.count() == 1);
+
+    // Requests issued while one is in progress are processed one after another.
+    QPageLayout layout(QPageSize(QPageSize::A4), QPageLayout::Portrait, QMarginsF(0.0, 0.0, 0.0, 0.0));
+    QSignalSpy savePdfSpy(&page, &QWebEnginePage::pdfPrintingFinished);
+    CallbackSpy<QByteArray> firstSpy;
+    CallbackSpy<QByteArray> secondSpy;
+    const QString path = tempDir.path() + "/print_queued.pdf";
+    page.printToPdf(firstSpy.ref(), layout);
+    page.printToPdf(path, layout);
+    page.printToPdf(secondSpy.ref(), layout);
+
+    QVERIFY(firstSpy.waitForResult().length() > 0);
+    QVERIFY(secondSpy.waitForResult().length() > 0);
+    QTRY_COMPARE(savePdfSpy.count(), 1);
+    QVERIFY(savePdfSpy.takeFirst().at(1).toBool());
+    QVERIFY(QFileInfo(path).size() > 0);
+}
+
+void tst_Printing::printToPdfAfterStop()
+{
+    QWebEnginePage page;
+    QSignalSpy spy(&page, &QWebEnginePage::loadFinished);
+    page.load(QUrl("qrc:///resources/basic_printing_page.html"));
+    QTRY_VERIFY(spy.count() == 1);
+
+    // Stopping fails the running job, whose result may still arrive while the next one runs.
+    QPageLayout layout(QPageSize(QPageSize::A4), QPageLayout::Portrait, QMarginsF(0.0, 0.0, 0.0, 0.0));
+    CallbackSpy<QByteArray> stoppedSpy;
+    page.printToPdf(stoppedSpy.ref(), layout);
+    page.triggerAction(QWebEnginePage::Stop);
+    QCOMPARE(stoppedSpy.waitForResult().length(), 0);
+
+    CallbackSpy<QByteArray> firstSpy;
+    CallbackSpy<QByteArray> secondSpy;
+    page.printToPdf(firstSpy.ref(), layout);
+    page.printToPdf(secondSpy.ref(), layout);
+    QVERIFY(firstSpy.waitForResult().startsWith("%PDF"));
+    QVERIFY(secondSpy.waitForResult().startsWith("%PDF"));
+}
+
 void tst_Printing::printRequest()
 {
      QWebEnginePage webPage;
@@ -108,6 +229,81 @@ void tst_Printing::printRequest()
      QVERIFY(data.length() > 0);
 }
 
+void tst_Printing::printOnPrinter()
+{
+    QTemporaryDir tempDir(QDir::tempPath() + "/tst_qwebengineview-XXXXXX");
+    QVERIFY(tempDir.isValid());
+    QWebEnginePage page;
+    QSignalSpy spy(&page, &QWebEnginePage::loadFinished);
+    page.load(QUrl("qrc:///resources/basic_printing_page.html"));
+    QTRY_VERIFY(spy.count() == 1);
+
+    const QString path = tempDir.path() + "/print_on_printer.pdf";
+    QPrinter printer;
+    printer.setOutputFormat(QPrinter::PdfFormat);
+    printer.setOutputFileName(path);
+    printer.setCopyCount(2);
+    printer.setCollateCopies(true);
+
+    QSignalSpy progressSpy(&page, &QWebEnginePage::printProgress);
+    CallbackSpy<bool> resultSpy;
+    page.print(&printer, resultSpy.ref());
+    QVERIFY(resultSpy.waitForResult());
+    QVERIFY(progressSpy.count() > 0);
+    const QList<QVariant> lastProgress = progressSpy.last();
+    QCOMPARE(lastProgress.at(0).toInt(), lastProgress.at(1).toInt());
+    QVERIFY(QFileInfo(path).size() > 0);
+
+    // Cancelling fails the print job.
+    CallbackSpy<bool> cancelledSpy;
+    page.print(&printer, cancelledSpy.ref());
+    page.cancelPrint();
+    QVERIFY(!cancelledSpy.waitForResult());
+}
+
+void tst_Printing::printOnPrinterCopies_data()
+{
+    QTest::addColumn<bool>("collate");
+    // Collated copies print each page several times in a row, rasterizing it only once.
+    QTest::newRow("collated") << true;
+    QTest::newRow("uncollated") << false;
+}
+
+void tst_Printing::printOnPrinterCopies()
+{
+    QFETCH(bool, collate);
+
+    QWebEnginePage page;
+    QSignalSpy spy(&page, &QWebEnginePage::loadFinished);
+    page.load(QUrl("qrc:///resources/basic_printing_page.html"));
+    QTRY_VERIFY(spy.count() == 1);
+
+    CountingPrinter single;
+    CallbackSpy<bool> singleSpy;
+    page.print(&single, singleSpy.ref());
+    QVERIFY(singleSpy.waitForResult());
+    const int pages = single.m_engine.m_paintedPages.load();
+    QVERIFY(pages > 0);
+    QCOMPARE(single.m_engine.m_newPages.load(), pages - 1);
+
+    const int copies = 3;
+    CountingPrinter printer;
+    printer.setCopyCount(copies);
+    printer.setCollateCopies(collate);
+    QVERIFY(!printer.supportsMultipleCopies());
+
+    QSignalSpy progressSpy(&page, &QWebEnginePage::printProgress);
+    CallbackSpy<bool> resultSpy;
+    page.print(&printer, resultSpy.ref());
+    QVERIFY(resultSpy.waitForResult());
+    QCOMPARE(progressSpy.count(), pages * copies);
+    const QList<QVariant> lastProgress = progressSpy.last();
+    QCOMPARE(lastProgress.at(0).toInt(), pages * copies);
+    QCOMPARE(lastProgress.at(1).toInt(), pages * copies);
+    QCOMPARE(printer.m_engine.m_paintedPages.load(), pages * copies);
+    QCOMPARE(printer.m_engine.m_newPages.load(), pages * copies - 1);
+}
+
 #if QT_CONFIG(webengine_poppler_cpp) && defined(Q_OS_LINUX) && defined(__GLIBCXX__)
 void tst_Printing::printToPdfPoppler()
 {
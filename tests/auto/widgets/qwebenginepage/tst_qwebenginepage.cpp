@@ -26,6 +26,7 @@
 #include <QDir>
 #include <QGraphicsWidget>
 #include <QHBoxLayout>
+#include <QJsonObject>
 #include <QLineEdit>
 #include <QMainWindow>
 #include <QMenu>
@@ -48,6 +49,7 @@
 #include <qnetworkreply.h>
 #include <qnetworkrequest.h>
 #include <qwebenginedownloaditem.h>
+#include <qwebengineframetiming.h>
 #include <qwebenginefullscreenrequest.h>
 #include <qwebenginehistory.h>
 #include <qwebenginepage.h>
@@ -57,6 +59,7 @@
 #include <qwebenginescript.h>
 #include <qwebenginescriptcollection.h>
 #include <qwebenginesettings.h>
+#include <qwebengineurlrequestinterceptor.h>
 #include <qwebengineview.h>
 #include <qimagewriter.h>
 
@@ -165,6 +168,7 @@ private Q_SLOTS:
 
     void runJavaScript();
     void runJavaScriptDisabled();
+    void runJavaScriptBatch();
     void fullScreenRequested();
     void quotaRequested();
 
@@ -181,6 +185,9 @@ private Q_SLOTS:
     void setHtmlWithImageResource();
     void setHtmlWithStylesheetResource();
     void setHtmlWithBaseURL();
+    void setHtmlWithLargeContent();
+    void setHtmlWithLargeContentWithoutBaseUrl();
+    void setHtmlWithLargeContentBypassesInterceptor();
     void setHtmlWithJSAlert();
     void inputFieldFocus();
     void hitTestContent();
@@ -232,6 +239,7 @@ private Q_SLOTS:
     void editActionsWithFocusOnIframe();
 
     void customUserAgentInNewTab();
+    void frameTimingReport();
 
 private:
     static QPoint elementCenter(QWebEnginePage *page, const QString &id);
@@ -2843,6 +2851,49 @@ void tst_QWebEnginePage::runJavaScriptDisabled()
              QVariant(2));
 }
 
+void tst_QWebEnginePage::runJavaScriptBatch()
+{
+    QWebEnginePage page;
+    QSignalSpy spy(&page, &QWebEnginePage::loadFinished);
+    page.load(QStringLiteral("about:blank"));
+    QTRY_COMPARE(spy.count(), 1);
+
+    CallbackSpy<QJsonArray> mainWorldSpy;
+    page.runJavaScript({ QStringLiteral("var counter = 1; counter"),
+                         QStringLiteral("++counter"),
+                         QStringLiteral("({ a: [1, 'x', null], b: true, c: undefined })"),
+                         QStringLiteral("undefined"),
+                         QStringLiteral("(function(){})"),
+                         QStringLiteral("document.body"),
+                         QStringLiteral("({a: 1, f() {}})"),
+                         QStringLiteral("[1, function(){}, document.body]"),
+                         QStringLiteral("var cycle = { a: 1 }; cycle.self = cycle; cycle") },
+                       QWebEngineScript::MainWorld, mainWorldSpy.ref());
+    const QJsonArray results = mainWorldSpy.waitForResult();
+    QVERIFY(mainWorldSpy.wasCalled());
+    QCOMPARE(results.size(), 9);
+    QCOMPARE(results.at(0), QJsonValue(1));
+    QCOMPARE(results.at(1), QJsonValue(2));
+    QCOMPARE(results.at(2), QJsonValue(QJsonObject{ { "a", QJsonArray{ 1, "x", QJsonValue() } }, { "b", true } }));
+    QCOMPARE(results.at(3), QJsonValue());
+    QCOMPARE(results.at(4), QJsonValue());
+    QCOMPARE(results.at(5), QJsonValue());
+    // Members that cannot be cloned are dropped like JSON.stringify() does:
+    QCOMPARE(results.at(6), QJsonValue(QJsonObject{ { "a", 1 } }));
+    QCOMPARE(results.at(7), QJsonValue(QJsonArray{ 1, QJsonValue(), QJsonValue() }));
+    QCOMPARE(results.at(8), QJsonValue());
+
+    CallbackSpy<QJsonArray> applicationWorldSpy;
+    page.runJavaScript(QStringList{ QStringLiteral("typeof counter") },
+                       QWebEngineScript::ApplicationWorld, applicationWorldSpy.ref());
+    QCOMPARE(applicationWorldSpy.waitForResult(), QJsonArray{ "undefined" });
+
+    // World ids out of the range Blink accepts are not run:
+    CallbackSpy<QJsonArray> invalidWorldSpy;
+    page.runJavaScript(QStringList{ QStringLiteral("1"), QStringLiteral("2") }, 0xffffffff, invalidWorldSpy.ref());
+    QCOMPARE(invalidWorldSpy.waitForResult(), (QJsonArray{ QJsonValue(), QJsonValue() }));
+}
+
 void tst_QWebEnginePage::fullScreenRequested()
 {
     JavaScriptCallbackWatcher watcher;
@@ -3243,6 +3294,110 @@ void tst_QWebEnginePage::setHtmlWithBaseURL()
     QCOMPARE(m_view->page()->history()->count(), 0);
 }
 
+void tst_QWebEnginePage::setHtmlWithLargeContent()
+{
+    // Content that does not fit into a data: URL is served for the base URL from memory.
+
+    if (!QDir(TESTS_SOURCE_DIR).exists())
+        W_QSKIP(QString("This test requires access to resources found in '%1'").arg(TESTS_SOURCE_DIR).toLatin1().constData(), SkipAll);
+
+    QString filler;
+    filler.fill(QLatin1Char('%'), 3 * 1024 * 1024);
+    QString html = QStringLiteral("<html><body><p id='filler'>") + filler
+            + QStringLiteral("</p><img src='resources/image2.png'/></body></html>");
+
+    QWebEnginePage page;
+    QSignalSpy spyFinished(&page, &QWebEnginePage::loadFinished);
+    page.setHtml(html, QUrl::fromLocalFile(TESTS_SOURCE_DIR));
+    QTRY_COMPARE_WITH_TIMEOUT(spyFinished.count(), 1, 20000);
+    QVERIFY(spyFinished.takeFirst().value(0).toBool());
+
+    QCOMPARE(evaluateJavaScriptSync(&page, "document.getElementById('filler').textContent.length").toInt(), filler.size());
+    QTRY_COMPARE(evaluateJavaScriptSync(&page, "document.images[0].width").toInt(), 128);
+}
+
+void tst_QWebEnginePage::setHtmlWithLargeContentWithoutBaseUrl()
+{
+    // Without a base URL to answer, content that does not fit into a data: URL is
+    // served from an internal URL and displayed as about:blank.
+
+    QString filler;
+    filler.fill(QLatin1Char('%'), 3 * 1024 * 1024);
+    QString html = QStringLiteral("<html><body><p id='filler'>") + filler + QStringLiteral("</p></body></html>");
+
+    QWebEnginePage page;
+    QSignalSpy spyFinished(&page, &QWebEnginePage::loadFinished);
+
+    // Content that needs no escaping still fits into a data: URL well above a third of the limit.
+    QString letters;
+    letters.fill(QLatin1Char('a'), 1024 * 1024);
+    page.setHtml(QStringLiteral("<p>") + letters);
+    QTRY_COMPARE_WITH_TIMEOUT(spyFinished.count(), 1, 20000);
+    QVERIFY(spyFinished.takeFirst().value(0).toBool());
+    QVERIFY(evaluateJavaScriptSync(&page, "document.URL").toString().startsWith(QStringLiteral("data:")));
+
+    page.setHtml(html);
+    QTRY_COMPARE_WITH_TIMEOUT(spyFinished.count(), 1, 20000);
+    QVERIFY(spyFinished.takeFirst().value(0).toBool());
+
+    QCOMPARE(evaluateJavaScriptSync(&page, "document.getElementById('filler').textContent.length").toInt(), filler.size());
+    QCOMPARE(page.url(), QUrl("about:blank"));
+    QCOMPARE(evaluateJavaScriptSync(&page, "window.origin").toString(), QStringLiteral("null"));
+
+    // The internal URL cannot be navigated to without the content behind it.
+    QUrl internalUrl(evaluateJavaScriptSync(&page, "document.URL").toString());
+    QCOMPARE(internalUrl.scheme(), QStringLiteral("qtwebengine-content"));
+    page.load(internalUrl);
+    QTRY_COMPARE_WITH_TIMEOUT(spyFinished.count(), 1, 20000);
+    QVERIFY(!spyFinished.takeFirst().value(0).toBool());
+}
+
+class MainFrameRequestRecorder : public QWebEngineUrlRequestInterceptor
+{
+public:
+    void interceptRequest(QWebEngineUrlRequestInfo &info) override
+    {
+        if (info.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeMainFrame)
+            mainFrameUrls.append(info.requestUrl());
+    }
+    QList<QUrl> mainFrameUrls;
+};
+
+void tst_QWebEnginePage::setHtmlWithLargeContentBypassesInterceptor()
+{
+    // Content served from memory is loaded like a data: URL: it does not reach the request
+    // interceptor, it may load local resources, and it stays available for its history entry.
+
+    if (!QDir(TESTS_SOURCE_DIR).exists())
+        W_QSKIP(QString("This test requires access to resources found in '%1'").arg(TESTS_SOURCE_DIR).toLatin1().constData(), SkipAll);
+
+    QWebEngineProfile profile;
+    MainFrameRequestRecorder interceptor;
+    profile.setRequestInterceptor(&interceptor);
+    QWebEnginePage page(&profile);
+    QSignalSpy spyFinished(&page, &QWebEnginePage::loadFinished);
+
+    QString filler;
+    filler.fill(QLatin1Char('%'), 1024 * 1024);
+    const QUrl imageUrl = QUrl::fromLocalFile(QDir(TESTS_SOURCE_DIR).filePath(QStringLiteral("resources/image2.png")));
+    for (int i = 0; i < 5; ++i) {
+        page.setHtml(QStringLiteral("<html><body><p id='filler'>") + filler
+                     + QStringLiteral("</p><p id='index'>%1</p><img src='%2'/></body></html>").arg(i).arg(imageUrl.toString()),
+                     QUrl(QStringLiteral("qrc:/")));
+        QTRY_COMPARE_WITH_TIMEOUT(spyFinished.count(), 1, 20000);
+        QVERIFY(spyFinished.takeFirst().value(0).toBool());
+    }
+    QVERIFY(interceptor.mainFrameUrls.isEmpty());
+    QTRY_COMPARE(evaluateJavaScriptSync(&page, "document.images[0].width").toInt(), 128);
+
+    QVERIFY(page.history()->count() >= 5);
+    page.history()->goToItem(page.history()->itemAt(0));
+    QTRY_COMPARE_WITH_TIMEOUT(spyFinished.count(), 1, 20000);
+    QVERIFY(spyFinished.takeFirst().value(0).toBool());
+    QCOMPARE(evaluateJavaScriptSync(&page, "document.getElementById('index').textContent").toString(), QStringLiteral("0"));
+    QCOMPARE(evaluateJavaScriptSync(&page, "document.getElementById('filler').textContent.length").toInt(), filler.size());
+}
+
 class MyPage : public QWebEnginePage
 {
 public:
@@ -4038,6 +4193,23 @@ void tst_QWebEnginePage::loadFromQrc()
     QCOMPARE(spy.takeFirst().value(0).toBool(), true);
     QCOMPARE(toPlainTextSync(&page), QStringLiteral("contents with spaces\n"));
 
+    // The MIME type follows from the file name.
+    page.load(QStringLiteral("qrc:///resources/style.css"));
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.takeFirst().value(0).toBool(), true);
+    QCOMPARE(evaluateJavaScriptSync(&page, "document.contentType").toString(), QStringLiteral("text/css"));
+
+    // Resources carry their timestamp as Last-Modified.
+    const QDateTime lastModified = QResource(QStringLiteral(":/resources/foo.txt")).lastModified();
+    if (lastModified.isValid()) {
+        page.load(QStringLiteral("qrc:///resources/foo.txt"));
+        QTRY_COMPARE(spy.count(), 1);
+        QCOMPARE(spy.takeFirst().value(0).toBool(), true);
+        const QString documentLastModified = evaluateJavaScriptSync(&page, "document.lastModified").toString();
+        QCOMPARE(QDateTime::fromString(documentLastModified, QStringLiteral("MM/dd/yyyy hh:mm:ss")),
+                 lastModified.toLocalTime().addMSecs(-lastModified.time().msec()));
+    }
+
     // Resource not found, loading fails.
     page.load(QStringLiteral("qrc:///nope"));
     QTRY_COMPARE(spy.count(), 1);
@@ -4660,6 +4832,46 @@ void tst_QWebEnginePage::customUserAgentInNewTab()
     QCOMPARE(lastUserAgent, profile2.httpUserAgent().toUtf8());
 }
 
+void tst_QWebEnginePage::frameTimingReport()
+{
+    QWebEngineView view;
+    view.resize(300, 300);
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+    QSignalSpy loadFinishedSpy(view.page(), &QWebEnginePage::loadFinished);
+    view.setHtml("<html><body><div id='box' style='width: 50px; height: 50px; background: green; position: absolute'></div>"
+                 "<script>var x = 0;"
+                 "function step() { document.getElementById('box').style.left = (++x % 200) + 'px'; requestAnimationFrame(step); }"
+                 "requestAnimationFrame(step);</script></body></html>");
+    QTRY_COMPARE(loadFinishedSpy.count(), 1);
+    QVERIFY(loadFinishedSpy.takeFirst().value(0).toBool());
+
+    // The animation keeps submitting frames, wait for a few of them to be presented.
+    QVector<QWebEngineFrameTiming> frames;
+    QTRY_VERIFY((frames = view.page()->frameTimingReport().frames()).count() >= 5);
+
+    qint64 previousSubmitTime = -1;
+    for (const QWebEngineFrameTiming &frame : qAsConst(frames)) {
+        QVERIFY(frame.submitTime() != -1);
+        QVERIFY(frame.submitTime() >= previousSubmitTime);
+        previousSubmitTime = frame.submitTime();
+
+        // Every stage a frame reached happened after the previous one.
+        qint64 previousStageTime = frame.submitTime();
+        for (qint64 stageTime : { frame.commitStartTime(), frame.commitEndTime(), frame.swapTime() }) {
+            if (stageTime == -1)
+                continue;
+            QVERIFY(stageTime >= previousStageTime);
+            previousStageTime = stageTime;
+        }
+        if (frame.isDropped())
+            QCOMPARE(frame.swapTime(), qint64(-1));
+    }
+    QVERIFY(std::any_of(frames.cbegin(), frames.cend(),
+                        [](const QWebEngineFrameTiming &frame) { return frame.swapTime() != -1; }));
+}
+
 static QByteArrayList params = {QByteArrayLiteral("--use-fake-device-for-media-stream")};
 W_QTEST_MAIN(tst_QWebEnginePage, params)
 
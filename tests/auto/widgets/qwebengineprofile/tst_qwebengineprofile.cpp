@@ -55,6 +55,13 @@ private Q_SLOTS:
     void urlSchemeHandlerFailRequest();
     void urlSchemeHandlerFailOnRead();
     void urlSchemeHandlerStreaming();
+    void urlSchemeHandlerConcurrent();
+    void urlSchemeHandlerRequestBody();
+    void urlSchemeHandlerResponseHeaders();
+    void urlSchemeHandlerRange_data();
+    void urlSchemeHandlerRange();
+    void urlSchemeHandlerRedirectStatus_data();
+    void urlSchemeHandlerRedirectStatus();
     void urlSchemeHandlerInstallation();
     void customUserAgent();
     void httpAcceptLanguage();
@@ -314,6 +321,128 @@ public:
     }
 };
 
+class ConcurrentStreamingUrlSchemeHandler : public QWebEngineConcurrentUrlSchemeHandler
+{
+public:
+    void requestStarted(QWebEngineUrlRequestJob *job)
+    {
+        QMutexLocker lock(&m_mutex);
+        m_requestThreads.append(QThread::currentThread());
+        job->reply("text/plain;charset=utf-8", new StreamingIODevice(job));
+    }
+
+    QList<QThread *> requestThreads() const
+    {
+        QMutexLocker lock(&m_mutex);
+        return m_requestThreads;
+    }
+
+private:
+    mutable QMutex m_mutex;
+    QList<QThread *> m_requestThreads;
+};
+
+class EchoingUrlSchemeHandler : public QWebEngineUrlSchemeHandler
+{
+public:
+    void requestStarted(QWebEngineUrlRequestJob *job)
+    {
+        m_requestHeaders = job->requestHeaders();
+        QIODevice *body = job->requestBody();
+        if (!body) {
+            job->fail(QWebEngineUrlRequestJob::RequestFailed);
+            return;
+        }
+        QBuffer *buffer = new QBuffer(job);
+        auto readBody = [this, job, body, buffer]() {
+            buffer->buffer().append(body->readAll());
+            if (body->atEnd() && !buffer->isOpen()) {
+                char c;
+                m_readAtEnd = body->read(&c, 1);
+                job->reply("text/plain;charset=utf-8", buffer);
+            }
+        };
+        QObject::connect(body, &QIODevice::readyRead, job, readBody);
+        QObject::connect(body, &QIODevice::readChannelFinished, job, readBody);
+    }
+
+    QMultiMap<QByteArray, QByteArray> m_requestHeaders;
+    qint64 m_readAtEnd = 0;
+};
+
+// Serves a page at the root, and ten bytes of random-access data at the other paths.
+// The data at /custom has its own status code and additional headers, the paths starting
+// with /redirect and /moved redirect to /data.
+class ResponseUrlSchemeHandler : public QWebEngineUrlSchemeHandler
+{
+public:
+    void requestStarted(QWebEngineUrlRequestJob *job) override
+    {
+        const QString path = job->requestUrl().path();
+        if (path == QLatin1String("/data"))
+            m_dataMethods.append(job->requestMethod());
+        if (path == QLatin1String("/redirect")) {
+            job->redirect(QUrl(QStringLiteral("foo://bar/data")));
+            return;
+        }
+        if (path == QLatin1String("/redirect307")) {
+            job->setResponseStatusCode(307);
+            job->redirect(QUrl(QStringLiteral("foo://bar/data")));
+            return;
+        }
+        QBuffer *buffer = new QBuffer(job);
+        if (path.isEmpty() || path == QLatin1String("/")) {
+            buffer->setData(QByteArrayLiteral("<html><body>page</body></html>"));
+            job->reply(QByteArrayLiteral("text/html"), buffer);
+            return;
+        }
+        if (path == QLatin1String("/moved") || path == QLatin1String("/nolocation")) {
+            // Only a redirect status code with a Location header redirects.
+            QMultiMap<QByteArray, QByteArray> headers;
+            if (path == QLatin1String("/moved"))
+                headers.insert(QByteArrayLiteral("Location"), QByteArrayLiteral("/data"));
+            job->setResponseStatusCode(301);
+            job->setAdditionalResponseHeaders(headers);
+            buffer->setData(QByteArrayLiteral("moved"));
+            job->reply(QByteArrayLiteral("text/plain"), buffer);
+            return;
+        }
+        if (path == QLatin1String("/custom")) {
+            QMultiMap<QByteArray, QByteArray> headers;
+            headers.insert(QByteArrayLiteral("X-Custom"), QByteArrayLiteral("first"));
+            headers.insert(QByteArrayLiteral("Cache-Control"), QByteArrayLiteral("no-store"));
+            // Invalid header values are dropped.
+            headers.insert(QByteArrayLiteral("X-Invalid"), QByteArrayLiteral("a\nb"));
+            job->setResponseStatusCode(203);
+            job->setAdditionalResponseHeaders(headers);
+        }
+        buffer->setData(QByteArrayLiteral("0123456789"));
+        job->reply(QByteArrayLiteral("text/plain"), buffer);
+    }
+
+    QList<QByteArray> m_dataMethods;
+};
+
+// Fetches url from the page with a synchronous XMLHttpRequest. Blink's fetch() only supports
+// the schemes registered for the Fetch API, which custom schemes aren't. Returns the status,
+// the body and the given response headers, or a null QVariant if the request failed.
+static QVariant requestSync(QWebEnginePage *page, const QString &url, const QString &range, const QStringList &headers)
+{
+    return evaluateJavaScriptSync(page, QStringLiteral(
+            "(function() {"
+            "    var xhr = new XMLHttpRequest();"
+            "    xhr.open('GET', '%1', false);"
+            "    if ('%2')"
+            "        xhr.setRequestHeader('Range', '%2');"
+            "    try {"
+            "        xhr.send();"
+            "    } catch (e) {"
+            "        return null;"
+            "    }"
+            "    return [xhr.status, xhr.responseText].concat(%3.map(function(name) { return xhr.getResponseHeader(name); }));"
+            "})()").arg(url, range, QStringLiteral("['") + headers.join(QStringLiteral("', '")) + QStringLiteral("']")));
+}
+
 static bool loadSync(QWebEngineView *view, const QUrl &url, int timeout = 5000)
 {
     // Ripped off QTRY_VERIFY.
@@ -467,6 +596,177 @@ void tst_QWebEngineProfile::urlSchemeHandlerStreaming()
     QCOMPARE(toPlainTextSync(view.page()), QString::fromLatin1(result));
 }
 
+void tst_QWebEngineProfile::urlSchemeHandlerConcurrent()
+{
+    ConcurrentStreamingUrlSchemeHandler handler;
+    QWebEngineProfile profile;
+    profile.installUrlSchemeHandler("stream", &handler);
+    QWebEngineView view;
+    QSignalSpy loadFinishedSpy(&view, SIGNAL(loadFinished(bool)));
+    view.setPage(new QWebEnginePage(&profile, &view));
+    view.settings()->setAttribute(QWebEngineSettings::ErrorPageEnabled, false);
+    view.load(QUrl(QStringLiteral("stream://whatever")));
+    QVERIFY(loadFinishedSpy.wait());
+    QByteArray result;
+    result.append(1000, 'c');
+    QCOMPARE(toPlainTextSync(view.page()), QString::fromLatin1(result));
+
+    // The request and its device were serviced on a worker thread.
+    const QList<QThread *> requestThreads = handler.requestThreads();
+    QCOMPARE(requestThreads.count(), 1);
+    QVERIFY(requestThreads.first() != QThread::currentThread());
+
+    // Requests are no longer dispatched to a removed handler.
+    profile.removeUrlSchemeHandler(&handler);
+    QVERIFY(loadSync(&view, QUrl(QStringLiteral("stream://whatever"))));
+    QCOMPARE(handler.requestThreads().count(), 1);
+}
+
+void tst_QWebEngineProfile::urlSchemeHandlerRequestBody()
+{
+    EchoingUrlSchemeHandler handler;
+    QWebEngineProfile profile;
+    profile.installUrlSchemeHandler("foo", &handler);
+    QWebEngineView view;
+    QSignalSpy loadFinishedSpy(&view, SIGNAL(loadFinished(bool)));
+    view.setPage(new QWebEnginePage(&profile, &view));
+    view.settings()->setAttribute(QWebEngineSettings::ErrorPageEnabled, false);
+
+    // Large enough to be streamed in several chunks.
+    const QString value(200000, QLatin1Char('a'));
+    QMap<QString, QString> postData;
+    postData.insert(QStringLiteral("key"), value);
+    view.load(QWebEngineHttpRequest::postRequest(QUrl(QStringLiteral("foo://bar")), postData));
+    QVERIFY(loadFinishedSpy.wait());
+    QCOMPARE(toPlainTextSync(view.page()), QStringLiteral("key=") + value);
+    QCOMPARE(handler.m_requestHeaders.value("Content-Type"), QByteArrayLiteral("application/x-www-form-urlencoded"));
+    QCOMPARE(handler.m_readAtEnd, qint64(-1));
+}
+
+void tst_QWebEngineProfile::urlSchemeHandlerResponseHeaders()
+{
+    ResponseUrlSchemeHandler handler;
+    QWebEngineProfile profile;
+    profile.installUrlSchemeHandler("foo", &handler);
+    QWebEnginePage page(&profile);
+    QSignalSpy loadFinishedSpy(&page, SIGNAL(loadFinished(bool)));
+    page.load(QUrl(QStringLiteral("foo://bar/")));
+    QTRY_COMPARE(loadFinishedSpy.count(), 1);
+    QVERIFY(loadFinishedSpy.takeFirst().value(0).toBool());
+
+    const QStringList headers = { QStringLiteral("Content-Type"), QStringLiteral("Content-Length"),
+                                  QStringLiteral("X-Custom"), QStringLiteral("Cache-Control"),
+                                  QStringLiteral("X-Invalid") };
+    const QVariantList response = requestSync(&page, QStringLiteral("foo://bar/custom"), QString(), headers).toList();
+    QCOMPARE(response.size(), 7);
+    QCOMPARE(response.at(0).toInt(), 203);
+    QCOMPARE(response.at(1).toString(), QStringLiteral("0123456789"));
+    QCOMPARE(response.at(2).toString(), QStringLiteral("text/plain"));
+    QCOMPARE(response.at(3).toString(), QStringLiteral("10"));
+    QCOMPARE(response.at(4).toString(), QStringLiteral("first"));
+    QCOMPARE(response.at(5).toString(), QStringLiteral("no-store"));
+    QVERIFY(response.at(6).isNull());
+}
+
+void tst_QWebEngineProfile::urlSchemeHandlerRange_data()
+{
+    QTest::addColumn<QString>("range");
+    QTest::addColumn<bool>("satisfiable");
+    QTest::addColumn<int>("status");
+    QTest::addColumn<QString>("body");
+    QTest::addColumn<QString>("contentRange");
+
+    QTest::newRow("partial") << QStringLiteral("bytes=2-5") << true << 206 << QStringLiteral("2345") << QStringLiteral("bytes 2-5/10");
+    QTest::newRow("open ended") << QStringLiteral("bytes=7-") << true << 206 << QStringLiteral("789") << QStringLiteral("bytes 7-9/10");
+    QTest::newRow("suffix") << QStringLiteral("bytes=-3") << true << 206 << QStringLiteral("789") << QStringLiteral("bytes 7-9/10");
+    QTest::newRow("clamped") << QStringLiteral("bytes=8-20") << true << 206 << QStringLiteral("89") << QStringLiteral("bytes 8-9/10");
+    // Fails with ERR_REQUEST_RANGE_NOT_SATISFIABLE, the request gets no response at all.
+    QTest::newRow("unsatisfiable") << QStringLiteral("bytes=10-20") << false << 0 << QString() << QString();
+}
+
+void tst_QWebEngineProfile::urlSchemeHandlerRange()
+{
+    QFETCH(QString, range);
+    QFETCH(bool, satisfiable);
+    QFETCH(int, status);
+    QFETCH(QString, body);
+    QFETCH(QString, contentRange);
+
+    ResponseUrlSchemeHandler handler;
+    QWebEngineProfile profile;
+    profile.installUrlSchemeHandler("foo", &handler);
+    QWebEnginePage page(&profile);
+    QSignalSpy loadFinishedSpy(&page, SIGNAL(loadFinished(bool)));
+    page.load(QUrl(QStringLiteral("foo://bar/")));
+    QTRY_COMPARE(loadFinishedSpy.count(), 1);
+    QVERIFY(loadFinishedSpy.takeFirst().value(0).toBool());
+
+    const QVariant response = requestSync(&page, QStringLiteral("foo://bar/data"), range, { QStringLiteral("Content-Range") });
+    if (!satisfiable) {
+        QVERIFY(response.isNull());
+        return;
+    }
+    const QVariantList values = response.toList();
+    QCOMPARE(values.size(), 3);
+    QCOMPARE(values.at(0).toInt(), status);
+    QCOMPARE(values.at(1).toString(), body);
+    QCOMPARE(values.at(2).toString(), contentRange);
+}
+
+void tst_QWebEngineProfile::urlSchemeHandlerRedirectStatus_data()
+{
+    QTest::addColumn<QString>("path");
+    QTest::addColumn<int>("status");
+    QTest::addColumn<QString>("body");
+    QTest::addColumn<QString>("responseUrl");
+    QTest::addColumn<QByteArray>("dataMethod");
+
+    // redirect() answers with 303 See Other, which turns the POST into a GET.
+    QTest::newRow("redirect") << QStringLiteral("/redirect") << 200 << QStringLiteral("0123456789")
+                              << QStringLiteral("foo://bar/data") << QByteArrayLiteral("GET");
+    // The status code set before redirect() is used, 307 keeps the method.
+    QTest::newRow("redirect 307") << QStringLiteral("/redirect307") << 200 << QStringLiteral("0123456789")
+                                  << QStringLiteral("foo://bar/data") << QByteArrayLiteral("POST");
+    QTest::newRow("reply with location") << QStringLiteral("/moved") << 200 << QStringLiteral("0123456789")
+                                         << QStringLiteral("foo://bar/data") << QByteArrayLiteral("GET");
+    QTest::newRow("reply without location") << QStringLiteral("/nolocation") << 301 << QStringLiteral("moved")
+                                            << QStringLiteral("foo://bar/nolocation") << QByteArray();
+}
+
+void tst_QWebEngineProfile::urlSchemeHandlerRedirectStatus()
+{
+    QFETCH(QString, path);
+    QFETCH(int, status);
+    QFETCH(QString, body);
+    QFETCH(QString, responseUrl);
+    QFETCH(QByteArray, dataMethod);
+
+    ResponseUrlSchemeHandler handler;
+    QWebEngineProfile profile;
+    profile.installUrlSchemeHandler("foo", &handler);
+    QWebEnginePage page(&profile);
+    QSignalSpy loadFinishedSpy(&page, SIGNAL(loadFinished(bool)));
+    page.load(QUrl(QStringLiteral("foo://bar/")));
+    QTRY_COMPARE(loadFinishedSpy.count(), 1);
+    QVERIFY(loadFinishedSpy.takeFirst().value(0).toBool());
+
+    const QVariantList response = evaluateJavaScriptSync(&page, QStringLiteral(
+            "(function() {"
+            "    var xhr = new XMLHttpRequest();"
+            "    xhr.open('POST', 'foo://bar%1', false);"
+            "    xhr.send('body');"
+            "    return [xhr.status, xhr.responseText, xhr.responseURL];"
+            "})()").arg(path)).toList();
+    QCOMPARE(response.size(), 3);
+    QCOMPARE(response.at(0).toInt(), status);
+    QCOMPARE(response.at(1).toString(), body);
+    QCOMPARE(response.at(2).toString(), responseUrl);
+    if (dataMethod.isEmpty())
+        QVERIFY(handler.m_dataMethods.isEmpty());
+    else
+        QCOMPARE(handler.m_dataMethods, QList<QByteArray>() << dataMethod);
+}
+
 void tst_QWebEngineProfile::urlSchemeHandlerInstallation()
 {
     FailingUrlSchemeHandler handler;
@@ -26,8 +26,11 @@
 #include <qwebenginesettings.h>
 #include <qwebengineview.h>
 #include "../util.h"
+#include <QJsonArray>
+#include <QJsonObject>
 #if QT_CONFIG(webengine_webchannel)
 #include <QWebChannel>
+#include <QtWebEngineCore/qwebenginewebchannelstatistics.h>
 #endif
 
 class tst_QWebEngineScript: public QObject {
@@ -41,6 +44,8 @@ private Q_SLOTS:
     void scriptDisabled();
     void viewSource();
     void scriptModifications();
+    void profileWideScriptInTwoProcesses();
+    void scriptWithInvalidWorldId();
 #if QT_CONFIG(webengine_webchannel)
     void webChannel_data();
     void webChannel();
@@ -48,9 +53,13 @@ private Q_SLOTS:
     void webChannelWithExistingQtObject();
     void navigation();
     void webChannelWithBadString();
+    void webChannelWireFormat();
+    void webChannelWireFormatVersion();
+    void webChannelBatching();
 #endif
     void noTransportWithoutWebChannel();
     void scriptsInNestedIframes();
+    void matchScriptsByHost();
 };
 
 void tst_QWebEngineScript::domEditing()
@@ -291,6 +300,67 @@ void tst_QWebEngineScript::scriptModifications()
     QVERIFY(page.scripts().count() == 0);
 }
 
+void tst_QWebEngineScript::profileWideScriptInTwoProcesses()
+{
+    QWebEngineProfile profile;
+    QWebEngineScript script;
+    script.setInjectionPoint(QWebEngineScript::DocumentCreation);
+    script.setWorldId(QWebEngineScript::MainWorld);
+    // Not ASCII, so the shared source has to be decoded from UTF-8 in every renderer.
+    const QString value = QString::fromUtf8("f\xc3\xbc\xc3\x9f \xe2\x82\xac");
+    script.setSourceCode(QStringLiteral("var userScriptValue = '%1';").arg(value));
+    profile.scripts()->insert(script);
+
+    QWebEnginePage page1(&profile);
+    QWebEnginePage page2(&profile);
+    QSignalSpy spyFinished1(&page1, &QWebEnginePage::loadFinished);
+    QSignalSpy spyFinished2(&page2, &QWebEnginePage::loadFinished);
+    page1.load(QUrl("about:blank"));
+    page2.load(QUrl("about:blank"));
+    QTRY_COMPARE(spyFinished1.count(), 1);
+    QTRY_COMPARE(spyFinished2.count(), 1);
+    QCOMPARE(evaluateJavaScriptSync(&page1, "userScriptValue"), QVariant(value));
+    QCOMPARE(evaluateJavaScriptSync(&page2, "userScriptValue"), QVariant(value));
+
+    // Running it again in the same process uses the source decoded there before.
+    page2.triggerAction(QWebEnginePage::Reload);
+    QTRY_COMPARE(spyFinished2.count(), 2);
+    QCOMPARE(evaluateJavaScriptSync(&page2, "userScriptValue"), QVariant(value));
+
+    // The second page outlives the renderer of the first one, so they run in different processes.
+    qRegisterMetaType<QWebEnginePage::RenderProcessTerminationStatus>("RenderProcessTerminationStatus");
+    QSignalSpy terminatedSpy(&page1, &QWebEnginePage::renderProcessTerminated);
+    page1.load(QUrl("chrome://crash"));
+    QVERIFY(!terminatedSpy.empty() || terminatedSpy.wait(20000));
+    QCOMPARE(evaluateJavaScriptSync(&page2, "userScriptValue"), QVariant(value));
+
+    // A renderer started after the script was added gets it too.
+    spyFinished1.clear();
+    page1.load(QUrl("about:blank"));
+    QTRY_COMPARE(spyFinished1.count(), 1);
+    QCOMPARE(evaluateJavaScriptSync(&page1, "userScriptValue"), QVariant(value));
+}
+
+void tst_QWebEngineScript::scriptWithInvalidWorldId()
+{
+    // Refused where it is added, instead of taking down the renderer that would run it.
+    QWebEngineProfile profile;
+    QWebEngineScript script;
+    script.setName(QStringLiteral("outOfRange"));
+    script.setInjectionPoint(QWebEngineScript::DocumentCreation);
+    script.setWorldId(1u << 30);
+    script.setSourceCode(QStringLiteral("var outOfRange = true;"));
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("User script outOfRange ignored: world id .* out of range"));
+    profile.scripts()->insert(script);
+    QVERIFY(!profile.scripts()->contains(script));
+
+    QWebEnginePage page(&profile);
+    QSignalSpy spyFinished(&page, &QWebEnginePage::loadFinished);
+    page.setHtml(QStringLiteral("<html><body>test</body></html>"));
+    QTRY_COMPARE(spyFinished.count(), 1);
+    QVERIFY(spyFinished.takeFirst().value(0).toBool());
+}
+
 class TestObject : public QObject
 {
     Q_OBJECT
@@ -315,6 +385,26 @@ private:
     QString m_text;
 };
 
+class JsonValueObject : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QJsonValue value READ value WRITE setValue NOTIFY valueChanged)
+public:
+    void setValue(const QJsonValue &value)
+    {
+        m_value = value;
+        emit valueChanged();
+    }
+
+    QJsonValue value() const { return m_value; }
+
+signals:
+    void valueChanged();
+
+private:
+    QJsonValue m_value;
+};
+
 #if QT_CONFIG(webengine_webchannel)
 static QString readFile(const QString &path)
 {
@@ -446,6 +536,45 @@ void tst_QWebEngineScript::scriptsInNestedIframes()
                 QVariant::fromValue(QStringLiteral("Modified Inner text")));
 }
 #if QT_CONFIG(webengine_webchannel)
+void tst_QWebEngineScript::matchScriptsByHost()
+{
+    // The scripts with URL patterns are only matched against the frames of the hosts
+    // of their patterns, but must run as if every script was matched.
+    auto scriptFor = [](const QString &name, const QStringList &patterns) {
+        QString source = QStringLiteral("// ==UserScript==\n");
+        for (const QString &pattern : patterns)
+            source += QStringLiteral("// @match %1\n").arg(pattern);
+        source += QStringLiteral("// ==/UserScript==\n(window.log = window.log || []).push('%1');").arg(name);
+        QWebEngineScript script;
+        script.setName(name);
+        script.setSourceCode(source);
+        script.setInjectionPoint(QWebEngineScript::DocumentReady);
+        script.setWorldId(QWebEngineScript::MainWorld);
+        return script;
+    };
+
+    QWebEnginePage page;
+    // Created in a different order than the one they are looked up in.
+    page.scripts().insert(scriptFor(QStringLiteral("subdomains"), { QStringLiteral("http://*.example.com/*") }));
+    page.scripts().insert(scriptFor(QStringLiteral("anyHost"), {}));
+    page.scripts().insert(scriptFor(QStringLiteral("twoHosts"), { QStringLiteral("http://*.sub.example.com/*"),
+                                                                   QStringLiteral("http://www.sub.example.com/*") }));
+    page.scripts().insert(scriptFor(QStringLiteral("otherHost"), { QStringLiteral("http://*.example.org/*") }));
+    page.scripts().insert(scriptFor(QStringLiteral("sameHost"), { QStringLiteral("http://www.sub.example.com/*") }));
+
+    QSignalSpy spyFinished(&page, &QWebEnginePage::loadFinished);
+    page.setHtml(QStringLiteral("<html><body>test</body></html>"), QUrl(QStringLiteral("http://www.sub.example.com/")));
+    QVERIFY(spyFinished.wait());
+    QCOMPARE(evaluateJavaScriptSync(&page, QStringLiteral("window.log")),
+             QVariant(QVariantList({ QStringLiteral("subdomains"), QStringLiteral("anyHost"),
+                                     QStringLiteral("twoHosts"), QStringLiteral("sameHost") })));
+
+    page.setHtml(QStringLiteral("<html><body>test</body></html>"), QUrl(QStringLiteral("http://example.org/")));
+    QVERIFY(spyFinished.wait());
+    QCOMPARE(evaluateJavaScriptSync(&page, QStringLiteral("window.log")),
+             QVariant(QVariantList({ QStringLiteral("anyHost"), QStringLiteral("otherHost") })));
+}
+
 void tst_QWebEngineScript::webChannelResettingAndUnsetting()
 {
     QWebEnginePage page;
@@ -548,6 +677,153 @@ void tst_QWebEngineScript::webChannelWithBadString()
     QVERIFY(hostSpy.wait(20000));
     QCOMPARE(host.text(), QString(QChar(QChar::ReplacementCharacter)));
 }
+
+// Messages sent as objects rather than JSON text are structured clones, and the
+// host answers in kind once it has received one.
+void tst_QWebEngineScript::webChannelWireFormat()
+{
+    QWebEnginePage page;
+    TestObject testObject;
+    QSignalSpy spyTextChanged(&testObject, &TestObject::textChanged);
+    QWebChannel channel;
+    channel.registerObject(QStringLiteral("object"), &testObject);
+    page.setWebChannel(&channel);
+    page.scripts().insert(webChannelScript());
+    page.setHtml(QStringLiteral("<html><body></body></html>"));
+    QSignalSpy spyFinished(&page, &QWebEnginePage::loadFinished);
+    QVERIFY(spyFinished.wait());
+
+    page.runJavaScript(QLatin1String(
+                                "new QWebChannel(qt.webChannelTransport, function(channel) {"
+                                "  channel.send = function(data) { channel.transport.send(data); };"
+                                "  channel.objects.object.textChanged.connect(function(text) { window.hostText = text; });"
+                                "  channel.objects.object.text = 'test';"
+                                "  window.channel = channel;"
+                                "});"));
+    QVERIFY(spyTextChanged.wait());
+    QCOMPARE(testObject.text(), QStringLiteral("test"));
+
+    testObject.setText(QStringLiteral("from host \u00e9\u4e2d"));
+    QTRY_COMPARE(evaluateJavaScriptSync(&page, "window.hostText"), QVariant(QStringLiteral("from host \u00e9\u4e2d")));
+
+    // ArrayBuffers arrive as base64.
+    page.runJavaScript(QLatin1String("channel.objects.object.text = new Uint8Array([113, 116]).buffer;"));
+    QTRY_COMPARE(testObject.text(), QStringLiteral("cXQ="));
+
+    // Values that cannot be cloned are rejected in the page.
+    QCOMPARE(evaluateJavaScriptSync(&page, "try { qt.webChannelTransport.send({ f: function() {} }); 'sent' }"
+                                           " catch (e) { 'rejected' }"),
+             QVariant(QStringLiteral("rejected")));
+
+    // Repeated references would expand to 2^40 values on the host, which drops the message.
+    QTest::ignoreMessage(QtCriticalMsg, QRegularExpression(QStringLiteral("received invalid webchannel message")));
+    const int textChanges = spyTextChanged.count();
+    page.runJavaScript(QLatin1String("var value = ['x'];"
+                                     "for (var i = 0; i < 40; ++i) value = [value, value];"
+                                     "channel.objects.object.text = value;"
+                                     "channel.objects.object.text = 'after';"));
+    QTRY_COMPARE(testObject.text(), QStringLiteral("after"));
+    QCOMPARE(spyTextChanged.count(), textChanges + 1);
+}
+
+// The host decodes the structured clones of the page itself, and only accepts the version
+// of the format written by the V8 it was made for. This fails when V8 changes that version.
+void tst_QWebEngineScript::webChannelWireFormatVersion()
+{
+    QWebEnginePage page;
+    JsonValueObject jsonObject;
+    QSignalSpy spyValueChanged(&jsonObject, &JsonValueObject::valueChanged);
+    QWebChannel channel;
+    channel.registerObject(QStringLiteral("json"), &jsonObject);
+    page.setWebChannel(&channel);
+    page.scripts().insert(webChannelScript());
+    page.setHtml(QStringLiteral("<html><body></body></html>"));
+    QSignalSpy spyFinished(&page, &QWebEnginePage::loadFinished);
+    QVERIFY(spyFinished.wait());
+
+    page.runJavaScript(QLatin1String(
+                                "new QWebChannel(qt.webChannelTransport, function(channel) {"
+                                "  channel.send = function(data) { channel.transport.send(data); };"
+                                "  channel.objects.json.value = { a: 1, b: 'x', c: [true, null] };"
+                                "  window.channel = channel;"
+                                "});"));
+    QVERIFY(spyValueChanged.wait());
+    QCOMPARE(jsonObject.value(), QJsonValue(QJsonObject{ { "a", 1 }, { "b", "x" }, { "c", QJsonArray{ true, QJsonValue() } } }));
+
+    // Arrays with holes are written as sparse arrays, whose holes become null.
+    page.runJavaScript(QLatin1String("channel.objects.json.value = [1,,3];"));
+    QVERIFY(spyValueChanged.wait());
+    QCOMPARE(jsonObject.value(), QJsonValue(QJsonArray{ 1, QJsonValue(), 3 }));
+
+    // Even when they are longer than their encoding.
+    page.runJavaScript(QLatin1String("var sparse = [1]; sparse[99] = 'x'; channel.objects.json.value = sparse;"));
+    QVERIFY(spyValueChanged.wait());
+    QJsonArray expected{ 1 };
+    for (int i = 1; i < 99; ++i)
+        expected.append(QJsonValue());
+    expected.append(QStringLiteral("x"));
+    QCOMPARE(jsonObject.value(), QJsonValue(expected));
+}
+
+// Messages sent in the same task travel together, and are delivered in order.
+void tst_QWebEngineScript::webChannelBatching()
+{
+    QWebEnginePage page;
+    TestObject testObject;
+    QStringList texts;
+    connect(&testObject, &TestObject::textChanged, [&texts](const QString &text) { texts.append(text); });
+    QWebChannel channel;
+    channel.registerObject(QStringLiteral("object"), &testObject);
+    page.setWebChannel(&channel);
+    page.scripts().insert(webChannelScript());
+    page.setHtml(QStringLiteral("<html><body></body></html>"));
+    QSignalSpy spyFinished(&page, &QWebEnginePage::loadFinished);
+    QVERIFY(spyFinished.wait());
+
+    page.runJavaScript(QLatin1String(
+                                "new QWebChannel(qt.webChannelTransport, function(channel) {"
+                                "  for (var i = 0; i < 500; ++i)"
+                                "    channel.objects.object.text = 'text' + i;"
+                                "});"));
+    QTRY_COMPARE(texts.size(), 500);
+    for (int i = 0; i < texts.size(); ++i)
+        QCOMPARE(texts.at(i), QStringLiteral("text%1").arg(i));
+    QTRY_COMPARE(page.webChannelStatistics().queueDepth(), 0);
+    const QWebEngineWebChannelStatistics before = page.webChannelStatistics();
+    QVERIFY(before.messagesReceived() >= 500);
+    QVERIFY(before.batchesReceived() > 0);
+    QVERIFY(before.messagesSent() > 0);
+
+    // send() refuses messages once as many as the high-water mark of 1000 wait for the
+    // host, and ondrain tells the page when the host has acknowledged enough of them.
+    QCOMPARE(page.webChannelHighWaterMark(), 1000u);
+    QCOMPARE(evaluateJavaScriptSync(&page, "window.drained = false;"
+                                           "qt.webChannelTransport.ondrain = function() { window.drained = true; };"
+                                           "var accepted = 0;"
+                                           "while (qt.webChannelTransport.send(JSON.stringify({ type: 4 })))"
+                                           "  ++accepted;"
+                                           "window.drainedBeforeAck = window.drained;"
+                                           "accepted;").toInt(), 1000);
+    QTRY_VERIFY(evaluateJavaScriptSync(&page, "window.drained").toBool());
+    QCOMPARE(evaluateJavaScriptSync(&page, "window.drainedBeforeAck"), QVariant(false));
+
+    // The message send() refused was dropped.
+    QTRY_COMPARE(page.webChannelStatistics().messagesReceived() - before.messagesReceived(), 1000ull);
+    QTRY_COMPARE(page.webChannelStatistics().queueDepth(), 0);
+    const QWebEngineWebChannelStatistics after = page.webChannelStatistics();
+    QVERIFY(after.batchesReceived() > before.batchesReceived());
+    QVERIFY(after.bytesReceived() > before.bytesReceived());
+
+    page.setWebChannelHighWaterMark(10);
+    QCOMPARE(page.webChannelHighWaterMark(), 10u);
+    QCOMPARE(evaluateJavaScriptSync(&page, "window.drained = false;"
+                                           "var accepted = 0;"
+                                           "while (qt.webChannelTransport.send(JSON.stringify({ type: 4 })))"
+                                           "  ++accepted;"
+                                           "accepted;").toInt(), 10);
+    QTRY_VERIFY(evaluateJavaScriptSync(&page, "window.drained").toBool());
+    QTRY_COMPARE(page.webChannelStatistics().messagesReceived() - after.messagesReceived(), 10ull);
+}
 #endif
 QTEST_MAIN(tst_QWebEngineScript)
 
@@ -0,0 +1,109 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+// Measures how many frames per second a WebEngineView can present while a page animates.
+// Run it once per compositing path to compare them, for example:
+//   QT_QUICK_BACKEND=software ./renderbenchmark       (software compositing, shared memory bitmaps)
+//   LIBGL_ALWAYS_SOFTWARE=1 ./renderbenchmark         (GL compositing on llvmpipe)
+// The paths used when the Qt Quick context doesn't share with Chromium can be forced on EGL:
+//   QT_XCB_GL_INTEGRATION=xcb_egl LIBGL_ALWAYS_SOFTWARE=1 QTWEBENGINE_TEXTURE_SHARING=eglimage ./renderbenchmark
+//   QT_XCB_GL_INTEGRATION=xcb_egl LIBGL_ALWAYS_SOFTWARE=1 QTWEBENGINE_TEXTURE_SHARING=copy ./renderbenchmark
+// Run with QT_LOGGING_RULES="qt.webengine.compositor*=true" to see which path was taken.
+// The page must animate smoothly and without stale or torn frames on both of them.
+// An optional argument sets the measured duration in seconds, 10 by default.
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QTimer>
+#include <QtGui/QGuiApplication>
+#include <QtQml/QQmlApplicationEngine>
+#include <QtQml/QQmlContext>
+#include <QtQuick/QQuickWindow>
+#include <QtWebEngine/qtwebengineglobal.h>
+
+#include <stdio.h>
+
+class Benchmark : public QObject
+{
+    Q_OBJECT
+public:
+    Benchmark(int duration) : m_duration(duration) { }
+
+public Q_SLOTS:
+    void start(QQuickWindow *window)
+    {
+        if (m_window)
+            return;
+        m_window = window;
+        // Let the page and the compositor settle before counting frames.
+        QTimer::singleShot(1000, this, [this]() {
+            connect(m_window, &QQuickWindow::frameSwapped, this, [this]() { ++m_frames; },
+                    Qt::DirectConnection);
+            m_timer.start();
+            QTimer::singleShot(m_duration * 1000, this, &Benchmark::finish);
+        });
+    }
+
+private:
+    void finish()
+    {
+        disconnect(m_window, &QQuickWindow::frameSwapped, this, nullptr);
+        const qint64 elapsed = m_timer.elapsed();
+        QString backend = QQuickWindow::sceneGraphBackend();
+        if (backend.isEmpty())
+            backend = QStringLiteral("default");
+        printf("scene graph backend: %s\n", qPrintable(backend));
+        const int frames = m_frames.load();
+        printf("%d frames in %lld ms: %.1f frames/s\n", frames, elapsed, frames * 1000.0 / elapsed);
+        QCoreApplication::quit();
+    }
+
+    QQuickWindow *m_window = nullptr;
+    QElapsedTimer m_timer;
+    QAtomicInt m_frames;
+    int m_duration;
+};
+
+int main(int argc, char **argv)
+{
+    QGuiApplication app(argc, argv);
+
+    QtWebEngine::initialize();
+
+    int duration = 10;
+    if (app.arguments().count() > 1)
+        duration = qMax(1, app.arguments().at(1).toInt());
+
+    QQmlApplicationEngine appEngine;
+    Benchmark benchmark(duration);
+    appEngine.rootContext()->setContextProperty("benchmark", &benchmark);
+    appEngine.load(QUrl("qrc:/main.qml"));
+
+    return app.exec();
+}
+
+#include "main.moc"
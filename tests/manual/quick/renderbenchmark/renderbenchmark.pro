@@ -0,0 +1,14 @@
+QT += qml quick webengine
+
+TARGET = renderbenchmark
+TEMPLATE = app
+
+SOURCES = \
+    main.cpp
+
+OTHER_FILES += \
+    main.qml \
+    animation.html
+
+RESOURCES += \
+    renderbenchmark.qrc
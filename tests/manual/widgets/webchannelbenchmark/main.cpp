@@ -0,0 +1,133 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+// Measures how many WebChannel messages per second go between a page and the host,
+// first with messages as JSON text and then as structured clones.
+// An optional argument sets the number of method calls per run, 20000 by default.
+// Each call is one message to the host and one reply to the page.
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtWebChannel/QWebChannel>
+#include <QtWebEngineWidgets/QWebEnginePage>
+#include <QtWebEngineWidgets/QWebEngineScript>
+#include <QtWebEngineWidgets/QWebEngineScriptCollection>
+#include <QtWidgets/QApplication>
+
+#include <stdio.h>
+
+static const char benchmarkScript[] = R"(
+new QWebChannel(qt.webChannelTransport, function(channel) {
+    if (%2)
+        channel.send = function(data) { channel.transport.send(data); };
+    var quotes = channel.objects.quotes;
+    var count = %1, replies = 0;
+    var start = performance.now();
+    for (var i = 0; i < count; ++i) {
+        quotes.update({ symbol: 'QTWE', bid: 100 + i / 100, ask: 100.5 + i / 100, sequence: i }, function() {
+            if (++replies == count)
+                quotes.finish(performance.now() - start);
+        });
+    }
+});
+)";
+
+class Quotes : public QObject
+{
+    Q_OBJECT
+public:
+    Q_INVOKABLE int update(const QVariantMap &quote) { return quote.value(QStringLiteral("sequence")).toInt(); }
+    Q_INVOKABLE void finish(double milliseconds) { Q_EMIT finished(milliseconds); }
+
+Q_SIGNALS:
+    void finished(double milliseconds);
+};
+
+class Benchmark : public QObject
+{
+    Q_OBJECT
+public:
+    Benchmark(int count) : m_count(count)
+    {
+        m_channel.registerObject(QStringLiteral("quotes"), &m_quotes);
+        m_page.setWebChannel(&m_channel);
+
+        QFile file(QStringLiteral(":/qtwebchannel/qwebchannel.js"));
+        file.open(QFile::ReadOnly);
+        QWebEngineScript script;
+        script.setSourceCode(QString::fromUtf8(file.readAll()));
+        script.setInjectionPoint(QWebEngineScript::DocumentCreation);
+        m_page.scripts().insert(script);
+
+        connect(&m_quotes, &Quotes::finished, this, &Benchmark::finished);
+        connect(&m_page, &QWebEnginePage::loadFinished, this, &Benchmark::run);
+    }
+
+    void start() { m_page.setHtml(QStringLiteral("<html><body></body></html>")); }
+
+private:
+    void run()
+    {
+        const bool wireFormat = m_runs == 1;
+        m_page.runJavaScript(QString::fromLatin1(benchmarkScript).arg(m_count).arg(QLatin1String(wireFormat ? "true" : "false")));
+    }
+
+    void finished(double milliseconds)
+    {
+        const char *mode = m_runs == 0 ? "JSON text" : "structured clone";
+        printf("%s: %d messages in %.0f ms: %.0f messages/s\n", mode, 2 * m_count, milliseconds,
+               2 * m_count * 1000.0 / milliseconds);
+        if (++m_runs == 2) {
+            QCoreApplication::quit();
+            return;
+        }
+        // A new document starts over with JSON text.
+        start();
+    }
+
+    QWebChannel m_channel;
+    QWebEnginePage m_page;
+    Quotes m_quotes;
+    int m_count;
+    int m_runs = 0;
+};
+
+int main(int argc, char **argv)
+{
+    QApplication app(argc, argv);
+
+    int count = 20000;
+    if (app.arguments().count() > 1)
+        count = qMax(1, app.arguments().at(1).toInt());
+
+    Benchmark benchmark(count);
+    benchmark.start();
+    return app.exec();
+}
+
+#include "main.moc"
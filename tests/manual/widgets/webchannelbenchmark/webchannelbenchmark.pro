@@ -0,0 +1,7 @@
+QT += webenginewidgets webchannel
+
+TARGET = webchannelbenchmark
+TEMPLATE = app
+
+SOURCES = \
+    main.cpp